@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bloomfilter.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char *p;
+    const BloomFilter *bf;
+    long i, n, lines;
+    FILE *fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./bftest file\n");
+        return -1;
+    }
+    if ((bf = BloomFilter_create(10000L, 0.01)) == NULL) {
+        fprintf(stderr, "Error creating Bloom filter\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of addKey() and mightContainKey()
+     */
+    printf("===== test of addKey and mightContainKey\n");
+    lines = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        p = strchr(buf, '\n');
+        *p = '\0';
+        bf->addKey(bf, buf, (long)strlen(buf));
+        lines++;
+    }
+    fclose(fd);
+    fd = fopen(argv[1], "r");		/* we know we can open it */
+    n = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        p = strchr(buf, '\n');
+        *p = '\0';
+        n += bf->mightContainKey(bf, buf, (long)strlen(buf));
+    }
+    fclose(fd);
+    printf("%ld lines added, %ld found\n", lines, n);
+    printf("size = %ld, bytes = %ld\n", bf->size(bf), bf->bytes(bf));
+    /*
+     * test of add() and mightContain(); values presented by hashes with
+     * poorly mixed bits must be spread over the filter as well
+     */
+    printf("===== test of add and mightContain\n");
+    bf->clear(bf);
+    printf("size after clear = %ld, mightContainKey(\"}\") = %d\n",
+           bf->size(bf), bf->mightContainKey(bf, "}", 1L));
+    for (i = 0; i < 10000; i++)
+        bf->add(bf, (unsigned long long)i);
+    for (i = 0, n = 0; i < 10000; i++)
+        n += bf->mightContain(bf, (unsigned long long)i);
+    printf("10000 hashes added, %ld found\n", n);
+    for (i = 10000, n = 0; i < 110000; i++)
+        n += bf->mightContain(bf, (unsigned long long)i);
+    printf("false positive rate below 2%% = %d\n", n < 2000);
+    for (i = 0, n = 0; i < 100000; i++)
+        n += bf->mightContain(bf, (unsigned long long)i << 40);
+    printf("false positive rate of high bit hashes below 2%% = %d\n",
+           n < 2000);
+    /*
+     * test of destroy()
+     */
+    printf("===== test of destroy\n");
+    bf->destroy(bf);
+
+    return 0;
+}
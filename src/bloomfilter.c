@@ -0,0 +1,180 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "bloomfilter.h"
+#include "hash64.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define BLOCK_WORDS 8		/* 64-bit words per block, i.e. 64 bytes */
+#define BLOCK_BYTES (BLOCK_WORDS * sizeof(unsigned long long))
+#define DEFAULT_EXPECTED 16L
+#define DEFAULT_FP_RATE 0.01
+#define MAX_BLOCKS 67108864L	/* 4GB of bits */
+
+/*
+ * implementation of a split block Bloom filter: each value sets one bit in
+ * each of the 8 words of the block selected by its hash, the bit in word
+ * i chosen by multiplying the low 32 bits of the hash by the odd constant
+ * salt[i] and keeping the top 6 bits of the product
+ */
+static const unsigned int salt[BLOCK_WORDS] = {
+    0x47b6137bU, 0x44974d91U, 0x8824ad5bU, 0xa2b7289dU,
+    0x705495c7U, 0x2df1424bU, 0x9efc4947U, 0x5c6bfb31U
+};
+
+typedef struct bf_data {
+    long size;
+    long nblocks;
+    unsigned long long *blocks;	/* nblocks * BLOCK_WORDS words */
+} BfData;
+
+/*
+ * local function returning the first word of the block for the mixed
+ * hash `m'; the high 32 bits of `m' are scaled to [0, nblocks) with a
+ * multiply rather than a division
+ */
+static unsigned long long *block(BfData *bfd, unsigned long long m) {
+    unsigned long long i = ((m >> 32) * (unsigned long long)bfd->nblocks) >> 32;
+
+    return bfd->blocks + i * BLOCK_WORDS;
+}
+
+#define BIT(m, i) (1ULL << (((unsigned int)(m) * salt[i]) >> 26))
+
+static void bf_destroy(const BloomFilter *bf) {
+    BfData *bfd = (BfData *)bf->self;
+
+    free(bfd->blocks);
+    free(bfd);
+    free((void *)bf);
+}
+
+static void bf_clear(const BloomFilter *bf) {
+    BfData *bfd = (BfData *)bf->self;
+
+    memset(bfd->blocks, 0, bfd->nblocks * BLOCK_BYTES);
+    bfd->size = 0L;
+}
+
+static void bf_add(const BloomFilter *bf, unsigned long long hash) {
+    BfData *bfd = (BfData *)bf->self;
+    unsigned long long m = hash64_int(hash);
+    unsigned long long *w = block(bfd, m);
+    int i;
+
+    for (i = 0; i < BLOCK_WORDS; i++)
+        w[i] |= BIT(m, i);
+    bfd->size++;
+}
+
+static int bf_mightContain(const BloomFilter *bf, unsigned long long hash) {
+    BfData *bfd = (BfData *)bf->self;
+    unsigned long long m = hash64_int(hash);
+    unsigned long long *w = block(bfd, m);
+    int i;
+
+    for (i = 0; i < BLOCK_WORDS; i++)
+        if ((w[i] & BIT(m, i)) == 0)
+            return 0;
+    return 1;
+}
+
+static void bf_addKey(const BloomFilter *bf, void *key, long len) {
+    bf_add(bf, hash64(key, (size_t)len));
+}
+
+static int bf_mightContainKey(const BloomFilter *bf, void *key, long len) {
+    return bf_mightContain(bf, hash64(key, (size_t)len));
+}
+
+static long bf_size(const BloomFilter *bf) {
+    BfData *bfd = (BfData *)bf->self;
+
+    return bfd->size;
+}
+
+static long bf_bytes(const BloomFilter *bf) {
+    BfData *bfd = (BfData *)bf->self;
+
+    return bfd->nblocks * (long)BLOCK_BYTES;
+}
+
+static BloomFilter template = {
+    NULL, bf_destroy, bf_clear, bf_add, bf_mightContain, bf_addKey,
+    bf_mightContainKey, bf_size, bf_bytes
+};
+
+/*
+ * a classic Bloom filter needs log2(1/fpRate) / ln(2) bits per value;
+ * confining each value to one block costs about 20% more, so bits per
+ * value is taken as 1.73 times the number of halvings from 1 to fpRate
+ */
+const BloomFilter *BloomFilter_create(long expected, double fpRate) {
+    BloomFilter *bf = (BloomFilter *)malloc(sizeof(BloomFilter));
+    double bits, q;
+    long N;
+
+    if (bf != NULL) {
+        BfData *bfd = (BfData *)malloc(sizeof(BfData));
+
+        if (bfd != NULL) {
+            void *p = NULL;
+
+            if (expected <= 0L)
+                expected = DEFAULT_EXPECTED;
+            if (fpRate <= 0.0 || fpRate >= 1.0)
+                fpRate = DEFAULT_FP_RATE;
+            for (bits = 0.0, q = fpRate; q < 1.0; q *= 2.0)
+                bits += 1.0;
+            bits = 1.73 * bits * (double)expected;
+            N = (long)(bits / (double)(8 * BLOCK_BYTES)) + 1L;
+            if (N > MAX_BLOCKS)
+                N = MAX_BLOCKS;
+            if (posix_memalign(&p, BLOCK_BYTES, N * BLOCK_BYTES) == 0) {
+                bfd->blocks = (unsigned long long *)p;
+                bfd->nblocks = N;
+                memset(p, 0, N * BLOCK_BYTES);
+                bfd->size = 0L;
+                *bf = template;
+                bf->self = bfd;
+            } else {
+                free(bfd);
+                free(bf);
+                bf = NULL;
+            }
+        } else {
+            free(bf);
+            bf = NULL;
+        }
+    }
+    return bf;
+}
@@ -0,0 +1,113 @@
+#ifndef _BLOOMFILTER_H_
+#define _BLOOMFILTER_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a blocked Bloom filter
+ *
+ * a Bloom filter answers whether a value might have been added to it;
+ * if the answer is no, the value was certainly never added, so a filter
+ * kept beside a larger structure lets lookups that will fail skip that
+ * structure altogether; the answer yes is wrong for a small fraction of
+ * values that were not added (the false positive rate)
+ *
+ * the filter is divided into blocks the size of a cache line, and all of
+ * the bits for a value are set in a single block, so add() and
+ * mightContain() each touch one cache line
+ *
+ * values are presented by their 64-bit hashes, which need not be well
+ * mixed; values cannot be removed from the filter, other than by clear()
+ */
+
+typedef struct bloomfilter BloomFilter;	/* forward reference */
+
+/*
+ * create a Bloom filter sized to hold `expected' values with a false
+ * positive rate of approximately `fpRate'; if expected <= 0, room for 16
+ * values is provided; if fpRate is not in (0.0, 1.0), a default rate of
+ * 0.01 is used; adding more than `expected' values raises the rate
+ *
+ * returns a pointer to the filter, or NULL if there are malloc() errors
+ */
+const BloomFilter *BloomFilter_create(long expected, double fpRate);
+
+/*
+ * now define struct bloomfilter
+ */
+struct bloomfilter {
+/*
+ * the private data of the filter
+ */
+    void *self;
+
+/*
+ * destroys the filter, returning its storage to the heap
+ */
+    void (*destroy)(const BloomFilter *bf);
+
+/*
+ * clears the filter; upon return, mightContain() returns 0 for every hash
+ */
+    void (*clear)(const BloomFilter *bf);
+
+/*
+ * adds the value whose 64-bit hash is `hash' to the filter
+ */
+    void (*add)(const BloomFilter *bf, unsigned long long hash);
+
+/*
+ * returns 0 if the value whose 64-bit hash is `hash' was certainly not
+ * added to the filter, 1 if it might have been
+ */
+    int (*mightContain)(const BloomFilter *bf, unsigned long long hash);
+
+/*
+ * adds/checks the `len'-byte key starting at `key', using the same 64-bit
+ * hash of its bytes as HashMap
+ */
+    void (*addKey)(const BloomFilter *bf, void *key, long len);
+    int (*mightContainKey)(const BloomFilter *bf, void *key, long len);
+
+/*
+ * returns the number of add()s and addKey()s since the filter was created
+ * or last cleared
+ */
+    long (*size)(const BloomFilter *bf);
+
+/*
+ * returns the number of bytes occupied by the bits of the filter
+ */
+    long (*bytes)(const BloomFilter *bf);
+};
+
+#endif /* _BLOOMFILTER_H_ */
@@ -0,0 +1,1043 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "orderedset.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * implementation for generic ordered set
+ * implemented as a B+tree
+ *
+ * each node holds a sorted array of up to `fanout' elements (a leaf) or
+ * of up to `fanout' separators and fanout + 1 children (an internal node)
+ * in a single allocation aligned to a cache line, so a search touches a
+ * few adjacent cache lines per level instead of one node per comparison,
+ * and the elements cost one pointer each; the leaves are linked in order,
+ * so scans and neighbour queries walk the leaves without descending
+ *
+ * separator i of an internal node is the least element of child i + 1;
+ * separators are always elements in the set, so an element must be
+ * replaced as a separator before it is handed to a freeFxn
+ */
+
+#define DEFAULT_FANOUT 28	/* leaves are then 4 cache lines */
+#define MIN_FANOUT 4
+#define MAX_FANOUT 4096
+#define LINE 64			/* nodes are aligned to a cache line */
+#define MAX_DEPTH 64		/* far more than 2^63 elements need */
+
+typedef struct bt_node {
+    int leaf;
+    int n;			/* number of elements or separators */
+    struct bt_node *next;	/* leaves only: the neighbouring leaves */
+    struct bt_node *prev;
+} BtNode;
+
+/*
+ * a node is followed by room for fanout + 1 elements or separators, one
+ * more than it may hold between operations; an internal node is then
+ * followed by room for fanout + 2 children
+ */
+#define ELEMS(p) ((void **)((p) + 1))
+#define KIDS(btd, p) ((BtNode **)(ELEMS(p) + (btd)->fanout + 1))
+
+typedef struct bt_data {
+    long size;
+    int fanout;
+    int minFill;		/* non-root nodes hold at least this many */
+    BtNode *root;		/* a leaf, possibly empty, if size <= fanout */
+    BtNode *head;		/* first and last leaves */
+    BtNode *tail;
+    int (*cmp)(void *, void *);
+} BtData;
+
+/*
+ * allocates a leaf or internal node for `btd'
+ *
+ * returns pointer to the node, or NULL if malloc failure
+ */
+static BtNode *newNode(BtData *btd, int leaf) {
+    size_t nbytes = sizeof(BtNode) + (btd->fanout + 1) * sizeof(void *);
+    void *p = NULL;
+
+    if (! leaf)
+        nbytes += (btd->fanout + 2) * sizeof(BtNode *);
+    nbytes = (nbytes + LINE - 1) & ~((size_t)LINE - 1);
+    if (posix_memalign(&p, LINE, nbytes) != 0)
+        return NULL;
+    ((BtNode *)p)->leaf = leaf;
+    ((BtNode *)p)->n = 0;
+    ((BtNode *)p)->next = ((BtNode *)p)->prev = NULL;
+    return (BtNode *)p;
+}
+
+/*
+ * returns the index of the first element of `p' that is >= `element',
+ * setting `*found' to 1 if it is equal, 0 otherwise
+ */
+static int search(BtData *btd, BtNode *p, void *element, int *found) {
+    void **e = ELEMS(p);
+    int lo = 0, hi = p->n;
+
+    while (lo < hi) {
+        int mid = (lo + hi) / 2;
+        int c = (*btd->cmp)(e[mid], element);
+
+        if (c == 0) {
+            *found = 1;
+            return mid;
+        }
+        if (c < 0)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    *found = 0;
+    return lo;
+}
+
+/*
+ * descends to the leaf where `element' is or would be
+ *
+ * returns the leaf, with the index returned by search() in `*pos'
+ */
+static BtNode *findLeaf(BtData *btd, void *element, int *pos, int *found) {
+    BtNode *p = btd->root;
+
+    while (! p->leaf) {
+        int i = search(btd, p, element, found);
+        p = KIDS(btd, p)[*found ? i + 1 : i];
+    }
+    *pos = search(btd, p, element, found);
+    return p;
+}
+
+/*
+ * returns the least element of the subtree rooted at `p'
+ */
+static void *leftmost(BtData *btd, BtNode *p) {
+    while (! p->leaf)
+        p = KIDS(btd, p)[0];
+    return ELEMS(p)[0];
+}
+
+/*
+ * frees the nodes of the subtree rooted at `p', except `keep'
+ */
+static void freeTree(BtData *btd, BtNode *p, BtNode *keep) {
+    int i;
+
+    if (! p->leaf)
+        for (i = 0; i <= p->n; i++)
+            freeTree(btd, KIDS(btd, p)[i], keep);
+    if (p != keep)
+        free(p);
+}
+
+/*
+ * frees every node but the first leaf, which becomes the empty root,
+ * calling freeFxn on each element
+ */
+static void purge(BtData *btd, void (*freeFxn)(void *element)) {
+    BtNode *p;
+    int i;
+
+    if (freeFxn != NULL)
+        for (p = btd->head; p != NULL; p = p->next)
+            for (i = 0; i < p->n; i++)
+                (*freeFxn)(ELEMS(p)[i]);
+    freeTree(btd, btd->root, btd->head);
+    btd->root = btd->tail = btd->head;
+    btd->head->n = 0;
+    btd->head->next = NULL;
+    btd->size = 0L;
+}
+
+static void bt_destroy(const OrderedSet *os, void (*freeFxn)(void *element)) {
+    BtData *btd = (BtData *)os->self;
+
+    purge(btd, freeFxn);
+    free(btd->root);
+    free(btd);
+    free((void *)os);
+}
+
+static void bt_clear(const OrderedSet *os, void (*freeFxn)(void *element)) {
+    BtData *btd = (BtData *)os->self;
+
+    purge(btd, freeFxn);
+}
+
+/*
+ * nodes preallocated by add() for the splits an insertion will cause, so
+ * that a malloc failure is detected before the tree is changed
+ */
+typedef struct stash {
+    BtNode *node[MAX_DEPTH + 1];
+    int n;
+} Stash;
+
+/*
+ * local function that splits the overfull node `p', at which an element
+ * or separator was just inserted at index `i', moving its upper part to a
+ * node from `stash'; a node on the right edge of the tree into which the
+ * last element was inserted keeps all it can hold, so that a set built in
+ * ascending order has full leaves
+ *
+ * returns the new right node, with its least element in `*sep'
+ */
+static BtNode *split(BtData *btd, BtNode *p, int i, int rightmost,
+                     Stash *stash, void **sep) {
+    BtNode *q = stash->node[--stash->n];
+    int n = p->n, keep;
+
+    if (p->leaf) {
+        keep = (rightmost && i == n - 1) ? btd->fanout : (n + 1) / 2;
+        memcpy(ELEMS(q), ELEMS(p) + keep, (n - keep) * sizeof(void *));
+        q->n = n - keep;
+        p->n = keep;
+        q->next = p->next;
+        q->prev = p;
+        if (p->next != NULL)
+            p->next->prev = q;
+        else
+            btd->tail = q;
+        p->next = q;
+        *sep = ELEMS(q)[0];
+    } else {			/* separator `keep' moves up */
+        keep = (rightmost && i == n - 1) ? n - 2 : n / 2;
+        *sep = ELEMS(p)[keep];
+        memcpy(ELEMS(q), ELEMS(p) + keep + 1,
+               (n - keep - 1) * sizeof(void *));
+        memcpy(KIDS(btd, q), KIDS(btd, p) + keep + 1,
+               (n - keep) * sizeof(BtNode *));
+        q->n = n - keep - 1;
+        p->n = keep;
+    }
+    return q;
+}
+
+/*
+ * local function that inserts `element', known to be absent, into the
+ * subtree rooted at `p'
+ *
+ * returns the new right sibling of `p' if `p' split, with its least
+ * element in `*sep', or NULL if it did not
+ */
+static BtNode *insert(BtData *btd, BtNode *p, void *element, int rightmost,
+                      Stash *stash, void **sep) {
+    void **e = ELEMS(p);
+    int i, found;
+
+    i = search(btd, p, element, &found);
+    if (p->leaf) {
+        memmove(e + i + 1, e + i, (p->n - i) * sizeof(void *));
+        e[i] = element;
+    } else {
+        BtNode **k = KIDS(btd, p);
+        BtNode *q = insert(btd, k[i], element, rightmost && i == p->n,
+                           stash, sep);
+
+        if (q == NULL)
+            return NULL;
+        memmove(e + i + 1, e + i, (p->n - i) * sizeof(void *));
+        memmove(k + i + 2, k + i + 1, (p->n - i) * sizeof(BtNode *));
+        e[i] = *sep;
+        k[i + 1] = q;
+    }
+    p->n++;
+    if (p->n > btd->fanout)
+        return split(btd, p, i, rightmost, stash, sep);
+    return NULL;
+}
+
+static int bt_add(const OrderedSet *os, void *element) {
+    BtData *btd = (BtData *)os->self;
+    BtNode *p = btd->root, *q;
+    Stash stash;
+    int i, found, depth = 0, full = 0;
+    void *sep;
+
+    /*
+     * check for the element, counting the full nodes at the bottom of
+     * the path, each of which will split
+     */
+    for (;;) {
+        i = search(btd, p, element, &found);
+        if (found)
+            return 0;
+        depth++;
+        full = (p->n == btd->fanout) ? full + 1 : 0;
+        if (p->leaf)
+            break;
+        p = KIDS(btd, p)[i];
+    }
+    if (full == depth)
+        full++;			/* the root splits, so a new root too */
+    /*
+     * the nodes are used from the end of the stash: first a leaf, then
+     * internal nodes up the path, and the new root, if any, last
+     */
+    for (stash.n = 0; stash.n < full; stash.n++) {
+        int leaf = (stash.n == full - 1);
+        if ((stash.node[stash.n] = newNode(btd, leaf)) == NULL) {
+            while (stash.n > 0)
+                free(stash.node[--stash.n]);
+            return 0;
+        }
+    }
+    q = insert(btd, btd->root, element, 1, &stash, &sep);
+    if (q != NULL) {
+        p = stash.node[--stash.n];
+        ELEMS(p)[0] = sep;
+        KIDS(btd, p)[0] = btd->root;
+        KIDS(btd, p)[1] = q;
+        p->n = 1;
+        btd->root = p;
+    }
+    btd->size++;
+    return 1;
+}
+
+/*
+ * local function that restores child `j' of `p', which has fewer than
+ * minFill elements or separators, by moving one over from a neighbour
+ * that can spare it, or else by merging it with a neighbour
+ */
+static void rebalance(BtData *btd, BtNode *p, int j) {
+    void **e = ELEMS(p);
+    BtNode **k = KIDS(btd, p);
+    BtNode *c = k[j], *l, *r;
+    int m;
+
+    if (j > 0 && k[j - 1]->n > btd->minFill) {		/* from the left */
+        l = k[j - 1];
+        memmove(ELEMS(c) + 1, ELEMS(c), c->n * sizeof(void *));
+        if (c->leaf) {
+            ELEMS(c)[0] = ELEMS(l)[l->n - 1];
+            e[j - 1] = ELEMS(c)[0];
+        } else {
+            memmove(KIDS(btd, c) + 1, KIDS(btd, c),
+                    (c->n + 1) * sizeof(BtNode *));
+            ELEMS(c)[0] = e[j - 1];
+            KIDS(btd, c)[0] = KIDS(btd, l)[l->n];
+            e[j - 1] = ELEMS(l)[l->n - 1];
+        }
+        c->n++;
+        l->n--;
+        return;
+    }
+    if (j < p->n && k[j + 1]->n > btd->minFill) {	/* from the right */
+        r = k[j + 1];
+        if (c->leaf) {
+            ELEMS(c)[c->n] = ELEMS(r)[0];
+            memmove(ELEMS(r), ELEMS(r) + 1, (r->n - 1) * sizeof(void *));
+            e[j] = ELEMS(r)[0];
+        } else {
+            ELEMS(c)[c->n] = e[j];
+            KIDS(btd, c)[c->n + 1] = KIDS(btd, r)[0];
+            e[j] = ELEMS(r)[0];
+            memmove(ELEMS(r), ELEMS(r) + 1, (r->n - 1) * sizeof(void *));
+            memmove(KIDS(btd, r), KIDS(btd, r) + 1, r->n * sizeof(BtNode *));
+        }
+        c->n++;
+        r->n--;
+        return;
+    }
+    if (j == p->n)		/* merge children m and m + 1 */
+        j--;
+    m = j;
+    l = k[m];
+    r = k[m + 1];
+    if (l->leaf) {
+        memcpy(ELEMS(l) + l->n, ELEMS(r), r->n * sizeof(void *));
+        l->n += r->n;
+        l->next = r->next;
+        if (r->next != NULL)
+            r->next->prev = l;
+        else
+            btd->tail = l;
+    } else {
+        ELEMS(l)[l->n] = e[m];
+        memcpy(ELEMS(l) + l->n + 1, ELEMS(r), r->n * sizeof(void *));
+        memcpy(KIDS(btd, l) + l->n + 1, KIDS(btd, r),
+               (r->n + 1) * sizeof(BtNode *));
+        l->n += r->n + 1;
+    }
+    free(r);
+    memmove(e + m, e + m + 1, (p->n - m - 1) * sizeof(void *));
+    memmove(k + m + 1, k + m + 2, (p->n - m - 1) * sizeof(BtNode *));
+    p->n--;
+}
+
+/*
+ * local function that removes `element' from the subtree rooted at `p'
+ *
+ * returns 1 if removed, with the element that was in the set in `*old';
+ * 0 if not present
+ */
+static int removeElement(BtData *btd, BtNode *p, void *element, void **old) {
+    int i, j, found;
+
+    i = search(btd, p, element, &found);
+    if (p->leaf) {
+        if (! found)
+            return 0;
+        *old = ELEMS(p)[i];
+        memmove(ELEMS(p) + i, ELEMS(p) + i + 1, (p->n - i - 1) * sizeof(void *));
+        p->n--;
+        return 1;
+    }
+    j = found ? i + 1 : i;
+    if (! removeElement(btd, KIDS(btd, p)[j], element, old))
+        return 0;
+    if (found)			/* it was the least element of child j */
+        ELEMS(p)[i] = leftmost(btd, KIDS(btd, p)[j]);
+    if (KIDS(btd, p)[j]->n < btd->minFill)
+        rebalance(btd, p, j);
+    return 1;
+}
+
+static int bt_remove(const OrderedSet *os, void *element,
+                     void (*freeFxn)(void *element)) {
+    BtData *btd = (BtData *)os->self;
+    BtNode *p = btd->root;
+    void *old;
+
+    if (! removeElement(btd, p, element, &old))
+        return 0;
+    if (! p->leaf && p->n == 0) {	/* the root has a single child */
+        btd->root = KIDS(btd, p)[0];
+        free(p);
+    }
+    btd->size--;
+    if (freeFxn != NULL)
+        (*freeFxn)(old);
+    return 1;
+}
+
+static int bt_contains(const OrderedSet *os, void *element) {
+    BtData *btd = (BtData *)os->self;
+    int pos, found;
+
+    (void) findLeaf(btd, element, &pos, &found);
+    return found;
+}
+
+/*
+ * the neighbour queries find the leaf position of `element', then step
+ * at most one element forward or back, which may be into the next or
+ * previous leaf; only the root leaf may be empty
+ */
+static int bt_ceiling(const OrderedSet *os, void *element, void **ceiling) {
+    BtData *btd = (BtData *)os->self;
+    int pos, found;
+    BtNode *p = findLeaf(btd, element, &pos, &found);
+
+    if (pos == p->n) {
+        if ((p = p->next) == NULL)
+            return 0;
+        pos = 0;
+    }
+    *ceiling = ELEMS(p)[pos];
+    return 1;
+}
+
+static int bt_higher(const OrderedSet *os, void *element, void **higher) {
+    BtData *btd = (BtData *)os->self;
+    int pos, found;
+    BtNode *p = findLeaf(btd, element, &pos, &found);
+
+    pos += found;
+    if (pos == p->n) {
+        if ((p = p->next) == NULL)
+            return 0;
+        pos = 0;
+    }
+    *higher = ELEMS(p)[pos];
+    return 1;
+}
+
+static int bt_floor(const OrderedSet *os, void *element, void **floor) {
+    BtData *btd = (BtData *)os->self;
+    int pos, found;
+    BtNode *p = findLeaf(btd, element, &pos, &found);
+
+    if (! found && --pos < 0) {
+        if ((p = p->prev) == NULL)
+            return 0;
+        pos = p->n - 1;
+    }
+    *floor = ELEMS(p)[pos];
+    return 1;
+}
+
+static int bt_lower(const OrderedSet *os, void *element, void **lower) {
+    BtData *btd = (BtData *)os->self;
+    int pos, found;
+    BtNode *p = findLeaf(btd, element, &pos, &found);
+
+    if (--pos < 0) {
+        if ((p = p->prev) == NULL)
+            return 0;
+        pos = p->n - 1;
+    }
+    *lower = ELEMS(p)[pos];
+    return 1;
+}
+
+static int bt_first(const OrderedSet *os, void **element) {
+    BtData *btd = (BtData *)os->self;
+
+    if (btd->size == 0L)
+        return 0;
+    *element = ELEMS(btd->head)[0];
+    return 1;
+}
+
+static int bt_last(const OrderedSet *os, void **element) {
+    BtData *btd = (BtData *)os->self;
+
+    if (btd->size == 0L)
+        return 0;
+    *element = ELEMS(btd->tail)[btd->tail->n - 1];
+    return 1;
+}
+
+static int bt_isEmpty(const OrderedSet *os) {
+    BtData *btd = (BtData *)os->self;
+
+    return (btd->size == 0L);
+}
+
+static int bt_pollFirst(const OrderedSet *os, void **element) {
+    return bt_first(os, element) && bt_remove(os, *element, NULL);
+}
+
+static int bt_pollLast(const OrderedSet *os, void **element) {
+    return bt_last(os, element) && bt_remove(os, *element, NULL);
+}
+
+static long bt_size(const OrderedSet *os) {
+    BtData *btd = (BtData *)os->self;
+
+    return btd->size;
+}
+
+/*
+ * generates an array of void * pointers on the heap and copies the
+ * elements into it, walking the leaves in order
+ *
+ * returns pointer to array or NULL if empty or malloc failure
+ */
+static void **genArray(BtData *btd) {
+    void **tmp = NULL;
+    BtNode *p;
+    long n = 0L;
+
+    if (btd->size > 0L) {
+        tmp = (void **)malloc(btd->size * sizeof(void *));
+        if (tmp != NULL)
+            for (p = btd->head; p != NULL; p = p->next) {
+                memcpy(tmp + n, ELEMS(p), p->n * sizeof(void *));
+                n += p->n;
+            }
+    }
+    return tmp;
+}
+
+static void **bt_toArray(const OrderedSet *os, long *len) {
+    BtData *btd = (BtData *)os->self;
+    void **array = genArray(btd);
+
+    if (array != NULL)
+        *len = btd->size;
+    return array;
+}
+
+static const Iterator *bt_itCreate(const OrderedSet *os) {
+    BtData *btd = (BtData *)os->self;
+    const Iterator *it = NULL;
+    void **tmp = genArray(btd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(btd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+/*
+ * set algebra
+ *
+ * the elements of both sets are listed in order and merged in a single
+ * linear pass, and the merged elements are then loaded into a new B+tree
+ * bottom up, without any comparisons or splits
+ */
+
+/*
+ * local function that loads the `n' ordered elements of `a' into the
+ * empty B+tree `btd'; the nodes of each level are filled evenly, so that
+ * each holds at least minFill
+ *
+ * returns 1 if successful, 0 if malloc failure, leaving `btd' unchanged
+ */
+static int load(BtData *btd, void **a, long n) {
+    BtNode **level, *head = NULL, *tail = NULL;
+    void **least;
+    long m, i, j, c, per, extra, used;
+    int ok = 1;
+
+    if (n == 0L)
+        return 1;
+    m = (n + btd->fanout - 1) / btd->fanout;
+    level = (BtNode **)malloc(m * sizeof(BtNode *));
+    least = (void **)malloc(m * sizeof(void *));
+    if (level == NULL || least == NULL) {
+        free(level);
+        free(least);
+        return 0;
+    }
+    for (i = 0; i < m; i++)
+        if ((level[i] = newNode(btd, 1)) == NULL)
+            ok = 0;
+    if (ok) {
+        per = n / m;
+        extra = n % m;
+        for (i = 0, used = 0; i < m; i++) {
+            c = per + (i < extra);
+            memcpy(ELEMS(level[i]), a + used, c * sizeof(void *));
+            level[i]->n = (int)c;
+            level[i]->prev = (i > 0) ? level[i - 1] : NULL;
+            level[i]->next = (i < m - 1) ? level[i + 1] : NULL;
+            least[i] = a[used];
+            used += c;
+        }
+        head = level[0];
+        tail = level[m - 1];
+    }
+    /*
+     * then groups of up to fanout + 1 nodes of each level become the
+     * children of the nodes of the next level, until one node remains;
+     * level and least are rewritten in place
+     */
+    while (ok && m > 1) {
+        long parents = (m + btd->fanout) / (btd->fanout + 1);
+        BtNode **fresh = (BtNode **)malloc(parents * sizeof(BtNode *));
+
+        if (fresh == NULL) {
+            ok = 0;
+            break;
+        }
+        for (i = 0; i < parents; i++)
+            if ((fresh[i] = newNode(btd, 0)) == NULL)
+                ok = 0;
+        if (ok) {
+            per = m / parents;
+            extra = m % parents;
+            for (i = 0, used = 0; i < parents; i++) {
+                BtNode *p = fresh[i];
+
+                c = per + (i < extra);
+                for (j = 0; j < c; j++) {
+                    KIDS(btd, p)[j] = level[used + j];
+                    if (j > 0)
+                        ELEMS(p)[j - 1] = least[used + j];
+                }
+                p->n = (int)(c - 1);
+                least[i] = least[used];
+                used += c;
+            }
+            for (i = 0; i < parents; i++)
+                level[i] = fresh[i];
+            m = parents;
+        } else {
+            for (i = 0; i < parents; i++)
+                free(fresh[i]);
+        }
+        free(fresh);
+    }
+    if (ok) {
+        free(btd->root);		/* the empty root leaf */
+        btd->root = level[0];
+        btd->head = head;
+        btd->tail = tail;
+        btd->size = n;
+    } else
+        for (i = 0; i < m; i++)
+            if (level[i] != NULL)
+                freeTree(btd, level[i], NULL);
+    free(level);
+    free(least);
+    return ok;
+}
+
+#define BT_UNION 0
+#define BT_INTERSECT 1
+#define BT_DIFFERENCE 2
+
+/*
+ * local function that implements setUnion(), intersect() and difference()
+ * by merging the ordered elements of the two sets
+ */
+static const OrderedSet *merge(const OrderedSet *os, const OrderedSet *other,
+                               int op) {
+    BtData *btd = (BtData *)os->self;
+    const OrderedSet *ans = NULL;
+    void **a = NULL, **b = NULL, **c = NULL;
+    long i = 0L, j = 0L, k = 0L, na = btd->size, nb = 0L;
+    int ok = 1;
+
+    if (na > 0L && (a = genArray(btd)) == NULL)
+        ok = 0;
+    if (ok && ! other->isEmpty(other) && (b = other->toArray(other, &nb)) == NULL)
+        ok = 0;
+    if (ok && na + nb > 0L &&
+        (c = (void **)malloc((na + nb) * sizeof(void *))) == NULL)
+        ok = 0;
+    if (ok) {
+        while (i < na && j < nb) {
+            int r = (*btd->cmp)(a[i], b[j]);
+
+            if (r < 0) {
+                if (op != BT_INTERSECT)
+                    c[k++] = a[i];
+                i++;
+            } else if (r > 0) {
+                if (op == BT_UNION)
+                    c[k++] = b[j];
+                j++;
+            } else {
+                if (op != BT_DIFFERENCE)
+                    c[k++] = a[i];
+                i++;
+                j++;
+            }
+        }
+        if (op != BT_INTERSECT)
+            while (i < na)
+                c[k++] = a[i++];
+        if (op == BT_UNION)
+            while (j < nb)
+                c[k++] = b[j++];
+        ans = OrderedSet_createBTree(btd->cmp, btd->fanout);
+        if (ans != NULL && ! load((BtData *)ans->self, c, k)) {
+            ans->destroy(ans, NULL);
+            ans = NULL;
+        }
+    }
+    free(a);
+    free(b);
+    free(c);
+    return ans;
+}
+
+static const OrderedSet *bt_setUnion(const OrderedSet *os,
+                                     const OrderedSet *other) {
+    return merge(os, other, BT_UNION);
+}
+
+static const OrderedSet *bt_intersect(const OrderedSet *os,
+                                      const OrderedSet *other) {
+    return merge(os, other, BT_INTERSECT);
+}
+
+static const OrderedSet *bt_difference(const OrderedSet *os,
+                                       const OrderedSet *other) {
+    return merge(os, other, BT_DIFFERENCE);
+}
+
+/*
+ * the leaves of `os' are walked in step with the ordered elements of
+ * `other'
+ */
+static int bt_isSubset(const OrderedSet *os, const OrderedSet *other) {
+    BtData *btd = (BtData *)os->self;
+    BtNode *p;
+    void **b;
+    long j = 0L, nb = 0L;
+    int i, ans = 1;
+
+    if (btd->size == 0L)
+        return 1;
+    if (btd->size > other->size(other))
+        return 0;
+    if ((b = other->toArray(other, &nb)) == NULL)
+        return -1;
+    for (p = btd->head; ans == 1 && p != NULL; p = p->next)
+        for (i = 0; ans == 1 && i < p->n; i++) {
+            void *e = ELEMS(p)[i];
+
+            while (j < nb && (*btd->cmp)(b[j], e) < 0)
+                j++;
+            if (j == nb || (*btd->cmp)(b[j], e) != 0)
+                ans = 0;
+        }
+    free(b);
+    return ans;
+}
+
+/*
+ * a cursor over a B+tree holds its leaf and the index of the element in
+ * the leaf, and moves between leaves along their links
+ */
+static int place(OSCursor *cursor, BtNode *p, int i, void **found) {
+    cursor->node = p;
+    cursor->index = (long)i;
+    if (p == NULL)
+        return 0;
+    *found = ELEMS(p)[i];
+    return 1;
+}
+
+static int bt_cursorFirst(const OrderedSet *os, OSCursor *cursor,
+                          void **found) {
+    BtData *btd = (BtData *)os->self;
+
+    if (btd->size == 0L)
+        return place(cursor, NULL, 0, found);
+    return place(cursor, btd->head, 0, found);
+}
+
+static int bt_cursorLast(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    BtData *btd = (BtData *)os->self;
+
+    if (btd->size == 0L)
+        return place(cursor, NULL, 0, found);
+    return place(cursor, btd->tail, btd->tail->n - 1, found);
+}
+
+static int bt_cursorSeek(const OrderedSet *os, OSCursor *cursor,
+                         void *element, void **found) {
+    BtData *btd = (BtData *)os->self;
+    int pos, match;
+    BtNode *p = findLeaf(btd, element, &pos, &match);
+
+    if (pos == p->n) {
+        p = p->next;
+        pos = 0;
+    }
+    return place(cursor, p, pos, found);
+}
+
+static int bt_cursorNext(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    BtNode *p = (BtNode *)cursor->node;
+    int i = (int)cursor->index + 1;
+
+    (void) os;
+    if (p == NULL)
+        return 0;
+    if (i == p->n) {
+        p = p->next;
+        i = 0;
+    }
+    return place(cursor, p, i, found);
+}
+
+static int bt_cursorPrev(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    BtNode *p = (BtNode *)cursor->node;
+    int i = (int)cursor->index - 1;
+
+    (void) os;
+    if (p == NULL)
+        return 0;
+    if (i < 0) {
+        p = p->prev;
+        i = (p != NULL) ? p->n - 1 : 0;
+    }
+    return place(cursor, p, i, found);
+}
+
+/*
+ * a range is walked with a cursor; rangeStart() places the cursor on the
+ * first element of the range, and inRange() tests against the upper bound
+ */
+static int rangeStart(const OrderedSet *os, OSCursor *cursor, void *lo,
+                      int loInclusive, void **found) {
+    BtData *btd = (BtData *)os->self;
+    int status;
+
+    if (lo == NULL)
+        return bt_cursorFirst(os, cursor, found);
+    status = bt_cursorSeek(os, cursor, lo, found);
+    if (status && !loInclusive && (*btd->cmp)(*found, lo) == 0)
+        status = bt_cursorNext(os, cursor, found);
+    return status;
+}
+
+static int inRange(BtData *btd, void *element, void *hi, int hiInclusive) {
+    int c;
+
+    if (hi == NULL)
+        return 1;
+    c = (*btd->cmp)(element, hi);
+    return (c < 0 || (c == 0 && hiInclusive));
+}
+
+typedef struct range_data {
+    const OrderedSet *os;
+    OSCursor cursor;
+    void *next;
+    int more;
+    void *hi;
+    int hiInclusive;
+} RangeData;
+
+static int range_hasNext(const Iterator *it) {
+    RangeData *rd = (RangeData *)it->self;
+
+    return rd->more;
+}
+
+static int range_next(const Iterator *it, void **element) {
+    RangeData *rd = (RangeData *)it->self;
+    BtData *btd = (BtData *)rd->os->self;
+
+    if (!rd->more)
+        return 0;
+    *element = rd->next;
+    rd->more = bt_cursorNext(rd->os, &rd->cursor, &rd->next) &&
+               inRange(btd, rd->next, rd->hi, rd->hiInclusive);
+    return 1;
+}
+
+static void range_destroy(const Iterator *it) {
+    free(it->self);
+    free((void *)it);
+}
+
+static Iterator rangeTemplate = {
+    NULL, range_hasNext, range_next, range_destroy
+};
+
+static const Iterator *bt_range(const OrderedSet *os, void *lo,
+                                int loInclusive, void *hi, int hiInclusive) {
+    BtData *btd = (BtData *)os->self;
+    Iterator *it = (Iterator *)malloc(sizeof(Iterator));
+
+    if (it != NULL) {
+        RangeData *rd = (RangeData *)malloc(sizeof(RangeData));
+
+        if (rd != NULL) {
+            rd->os = os;
+            rd->hi = hi;
+            rd->hiInclusive = hiInclusive;
+            rd->more = rangeStart(os, &rd->cursor, lo, loInclusive,
+                                  &rd->next) &&
+                       inRange(btd, rd->next, hi, hiInclusive);
+            *it = rangeTemplate;
+            it->self = rd;
+        } else {
+            free(it);
+            it = NULL;
+        }
+    }
+    return it;
+}
+
+/*
+ * a leaf whose last element is in the range is counted whole, so the
+ * count takes O(log n + k/fanout) comparisons
+ */
+static long bt_countRange(const OrderedSet *os, void *lo, int loInclusive,
+                          void *hi, int hiInclusive) {
+    BtData *btd = (BtData *)os->self;
+    OSCursor cursor;
+    void *element;
+    BtNode *p;
+    int i;
+    long n = 0L;
+
+    if (!rangeStart(os, &cursor, lo, loInclusive, &element))
+        return 0L;
+    p = (BtNode *)cursor.node;
+    i = (int)cursor.index;
+    while (p != NULL && inRange(btd, ELEMS(p)[p->n - 1], hi, hiInclusive)) {
+        n += (long)(p->n - i);
+        p = p->next;
+        i = 0;
+    }
+    if (p != NULL)
+        while (inRange(btd, ELEMS(p)[i], hi, hiInclusive)) {
+            n++;
+            i++;
+        }
+    return n;
+}
+
+static OrderedSet template = {
+    NULL, bt_destroy, bt_add, bt_ceiling, bt_clear, bt_contains,
+    bt_first, bt_floor, bt_higher, bt_isEmpty, bt_last, bt_lower,
+    bt_pollFirst, bt_pollLast, bt_remove, bt_size, bt_toArray, bt_itCreate,
+    bt_setUnion, bt_intersect, bt_difference, bt_isSubset, bt_cursorFirst,
+    bt_cursorLast, bt_cursorSeek, bt_cursorNext, bt_cursorPrev,
+    bt_range, bt_countRange
+};
+
+const OrderedSet *OrderedSet_createBTree(int (*cmpFunction)(void *, void *),
+                                         int fanout) {
+    OrderedSet *os = (OrderedSet *)malloc(sizeof(OrderedSet));
+
+    if (os != NULL) {
+        BtData *btd = (BtData *)malloc(sizeof(BtData));
+
+        if (btd != NULL) {
+            if (fanout <= 0)
+                fanout = DEFAULT_FANOUT;
+            else if (fanout < MIN_FANOUT)
+                fanout = MIN_FANOUT;
+            else if (fanout > MAX_FANOUT)
+                fanout = MAX_FANOUT;
+            btd->fanout = fanout;
+            btd->minFill = fanout / 2;
+            btd->size = 0L;
+            btd->cmp = cmpFunction;
+            if ((btd->root = newNode(btd, 1)) != NULL) {
+                btd->head = btd->tail = btd->root;
+                *os = template;
+                os->self = btd;
+            } else {
+                free(btd);
+                free(os);
+                os = NULL;
+            }
+        } else {
+            free(os);
+            os = NULL;
+        }
+    }
+    return os;
+}
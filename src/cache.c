@@ -0,0 +1,527 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for generic bounded cache
+ *
+ * an index HashMap maps each key to a node that holds the element and
+ * links the entry into the lists of the replacement policy; a hit is a
+ * single lookup in the index followed by constant work on the node
+ *
+ * all policies use doubly linked lists with a sentinel; new entries are
+ * linked at the front, and eviction candidates are taken from the back;
+ * CACHE_LRU and CACHE_CLOCK use a single list, while CACHE_S3FIFO uses a
+ * small and a main queue, plus a ghost queue of nodes that keep only the
+ * keys of entries recently evicted from the small queue; ghost nodes stay
+ * in the index, so a returning key is recognized by the same lookup that
+ * would find it in the cache
+ */
+
+#include "cache.h"
+#include "hashmap.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define FL_INCREMENT 128	/* number of nodes to add to free list */
+#define SMALL_SHARE 10		/* S3-FIFO small queue is 1/10 of capacity */
+#define MAX_FREQ 3		/* S3-FIFO saturating hit counter */
+
+#define Q_MAIN 0		/* the only list for LRU and CLOCK */
+#define Q_SMALL 1
+#define Q_GHOST 2
+
+typedef struct cnode {
+    struct cnode *next;
+    struct cnode *prev;
+    char *key;
+    void *element;
+    long size;			/* charge against the capacity */
+    int queue;			/* list the node is on */
+    int freq;			/* reference bit or S3-FIFO hit counter */
+} CNode;
+
+typedef struct c_data {
+    const HashMap *index;	/* key -> CNode *, including ghosts */
+    int policy;
+    long capacity;
+    long smallCapacity;
+    long (*sizeFxn)(void *element);
+    void (*evictFxn)(char *key, void *element);
+    long size;			/* number of live entries */
+    long used;			/* sum of their charges */
+    long counts[3];		/* number of nodes on each list */
+    long smallUsed;		/* charge of the entries on the small queue */
+    long evictions;
+    CNode *hand;		/* CLOCK hand */
+    CNode *freel;
+    CNode lists[3];		/* sentinels */
+} CData;
+
+#define SENTINEL(cd, q) (&(cd)->lists[q])
+
+/*
+ * local routines for maintaining free list of CNode's
+ */
+
+static void putNode(CData *cd, CNode *p) {
+    free(p->key);
+    p->key = NULL;
+    p->element = NULL;
+    p->next = cd->freel;
+    cd->freel = p;
+}
+
+static CNode *getNode(CData *cd) {
+    CNode *p;
+
+    if ((p = cd->freel) == NULL) {
+        long i;
+        for (i = 0; i < FL_INCREMENT; i++) {
+            p = (CNode *)malloc(sizeof(CNode));
+            if (p == NULL)
+                break;
+            p->key = NULL;
+            putNode(cd, p);
+        }
+        p = cd->freel;
+    }
+    if (p != NULL)
+        cd->freel = p->next;
+    return p;
+}
+
+/*
+ * link `p' between `before' and `after' on list `q'
+ */
+static void linkNode(CData *cd, CNode *before, CNode *p, CNode *after,
+                     int q) {
+    p->next = after;
+    p->prev = before;
+    after->prev = p;
+    before->next = p;
+    p->queue = q;
+    cd->counts[q]++;
+    if (q == Q_SMALL)
+        cd->smallUsed += p->size;
+}
+
+static void unlinkNode(CData *cd, CNode *p) {
+    if (p == cd->hand)
+        cd->hand = p->next;
+    p->prev->next = p->next;
+    p->next->prev = p->prev;
+    cd->counts[p->queue]--;
+    if (p->queue == Q_SMALL)
+        cd->smallUsed -= p->size;
+}
+
+static void linkFront(CData *cd, CNode *p, int q) {
+    linkNode(cd, SENTINEL(cd, q), p, SENTINEL(cd, q)->next, q);
+}
+
+/*
+ * local function that removes the node `p' from its list and the index,
+ * and returns it to the free list
+ */
+static void dropNode(CData *cd, CNode *p) {
+    void *ignore;
+
+    unlinkNode(cd, p);
+    (void) cd->index->remove(cd->index, p->key, &ignore);
+    putNode(cd, p);
+}
+
+/*
+ * traverses the lists, calling freeFxn on each live element, and returns
+ * all nodes to the free list
+ */
+static void purge(CData *cd, void (*freeFxn)(void *element)) {
+    int q;
+
+    for (q = Q_MAIN; q <= Q_GHOST; q++) {
+        CNode *s = SENTINEL(cd, q);
+        CNode *p = s->next;
+
+        while (p != s) {
+            CNode *next = p->next;
+            if (freeFxn != NULL && q != Q_GHOST)
+                (*freeFxn)(p->element);
+            putNode(cd, p);
+            p = next;
+        }
+        s->next = s->prev = s;
+        cd->counts[q] = 0L;
+    }
+    cd->index->clear(cd->index, NULL);
+    cd->hand = SENTINEL(cd, Q_MAIN);
+    cd->size = cd->used = cd->smallUsed = 0L;
+}
+
+static void c_destroy(const Cache *c, void (*freeFxn)(void *element)) {
+    CData *cd = (CData *)c->self;
+    CNode *p;
+
+    purge(cd, freeFxn);
+    p = cd->freel;
+    while (p != NULL) {		/* return nodes on free list */
+        CNode *q = p->next;
+        free(p);
+        p = q;
+    }
+    cd->index->destroy(cd->index, NULL);
+    free(cd);
+    free((void *)c);
+}
+
+static void c_clear(const Cache *c, void (*freeFxn)(void *element)) {
+    CData *cd = (CData *)c->self;
+
+    purge(cd, freeFxn);
+}
+
+/*
+ * local function that returns the live node for `key', or NULL
+ */
+static CNode *findNode(CData *cd, char *key) {
+    CNode *p;
+
+    if (cd->index->get(cd->index, key, (void **)&p) && p->queue != Q_GHOST)
+        return p;
+    return NULL;
+}
+
+static int c_containsKey(const Cache *c, char *key) {
+    CData *cd = (CData *)c->self;
+
+    return (findNode(cd, key) != NULL);
+}
+
+/*
+ * local function that records a hit on `p' according to the policy
+ */
+static void touch(CData *cd, CNode *p) {
+    switch (cd->policy) {
+    case CACHE_LRU:
+        if (SENTINEL(cd, Q_MAIN)->next != p) {
+            unlinkNode(cd, p);
+            linkFront(cd, p, Q_MAIN);
+        }
+        break;
+    case CACHE_CLOCK:
+        p->freq = 1;
+        break;
+    default:
+        if (p->freq < MAX_FREQ)
+            p->freq++;
+        break;
+    }
+}
+
+static int c_get(const Cache *c, char *key, void **element) {
+    CData *cd = (CData *)c->self;
+    CNode *p = findNode(cd, key);
+
+    if (p == NULL)
+        return 0;
+    touch(cd, p);
+    *element = p->element;
+    return 1;
+}
+
+static int c_isEmpty(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return (cd->size == 0L);
+}
+
+static char **c_keyArray(const Cache *c, long *len) {
+    CData *cd = (CData *)c->self;
+    char **tmp;
+    long n = 0L;
+    int q;
+
+    if (cd->size == 0L)
+        return NULL;
+    if ((tmp = (char **)malloc(cd->size * sizeof(char *))) == NULL)
+        return NULL;
+    for (q = Q_MAIN; q <= Q_SMALL; q++) {
+        CNode *s = SENTINEL(cd, q);
+        CNode *p;
+
+        for (p = s->next; p != s; p = p->next)
+            tmp[n++] = p->key;
+    }
+    *len = n;
+    return tmp;
+}
+
+static int c_peek(const Cache *c, char *key, void **element) {
+    CData *cd = (CData *)c->self;
+    CNode *p = findNode(cd, key);
+
+    if (p == NULL)
+        return 0;
+    *element = p->element;
+    return 1;
+}
+
+/*
+ * local function that evicts the live node `p', invoking the eviction
+ * callback; with S3-FIFO, a node evicted from the small queue becomes a
+ * ghost, and the oldest ghosts are dropped so that there are never more
+ * ghosts than live entries
+ */
+static void evictNode(CData *cd, CNode *p) {
+    int q = p->queue;
+
+    if (cd->evictFxn != NULL)
+        (*cd->evictFxn)(p->key, p->element);
+    cd->size--;
+    cd->used -= p->size;
+    cd->evictions++;
+    if (q != Q_SMALL) {
+        dropNode(cd, p);
+        return;
+    }
+    unlinkNode(cd, p);
+    p->element = NULL;
+    p->size = 0L;
+    p->freq = 0;
+    linkFront(cd, p, Q_GHOST);
+    while (cd->counts[Q_GHOST] > cd->size)
+        dropNode(cd, SENTINEL(cd, Q_GHOST)->prev);
+}
+
+/*
+ * local function that evicts one entry other than `keep', which has just
+ * been put; there must be at least one such entry
+ */
+static void evictOne(CData *cd, CNode *keep) {
+    CNode *main = SENTINEL(cd, Q_MAIN);
+    CNode *small = SENTINEL(cd, Q_SMALL);
+    CNode *p;
+
+    switch (cd->policy) {
+    case CACHE_LRU:
+        evictNode(cd, main->prev);	/* keep is at the front */
+        break;
+    case CACHE_CLOCK:
+        for (;;) {
+            p = cd->hand;
+            cd->hand = p->next;
+            if (p == main)
+                continue;
+            if (p == keep || p->freq != 0) {
+                p->freq = 0;		/* second chance */
+                continue;
+            }
+            evictNode(cd, p);
+            break;
+        }
+        break;
+    default:
+        for (;;) {
+            long mainVictims = cd->counts[Q_MAIN] - (keep->queue == Q_MAIN);
+            long smallVictims = cd->counts[Q_SMALL] - (keep->queue == Q_SMALL);
+
+            if (smallVictims > 0L &&
+                (cd->smallUsed >= cd->smallCapacity || mainVictims == 0L)) {
+                p = small->prev;	/* keep is at the front */
+                if (p->freq > 0) {	/* hit while in small queue */
+                    unlinkNode(cd, p);
+                    p->freq = 0;
+                    linkFront(cd, p, Q_MAIN);
+                    continue;
+                }
+            } else {
+                p = main->prev;
+                if (p == keep || p->freq > 0) {
+                    unlinkNode(cd, p);
+                    if (p != keep)
+                        p->freq--;
+                    linkFront(cd, p, Q_MAIN);
+                    continue;
+                }
+            }
+            evictNode(cd, p);
+            break;
+        }
+        break;
+    }
+}
+
+/*
+ * context and HashMap compute() callback for put(); the node for the key
+ * is located or created by the same lookup in the index
+ */
+typedef struct putctx {
+    CData *cd;
+    void *element;
+    void *previous;
+    CNode *node;
+} PutCtx;
+
+static int putNodeFor(char *key, void **element, void *ctx) {
+    PutCtx *pc = (PutCtx *)ctx;
+    CData *cd = pc->cd;
+    CNode *p = (CNode *)*element;
+    long size = (cd->sizeFxn != NULL) ? (*cd->sizeFxn)(pc->element) : 1L;
+
+    if (p != NULL && p->queue != Q_GHOST) {	/* replace element */
+        pc->previous = p->element;
+        if (p->queue == Q_SMALL)
+            cd->smallUsed += size - p->size;
+        cd->used += size - p->size;
+        p->element = pc->element;
+        p->size = size;
+        touch(cd, p);
+    } else {
+        if (p != NULL)			/* returning ghost */
+            unlinkNode(cd, p);
+        else if ((p = getNode(cd)) == NULL)
+            return 0;
+        else if ((p->key = strdup(key)) == NULL) {
+            putNode(cd, p);
+            return 0;
+        }
+        p->element = pc->element;
+        p->size = size;
+        p->freq = 0;
+        if (cd->policy == CACHE_CLOCK)	/* visited last by the hand */
+            linkNode(cd, cd->hand->prev, p, cd->hand, Q_MAIN);
+        else if (cd->policy == CACHE_S3FIFO && *element == NULL)
+            linkFront(cd, p, Q_SMALL);
+        else
+            linkFront(cd, p, Q_MAIN);
+        cd->size++;
+        cd->used += size;
+        *element = p;
+    }
+    pc->node = p;
+    return 1;
+}
+
+static int c_put(const Cache *c, char *key, void *element, void **previous) {
+    CData *cd = (CData *)c->self;
+    PutCtx pc;
+
+    pc.cd = cd;
+    pc.element = element;
+    pc.previous = NULL;
+    pc.node = NULL;
+    if (!cd->index->compute(cd->index, key, putNodeFor, &pc))
+        return 0;
+    *previous = pc.previous;
+    while (cd->used > cd->capacity && cd->size > 1L)
+        evictOne(cd, pc.node);
+    return 1;
+}
+
+static int c_remove(const Cache *c, char *key, void **element) {
+    CData *cd = (CData *)c->self;
+    CNode *p = findNode(cd, key);
+
+    if (p == NULL)
+        return 0;
+    *element = p->element;
+    cd->size--;
+    cd->used -= p->size;
+    dropNode(cd, p);
+    return 1;
+}
+
+static long c_size(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return cd->size;
+}
+
+static long c_used(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return cd->used;
+}
+
+static long c_evictions(const Cache *c) {
+    CData *cd = (CData *)c->self;
+
+    return cd->evictions;
+}
+
+static Cache template = {
+    NULL, c_destroy, c_clear, c_containsKey, c_get, c_isEmpty, c_keyArray,
+    c_peek, c_put, c_remove, c_size, c_used, c_evictions
+};
+
+const Cache *Cache_create(long capacity, int policy,
+                          long (*sizeFxn)(void *element),
+                          void (*evictFxn)(char *key, void *element)) {
+    Cache *c;
+    int q;
+
+    if (capacity <= 0L || policy < CACHE_LRU || policy > CACHE_S3FIFO)
+        return NULL;
+    c = (Cache *)malloc(sizeof(Cache));
+    if (c != NULL) {
+        CData *cd = (CData *)malloc(sizeof(CData));
+
+        if (cd != NULL) {
+            cd->index = HashMap_create(0L, 0.0);
+            if (cd->index != NULL) {
+                cd->policy = policy;
+                cd->capacity = capacity;
+                cd->smallCapacity = capacity / SMALL_SHARE;
+                if (cd->smallCapacity == 0L)
+                    cd->smallCapacity = 1L;
+                cd->sizeFxn = sizeFxn;
+                cd->evictFxn = evictFxn;
+                cd->size = cd->used = cd->smallUsed = 0L;
+                cd->evictions = 0L;
+                for (q = Q_MAIN; q <= Q_GHOST; q++) {
+                    cd->lists[q].next = cd->lists[q].prev = &cd->lists[q];
+                    cd->counts[q] = 0L;
+                }
+                cd->hand = SENTINEL(cd, Q_MAIN);
+                cd->freel = NULL;
+                *c = template;
+                c->self = cd;
+            } else {
+                free(cd);
+                free(c);
+                c = NULL;
+            }
+        } else {
+            free(c);
+            c = NULL;
+        }
+    }
+    return c;
+}
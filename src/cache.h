@@ -0,0 +1,193 @@
+#ifndef _CACHE_H_
+#define _CACHE_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * interface definition for a bounded cache with String keys
+ *
+ * a cache maps keys to elements like a HashMap, but holds at most
+ * `capacity' worth of elements; when a put() would exceed the capacity,
+ * entries chosen by the replacement policy are evicted, and the eviction
+ * callback, if any, is invoked on each of them
+ *
+ * get() finds the entry with a single hashmap lookup and records the hit
+ * in constant time, as each entry has its own node on the replacement
+ * lists
+ */
+
+typedef struct cache Cache;		/* forward reference */
+
+/*
+ * replacement policies that may be passed to Cache_create()
+ *
+ * CACHE_LRU    - evicts the least recently used entry; each hit moves the
+ *                entry to the front of the recency list
+ * CACHE_CLOCK  - approximates LRU with a reference bit per entry, set by
+ *                a hit; entries are evicted by a hand that sweeps a
+ *                circular list, clearing reference bits, until it finds an
+ *                entry whose bit is clear, so a hit writes no list links
+ * CACHE_S3FIFO - new entries enter a small FIFO queue (10% of the
+ *                capacity), and only those hit while in it are moved to
+ *                the main FIFO queue; the keys of entries evicted from the
+ *                small queue are remembered for a while, and are put
+ *                directly into the main queue if they return; a hit only
+ *                increments a small counter in the entry; this keeps
+ *                entries that are used once from displacing the working
+ *                set
+ */
+#define CACHE_LRU 0
+#define CACHE_CLOCK 1
+#define CACHE_S3FIFO 2
+
+/*
+ * create a cache with the specified capacity and replacement policy;
+ * if sizeFxn == NULL, each entry counts 1 against the capacity, so the
+ * capacity is a number of entries; otherwise, each entry counts
+ * sizeFxn(element), so the capacity may, for example, be a number of bytes
+ *
+ * if evictFxn != NULL, evictFxn(key, element) is invoked on each entry
+ * evicted to make room for a put(); it is not invoked for entries that
+ * are replaced by put(), removed by remove(), or purged by clear() or
+ * destroy(); `key' is only valid during the call
+ *
+ * returns a pointer to the cache, or NULL if capacity <= 0, the policy is
+ * unknown, or there are malloc() errors
+ */
+const Cache *Cache_create(long capacity, int policy,
+                          long (*sizeFxn)(void *element),
+                          void (*evictFxn)(char *key, void *element));
+
+/*
+ * now define struct cache
+ */
+struct cache {
+/*
+ * the private data of the cache
+ */
+    void *self;
+
+/*
+ * destroys the cache; for each entry, if freeFxn != NULL, it is invoked
+ * on the element in that entry; the storage associated with the cache is
+ * then returned to the heap
+ */
+    void (*destroy)(const Cache *c, void (*freeFxn)(void *element));
+
+/*
+ * clears all entries from the cache; for each entry, if freeFxn != NULL,
+ * it is invoked on the element in that entry
+ *
+ * upon return, the cache will be empty
+ */
+    void (*clear)(const Cache *c, void (*freeFxn)(void *element));
+
+/*
+ * returns 1 if the cache has an entry for `key', 0 otherwise; this does
+ * not count as a use of the entry
+ */
+    int (*containsKey)(const Cache *c, char *key);
+
+/*
+ * returns the element to which `key' is mapped in `*element', and records
+ * the use of the entry with the replacement policy
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*get)(const Cache *c, char *key, void **element);
+
+/*
+ * returns 1 if the cache is empty, 0 if it is not
+ */
+    int (*isEmpty)(const Cache *c);
+
+/*
+ * returns an array containing all of the keys in the cache; for CACHE_LRU,
+ * the keys are in order from most to least recently used, otherwise they
+ * are in an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to char * array of keys, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the char * array when
+ * finished; the keys are only valid until the next put(), remove() or
+ * clear() on the cache
+ */
+    char **(*keyArray)(const Cache *c, long *len);
+
+/*
+ * returns the element to which `key' is mapped in `*element' without
+ * recording a use of the entry
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*peek)(const Cache *c, char *key, void **element);
+
+/*
+ * associates `element' with `key'; if this replaces an existing mapping,
+ * the old element is returned in `*previous', otherwise *previous == NULL;
+ * replacing a mapping counts as a use of the entry
+ *
+ * entries are then evicted until the cache is within its capacity; the
+ * entry just put is never evicted, so an element that is larger than the
+ * capacity is held alone until the next put()
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*put)(const Cache *c, char *key, void *element, void **previous);
+
+/*
+ * removes the entry associated with `key' if one exists; returns the
+ * element associated with key in `*element'
+ *
+ * returns 1 if successful, 0 if no element associated with `key'
+ */
+    int (*remove)(const Cache *c, char *key, void **element);
+
+/*
+ * returns the number of entries in the cache
+ */
+    long (*size)(const Cache *c);
+
+/*
+ * returns the amount of the capacity used by the entries in the cache;
+ * this equals size() if the cache was created with sizeFxn == NULL
+ */
+    long (*used)(const Cache *c);
+
+/*
+ * returns the number of entries that have been evicted since the cache
+ * was created
+ */
+    long (*evictions)(const Cache *c);
+};
+
+#endif /* _CACHE_H_ */
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "cache.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+static const char *names[] = {"CACHE_LRU", "CACHE_CLOCK", "CACHE_S3FIFO"};
+static long nevicted = 0L;
+
+/*
+ * eviction callback that counts the evicted entries and frees their
+ * elements
+ */
+static void evictFree(char *key, void *element) {
+    (void) key;
+    nevicted++;
+    free(element);
+}
+
+static long elementSize(void *element) {
+    return (long)strlen((char *)element);
+}
+
+/*
+ * prints the keys of `c' in the order returned by keyArray()
+ */
+static void printKeys(const Cache *c) {
+    char **keys;
+    long i, n;
+
+    printf("keys:");
+    if ((keys = c->keyArray(c, &n)) != NULL) {
+        for (i = 0; i < n; i++)
+            printf(" %s", keys[i]);
+        free(keys);
+    }
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char key[32];
+    char *p;
+    const Cache *c;
+    long i, n;
+    int policy;
+    FILE *fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./catest file\n");
+        return -1;
+    }
+    if ((c = Cache_create(10L, CACHE_LRU, NULL, evictFree)) == NULL) {
+        fprintf(stderr, "Error creating cache\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of put() beyond the capacity
+     */
+    printf("===== test of put beyond capacity\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!c->put(c, key, p, (void **)&prev)) {
+            fprintf(stderr, "Error adding key,string to cache\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    printf("%ld lines put, size = %ld, used = %ld, evictions = %ld/%ld\n",
+           i, c->size(c), c->used(c), c->evictions(c), nevicted);
+    /*
+     * test of get() of the lines that are left
+     */
+    printf("===== test of get\n");
+    for (n = i, i = 0; i < n; i++) {
+        sprintf(key, "%ld", i);
+        if (c->get(c, key, (void **)&p))
+            printf("%s,%s", key, p);
+    }
+    /*
+     * test of clear()
+     */
+    printf("===== test of clear\n");
+    c->clear(c, free);
+    printf("Size after clear = %ld, isEmpty = %d\n", c->size(c),
+           c->isEmpty(c));
+    c->destroy(c, free);
+    /*
+     * test of eviction order, peek(), replacement and remove(); with
+     * CACHE_S3FIFO, "b" is remembered when it is evicted, so it goes
+     * straight to the main queue when it is put again
+     */
+    printf("===== test of eviction order\n");
+    for (policy = CACHE_LRU; policy <= CACHE_S3FIFO; policy++) {
+        if ((c = Cache_create(3L, policy, NULL, evictFree)) == NULL) {
+            fprintf(stderr, "Error creating cache\n");
+            return -1;
+        }
+        printf("%s:\n", names[policy]);
+        (void) c->put(c, "a", strdup("a"), (void **)&p);
+        (void) c->put(c, "b", strdup("b"), (void **)&p);
+        (void) c->put(c, "c", strdup("c"), (void **)&p);
+        (void) c->get(c, "a", (void **)&p);
+        (void) c->put(c, "d", strdup("d"), (void **)&p);
+        printKeys(c);
+        printf("containsKey(\"a\") = %d, containsKey(\"b\") = %d\n",
+               c->containsKey(c, "a"), c->containsKey(c, "b"));
+        (void) c->peek(c, "c", (void **)&p);
+        (void) c->put(c, "d", strdup("D"), (void **)&p);
+        printf("replaced \"%s\", size = %ld\n", p, c->size(c));
+        free(p);
+        printf("remove(\"c\") = %d, ", c->remove(c, "c", (void **)&p));
+        free(p);
+        printf("remove(\"c\") = %d, size = %ld, evictions = %ld\n",
+               c->remove(c, "c", (void **)&p), c->size(c), c->evictions(c));
+        (void) c->put(c, "b", strdup("b"), (void **)&p);
+        printKeys(c);
+        c->destroy(c, free);
+    }
+    /*
+     * test of a capacity in bytes
+     */
+    printf("===== test of capacity in bytes\n");
+    if ((c = Cache_create(20L, CACHE_LRU, elementSize, evictFree)) == NULL) {
+        fprintf(stderr, "Error creating cache\n");
+        return -1;
+    }
+    (void) c->put(c, "1", strdup("12345678"), (void **)&p);
+    (void) c->put(c, "2", strdup("12345678"), (void **)&p);
+    printf("size = %ld, used = %ld\n", c->size(c), c->used(c));
+    (void) c->put(c, "3", strdup("12345678"), (void **)&p);
+    printf("size = %ld, used = %ld\n", c->size(c), c->used(c));
+    (void) c->put(c, "4", strdup("123456789012345678901234"), (void **)&p);
+    printf("size = %ld, used = %ld\n", c->size(c), c->used(c));
+    printKeys(c);
+    (void) c->put(c, "5", strdup("1"), (void **)&p);
+    printf("size = %ld, used = %ld\n", c->size(c), c->used(c));
+    printKeys(c);
+    c->destroy(c, free);
+    /*
+     * test of a working set followed by a scan of keys used only once
+     */
+    printf("===== test of scan resistance\n");
+    for (policy = CACHE_LRU; policy <= CACHE_S3FIFO; policy++) {
+        if ((c = Cache_create(100L, policy, NULL, NULL)) == NULL) {
+            fprintf(stderr, "Error creating cache\n");
+            return -1;
+        }
+        for (i = 0; i < 50; i++) {
+            sprintf(key, "w%ld", i);
+            (void) c->put(c, key, NULL, (void **)&p);
+            (void) c->get(c, key, (void **)&p);
+            (void) c->get(c, key, (void **)&p);
+        }
+        for (i = 0; i < 1000; i++) {
+            sprintf(key, "s%ld", i);
+            (void) c->put(c, key, NULL, (void **)&p);
+        }
+        for (i = 0, n = 0; i < 50; i++) {
+            sprintf(key, "w%ld", i);
+            n += c->containsKey(c, key);
+        }
+        printf("%s: %ld of 50 working set keys retained, size = %ld\n",
+               names[policy], n, c->size(c));
+        c->destroy(c, NULL);
+    }
+    /*
+     * test of many puts and gets of a key space larger than the capacity
+     */
+    printf("===== test of churn\n");
+    for (policy = CACHE_LRU; policy <= CACHE_S3FIFO; policy++) {
+        char **keys;
+        long found = 0L;
+
+        nevicted = 0L;
+        if ((c = Cache_create(100L, policy, NULL, evictFree)) == NULL) {
+            fprintf(stderr, "Error creating cache\n");
+            return -1;
+        }
+        for (i = 0; i < 100000; i++) {
+            sprintf(key, "%ld", (i * 7919L) % 300L);
+            if (!c->get(c, key, (void **)&p)) {
+                if (!c->put(c, key, strdup(key), (void **)&p)) {
+                    fprintf(stderr, "Error adding %s to cache\n", key);
+                    return -1;
+                }
+            } else if (strcmp(key, p) != 0)
+                fprintf(stderr, "Error: %s mapped to %s\n", key, p);
+        }
+        if ((keys = c->keyArray(c, &n)) != NULL) {
+            for (i = 0; i < n; i++)
+                found += c->containsKey(c, keys[i]);
+            free(keys);
+        }
+        printf("%s: size = %ld, used = %ld, %ld keys found, ",
+               names[policy], c->size(c), c->used(c), found);
+        printf("evictions consistent = %d\n",
+               c->evictions(c) == nevicted && nevicted > 0L);
+        c->destroy(c, free);
+    }
+
+    return 0;
+}
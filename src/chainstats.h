@@ -0,0 +1,142 @@
+#ifndef _CHAINSTATS_H_
+#define _CHAINSTATS_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * private helpers shared by the stats() methods of the hash-based ADTs;
+ * they are not installed with the public headers
+ */
+
+#include "hashstats.h"
+#include <string.h>
+#include <time.h>
+
+/*
+ * STAT(x) evaluates `x' only if the library is compiled with -DHASH_STATS;
+ * it is used to maintain the per-lookup counters
+ */
+#ifdef HASH_STATS
+#define STAT(x) (x)
+#else
+#define STAT(x)
+#endif
+
+/*
+ * returns a monotonic time in seconds, for timing resizes
+ */
+static inline double chainstats_clock(void) {
+    struct timespec ts;
+
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec + 1.0e-9 * (double)ts.tv_nsec;
+}
+
+/*
+ * clears `hs' before the chains of a table are added to it
+ */
+static inline void chainstats_init(HashStats *hs) {
+    memset(hs, 0, sizeof(HashStats));
+}
+
+/*
+ * adds a chain of length `len' to `hs'; empty chains are only counted in
+ * the capacity, which the caller sets
+ */
+static inline void chainstats_add(HashStats *hs, long len) {
+    if (len > 0L) {
+        hs->occupied++;
+        hs->meanChain += (double)len;	/* summed until chainstats_finish() */
+        if (len > hs->maxChain)
+            hs->maxChain = len;
+        hs->histogram[(len < HASHSTATS_BINS) ? len - 1 : HASHSTATS_BINS - 1]++;
+    }
+}
+
+/*
+ * completes `hs' once all chains have been added, given the resize and
+ * lookup counters of the table
+ */
+static inline void chainstats_finish(HashStats *hs, long resizes,
+                                     double resizeSeconds, long hits,
+                                     long misses, long probes) {
+    if (hs->occupied > 0L)
+        hs->meanChain /= (double)hs->occupied;
+    hs->resizes = resizes;
+    hs->resizeSeconds = resizeSeconds;
+#ifdef HASH_STATS
+    hs->hits = hits;
+    hs->misses = misses;
+    hs->probes = probes;
+    if (hits + misses > 0L)
+        hs->meanProbes = (double)probes / (double)(hits + misses);
+#else
+    (void) hits;
+    (void) misses;
+    (void) probes;
+    hs->hits = hs->misses = hs->probes = -1L;
+#endif
+}
+
+/*
+ * adds the statistics in `other' to those in `total', for tables, such
+ * as the stripes of a striped hashmap, that are reported as one
+ */
+static inline void chainstats_merge(HashStats *total, HashStats *other) {
+    long occupied = total->occupied + other->occupied;
+    int i;
+
+    if (occupied > 0L)
+        total->meanChain = (total->meanChain * (double)total->occupied +
+                            other->meanChain * (double)other->occupied) /
+                           (double)occupied;
+    total->size += other->size;
+    total->capacity += other->capacity;
+    total->occupied = occupied;
+    if (other->maxChain > total->maxChain)
+        total->maxChain = other->maxChain;
+    for (i = 0; i < HASHSTATS_BINS; i++)
+        total->histogram[i] += other->histogram[i];
+    total->resizes += other->resizes;
+    total->resizeSeconds += other->resizeSeconds;
+    if (other->hits >= 0L) {
+        total->hits += other->hits;
+        total->misses += other->misses;
+        total->probes += other->probes;
+        if (total->hits + total->misses > 0L)
+            total->meanProbes = (double)total->probes /
+                                (double)(total->hits + total->misses);
+    } else
+        total->hits = total->misses = total->probes = -1L;
+}
+
+#endif /* _CHAINSTATS_H_ */
@@ -0,0 +1,524 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*
+ * forEach() callback that counts entries, stopping when *ctx reaches 0
+ */
+static int countDown(HMEntry *entry, void *ctx) {
+    long *n = (long *)ctx;
+
+    (void) entry;
+    return (--(*n) == 0L);
+}
+
+/*
+ * prints the parts of `*hs' that do not depend on how the hash function
+ * spreads the keys, and checks that the rest are consistent
+ */
+static void printStats(HashStats *hs) {
+    long i, n;
+
+    printf("size = %ld, capacity = %ld, resizes = %ld\n", hs->size,
+           hs->capacity, hs->resizes);
+    for (i = 0, n = 0; i < HASHSTATS_BINS; i++)
+        n += hs->histogram[i];
+    printf("histogram consistent = %d, ", n == hs->occupied &&
+           hs->maxChain >= 1 && hs->occupied <= hs->size);
+    printf("meanChain consistent = %d, ", hs->meanChain >= 1.0 &&
+           hs->meanChain <= (double)hs->maxChain);
+    printf("lookup counters consistent = %d\n", hs->hits == -1L ||
+           (hs->hits >= hs->size && hs->probes >= hs->hits));
+}
+
+/*
+ * callbacks for the computeIfAbsent/compute/merge test; elements are
+ * counts stored directly in the element pointers
+ */
+static void *newCount(char *key, void *ctx) {
+    (void) key;
+    (*(long *)ctx)++;			/* number of times invoked */
+    return (void *)1000L;
+}
+
+static int bumpCount(char *key, void **element, void *ctx) {
+    long n = (long)*element;
+
+    (void) key;
+    if (n == 1000L)			/* drop those made by newCount() */
+        return 0;
+    if (n == 0L && ctx != NULL)		/* only update existing counts */
+        return 0;
+    *element = (void *)(n + 1L);
+    return 1;
+}
+
+/*
+ * expiry callback for the putWithTTL/expire test; each element is the
+ * deadline of its entry, which must not be later than `horizon'
+ */
+static long expired = 0L, early = 0L, horizon = 0L;
+
+static void countExpired(char *key, void *element) {
+    (void) key;
+    expired++;
+    if ((long)element > horizon)
+        early++;
+}
+
+static void *addCounts(void *old, void *element) {
+    return (void *)((long)old + (long)element);
+}
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char key[32];
+    char *p;
+    const HashMap *hm;
+    long i, n;
+    HashStats hs;
+    FILE *fd;
+    HMEntry **array;
+    const Iterator *it;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./fhmtest file\n");
+        return -1;
+    }
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of put()
+     */
+    printf("===== test of put when key not in hashmap\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!hm->put(hm, key, p, (void**)&prev)) {
+            fprintf(stderr, "Error adding key,string to hashmap\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    n = hm->size(hm);
+    /*
+     * test of get()
+     */
+    printf("===== test of get\n");
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        sprintf(key, "%ld", i);
+        if (!hm->get(hm, key, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%s,%s", key, element);
+    }
+    /*
+     * test of remove
+     */
+    printf("===== test of remove\n");
+    printf("Size before remove = %ld\n", n);
+    for (i = n - 1; i >= 0; i--) {
+        sprintf(key, "%ld", i);
+        if (!hm->remove(hm, key, (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th element\n", i);
+            return -1;
+        }
+        free(p);
+    }
+    printf("Size after remove = %ld\n", hm->size(hm));
+    /*
+     * test of destroy with NULL freeFxn
+     */
+    printf("===== test of destroy(NULL)\n");
+    hm->destroy(hm, NULL);
+    /*
+     * test of insert
+     */
+    if ((hm = HashMap_createFlat(0L, 3.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    fd = fopen(argv[1], "r");		/* we know we can open it */
+    i = 0L;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!hm->put(hm, key, p, (void **)&prev)) {
+            fprintf(stderr, "Error adding key,value to hashmap\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    /*
+     * test of put replacing value associated with an existing key
+     */
+    printf("===== test of put (replace value associated with key)\n");
+    for (i = 0; i < n; i++) {
+        char bf[1024], *q;
+        sprintf(bf, "line %ld\n", i);
+        if ((p = strdup(bf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i);
+        if (!hm->put(hm, key, p, (void **)&q)) {
+            fprintf(stderr, "Error replacing %ld'th element\n", i);
+            return -1;
+        }
+        free(q);
+    }
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        sprintf(key, "%ld", i);
+        if (!hm->get(hm, key, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%s,%s", key, element);
+    }
+    /*
+     * test of entryArray
+     */
+    printf("===== test of entryArray\n");
+    if ((array = (HMEntry **)hm->entryArray(hm, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking hm->entryArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        printf("%s,%s", hmentry_key(array[i]), (char *)hmentry_value(array[i]));
+    }
+    free(array);
+    /*
+     * test of iterator
+     */
+    printf("===== test of iterator\n");
+    if ((it = hm->itCreate(hm)) == NULL) {
+        fprintf(stderr, "Error in creating iterator\n");
+        return -1;
+    }
+    while (it->hasNext(it)) {
+        HMEntry *p;
+        (void) it->next(it, (void **)&p);
+        printf("%s,%s", hmentry_key(p), (char *)hmentry_value(p));
+    }
+    it->destroy(it);
+    /*
+     * test of destroy with free() as freeFxn
+     */
+    printf("===== test of destroy(free)\n");
+    hm->destroy(hm, free);
+
+    /*
+     * test of binary keys
+     */
+    printf("===== test of putn/getn/containsKeyn/removen\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of binary keys\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->putn(hm, bkey, sizeof(bkey), argv[1], (void **)&p)) {
+            fprintf(stderr, "Error adding %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    printf("Size after putn = %ld\n", hm->size(hm));
+    for (i = 0, n = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (hm->getn(hm, bkey, sizeof(bkey), (void **)&p) && p == argv[1])
+            n++;
+        if (hm->containsKeyn(hm, bkey, sizeof(bkey) - 1))
+            n--;		/* prefix of a key must not match */
+    }
+    printf("Number of keys found = %ld\n", n);
+    (void) hm->put(hm, "abc", argv[1], (void **)&p);
+    printf("containsKeyn(\"abc\", 3) = %d\n", hm->containsKeyn(hm, "abc", 3));
+    printf("containsKeyn(\"abc\", 4) = %d\n", hm->containsKeyn(hm, "abc", 4));
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->removen(hm, bkey, sizeof(bkey), (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    (void) hm->removen(hm, "abc", 3, (void **)&p);
+    printf("Size after removen = %ld\n", hm->size(hm));
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of batch methods
+     */
+    printf("===== test of putBatch/getBatch\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for batches\n");
+        return -1;
+    }
+    {
+        char kbuf[2000][20];
+        char *bkeys[2000];
+        void *values[2000];
+        int found[2000];
+
+        for (i = 0; i < 2000; i++) {
+            sprintf(kbuf[i], "k%ld", i);
+            bkeys[i] = kbuf[i];
+            values[i] = kbuf[i];
+        }
+        n = hm->putBatch(hm, bkeys, 1000, values, NULL);
+        printf("putBatch stored %ld mappings, size = %ld\n", n, hm->size(hm));
+        n = hm->getBatch(hm, bkeys, 2000, values, found);
+        printf("getBatch found %ld of 2000 keys\n", n);
+        for (i = 0; i < 2000; i++) {
+            if (found[i] != (i < 1000) ||
+                (found[i] && strcmp((char *)values[i], bkeys[i]) != 0)) {
+                fprintf(stderr, "Error in getBatch for %ld'th key\n", i);
+                return -1;
+            }
+        }
+    }
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of forEach() and scan()
+     */
+    printf("===== test of forEach/scan\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for forEach\n");
+        return -1;
+    }
+    {
+        char kbuf[2000][20];
+        char seen[2000];
+        HMCursor cursor = HMCURSOR_INIT;
+        HMEntry *entry;
+
+        for (i = 0; i < 2000; i++) {
+            sprintf(kbuf[i], "%ld", i);
+            seen[i] = 0;
+            (void) hm->put(hm, kbuf[i], kbuf[i], (void **)&p);
+        }
+        n = -1L;
+        printf("forEach over all entries returned %d\n",
+               hm->forEach(hm, countDown, &n));
+        printf("forEach visited %ld entries\n", -1L - n);
+        n = 10L;
+        printf("forEach stopped early returned %d\n",
+               hm->forEach(hm, countDown, &n));
+        for (n = 0L; n < 500L && hm->scan(hm, &cursor, &entry); n++)
+            seen[atol(hmentry_key(entry))]++;
+        printf("scan stopped after %ld entries\n", n);
+        while (hm->scan(hm, &cursor, &entry)) {    /* resume the scan */
+            i = atol(hmentry_key(entry));
+            if (seen[i]++)
+                fprintf(stderr, "Error: scan returned %ld twice\n", i);
+            n++;
+        }
+        printf("scan returned %ld entries\n", n);
+        printf("scan after end returned %d\n",
+               hm->scan(hm, &cursor, &entry));
+    }
+    hm->destroy(hm, NULL);
+    /*
+     * test of shrinking as entries are removed, and of compact()
+     */
+    printf("===== test of shrinking and compact\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for compact\n");
+        return -1;
+    }
+    for (i = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        (void) hm->put(hm, key, NULL, (void **)&p);
+    }
+    for (i = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        if (i % 100 != 0 && !hm->remove(hm, key, (void **)&p))
+            fprintf(stderr, "Error removing %s\n", key);
+    }
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        n += hm->containsKey(hm, key);
+    }
+    printf("Size after removes = %ld, %ld keys found\n", hm->size(hm), n);
+    printf("compact() returned %d\n", hm->compact(hm));
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        n += hm->containsKey(hm, key);
+    }
+    printf("Size after compact = %ld, %ld keys found\n", hm->size(hm), n);
+    for (i = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        (void) hm->put(hm, key, NULL, (void **)&p);
+    }
+    printf("Size after puts = %ld\n", hm->size(hm));
+    hm->destroy(hm, NULL);
+    /*
+     * test of stats()
+     */
+    printf("===== test of stats\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for stats\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "%ld", i);
+        (void) hm->put(hm, key, NULL, (void **)&p);
+        (void) hm->containsKey(hm, key);
+    }
+    hm->stats(hm, &hs);
+    printStats(&hs);
+    hm->destroy(hm, NULL);
+    /*
+     * test of computeIfAbsent(), compute() and merge()
+     */
+    printf("===== test of computeIfAbsent/compute/merge\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for compute\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i % 100);
+        if (!hm->merge(hm, buf, (void *)1L, addCounts))
+            fprintf(stderr, "Error merging %s\n", buf);
+    }
+    for (i = 0, n = 0; i < 100; i++) {
+        sprintf(buf, "%ld", i);
+        if (hm->get(hm, buf, (void **)&p) && (long)p == 10L)
+            n++;
+    }
+    printf("Size after merges = %ld, %ld counts of 10\n", hm->size(hm), n);
+    n = 0L;
+    for (i = 0; i < 200; i++) {
+        sprintf(buf, "%ld", i);
+        if (!hm->computeIfAbsent(hm, buf, newCount, &n, (void **)&p) ||
+            (long)p != ((i < 100) ? 10L : 1000L))
+            fprintf(stderr, "Error in computeIfAbsent for %s\n", buf);
+    }
+    printf("Size after computeIfAbsent = %ld, factory invoked %ld times\n",
+           hm->size(hm), n);
+    for (i = 0, n = 0; i < 200; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->compute(hm, buf, bumpCount, NULL);
+    }
+    (void) hm->get(hm, "42", (void **)&p);
+    printf("Size after compute = %ld, %ld kept, \"42\" -> %ld\n",
+           hm->size(hm), n, (long)p);
+    i = hm->compute(hm, "absent", bumpCount, &n);
+    printf("compute(\"absent\") declined = %ld, ", i);
+    printf("containsKey(\"absent\") = %d\n", hm->containsKey(hm, "absent"));
+    i = hm->compute(hm, "absent", bumpCount, NULL);
+    (void) hm->get(hm, "absent", (void **)&p);
+    printf("compute(\"absent\") = %ld, \"absent\" -> %ld\n", i, (long)p);
+    hm->destroy(hm, NULL);
+    /*
+     * test of putWithTTL() and expire(); entries must be reaped no earlier
+     * than their deadlines, through the resizes caused by the puts, and
+     * lookups must not find entries whose deadlines have passed even when
+     * maxWork has cut the sweep short
+     */
+    printf("===== test of putWithTTL/expire\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for TTL\n");
+        return -1;
+    }
+    hm->setExpiryFxn(hm, countExpired);
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i);
+        n = 1L + i * i;
+        if (!hm->putWithTTL(hm, buf, (void *)n, n, (void **)&p))
+            fprintf(stderr, "Error in putWithTTL for %s\n", buf);
+    }
+    (void) hm->put(hm, "forever", NULL, (void **)&p);
+    (void) hm->put(hm, "500", (void *)0L, (void **)&p);	/* cancels TTL */
+    for (horizon = 1L; horizon <= 1000000L; horizon *= 10L) {
+        n = hm->expire(hm, horizon, 0L);
+        printf("expire(%ld) reaped %ld, size = %ld\n", horizon, n,
+               hm->size(hm));
+    }
+    printf("expiryFxn invoked %ld times, %ld before the deadline\n",
+           expired, early);
+    printf("containsKey(\"500\") = %d, containsKey(\"forever\") = %d\n",
+           hm->containsKey(hm, "500"), hm->containsKey(hm, "forever"));
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "same%ld", i);
+        (void) hm->putWithTTL(hm, buf, (void *)(horizon + 10L), 10L,
+                              (void **)&p);
+    }
+    horizon += 10L;
+    n = hm->expire(hm, horizon, 100L);
+    printf("expire(now + 10, 100) reaped %ld, size = %ld\n", n,
+           hm->size(hm));
+    for (i = 0, n = 0; i < 1000; i++) {
+        sprintf(buf, "same%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    printf("%ld found by containsKey(), size = %ld\n", n, hm->size(hm));
+    printf("expiryFxn invoked %ld times, %ld before the deadline\n",
+           expired, early);
+    hm->destroy(hm, NULL);
+
+    return 0;
+}
@@ -0,0 +1,221 @@
+#ifndef _FLATGROUP_H_
+#define _FLATGROUP_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * private helpers shared by the open addressing tables of flathashmap.c
+ * and flatunorderedset.c; they are not installed with the public headers
+ *
+ * patterned after Google's SwissTable: alongside the array of slots is an
+ * array of one-byte control values, one per slot; a full slot's control
+ * byte holds 7 bits of its hash, so a probe compares a group of GROUP
+ * control bytes at once (using SSE2 where available) and only touches the
+ * slots whose fingerprint matches
+ *
+ * the control array has capacity + GROUP bytes, the first GROUP of them
+ * mirrored after the end (see flat_setCtrl()), and the capacity is always
+ * a power of 2, >= GROUP
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#define MAX_CAPACITY 134217728L
+#define GROUP 16		/* number of control bytes in a probe group */
+
+/*
+ * values of control bytes; a full slot has a control byte in 0..127
+ */
+#define EMPTY ((signed char)-128)
+#define DELETED ((signed char)-2)
+
+/*
+ * the low 7 bits of a hash are used as its fingerprint, the remaining
+ * bits select where its probe sequence starts
+ */
+#define H1(h) ((long)((h) >> 7))
+#define H2(h) ((signed char)((h) & 0x7f))
+
+/*
+ * bitmask functions over a group of GROUP control bytes starting at `g';
+ * bit i of the result is set if g[i] satisfies the predicate
+ */
+#ifdef __SSE2__
+static inline unsigned int flat_matchByte(const signed char *g,
+                                          signed char b) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpeq_epi8(_mm_set1_epi8(b), ctrl));
+}
+
+static inline unsigned int flat_matchEmptyOrDeleted(const signed char *g) {
+    __m128i ctrl = _mm_loadu_si128((const __m128i *)g);
+    return (unsigned int)_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_set1_epi8(-1), ctrl));
+}
+#else
+static inline unsigned int flat_matchByte(const signed char *g,
+                                          signed char b) {
+    unsigned int ans = 0;
+    int i;
+
+    for (i = 0; i < GROUP; i++)
+        if (g[i] == b)
+            ans |= (1U << i);
+    return ans;
+}
+
+static inline unsigned int flat_matchEmptyOrDeleted(const signed char *g) {
+    unsigned int ans = 0;
+    int i;
+
+    for (i = 0; i < GROUP; i++)
+        if (g[i] < -1)
+            ans |= (1U << i);
+    return ans;
+}
+#endif /* __SSE2__ */
+
+/*
+ * returns the index of the lowest bit set in `mask', which is not 0
+ */
+static inline int flat_lowestBit(unsigned int mask) {
+    int i = 0;
+
+    while ((mask & 1U) == 0) {
+        mask >>= 1;
+        i++;
+    }
+    return i;
+}
+
+/*
+ * sets control byte `i' of a table of `capacity' slots; the first GROUP
+ * bytes are mirrored after the end of the array so that a group load
+ * starting near the end wraps around
+ */
+static inline void flat_setCtrl(signed char *ctrl, long capacity, long i,
+                                signed char c) {
+    ctrl[i] = c;
+    if (i < GROUP)
+        ctrl[capacity + i] = c;
+}
+
+/*
+ * returns the first EMPTY or DELETED slot on the probe sequence for `h';
+ * there is always one, as size + deleted < capacity
+ */
+static inline long flat_findFree(const signed char *ctrl, long capacity,
+                                 unsigned long long h) {
+    long mask = capacity - 1;
+    long pos = H1(h) & mask;
+    long step = 0L;
+
+    for (;;) {
+        unsigned int m = flat_matchEmptyOrDeleted(ctrl + pos);
+
+        if (m != 0)
+            return (pos + flat_lowestBit(m)) & mask;
+        step += GROUP;
+        pos = (pos + step) & mask;
+    }
+}
+
+/*
+ * returns the number of slots of a table of `capacity' slots that may be
+ * full or DELETED, given its load factor
+ */
+static inline long flat_growthLimit(long capacity, double loadFactor) {
+    long n = (long)(loadFactor * (double)capacity);
+
+    if (n >= capacity)
+        n = capacity - 1;
+    return n;
+}
+
+/*
+ * returns the smallest power of 2 that is >= `min' and whose growth limit
+ * is at least `n'
+ */
+static inline long flat_fitCapacity(double loadFactor, long n, long min) {
+    long N;
+
+    for (N = min; N < MAX_CAPACITY && flat_growthLimit(N, loadFactor) < n;
+         N *= 2)
+        ;
+    return N;
+}
+
+/*
+ * allocates the control array and an array of N slots of `slotSize'
+ * bytes for a table of N slots, marking every slot EMPTY
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static inline int flat_allocTable(long N, size_t slotSize, signed char **ctrl,
+                                  void **slots) {
+    *ctrl = (signed char *)malloc(N + GROUP);
+    *slots = malloc(N * slotSize);
+    if (*ctrl == NULL || *slots == NULL) {
+        free(*ctrl);
+        free(*slots);
+        return 0;
+    }
+    memset(*ctrl, EMPTY, N + GROUP);
+    return 1;
+}
+
+/*
+ * decides how to make room for one more entry in a table of `capacity'
+ * slots, `size' of them full and `deleted' DELETED: if most of the slots
+ * in use are full, the table is doubled, otherwise it is rebuilt at the
+ * same capacity to squeeze out the DELETED slots
+ *
+ * returns the capacity with which to rebuild the table, or 0 if there is
+ * room without rebuilding it (or nothing a rebuild would gain)
+ */
+static inline long flat_reserve(long size, long deleted, long limit,
+                                long capacity) {
+    long N = capacity;
+
+    if (size + deleted < limit)
+        return 0L;
+    if (2 * (size + 1) > limit && N < MAX_CAPACITY)
+        N *= 2;			/* mostly live entries, so grow */
+    if (N != capacity || deleted > 0L)
+        return N;
+    return 0L;
+}
+
+#endif /* _FLATGROUP_H_ */
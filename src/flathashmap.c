@@ -0,0 +1,796 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"
+#include "hmentry.h"
+#include "hash64.h"
+#include "chainstats.h"
+#include "flatgroup.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * implementation of the HashMap interface using open addressing; the
+ * control bytes and their group probes are those of flatgroup.h, and each
+ * slot is an HMEntry whose hash is the hash64() of its key
+ */
+
+#define DEFAULT_CAPACITY 16L
+#define DEFAULT_LOAD_FACTOR 0.875
+#define MAX_LOAD_FACTOR 0.875
+#define SHRINK_LOAD 4	/* shrink if load < loadFactor / SHRINK_LOAD */
+#define BATCH 16	/* keys hashed and prefetched together in batch methods */
+
+#ifdef __GNUC__
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p)
+#endif
+
+#define NO_DEADLINE 0L	/* deadlines are > 0, as the clock starts at 0 */
+
+typedef struct fhm_data {
+    long size;
+    long capacity;		/* always a power of 2, >= GROUP */
+    long minCapacity;		/* automatic shrinking stops here */
+    long deleted;		/* number of DELETED control bytes */
+    long limit;			/* size + deleted may not exceed this */
+    double loadFactor;
+    signed char *ctrl;		/* capacity + GROUP bytes, see flatgroup.h */
+    HMEntry *slots;
+    long *deadline;		/* per slot; NULL until the first TTL is set */
+    long clock;			/* the `now' of the last expire() */
+    long sweep;			/* slot where the next expire() resumes */
+    void (*expiryFxn)(char *key, void *element);
+    long resizes;		/* counters reported by stats(); the last */
+    double resizeTime;		/* three are only maintained if compiled */
+    long hits;			/* with -DHASH_STATS */
+    long misses;
+    long probes;
+} FhmData;
+
+#define EXPIRED(fhd, i) ((fhd)->deadline != NULL && \
+                         (fhd)->deadline[i] != NO_DEADLINE && \
+                         (fhd)->deadline[i] <= (fhd)->clock)
+
+/*
+ * local function to free the key in slot `i' and mark the slot DELETED
+ */
+static void deleteSlot(FhmData *fhd, long i) {
+    free(fhd->slots[i].key);
+    flat_setCtrl(fhd->ctrl, fhd->capacity, i, DELETED);
+    fhd->deleted++;
+    fhd->size--;
+}
+
+/*
+ * local function to remove the entry in slot `i', whose deadline has
+ * passed, invoking the expiry function on it
+ */
+static void reap(FhmData *fhd, long i) {
+    if (fhd->expiryFxn != NULL)
+        (*fhd->expiryFxn)(fhd->slots[i].key, fhd->slots[i].element);
+    deleteSlot(fhd, i);
+}
+
+/*
+ * local function to locate the `len'-byte key in the table; `h' is the
+ * hash of `key'; an entry whose deadline has passed is reaped and not found
+ *
+ * returns index of the slot, if found; -1 if not found
+ */
+static long findKey(FhmData *fhd, void *key, size_t len, unsigned long long h) {
+    long mask = fhd->capacity - 1;
+    long pos = H1(h) & mask;
+    long step = 0L;
+    signed char h2 = H2(h);
+
+    for (;;) {
+        signed char *g = fhd->ctrl + pos;
+        unsigned int m = flat_matchByte(g, h2);
+
+        STAT(fhd->probes++);
+        while (m != 0) {
+            int b = flat_lowestBit(m);
+            long i = (pos + b) & mask;
+            HMEntry *p = &fhd->slots[i];
+            if (p->hash == h && p->keylen == len &&
+                memcmp(p->key, key, len) == 0) {
+                if (EXPIRED(fhd, i)) {
+                    reap(fhd, i);
+                    STAT(fhd->misses++);
+                    return -1L;
+                }
+                STAT(fhd->hits++);
+                return i;
+            }
+            m &= m - 1;
+        }
+        if (flat_matchByte(g, EMPTY) != 0)
+            break;
+        step += GROUP;
+        if (step > fhd->capacity)	/* visited every group */
+            break;
+        pos = (pos + step) & mask;
+    }
+    STAT(fhd->misses++);
+    return -1L;
+}
+
+/*
+ * allocates the control and slot arrays for a table of N slots
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int allocTable(long N, signed char **ctrl, HMEntry **slots) {
+    void *p;
+
+    if (! flat_allocTable(N, sizeof(HMEntry), ctrl, &p))
+        return 0;
+    *slots = (HMEntry *)p;
+    return 1;
+}
+
+/*
+ * routine that rebuilds the table with N slots, dropping all DELETED
+ * entries; N may equal the current capacity; entries are placed using
+ * the hash cached in each slot, so keys are not rehashed
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int rebuild(FhmData *fhd, long N) {
+    signed char *oldCtrl = fhd->ctrl;
+    HMEntry *oldSlots = fhd->slots;
+    long *oldDeadline = fhd->deadline;
+    long oldN = fhd->capacity;
+    long i;
+    double start = chainstats_clock();
+
+    if (! allocTable(N, &fhd->ctrl, &fhd->slots)) {
+        fhd->ctrl = oldCtrl;
+        fhd->slots = oldSlots;
+        return 0;
+    }
+    if (oldDeadline != NULL &&
+        (fhd->deadline = (long *)malloc(N * sizeof(long))) == NULL) {
+        free(fhd->ctrl);
+        free(fhd->slots);
+        fhd->ctrl = oldCtrl;
+        fhd->slots = oldSlots;
+        fhd->deadline = oldDeadline;
+        return 0;
+    }
+    fhd->capacity = N;
+    for (i = 0L; i < oldN; i++) {
+        if (oldCtrl[i] >= 0) {
+            unsigned long long h = oldSlots[i].hash;
+            long j = flat_findFree(fhd->ctrl, fhd->capacity, h);
+            flat_setCtrl(fhd->ctrl, fhd->capacity, j, H2(h));
+            fhd->slots[j] = oldSlots[i];
+            if (oldDeadline != NULL)
+                fhd->deadline[j] = oldDeadline[i];
+        }
+    }
+    free(oldCtrl);
+    free(oldSlots);
+    free(oldDeadline);
+    fhd->deleted = 0L;
+    fhd->limit = flat_growthLimit(N, fhd->loadFactor);
+    fhd->resizes++;
+    fhd->resizeTime += chainstats_clock() - start;
+    return 1;
+}
+
+/*
+ * ensures there is room for one more entry, growing the table or
+ * squeezing out DELETED entries as needed
+ *
+ * returns 1 if room is available, 0 if not
+ */
+static int reserveOne(FhmData *fhd) {
+    long N = flat_reserve(fhd->size, fhd->deleted, fhd->limit, fhd->capacity);
+
+    if (N > 0L)
+        (void) rebuild(fhd, N);
+    return (fhd->size + fhd->deleted < fhd->capacity - 1);
+}
+
+/*
+ * traverses the table, calling freeFxn on each element
+ * then frees storage associated with the key
+ */
+static void purge(FhmData *fhd, void (*freeFxn)(void *element)) {
+    long i;
+
+    for (i = 0L; i < fhd->capacity; i++) {
+        if (fhd->ctrl[i] >= 0) {
+            if (freeFxn != NULL)
+                (*freeFxn)(fhd->slots[i].element);
+            free(fhd->slots[i].key);
+        }
+    }
+    memset(fhd->ctrl, EMPTY, fhd->capacity + GROUP);
+    fhd->size = 0L;
+    fhd->deleted = 0L;
+}
+
+static void fhm_destroy(const HashMap *hm, void (*freeFxn)(void *element)) {
+    FhmData *fhd = (FhmData *)hm->self;
+    purge(fhd, freeFxn);
+    free(fhd->ctrl);
+    free(fhd->slots);
+    free(fhd->deadline);
+    free(fhd);
+    free((void *)hm);
+}
+
+static void fhm_clear(const HashMap *hm, void (*freeFxn)(void *element)) {
+    FhmData *fhd = (FhmData *)hm->self;
+    purge(fhd, freeFxn);
+}
+
+static int fhm_containsKeyn(const HashMap *hm, void *key, long len) {
+    FhmData *fhd = (FhmData *)hm->self;
+
+    return (findKey(fhd, key, len, hash64(key, len)) >= 0L);
+}
+
+static int fhm_containsKey(const HashMap *hm, char *key) {
+    return fhm_containsKeyn(hm, key, (long)strlen(key));
+}
+
+/*
+ * local function for generating an array of HMEntry * from the table
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static HMEntry **entries(FhmData *fhd) {
+    HMEntry **tmp = NULL;
+    if (fhd->size > 0L) {
+        size_t nbytes = fhd->size * sizeof(HMEntry *);
+        tmp = (HMEntry **)malloc(nbytes);
+        if (tmp != NULL) {
+            long i, n = 0L;
+            for (i = 0L; i < fhd->capacity; i++)
+                if (fhd->ctrl[i] >= 0)
+                    tmp[n++] = &fhd->slots[i];
+        }
+    }
+    return tmp;
+}
+
+static HMEntry **fhm_entryArray(const HashMap *hm, long *len) {
+    FhmData *fhd = (FhmData *)hm->self;
+    HMEntry **tmp = entries(fhd);
+
+    if (tmp != NULL)
+        *len = fhd->size;
+    return tmp;
+}
+
+static int fhm_getn(const HashMap *hm, void *key, long len, void **element) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i = findKey(fhd, key, len, hash64(key, len));
+    int ans = 0;
+
+    if (i >= 0L) {
+        ans = 1;
+        *element = fhd->slots[i].element;
+    }
+    return ans;
+}
+
+static int fhm_get(const HashMap *hm, char *key, void **element) {
+    return fhm_getn(hm, key, (long)strlen(key), element);
+}
+
+static int fhm_isEmpty(const HashMap *hm) {
+    FhmData *fhd = (FhmData *)hm->self;
+    return (fhd->size == 0L);
+}
+
+/*
+ * local function for generating an array of keys from the table
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static char **keys(FhmData *fhd) {
+    char **tmp = NULL;
+    if (fhd->size > 0L) {
+        size_t nbytes = fhd->size * sizeof(char *);
+        tmp = (char **)malloc(nbytes);
+        if (tmp != NULL) {
+            long i, n = 0L;
+            for (i = 0L; i < fhd->capacity; i++)
+                if (fhd->ctrl[i] >= 0)
+                    tmp[n++] = fhd->slots[i].key;
+        }
+    }
+    return tmp;
+}
+
+static char **fhm_keyArray(const HashMap *hm, long *len) {
+    FhmData *fhd = (FhmData *)hm->self;
+    char **tmp = keys(fhd);
+
+    if (tmp != NULL)
+        *len = fhd->size;
+    return tmp;
+}
+
+/*
+ * helper function to insert new (key, element) into table; `h' is
+ * the hash of the `len'-byte key, which is known not to be present;
+ * the stored copy of the key is always followed by a '\0'
+ *
+ * returns index of the slot used, or -1 if malloc failure
+ */
+static long insertEntry(FhmData *fhd, void *key, size_t len, void *element,
+                        unsigned long long h) {
+    char *q;
+    long i;
+
+    if (! reserveOne(fhd))
+        return -1L;
+    if ((q = (char *)malloc(len + 1)) == NULL)
+        return -1L;
+    memcpy(q, key, len);
+    q[len] = '\0';
+    i = flat_findFree(fhd->ctrl, fhd->capacity, h);
+    if (fhd->ctrl[i] == DELETED)
+        fhd->deleted--;
+    flat_setCtrl(fhd->ctrl, fhd->capacity, i, H2(h));
+    fhd->slots[i].next = NULL;
+    fhd->slots[i].hash = h;
+    fhd->slots[i].keylen = len;
+    fhd->slots[i].key = q;
+    fhd->slots[i].element = element;
+    if (fhd->deadline != NULL)
+        fhd->deadline[i] = NO_DEADLINE;
+    fhd->size++;
+    return i;
+}
+
+/*
+ * local function that implements put(); `h' is the hash of the `len'-byte key
+ */
+static int putHashed(FhmData *fhd, void *key, size_t len, unsigned long long h,
+                     void *element, void **previous) {
+    long i = findKey(fhd, key, len, h);
+    int ans = 0;
+
+    if (i >= 0L) {
+        if (previous != NULL)
+            *previous = fhd->slots[i].element;
+        fhd->slots[i].element = element;
+        if (fhd->deadline != NULL)
+            fhd->deadline[i] = NO_DEADLINE;
+        ans = 1;
+    } else {
+        if (previous != NULL)
+            *previous = NULL;
+        ans = (insertEntry(fhd, key, len, element, h) >= 0L);
+    }
+    return ans;
+}
+
+static int fhm_putn(const HashMap *hm, void *key, long len, void *element,
+                    void **previous) {
+    FhmData *fhd = (FhmData *)hm->self;
+
+    return putHashed(fhd, key, len, hash64(key, len), element, previous);
+}
+
+static int fhm_put(const HashMap *hm, char *key, void *element, void **previous) {
+    return fhm_putn(hm, key, (long)strlen(key), element, previous);
+}
+
+static int fhm_putUnique(const HashMap *hm, char *key, void *element) {
+    FhmData *fhd = (FhmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    int ans = 0;
+
+    if (findKey(fhd, key, len, h) < 0L)
+        ans = (insertEntry(fhd, key, len, element, h) >= 0L);
+    return ans;
+}
+
+static int fhm_removen(const HashMap *hm, void *key, long len, void **element) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i = findKey(fhd, key, len, hash64(key, len));
+    int ans = 0;
+
+    if (i >= 0L) {
+        *element = fhd->slots[i].element;
+        deleteSlot(fhd, i);
+        /*
+         * shrink to half full if the load has fallen below
+         * loadFactor / SHRINK_LOAD; the gap keeps a table whose size
+         * hovers around the threshold from being rebuilt repeatedly
+         */
+        if (fhd->size * SHRINK_LOAD < fhd->limit &&
+            fhd->capacity > fhd->minCapacity) {
+            long N = flat_fitCapacity(fhd->loadFactor, 2 * fhd->size, fhd->minCapacity);
+            if (N < fhd->capacity)
+                (void) rebuild(fhd, N);
+        }
+        ans = 1;
+    }
+    return ans;
+}
+
+static int fhm_remove(const HashMap *hm, char *key, void **element) {
+    return fhm_removen(hm, key, (long)strlen(key), element);
+}
+
+/*
+ * local function that locates the slot for `key', adding an entry with a
+ * NULL element if there is none; `*added' is set to 1 if the entry was
+ * added
+ *
+ * returns index of the slot, or -1 if malloc failure
+ */
+static long findOrAdd(FhmData *fhd, char *key, int *added) {
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    long i = findKey(fhd, key, len, h);
+
+    *added = 0;
+    if (i < 0L && (i = insertEntry(fhd, key, len, NULL, h)) >= 0L)
+        *added = 1;
+    return i;
+}
+
+static int fhm_computeIfAbsent(const HashMap *hm, char *key,
+                               void *(*factory)(char *key, void *ctx),
+                               void *ctx, void **element) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i;
+    int added;
+
+    if ((i = findOrAdd(fhd, key, &added)) < 0L)
+        return 0;
+    if (added)
+        fhd->slots[i].element = factory(key, ctx);
+    *element = fhd->slots[i].element;
+    return 1;
+}
+
+static int fhm_compute(const HashMap *hm, char *key,
+                       int (*fxn)(char *key, void **element, void *ctx),
+                       void *ctx) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i;
+    int added;
+
+    if ((i = findOrAdd(fhd, key, &added)) < 0L)
+        return 0;
+    if (fxn(key, &fhd->slots[i].element, ctx))
+        return 1;
+    deleteSlot(fhd, i);
+    return 0;
+}
+
+static int fhm_merge(const HashMap *hm, char *key, void *element,
+                     void *(*mergeFxn)(void *old, void *element)) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i;
+    int added;
+
+    if ((i = findOrAdd(fhd, key, &added)) < 0L)
+        return 0;
+    fhd->slots[i].element = (added) ? element :
+                            mergeFxn(fhd->slots[i].element, element);
+    return 1;
+}
+
+/*
+ * the deadline of each slot is kept in an array parallel to the slots,
+ * which is only allocated when the first time-to-live is set
+ */
+static int fhm_putWithTTL(const HashMap *hm, char *key, void *element,
+                          long ttl, void **previous) {
+    FhmData *fhd = (FhmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    long i;
+
+    if (ttl <= 0L)
+        return putHashed(fhd, key, len, h, element, previous);
+    if (fhd->deadline == NULL) {
+        fhd->deadline = (long *)malloc(fhd->capacity * sizeof(long));
+        if (fhd->deadline == NULL)
+            return 0;
+        for (i = 0L; i < fhd->capacity; i++)
+            fhd->deadline[i] = NO_DEADLINE;
+    }
+    if ((i = findKey(fhd, key, len, h)) >= 0L) {
+        if (previous != NULL)
+            *previous = fhd->slots[i].element;
+        fhd->slots[i].element = element;
+    } else {
+        if ((i = insertEntry(fhd, key, len, element, h)) < 0L)
+            return 0;
+        if (previous != NULL)
+            *previous = NULL;
+    }
+    fhd->deadline[i] = fhd->clock + ttl;
+    return 1;
+}
+
+/*
+ * there is no timer wheel: the clock is set to `now' at once, so lookups
+ * no longer find entries whose deadlines are <= now, and the table is
+ * swept for such entries from where the previous call stopped; each entry
+ * reaped and each group of slots examined is one unit of work
+ */
+static long fhm_expire(const HashMap *hm, long now, long maxWork) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i, seen, work = 0L, n = 0L;
+
+    if (now > fhd->clock)
+        fhd->clock = now;
+    if (fhd->deadline == NULL)
+        return 0L;
+    for (seen = 0L; seen < fhd->capacity; seen++) {
+        if (maxWork > 0L && work >= maxWork)
+            break;
+        i = fhd->sweep & (fhd->capacity - 1);
+        fhd->sweep = i + 1;
+        if (fhd->ctrl[i] >= 0 && EXPIRED(fhd, i)) {
+            reap(fhd, i);
+            work++;
+            n++;
+        }
+        if ((i & (GROUP - 1)) == GROUP - 1)
+            work++;
+    }
+    return n;
+}
+
+static void fhm_setExpiryFxn(const HashMap *hm,
+                             void (*expiryFxn)(char *key, void *element)) {
+    FhmData *fhd = (FhmData *)hm->self;
+
+    fhd->expiryFxn = expiryFxn;
+}
+
+static long fhm_size(const HashMap *hm) {
+    FhmData *fhd = (FhmData *)hm->self;
+    return fhd->size;
+}
+
+static const Iterator *fhm_itCreate(const HashMap *hm) {
+    FhmData *fhd = (FhmData *)hm->self;
+    const Iterator *it = NULL;
+    void **tmp = (void **)entries(fhd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(fhd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+/*
+ * local function that computes the lengths and hashes of the `n' keys
+ * (n <= BATCH), and prefetches the first control group and slot that
+ * each key's probe sequence will examine
+ */
+static void prepareBatch(FhmData *fhd, char **keys, long n, size_t *lens,
+                         unsigned long long *hashes) {
+    long mask = fhd->capacity - 1;
+    long j;
+
+    for (j = 0; j < n; j++) {
+        long pos;
+        lens[j] = strlen(keys[j]);
+        hashes[j] = hash64(keys[j], lens[j]);
+        pos = H1(hashes[j]) & mask;
+        PREFETCH(fhd->ctrl + pos);
+        PREFETCH(&fhd->slots[pos]);
+    }
+}
+
+static long fhm_getBatch(const HashMap *hm, char **keys, long n,
+                         void **elements, int *found) {
+    FhmData *fhd = (FhmData *)hm->self;
+    size_t lens[BATCH];
+    unsigned long long hashes[BATCH];
+    long i, j, m, ans = 0L;
+
+    for (i = 0L; i < n; i += BATCH) {
+        m = (n - i < BATCH) ? n - i : BATCH;
+        prepareBatch(fhd, keys + i, m, lens, hashes);
+        for (j = 0; j < m; j++) {
+            long k = findKey(fhd, keys[i + j], lens[j], hashes[j]);
+            elements[i + j] = (k >= 0L) ? fhd->slots[k].element : NULL;
+            if (found != NULL)
+                found[i + j] = (k >= 0L);
+            if (k >= 0L)
+                ans++;
+        }
+    }
+    return ans;
+}
+
+static long fhm_putBatch(const HashMap *hm, char **keys, long n,
+                         void **elements, void **previous) {
+    FhmData *fhd = (FhmData *)hm->self;
+    size_t lens[BATCH];
+    unsigned long long hashes[BATCH];
+    long i, j, m, ans = 0L;
+    void *prev;
+
+    for (i = 0L; i < n; i += BATCH) {
+        m = (n - i < BATCH) ? n - i : BATCH;
+        prepareBatch(fhd, keys + i, m, lens, hashes);
+        for (j = 0; j < m; j++) {
+            if (putHashed(fhd, keys[i + j], lens[j], hashes[j],
+                          elements[i + j], &prev))
+                ans++;
+            if (previous != NULL)
+                previous[i + j] = prev;
+        }
+    }
+    return ans;
+}
+
+static int fhm_forEach(const HashMap *hm,
+                       int (*callback)(HMEntry *entry, void *ctx), void *ctx) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i;
+    int ans;
+
+    for (i = 0L; i < fhd->capacity; i++) {
+        if (fhd->ctrl[i] >= 0) {
+            if ((ans = (*callback)(&fhd->slots[i], ctx)) != 0)
+                return ans;
+        }
+    }
+    return 0;
+}
+
+/*
+ * the cursor is simply the index of the next slot to examine
+ */
+static int fhm_scan(const HashMap *hm, HMCursor *cursor, HMEntry **entry) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long i;
+
+    for (i = cursor->bucket; i < fhd->capacity; i++) {
+        if (fhd->ctrl[i] >= 0) {
+            *entry = &fhd->slots[i];
+            cursor->bucket = i + 1;
+            return 1;
+        }
+    }
+    cursor->bucket = i;
+    return 0;
+}
+
+/*
+ * entries live in the table itself, so there are no free nodes to return
+ */
+static long fhm_trim(const HashMap *hm) {
+    (void) hm;
+    return 0L;
+}
+
+/*
+ * rebuilding the table also squeezes out the DELETED entries
+ */
+static int fhm_compact(const HashMap *hm) {
+    FhmData *fhd = (FhmData *)hm->self;
+
+    return rebuild(fhd, flat_fitCapacity(fhd->loadFactor, fhd->size, DEFAULT_CAPACITY));
+}
+
+/*
+ * the chain of each entry is the sequence of groups probed to reach it
+ */
+static void fhm_stats(const HashMap *hm, HashStats *hs) {
+    FhmData *fhd = (FhmData *)hm->self;
+    long mask = fhd->capacity - 1;
+    long i, n, pos, step;
+
+    chainstats_init(hs);
+    hs->size = fhd->size;
+    hs->capacity = fhd->capacity;
+    for (i = 0L; i < fhd->capacity; i++) {
+        if (fhd->ctrl[i] >= 0) {
+            pos = H1(fhd->slots[i].hash) & mask;
+            for (n = 1L, step = 0L; ((i - pos) & mask) >= GROUP; n++) {
+                step += GROUP;
+                pos = (pos + step) & mask;
+            }
+            chainstats_add(hs, n);
+        }
+    }
+    chainstats_finish(hs, fhd->resizes, fhd->resizeTime, fhd->hits,
+                      fhd->misses, fhd->probes);
+}
+
+static HashMap template = {
+    NULL, fhm_destroy, fhm_clear, fhm_containsKey, fhm_entryArray, fhm_get,
+    fhm_isEmpty, fhm_keyArray, fhm_put, fhm_putUnique, fhm_remove, fhm_size,
+    fhm_itCreate, fhm_containsKeyn, fhm_getn, fhm_putn, fhm_removen,
+    fhm_getBatch, fhm_putBatch, fhm_forEach, fhm_scan, fhm_trim,
+    fhm_compact, fhm_stats, fhm_computeIfAbsent, fhm_compute, fhm_merge,
+    fhm_putWithTTL, fhm_expire, fhm_setExpiryFxn
+};
+
+const HashMap *HashMap_createFlat(long capacity, double loadFactor) {
+    HashMap *hm = (HashMap *)malloc(sizeof(HashMap));
+    long N;
+    double lf;
+
+    if (hm != NULL) {
+        FhmData *fhd = (FhmData *)malloc(sizeof(FhmData));
+
+        if (fhd != NULL) {
+            if (capacity > MAX_CAPACITY)
+                capacity = MAX_CAPACITY;
+            for (N = DEFAULT_CAPACITY; N < capacity; N *= 2)
+                ;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            if (lf > MAX_LOAD_FACTOR)
+                lf = MAX_LOAD_FACTOR;
+            if (allocTable(N, &fhd->ctrl, &fhd->slots)) {
+                fhd->capacity = N;
+                fhd->minCapacity = N;
+                fhd->resizes = 0L;
+                fhd->resizeTime = 0.0;
+                fhd->hits = fhd->misses = fhd->probes = 0L;
+                fhd->loadFactor = lf;
+                fhd->size = 0L;
+                fhd->deleted = 0L;
+                fhd->limit = flat_growthLimit(N, lf);
+                fhd->deadline = NULL;
+                fhd->clock = 0L;
+                fhd->sweep = 0L;
+                fhd->expiryFxn = NULL;
+                *hm = template;
+                hm->self = fhd;
+            } else {
+                free(fhd);
+                free(hm);
+                hm = NULL;
+            }
+        } else {
+            free(hm);
+            hm = NULL;
+        }
+    }
+    return hm;
+}
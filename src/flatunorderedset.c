@@ -0,0 +1,652 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "unorderedset.h"
+#include "chainstats.h"
+#include "flatgroup.h"
+#include "ustag.h"
+#include "workers.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * implementation of UnorderedSet_createFlat(); the table is laid out as in
+ * flathashmap.c, with the control bytes and group probes of flatgroup.h,
+ * but each slot holds the element and the full 64-bit hash that the
+ * user's hash function returned for it when it was added
+ *
+ * a probe only calls the user's cmp function on slots whose stored hash
+ * equals that of the element sought, and the table is rebuilt from the
+ * stored hashes, so the user's hash function is invoked exactly once per
+ * add(), contains() or remove() and never by a resize
+ */
+
+#define DEFAULT_CAPACITY 16L
+#define DEFAULT_LOAD_FACTOR 0.875
+#define MAX_LOAD_FACTOR 0.875
+#define SHRINK_LOAD 4	/* shrink if load < loadFactor / SHRINK_LOAD */
+#define PAR_MIN 16384L	/* set algebra on fewer elements is not threaded */
+
+typedef struct fus_slot {
+    unsigned long long hash;	/* scrambled, see scramble() */
+    void *element;
+} FusSlot;
+
+typedef struct fus_data {
+    int tag;			/* US_TAG_FLAT, see ustag.h */
+    long size;
+    long capacity;		/* always a power of 2, >= GROUP */
+    long minCapacity;		/* automatic shrinking stops here */
+    long deleted;		/* number of DELETED control bytes */
+    long limit;			/* size + deleted may not exceed this */
+    double loadFactor;
+    int (*cmp)(void *, void *);
+    unsigned long long (*hash)(void *);
+    signed char *ctrl;		/* capacity + GROUP bytes, see flatgroup.h */
+    FusSlot *slots;
+    long resizes;		/* counters reported by stats(); the last */
+    double resizeTime;		/* three are only maintained if compiled */
+    long hits;			/* with -DHASH_STATS */
+    long misses;
+    long probes;
+} FusData;
+
+/*
+ * the user's hash is passed through a bijective mixing step before it is
+ * stored, so that hashes that differ only in their high bits (or only in
+ * their low bits) still spread over the table and the fingerprints;
+ * as the step is a bijection, equal stored hashes mean equal user hashes
+ */
+static unsigned long long scramble(unsigned long long h) {
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    h *= 0xd6e8feb86659fd93ULL;
+    h ^= h >> 32;
+    return h;
+}
+
+/*
+ * local function to locate `element' in the table; `h' is its scrambled
+ * hash; the number of groups probed is stored in `*groups'
+ *
+ * it only reads the table, so workers may call it concurrently
+ *
+ * returns index of the slot, if found; -1 if not found
+ */
+static long lookup(FusData *fsd, void *element, unsigned long long h,
+                   long *groups) {
+    long mask = fsd->capacity - 1;
+    long pos = H1(h) & mask;
+    long step = 0L;
+    signed char h2 = H2(h);
+
+    for (*groups = 1L; ; (*groups)++) {
+        signed char *g = fsd->ctrl + pos;
+        unsigned int m = flat_matchByte(g, h2);
+
+        while (m != 0) {
+            long i = (pos + flat_lowestBit(m)) & mask;
+            FusSlot *p = &fsd->slots[i];
+            if (p->hash == h && fsd->cmp(p->element, element) == 0)
+                return i;
+            m &= m - 1;
+        }
+        if (flat_matchByte(g, EMPTY) != 0)
+            break;
+        step += GROUP;
+        if (step > fsd->capacity)	/* visited every group */
+            break;
+        pos = (pos + step) & mask;
+    }
+    return -1L;
+}
+
+/*
+ * lookup() for the methods of the hashset, counting the probe in the
+ * statistics
+ */
+static long findElement(FusData *fsd, void *element, unsigned long long h) {
+    long groups;
+    long i = lookup(fsd, element, h, &groups);
+
+    STAT(fsd->probes += groups);
+    STAT(fsd->hits += (i >= 0L));
+    STAT(fsd->misses += (i < 0L));
+    return i;
+}
+
+/*
+ * allocates the control and slot arrays for a table of N slots
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int allocTable(long N, signed char **ctrl, FusSlot **slots) {
+    void *p;
+
+    if (! flat_allocTable(N, sizeof(FusSlot), ctrl, &p))
+        return 0;
+    *slots = (FusSlot *)p;
+    return 1;
+}
+
+/*
+ * routine that rebuilds the table with N slots, dropping all DELETED
+ * entries; N may equal the current capacity; elements are placed using
+ * the hash stored in each slot, so the user's hash function is not called
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int rebuild(FusData *fsd, long N) {
+    signed char *oldCtrl = fsd->ctrl;
+    FusSlot *oldSlots = fsd->slots;
+    long oldN = fsd->capacity;
+    long i;
+    double start = chainstats_clock();
+
+    if (! allocTable(N, &fsd->ctrl, &fsd->slots)) {
+        fsd->ctrl = oldCtrl;
+        fsd->slots = oldSlots;
+        return 0;
+    }
+    fsd->capacity = N;
+    for (i = 0L; i < oldN; i++) {
+        if (oldCtrl[i] >= 0) {
+            unsigned long long h = oldSlots[i].hash;
+            long j = flat_findFree(fsd->ctrl, fsd->capacity, h);
+            flat_setCtrl(fsd->ctrl, fsd->capacity, j, H2(h));
+            fsd->slots[j] = oldSlots[i];
+        }
+    }
+    free(oldCtrl);
+    free(oldSlots);
+    fsd->deleted = 0L;
+    fsd->limit = flat_growthLimit(N, fsd->loadFactor);
+    fsd->resizes++;
+    fsd->resizeTime += chainstats_clock() - start;
+    return 1;
+}
+
+/*
+ * ensures there is room for one more element, growing the table or
+ * squeezing out DELETED entries as needed
+ *
+ * returns 1 if room is available, 0 if not
+ */
+static int reserveOne(FusData *fsd) {
+    long N = flat_reserve(fsd->size, fsd->deleted, fsd->limit, fsd->capacity);
+
+    if (N > 0L)
+        (void) rebuild(fsd, N);
+    return (fsd->size + fsd->deleted < fsd->capacity - 1);
+}
+
+/*
+ * traverses the table, calling freeFxn on each element
+ */
+static void purge(FusData *fsd, void (*freeFxn)(void *element)) {
+    long i;
+
+    if (freeFxn != NULL)
+        for (i = 0L; i < fsd->capacity; i++)
+            if (fsd->ctrl[i] >= 0)
+                (*freeFxn)(fsd->slots[i].element);
+    memset(fsd->ctrl, EMPTY, fsd->capacity + GROUP);
+    fsd->size = 0L;
+    fsd->deleted = 0L;
+}
+
+static void fus_destroy(const UnorderedSet *us,
+                        void (*freeFxn)(void *element)) {
+    FusData *fsd = (FusData *)us->self;
+    purge(fsd, freeFxn);
+    free(fsd->ctrl);
+    free(fsd->slots);
+    free(fsd);
+    free((void *)us);
+}
+
+static void fus_clear(const UnorderedSet *us, void (*freeFxn)(void *element)) {
+    FusData *fsd = (FusData *)us->self;
+    purge(fsd, freeFxn);
+}
+
+static int fus_add(const UnorderedSet *us, void *element) {
+    FusData *fsd = (FusData *)us->self;
+    unsigned long long h = scramble(fsd->hash(element));
+    long i;
+
+    if (findElement(fsd, element, h) >= 0L || ! reserveOne(fsd))
+        return 0;
+    i = flat_findFree(fsd->ctrl, fsd->capacity, h);
+    if (fsd->ctrl[i] == DELETED)
+        fsd->deleted--;
+    flat_setCtrl(fsd->ctrl, fsd->capacity, i, H2(h));
+    fsd->slots[i].hash = h;
+    fsd->slots[i].element = element;
+    fsd->size++;
+    return 1;
+}
+
+static int fus_contains(const UnorderedSet *us, void *element) {
+    FusData *fsd = (FusData *)us->self;
+
+    return (findElement(fsd, element, scramble(fsd->hash(element))) >= 0L);
+}
+
+static int fus_isEmpty(const UnorderedSet *us) {
+    FusData *fsd = (FusData *)us->self;
+    return (fsd->size == 0L);
+}
+
+static int fus_remove(const UnorderedSet *us, void *element,
+                      void (*freeFxn)(void *)) {
+    FusData *fsd = (FusData *)us->self;
+    long i = findElement(fsd, element, scramble(fsd->hash(element)));
+    int ans = 0;
+
+    if (i >= 0L) {
+        if (freeFxn != NULL)
+            (*freeFxn)(fsd->slots[i].element);
+        flat_setCtrl(fsd->ctrl, fsd->capacity, i, DELETED);
+        fsd->deleted++;
+        fsd->size--;
+        /*
+         * shrink to half full if the load has fallen below
+         * loadFactor / SHRINK_LOAD, as the flat hashmap does
+         */
+        if (fsd->size * SHRINK_LOAD < fsd->limit &&
+            fsd->capacity > fsd->minCapacity) {
+            long N = flat_fitCapacity(fsd->loadFactor, 2 * fsd->size, fsd->minCapacity);
+            if (N < fsd->capacity)
+                (void) rebuild(fsd, N);
+        }
+        ans = 1;
+    }
+    return ans;
+}
+
+static long fus_size(const UnorderedSet *us) {
+    FusData *fsd = (FusData *)us->self;
+    return fsd->size;
+}
+
+/*
+ * local function for generating an array of void * from the table
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static void **entries(FusData *fsd) {
+    void **tmp = NULL;
+    if (fsd->size > 0L) {
+        size_t nbytes = fsd->size * sizeof(void *);
+        tmp = (void **)malloc(nbytes);
+        if (tmp != NULL) {
+            long i, n = 0L;
+            for (i = 0L; i < fsd->capacity; i++)
+                if (fsd->ctrl[i] >= 0)
+                    tmp[n++] = fsd->slots[i].element;
+        }
+    }
+    return tmp;
+}
+
+static void **fus_toArray(const UnorderedSet *us, long *len) {
+    FusData *fsd = (FusData *)us->self;
+    void **tmp = entries(fsd);
+
+    if (tmp != NULL)
+        *len = fsd->size;
+    return tmp;
+}
+
+static const Iterator *fus_itCreate(const UnorderedSet *us) {
+    FusData *fsd = (FusData *)us->self;
+    const Iterator *it = NULL;
+    void **tmp = entries(fsd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(fsd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+/*
+ * the elements live in the table itself, so there is no free list to trim
+ */
+static long fus_trim(const UnorderedSet *us) {
+    (void) us;
+    return 0L;
+}
+
+/*
+ * rebuilding the table also squeezes out the DELETED entries
+ */
+static int fus_compact(const UnorderedSet *us) {
+    FusData *fsd = (FusData *)us->self;
+
+    return rebuild(fsd, flat_fitCapacity(fsd->loadFactor, fsd->size, DEFAULT_CAPACITY));
+}
+
+/*
+ * the chain of each element is the sequence of groups probed to reach it
+ */
+static void fus_stats(const UnorderedSet *us, HashStats *hs) {
+    FusData *fsd = (FusData *)us->self;
+    long mask = fsd->capacity - 1;
+    long i, n, pos, step;
+
+    chainstats_init(hs);
+    hs->size = fsd->size;
+    hs->capacity = fsd->capacity;
+    for (i = 0L; i < fsd->capacity; i++) {
+        if (fsd->ctrl[i] >= 0) {
+            pos = H1(fsd->slots[i].hash) & mask;
+            for (n = 1L, step = 0L; ((i - pos) & mask) >= GROUP; n++) {
+                step += GROUP;
+                pos = (pos + step) & mask;
+            }
+            chainstats_add(hs, n);
+        }
+    }
+    chainstats_finish(hs, fsd->resizes, fsd->resizeTime, fsd->hits,
+                      fsd->misses, fsd->probes);
+}
+
+/*
+ * set algebra
+ *
+ * the result is created with room for every candidate element, and each
+ * element kept is placed using its stored hash, so building the result
+ * neither resizes the table nor calls the hash function; when `other' is
+ * also a flat hashset with the same hash function, it is probed with the
+ * stored hashes as well
+ *
+ * when `other' is a flat hashset, probing it only reads it, so on a large
+ * table the probes are divided among worker threads, each taking a range
+ * of slots and marking those to keep; the marked elements are then placed
+ * in the result by the calling thread, since placing an element with open
+ * addressing may probe into the range of any other worker; with any other
+ * kind of UnorderedSet, nothing is known about the thread-safety of its
+ * contains(), and the calling thread does all the work
+ */
+
+/*
+ * local function that creates an empty flat hashset like `fsd' with room
+ * for `n' elements
+ */
+static const UnorderedSet *emptyLike(FusData *fsd, long n) {
+    const UnorderedSet *us;
+
+    us = UnorderedSet_createFlat(fsd->cmp, fsd->hash,
+                                 flat_fitCapacity(fsd->loadFactor, n, DEFAULT_CAPACITY),
+                                 fsd->loadFactor);
+    if (us != NULL)
+        ((FusData *)us->self)->minCapacity = DEFAULT_CAPACITY;
+    return us;
+}
+
+/*
+ * local function that places `element', with scrambled hash `h', in a
+ * table known not to contain it and to have room for it
+ */
+static void place(FusData *fsd, void *element, unsigned long long h) {
+    long i = flat_findFree(fsd->ctrl, fsd->capacity, h);
+
+    flat_setCtrl(fsd->ctrl, fsd->capacity, i, H2(h));
+    fsd->slots[i].hash = h;
+    fsd->slots[i].element = element;
+    fsd->size++;
+}
+
+/*
+ * returns 1 if `other' contains `element', whose scrambled hash under the
+ * hash function of `fsd' is `h'; if `other' is a flat hashset, this has
+ * no side effects
+ */
+static int member(FusData *fsd, const UnorderedSet *other,
+                  void *element, unsigned long long h) {
+    FusData *ofd = (FusData *)other->self;
+    long groups;
+
+    if (US_TAG(other) != US_TAG_FLAT)
+        return other->contains(other, element);
+    if (ofd->hash != fsd->hash)
+        h = scramble(ofd->hash(element));
+    return (lookup(ofd, element, h, &groups) >= 0L);
+}
+
+typedef struct fus_job {
+    FusData *fsd;		/* the job marks slots [start, end) of fsd */
+    long start;
+    long end;
+    const UnorderedSet *other;	/* whose elements are or are not */
+    int keepIfFound;		/* members of other */
+    unsigned char *keep;	/* 1 for each slot marked, if not NULL */
+    long kept;			/* out: number of slots marked */
+} FusJob;
+
+static void *markJob(void *arg) {
+    FusJob *j = (FusJob *)arg;
+    FusData *fsd = j->fsd;
+    long i;
+    int k;
+
+    j->kept = 0L;
+    for (i = j->start; i < j->end; i++) {
+        k = (fsd->ctrl[i] >= 0 &&
+             member(fsd, j->other, fsd->slots[i].element,
+                    fsd->slots[i].hash) == j->keepIfFound);
+        if (j->keep != NULL)
+            j->keep[i] = (unsigned char)k;
+        j->kept += k;
+    }
+    return NULL;
+}
+
+/*
+ * local function that marks in keep[], if it is not NULL, the full slots
+ * of `fsd' whose elements are (keepIfFound == 1) or are not (keepIfFound
+ * == 0) members of `other'; when `other' is also a flat hashset, probing
+ * it has no side effects, so a large table is divided among workers
+ *
+ * returns the number of slots marked
+ */
+static long mark(FusData *fsd, const UnorderedSet *other, int keepIfFound,
+                 unsigned char *keep) {
+    FusJob jobs[WORKERS_MAX];
+    long i, nw = 1L, kept = 0L;
+
+    if (fsd->size >= PAR_MIN && US_TAG(other) == US_TAG_FLAT)
+        nw = workers_count(fsd->size, PAR_MIN / 2);
+    for (i = 0L; i < nw; i++) {
+        jobs[i].fsd = fsd;
+        jobs[i].start = fsd->capacity * i / nw;
+        jobs[i].end = fsd->capacity * (i + 1) / nw;
+        jobs[i].other = other;
+        jobs[i].keepIfFound = keepIfFound;
+        jobs[i].keep = keep;
+    }
+    workers_run(markJob, jobs, sizeof(FusJob), nw);
+    for (i = 0L; i < nw; i++)
+        kept += jobs[i].kept;
+    return kept;
+}
+
+/*
+ * local function that copies into `ans' the elements of `fsd' that are
+ * (keepIfFound == 1) or are not (keepIfFound == 0) members of `other', or
+ * all of them if `other' is NULL
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int keepIf(FusData *fsd, const UnorderedSet *other, int keepIfFound,
+                  FusData *ans) {
+    unsigned char *keep = NULL;
+    long i;
+
+    if (other != NULL) {
+        if ((keep = (unsigned char *)malloc(fsd->capacity)) == NULL)
+            return 0;
+        (void) mark(fsd, other, keepIfFound, keep);
+    }
+    for (i = 0L; i < fsd->capacity; i++)
+        if (fsd->ctrl[i] >= 0 && (keep == NULL || keep[i]))
+            place(ans, fsd->slots[i].element, fsd->slots[i].hash);
+    free(keep);
+    return 1;
+}
+
+/*
+ * local function returning `ans' if `ok', otherwise destroying it and
+ * returning NULL
+ */
+static const UnorderedSet *checked(const UnorderedSet *ans, int ok) {
+    if (ans != NULL && ! ok) {
+        ans->destroy(ans, NULL);
+        ans = NULL;
+    }
+    return ans;
+}
+
+static const UnorderedSet *fus_setUnion(const UnorderedSet *us,
+                                        const UnorderedSet *other) {
+    FusData *fsd = (FusData *)us->self;
+    FusData *ofd = NULL;
+    const UnorderedSet *ans;
+    void **tmp = NULL;
+    long i, n = 0L;
+    int ok = 1;
+
+    if (US_TAG(other) == US_TAG_FLAT &&
+        ((FusData *)other->self)->hash == fsd->hash)
+        ofd = (FusData *)other->self;
+    else if (! other->isEmpty(other) &&
+             (tmp = other->toArray(other, &n)) == NULL)
+        return NULL;
+    if ((ans = emptyLike(fsd, fsd->size + other->size(other))) != NULL) {
+        FusData *ad = (FusData *)ans->self;
+
+        ok = keepIf(fsd, NULL, 1, ad);
+        if (ofd != NULL)
+            ok = ok && keepIf(ofd, us, 0, ad);
+        else
+            for (i = 0L; i < n; i++) {
+                unsigned long long h = scramble(fsd->hash(tmp[i]));
+                if (findElement(fsd, tmp[i], h) < 0L)
+                    place(ad, tmp[i], h);
+            }
+    }
+    free(tmp);
+    return checked(ans, ok);
+}
+
+static const UnorderedSet *fus_intersect(const UnorderedSet *us,
+                                         const UnorderedSet *other) {
+    FusData *fsd = (FusData *)us->self;
+    const UnorderedSet *ans = emptyLike(fsd, fsd->size);
+
+    return checked(ans, ans != NULL &&
+                        keepIf(fsd, other, 1, (FusData *)ans->self));
+}
+
+static const UnorderedSet *fus_difference(const UnorderedSet *us,
+                                          const UnorderedSet *other) {
+    FusData *fsd = (FusData *)us->self;
+    const UnorderedSet *ans = emptyLike(fsd, fsd->size);
+
+    return checked(ans, ans != NULL &&
+                        keepIf(fsd, other, 0, (FusData *)ans->self));
+}
+
+static int fus_isSubset(const UnorderedSet *us, const UnorderedSet *other) {
+    FusData *fsd = (FusData *)us->self;
+
+    if (fsd->size > other->size(other))
+        return 0;
+    return (mark(fsd, other, 0, NULL) == 0L);
+}
+
+static UnorderedSet template = {
+    NULL, fus_destroy, fus_clear, fus_add, fus_contains, fus_isEmpty,
+    fus_remove, fus_size, fus_toArray, fus_itCreate, fus_trim, fus_compact,
+    fus_stats, fus_setUnion, fus_intersect, fus_difference, fus_isSubset
+};
+
+const UnorderedSet *UnorderedSet_createFlat(
+                              int (*cmpFn)(void*,void*),
+                              unsigned long long (*hashFn)(void*),
+                              long capacity, double loadFactor
+) {
+    UnorderedSet *us = (UnorderedSet *)malloc(sizeof(UnorderedSet));
+    long N;
+    double lf;
+
+    if (us != NULL) {
+        FusData *fsd = (FusData *)malloc(sizeof(FusData));
+
+        if (fsd != NULL) {
+            if (capacity > MAX_CAPACITY)
+                capacity = MAX_CAPACITY;
+            for (N = DEFAULT_CAPACITY; N < capacity; N *= 2)
+                ;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            if (lf > MAX_LOAD_FACTOR)
+                lf = MAX_LOAD_FACTOR;
+            if (allocTable(N, &fsd->ctrl, &fsd->slots)) {
+                fsd->tag = US_TAG_FLAT;
+                fsd->capacity = N;
+                fsd->minCapacity = N;
+                fsd->resizes = 0L;
+                fsd->resizeTime = 0.0;
+                fsd->hits = fsd->misses = fsd->probes = 0L;
+                fsd->loadFactor = lf;
+                fsd->size = 0L;
+                fsd->deleted = 0L;
+                fsd->limit = flat_growthLimit(N, lf);
+                fsd->cmp = cmpFn;
+                fsd->hash = hashFn;
+                *us = template;
+                us->self = fsd;
+            } else {
+                free(fsd);
+                free(us);
+                us = NULL;
+            }
+        } else {
+            free(us);
+            us = NULL;
+        }
+    }
+    return us;
+}
@@ -0,0 +1,193 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "frozenmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char key[32];
+    char *p;
+    const HashMap *hm;
+    const FrozenMap *fm;
+    long i, n;
+    FILE *fd;
+    char **keys;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./fmtest file\n");
+        return -1;
+    }
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of FrozenMap_build()
+     */
+    printf("===== test of FrozenMap_build\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!hm->put(hm, key, p, (void**)&prev)) {
+            fprintf(stderr, "Error adding key,string to hashmap\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    if ((fm = FrozenMap_build(hm)) == NULL) {
+        fprintf(stderr, "Error building frozen map\n");
+        return -1;
+    }
+    hm->destroy(hm, NULL);		/* the frozen map owns the strings */
+    n = fm->size(fm);
+    printf("Size of frozen map = %ld\n", n);
+    /*
+     * test of get()
+     */
+    printf("===== test of get\n");
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        sprintf(key, "%ld", i);
+        if (!fm->get(fm, key, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%s,%s", key, element);
+    }
+    /*
+     * test of containsKey() for keys that are not present
+     */
+    printf("===== test of containsKey\n");
+    for (i = n, n = 0; i < 100000; i++) {
+        sprintf(key, "%ld", i);
+        n += fm->containsKey(fm, key);
+    }
+    printf("containsKey found %ld absent keys\n", n);
+    printf("containsKey(\"\") = %d\n", fm->containsKey(fm, ""));
+    printf("containsKeyn(\"12\", 1) = %d\n", fm->containsKeyn(fm, "12", 1));
+    /*
+     * test of keyArray
+     */
+    printf("===== test of keyArray\n");
+    if ((keys = fm->keyArray(fm, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking fm->keyArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        if (!fm->getn(fm, keys[i], (long)strlen(keys[i]), (void **)&p)) {
+            fprintf(stderr, "Error retrieving key %s\n", keys[i]);
+            return -1;
+        }
+    }
+    printf("keyArray returned %ld keys, all present\n", n);
+    free(keys);
+    /*
+     * test of destroy with free() as freeFxn
+     */
+    printf("===== test of destroy(free)\n");
+    fm->destroy(fm, free);
+    /*
+     * test of a large frozen map, and of an empty one
+     */
+    printf("===== test of large and empty frozen maps\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    if ((fm = FrozenMap_build(hm)) == NULL) {
+        fprintf(stderr, "Error building empty frozen map\n");
+        return -1;
+    }
+    printf("Empty frozen map: size = %ld, isEmpty = %d, containsKey = %d\n",
+           fm->size(fm), fm->isEmpty(fm), fm->containsKey(fm, "0"));
+    fm->destroy(fm, NULL);
+    for (i = 0; i < 100000; i++) {
+        sprintf(key, "k%ld", i);
+        (void) hm->put(hm, key, argv[1], (void **)&p);
+    }
+    if ((fm = FrozenMap_build(hm)) == NULL) {
+        fprintf(stderr, "Error building large frozen map\n");
+        return -1;
+    }
+    hm->destroy(hm, NULL);
+    for (i = 0, n = 0; i < 200000; i++) {
+        sprintf(key, "k%ld", i);
+        if (fm->get(fm, key, (void **)&p) && p == argv[1])
+            n++;
+    }
+    printf("Size = %ld, %ld of 200000 keys found\n", fm->size(fm), n);
+    fm->destroy(fm, NULL);
+    /*
+     * test of a hashmap holding each key twice, put() with a NULL previous;
+     * only the element that get() returns is kept
+     */
+    printf("===== test of duplicate keys\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    for (i = 0; i < 2000; i++) {
+        sprintf(key, "d%ld", i % 1000);
+        (void) hm->put(hm, key, (void *)(i / 1000), NULL);
+    }
+    if ((fm = FrozenMap_build(hm)) == NULL) {
+        fprintf(stderr, "Error building frozen map with duplicate keys\n");
+        return -1;
+    }
+    for (i = 0, n = 0; i < 1000; i++) {
+        void *e, *f;
+
+        sprintf(key, "d%ld", i);
+        if (fm->get(fm, key, &e) && hm->get(hm, key, &f) && e == f)
+            n++;
+    }
+    printf("hashmap size = %ld, frozen map size = %ld, ", hm->size(hm),
+           fm->size(fm));
+    printf("%ld of 1000 keys map to the element get() returns\n", n);
+    fm->destroy(fm, NULL);
+    hm->destroy(hm, NULL);
+
+    return 0;
+}
@@ -0,0 +1,398 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "frozenmap.h"
+#include "hmentry.h"
+#include "hash64.h"
+#include <stdlib.h>
+#include <string.h>
+
+/*
+ * implementation of the frozen map
+ *
+ * the n keys are divided among about n/LAMBDA buckets by their hash; the
+ * buckets are then placed largest first, searching for each bucket the
+ * smallest `pilot' value for which every key of the bucket hashes, with
+ * the pilot mixed in, to a distinct slot that no earlier bucket has taken;
+ * a lookup recomputes the bucket of a key and its slot from the pilot
+ *
+ * slot i holds the element elements[i] and the key at keys + offsets[i],
+ * whose length is offsets[i+1] - offsets[i] - 1 (each key is followed by
+ * '\0')
+ */
+
+#define LAMBDA 4		/* average number of keys per bucket */
+#define MAX_PILOT 0x7fffffffU
+#define MAX_SEEDS 16
+
+typedef struct fm_data {
+    long size;
+    long nbuckets;
+    unsigned long long seed;
+    unsigned int *pilots;
+    size_t *offsets;		/* size + 1 of these */
+    void **elements;
+    char *keys;
+} FmData;
+
+#define MIXED(h, seed) hash64_int((h) ^ (seed))
+#define BUCKET(x, nb) ((long)(((x) >> 32) % (unsigned long long)(nb)))
+#define SLOT(x, pilot, seed, n) \
+    ((long)(((x) ^ hash64_int((unsigned long long)(pilot) + (seed))) % \
+            (unsigned long long)(n)))
+
+static void fm_destroy(const FrozenMap *fm, void (*freeFxn)(void *element)) {
+    FmData *fmd = (FmData *)fm->self;
+    long i;
+
+    if (freeFxn != NULL)
+        for (i = 0L; i < fmd->size; i++)
+            (*freeFxn)(fmd->elements[i]);
+    free(fmd->pilots);
+    free(fmd->offsets);
+    free(fmd->elements);
+    free(fmd->keys);
+    free(fmd);
+    free((void *)fm);
+}
+
+/*
+ * local function returning the only slot that can hold the `len'-byte key,
+ * or -1 if the key is not in the frozen map
+ */
+static long findSlot(FmData *fmd, void *key, size_t len) {
+    unsigned long long x;
+    long i;
+
+    if (fmd->size == 0L)
+        return -1L;
+    x = MIXED(hash64(key, len), fmd->seed);
+    i = SLOT(x, fmd->pilots[BUCKET(x, fmd->nbuckets)], fmd->seed, fmd->size);
+    if (fmd->offsets[i + 1] - fmd->offsets[i] - 1 == len &&
+        memcmp(fmd->keys + fmd->offsets[i], key, len) == 0)
+        return i;
+    return -1L;
+}
+
+static int fm_containsKeyn(const FrozenMap *fm, void *key, long len) {
+    return (findSlot((FmData *)fm->self, key, (size_t)len) >= 0L);
+}
+
+static int fm_containsKey(const FrozenMap *fm, char *key) {
+    return fm_containsKeyn(fm, key, (long)strlen(key));
+}
+
+static int fm_getn(const FrozenMap *fm, void *key, long len, void **element) {
+    FmData *fmd = (FmData *)fm->self;
+    long i = findSlot(fmd, key, (size_t)len);
+
+    if (i < 0L)
+        return 0;
+    *element = fmd->elements[i];
+    return 1;
+}
+
+static int fm_get(const FrozenMap *fm, char *key, void **element) {
+    return fm_getn(fm, key, (long)strlen(key), element);
+}
+
+static int fm_isEmpty(const FrozenMap *fm) {
+    FmData *fmd = (FmData *)fm->self;
+    return (fmd->size == 0L);
+}
+
+static char **fm_keyArray(const FrozenMap *fm, long *len) {
+    FmData *fmd = (FmData *)fm->self;
+    char **tmp = NULL;
+    long i;
+
+    if (fmd->size > 0L) {
+        tmp = (char **)malloc(fmd->size * sizeof(char *));
+        if (tmp != NULL) {
+            for (i = 0L; i < fmd->size; i++)
+                tmp[i] = fmd->keys + fmd->offsets[i];
+            *len = fmd->size;
+        }
+    }
+    return tmp;
+}
+
+static long fm_size(const FrozenMap *fm) {
+    FmData *fmd = (FmData *)fm->self;
+    return fmd->size;
+}
+
+/*
+ * local function that divides the `n' keys whose mixed hashes are in x[]
+ * among `nb' buckets; bucket b holds the keys members[start[b]] ..
+ * members[start[b+1] - 1], in increasing order
+ *
+ * returns the size of the largest bucket
+ */
+static long group(unsigned long long *x, long n, long nb, long *members,
+                  long *start) {
+    long i, b, maxSize = 0L;
+
+    for (b = 0L; b <= nb; b++)
+        start[b] = 0L;
+    for (i = 0L; i < n; i++)
+        start[BUCKET(x[i], nb) + 1]++;
+    for (b = 0L; b < nb; b++) {
+        if (start[b + 1] > maxSize)
+            maxSize = start[b + 1];
+        start[b + 1] += start[b];
+    }
+    for (i = 0L; i < n; i++) {
+        b = BUCKET(x[i], nb);
+        members[start[b]++] = i;
+    }
+    for (b = nb; b > 0L; b--)	/* bucket b is [start[b], start[b+1]) */
+        start[b] = start[b - 1];
+    start[0] = 0L;
+    return maxSize;
+}
+
+/*
+ * local function that tries to place the `n' keys whose mixed hashes are
+ * in x[] using fmd->seed, filling in fmd->pilots and the slot of each key
+ * in slot[]; members[], start[] and order[] are work arrays of n, nbuckets
+ * + 1 and nbuckets longs, and taken[] an array of n chars
+ *
+ * returns 1 if successful, 0 if some bucket could not be placed
+ */
+static int place(FmData *fmd, unsigned long long *x, long *slot,
+                 long *members, long *start, long *order, char *taken) {
+    long n = fmd->size, nb = fmd->nbuckets;
+    long i, j, k, b, maxSize;
+    unsigned int pilot, limit;
+
+    maxSize = group(x, n, nb, members, start);
+    /*
+     * order the buckets by decreasing size, with a counting sort
+     */
+    for (k = 0L, j = maxSize; j > 0L; j--)
+        for (b = 0L; b < nb; b++)
+            if (start[b + 1] - start[b] == j)
+                order[k++] = b;
+    for (i = 0L; i < n; i++)
+        taken[i] = 0;
+    for (b = 0L; b < nb; b++)
+        fmd->pilots[b] = 0U;
+    /*
+     * the last buckets placed have a 1 in (free slots) chance of success
+     * per pilot, so the search is bounded well above n before the seed is
+     * abandoned
+     */
+    limit = (n > (long)(MAX_PILOT / 64U)) ? MAX_PILOT : 64U * (unsigned int)n;
+    for (j = 0L; j < k; j++) {
+        long first, last;
+
+        b = order[j];
+        first = start[b];
+        last = start[b + 1];
+        for (pilot = 0U; pilot < limit; pilot++) {
+            for (i = first; i < last; i++) {
+                long s = SLOT(x[members[i]], pilot, fmd->seed, n);
+
+                if (taken[s])
+                    break;
+                taken[s] = 1;
+                slot[members[i]] = s;
+            }
+            if (i == last)
+                break;
+            while (--i >= first)	/* undo the partial placement */
+                taken[slot[members[i]]] = 0;
+        }
+        if (pilot == limit)
+            return 0;
+        fmd->pilots[b] = pilot;
+    }
+    return 1;
+}
+
+/*
+ * local function that removes from entries[] each entry whose key is the
+ * same as that of an earlier entry, as happens when put() was called with
+ * a NULL `previous'; the earlier entry is the one the hashmap's get()
+ * returns
+ *
+ * keys with equal hashes have equal mixed hashes whatever the seed, so
+ * no pilot can ever separate them; they always share a bucket, so only
+ * the members of each bucket need be compared
+ *
+ * returns the number of entries kept, or -1 if two different keys have
+ * the same hash
+ */
+static long unique(FmData *fmd, HMEntry **entries, unsigned long long *x,
+                   long *members, long *start, char *dropped) {
+    long n = fmd->size, nb = fmd->nbuckets;
+    long i, j, b, kept;
+
+    for (i = 0L; i < n; i++) {
+        x[i] = MIXED(entries[i]->hash, 0ULL);
+        dropped[i] = 0;
+    }
+    (void) group(x, n, nb, members, start);
+    for (b = 0L; b < nb; b++) {
+        for (i = start[b]; i < start[b + 1]; i++) {
+            HMEntry *e = entries[members[i]];
+
+            for (j = start[b]; j < i; j++) {
+                HMEntry *f = entries[members[j]];
+
+                if (dropped[members[j]] || f->hash != e->hash)
+                    continue;
+                if (f->keylen != e->keylen ||
+                    memcmp(f->key, e->key, e->keylen) != 0)
+                    return -1L;
+                dropped[members[i]] = 1;
+                break;
+            }
+        }
+    }
+    for (i = 0L, kept = 0L; i < n; i++)
+        if (! dropped[i])
+            entries[kept++] = entries[i];
+    return kept;
+}
+
+/*
+ * local function that computes the pilots for the `n' entries, then lays
+ * out their keys and elements by slot
+ *
+ * returns 1 if successful, 0 if malloc failure or if two different keys
+ * have the same hash
+ */
+static int build(FmData *fmd, HMEntry **entries) {
+    long n = fmd->size, nb = fmd->nbuckets;
+    unsigned long long *x = NULL;
+    long *slot = NULL, *members = NULL, *start = NULL, *order = NULL;
+    long *inverse;
+    char *taken = NULL;
+    size_t total;
+    long i, attempt;
+    int ok = 0;
+
+    x = (unsigned long long *)malloc(n * sizeof(unsigned long long));
+    slot = (long *)malloc(n * sizeof(long));
+    members = (long *)malloc(n * sizeof(long));
+    start = (long *)malloc((nb + 1) * sizeof(long));
+    order = (long *)malloc(nb * sizeof(long));
+    taken = (char *)malloc(n);
+    if (x != NULL && slot != NULL && members != NULL && start != NULL &&
+        order != NULL && taken != NULL &&
+        (n = unique(fmd, entries, x, members, start, taken)) >= 0L) {
+        fmd->size = n;
+        for (attempt = 0L; !ok && attempt < MAX_SEEDS; attempt++) {
+            fmd->seed = hash64_int((unsigned long long)attempt);
+            for (i = 0L; i < n; i++)
+                x[i] = MIXED(entries[i]->hash, fmd->seed);
+            ok = place(fmd, x, slot, members, start, order, taken);
+        }
+    }
+    if (ok) {
+        inverse = members;		/* no longer needed */
+        for (i = 0L, total = 0; i < n; i++) {
+            inverse[slot[i]] = i;
+            total += entries[i]->keylen + 1;
+        }
+        fmd->keys = (char *)malloc(total);
+        if (fmd->keys != NULL) {
+            for (i = 0L, total = 0; i < n; i++) {
+                HMEntry *e = entries[inverse[i]];
+
+                fmd->offsets[i] = total;
+                memcpy(fmd->keys + total, e->key, e->keylen + 1);
+                fmd->elements[i] = e->element;
+                total += e->keylen + 1;
+            }
+            fmd->offsets[n] = total;
+        } else
+            ok = 0;
+    }
+    free(x);
+    free(slot);
+    free(members);
+    free(start);
+    free(order);
+    free(taken);
+    return ok;
+}
+
+static FrozenMap template = {
+    NULL, fm_destroy, fm_containsKey, fm_get, fm_isEmpty, fm_keyArray,
+    fm_size, fm_containsKeyn, fm_getn
+};
+
+const FrozenMap *FrozenMap_build(const HashMap *hm) {
+    FrozenMap *fm = (FrozenMap *)malloc(sizeof(FrozenMap));
+    FmData *fmd = NULL;
+    HMEntry **entries = NULL;
+    long n = hm->size(hm);
+    int ok = 0;
+
+    if (fm != NULL && (fmd = (FmData *)malloc(sizeof(FmData))) != NULL) {
+        fmd->size = 0L;
+        fmd->nbuckets = n / LAMBDA + 1L;
+        fmd->seed = 0ULL;
+        fmd->pilots = (unsigned int *)malloc(fmd->nbuckets *
+                                             sizeof(unsigned int));
+        fmd->offsets = (size_t *)malloc((n + 1) * sizeof(size_t));
+        fmd->elements = (void **)malloc((n > 0L ? n : 1L) * sizeof(void *));
+        fmd->keys = NULL;
+        if (fmd->pilots != NULL && fmd->offsets != NULL &&
+            fmd->elements != NULL) {
+            if (n == 0L) {
+                fmd->offsets[0] = 0;
+                ok = 1;
+            } else if ((entries = hm->entryArray(hm, &n)) != NULL) {
+                fmd->size = n;
+                ok = build(fmd, entries);
+                free(entries);
+            }
+        }
+    }
+    if (ok) {
+        *fm = template;
+        fm->self = fmd;
+        return fm;
+    }
+    if (fmd != NULL) {
+        free(fmd->pilots);
+        free(fmd->offsets);
+        free(fmd->elements);
+        free(fmd->keys);
+        free(fmd);
+    }
+    free(fm);
+    return NULL;
+}
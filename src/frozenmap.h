@@ -0,0 +1,131 @@
+#ifndef _FROZENMAP_H_
+#define _FROZENMAP_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"			/* needed for factory method */
+
+/*
+ * interface definition for an immutable map with String keys, built from
+ * a HashMap that will no longer change
+ *
+ * the keys are placed with a minimal perfect hash function (a hash and
+ * displace scheme): every key is assigned its own slot in [0, size), so
+ * every lookup examines exactly one slot and compares at most one key;
+ * the keys are stored back to back in a single block of storage, without
+ * per-entry headers or bucket pointers
+ *
+ * since a frozen map is never modified, any number of threads may use it
+ * concurrently without locking
+ */
+
+typedef struct frozenmap FrozenMap;	/* forward reference */
+
+/*
+ * create a frozen map holding copies of the keys of `hm', mapped to the
+ * same elements; `hm' is not changed, and may be destroyed afterwards
+ * (with a NULL freeFxn, if the elements are now owned by the frozen map)
+ *
+ * if `hm' holds the same key more than once, as put() with a NULL
+ * `previous' allows, only the element that hm's get() returns is kept;
+ * the others are not owned by the frozen map
+ *
+ * returns a pointer to the frozen map, or NULL if there are malloc() errors
+ * or if two different keys of `hm' have the same 64-bit hash, which no
+ * choice of slots can separate (for n keys, the odds are about n*n in 2^65)
+ */
+const FrozenMap *FrozenMap_build(const HashMap *hm);
+
+/*
+ * now define struct frozenmap
+ */
+struct frozenmap {
+/*
+ * the private data of the frozen map
+ */
+    void *self;
+
+/*
+ * destroys the frozen map; for each mapping, if freeFxn != NULL,
+ * it is invoked on the element of that mapping; the storage associated
+ * with the frozen map is then returned to the heap
+ */
+    void (*destroy)(const FrozenMap *fm, void (*freeFxn)(void *element));
+
+/*
+ * returns 1 if the frozen map has an entry for `key', 0 otherwise
+ */
+    int (*containsKey)(const FrozenMap *fm, char *key);
+
+/*
+ * returns the element to which the specified key is mapped in `*element'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*get)(const FrozenMap *fm, char *key, void **element);
+
+/*
+ * returns 1 if the frozen map is empty, 0 if it is not
+ */
+    int (*isEmpty)(const FrozenMap *fm);
+
+/*
+ * returns an array containing all of the keys in the frozen map in
+ * an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to char * array of keys, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the char * array when finished;
+ * the keys themselves belong to the frozen map
+ */
+    char **(*keyArray)(const FrozenMap *fm, long *len);
+
+/*
+ * returns the number of mappings in the frozen map
+ */
+    long (*size)(const FrozenMap *fm);
+
+/*
+ * returns 1 if the frozen map has an entry for the `len'-byte `key', as
+ * stored by HashMap's putn(), 0 otherwise
+ */
+    int (*containsKeyn)(const FrozenMap *fm, void *key, long len);
+
+/*
+ * returns the element to which the `len'-byte `key' is mapped in `*element'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*getn)(const FrozenMap *fm, void *key, long len, void **element);
+};
+
+#endif /* _FROZENMAP_H_ */
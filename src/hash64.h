@@ -0,0 +1,150 @@
+#ifndef _HASH64_H_
+#define _HASH64_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * private 64-bit hash function shared by the hash-based ADTs
+ *
+ * this is a version of Wang Yi's public domain wyhash: keys are consumed
+ * 8 or 16 bytes at a time and each step is folded in with a 64x64->128
+ * bit multiply; short keys (<= 16 bytes) take no loop at all
+ */
+
+#include <stddef.h>
+#include <string.h>
+
+#define HASH64_S0 0x2d358dccaa6c78a5ULL
+#define HASH64_S1 0x8bb84b93962eacc9ULL
+#define HASH64_S2 0x4b33a62ed433d4a3ULL
+#define HASH64_S3 0x4d5a2da51de1aa47ULL
+
+/*
+ * replaces `*a' and `*b' by the low and high 64 bits of their 128-bit product
+ */
+static inline void hash64_mum(unsigned long long *a, unsigned long long *b) {
+#ifdef __SIZEOF_INT128__
+    __uint128_t r = (__uint128_t)*a * *b;
+    *a = (unsigned long long)r;
+    *b = (unsigned long long)(r >> 64);
+#else
+    unsigned long long ha = *a >> 32, hb = *b >> 32;
+    unsigned long long la = (unsigned int)*a, lb = (unsigned int)*b;
+    unsigned long long rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    unsigned long long t = rl + (rm0 << 32), c = (t < rl);
+    unsigned long long lo = t + (rm1 << 32);
+    c += (lo < t);
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+/*
+ * multiplies `a' and `b', returning the xor of the two halves of the product
+ */
+static inline unsigned long long hash64_mix(unsigned long long a,
+                                            unsigned long long b) {
+    hash64_mum(&a, &b);
+    return a ^ b;
+}
+
+static inline unsigned long long hash64_r8(const unsigned char *p) {
+    unsigned long long v;
+    memcpy(&v, p, 8);
+    return v;
+}
+
+static inline unsigned long long hash64_r4(const unsigned char *p) {
+    unsigned int v;
+    memcpy(&v, p, 4);
+    return v;
+}
+
+/*
+ * returns the 64-bit hash of the `len' bytes starting at `key'
+ */
+static inline unsigned long long hash64(const void *key, size_t len) {
+    const unsigned char *p = (const unsigned char *)key;
+    unsigned long long seed = hash64_mix(HASH64_S0, HASH64_S1);
+    unsigned long long a, b;
+
+    if (len <= 16) {
+        if (len >= 4) {
+            a = (hash64_r4(p) << 32) | hash64_r4(p + ((len >> 3) << 2));
+            b = (hash64_r4(p + len - 4) << 32) |
+                hash64_r4(p + len - 4 - ((len >> 3) << 2));
+        } else if (len > 0) {
+            a = ((unsigned long long)p[0] << 16) |
+                ((unsigned long long)p[len >> 1] << 8) | p[len - 1];
+            b = 0;
+        } else
+            a = b = 0;
+    } else {
+        size_t i = len;
+        if (i >= 48) {
+            unsigned long long see1 = seed, see2 = seed;
+            do {
+                seed = hash64_mix(hash64_r8(p) ^ HASH64_S1,
+                                  hash64_r8(p + 8) ^ seed);
+                see1 = hash64_mix(hash64_r8(p + 16) ^ HASH64_S2,
+                                  hash64_r8(p + 24) ^ see1);
+                see2 = hash64_mix(hash64_r8(p + 32) ^ HASH64_S3,
+                                  hash64_r8(p + 40) ^ see2);
+                p += 48;
+                i -= 48;
+            } while (i >= 48);
+            seed ^= see1 ^ see2;
+        }
+        while (i > 16) {
+            seed = hash64_mix(hash64_r8(p) ^ HASH64_S1, hash64_r8(p + 8) ^ seed);
+            i -= 16;
+            p += 16;
+        }
+        a = hash64_r8(p + i - 16);
+        b = hash64_r8(p + i - 8);
+    }
+    a ^= HASH64_S1;
+    b ^= seed;
+    hash64_mum(&a, &b);
+    return hash64_mix(a ^ HASH64_S0 ^ len, b ^ HASH64_S1);
+}
+
+/*
+ * returns the 64-bit hash of the integer `k'; every bit of `k' affects
+ * every bit of the result, so the low bits may be used to index a table
+ * whose size is a power of 2
+ */
+static inline unsigned long long hash64_int(unsigned long long k) {
+    return hash64_mix(k ^ HASH64_S0, HASH64_S1);
+}
+
+#endif /* _HASH64_H_ */
@@ -30,6 +30,12 @@
  */
 
 #include "hashmap.h"
+#include "hmentry.h"
+#include "hmhashed.h"
+#include "hash64.h"
+#include "nodepool.h"
+#include "chainstats.h"
+#include "bloomfilter.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -37,62 +43,365 @@
 #define MAX_CAPACITY 134217728L
 #define DEFAULT_LOAD_FACTOR 0.75
 #define TRIGGER 100	/* number of changes that will trigger a load check */
+#define SHRINK_LOAD 4	/* shrink if load < loadFactor / SHRINK_LOAD */
+#define MIGRATE_STEP 16	/* buckets migrated per operation if HM_INCREMENTAL */
+#define SLAB_SIZE 65536	/* bytes per slab if HM_ARENA */
+#define ALIGN(n) (((n) + 7) & ~((size_t)7))
+#define BATCH 16	/* keys hashed and prefetched together in batch methods */
+#define WHEEL_BITS 6	/* timer wheel: each level has 2^WHEEL_BITS slots, */
+#define WHEEL_SLOTS 64	/* each WHEEL_SLOTS times coarser than the level */
+#define WHEEL_LEVELS 5	/* below it, so 2^30 ticks are covered */
+#define FILTER_FP 0.01	/* false positive rate of the filter if HM_FILTERED */
+
+#ifdef __GNUC__
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p)
+#endif
+
+/*
+ * header of a slab of entries when HM_ARENA is specified; entries are
+ * carved from the bytes following the header
+ */
+typedef struct slab {
+    struct slab *next;
+    size_t used;
+    size_t size;
+} Slab;
+
+/*
+ * the chained hashmap allocates each entry as an HmNode, so that an
+ * entry with a time-to-live can find its timer; the key follows the node
+ */
+typedef struct hm_node {
+    HMEntry entry;
+    struct hm_timer *timer;	/* NULL if the entry does not expire */
+} HmNode;
+
+#define TIMER(p) (((HmNode *)(p))->timer)
+
+/*
+ * a timer on the wheel; the sentinel of each slot is also an HmTimer
+ */
+typedef struct hm_timer {
+    struct hm_timer *next;
+    struct hm_timer *prev;
+    HMEntry *entry;
+    long deadline;
+    int level;
+} HmTimer;
 
 typedef struct hm_data {
     long size;
     long capacity;
+    long minCapacity;		/* automatic shrinking stops here */
     long changes;
     double load;
     double loadFactor;
     double increment;
+    int flags;
     HMEntry **buckets;
-} HmData;
+    HMEntry **oldBuckets;	/* non-NULL while an incremental resize is */
+    long oldCapacity;		/* in progress; buckets [0, migrated) of */
+    long migrated;		/* oldBuckets have been moved to buckets */
+    Slab *slabs;		/* HM_ARENA only; first slab is current */
+    NodePool *pool;		/* HM_POOLED only; source of entries and timers */
+    long resizes;		/* counters reported by stats(); the last */
+    double resizeTime;		/* three are only maintained if compiled */
+    long hits;			/* with -DHASH_STATS */
+    long misses;
+    long probes;
+    HmTimer *wheel;		/* allocated by the first putWithTTL() */
+    long clock;			/* the `now' of the last expire() */
+    long timers;		/* number of timers on the wheel */
+    long levelTimers[WHEEL_LEVELS];
+    void (*expiryFxn)(char *key, void *element);
+    const BloomFilter *filter;	/* HM_FILTERED only; holds the hash of every */
+    long stale;			/* key put since it was built, `stale' of */
+} HmData;			/* which have since been removed */
 
-struct hmentry {
-    struct hmentry *next;
-    char *key;
-    void *element;
-};
+#define ENTRY_SIZE(len) ALIGN(sizeof(HmNode) + (len) + 1)
+#define SLOT(hmd, k, i) (&(hmd)->wheel[(k) * WHEEL_SLOTS + (i)])
+#define EXPIRED(hmd, p) (TIMER(p) != NULL && TIMER(p)->deadline <= (hmd)->clock)
 
 /*
- * generate hash value from key; value returned in range of 0..N-1
+ * allocates an entry with room for a key of `len' characters immediately
+ * following the HMEntry structure; with HM_ARENA, the entry is carved from
+ * the current slab, otherwise it is obtained from the node pool, which is
+ * the heap without HM_POOLED
+ *
+ * returns pointer to the entry, with `key' set, or NULL if malloc failure
  */
-#define SHIFT 7L			/* should be prime */
-static long hash(char *key, long N) {
-    long ans = 0L;
-    char *sp;
+static HMEntry *newEntry(HmData *hmd, size_t len) {
+    size_t nbytes = ENTRY_SIZE(len);
+    HMEntry *p;
 
-    for (sp = key; *sp != '\0'; sp++)
-        ans = ((SHIFT * ans) + *sp) % N;
-    return ans;
+    if (hmd->flags & HM_ARENA) {
+        Slab *s = hmd->slabs;
+        if (s == NULL || s->used + nbytes > s->size) {
+            size_t size = SLAB_SIZE - ALIGN(sizeof(Slab));
+            if (nbytes > size)
+                size = nbytes;
+            s = (Slab *)malloc(ALIGN(sizeof(Slab)) + size);
+            if (s == NULL)
+                return NULL;
+            s->used = 0;
+            s->size = size;
+            s->next = hmd->slabs;
+            hmd->slabs = s;
+        }
+        p = (HMEntry *)((char *)s + ALIGN(sizeof(Slab)) + s->used);
+        s->used += nbytes;
+    } else if ((p = (HMEntry *)nodepool_alloc(hmd->pool, nbytes)) == NULL)
+        return NULL;
+    p->key = (char *)((HmNode *)p + 1);
+    TIMER(p) = NULL;
+    return p;
+}
+
+/*
+ * returns an entry to the node pool; with HM_ARENA, its storage is not
+ * reclaimed until the hashmap is cleared or destroyed
+ */
+static void freeEntry(HmData *hmd, HMEntry *p) {
+    if (! (hmd->flags & HM_ARENA))
+        nodepool_free(hmd->pool, p, ENTRY_SIZE(p->keylen));
+}
+
+/*
+ * returns all slabs to the heap, except that if `keep' is non-zero,
+ * the most recent slab is retained (empty) for reuse
+ */
+static void freeSlabs(HmData *hmd, int keep) {
+    Slab *s = hmd->slabs, *t;
+
+    if (keep && s != NULL) {
+        s->used = 0;
+        t = s;
+        s = s->next;
+        t->next = NULL;
+    } else
+        hmd->slabs = NULL;
+    for (; s != NULL; s = t) {
+        t = s->next;
+        free(s);
+    }
+}
+
+/*
+ * the entries with a time-to-live have timers on a hierarchical timing
+ * wheel; level k has WHEEL_SLOTS slots, each covering 2^(WHEEL_BITS * k)
+ * ticks, and a timer is placed in the lowest level that reaches its
+ * deadline; as the clock passes a multiple of the span of a level-k slot,
+ * the timers of the next slot of level k are cascaded into lower levels,
+ * so each timer is moved at most WHEEL_LEVELS - 1 times, and inserting or
+ * cancelling a timer is O(1)
+ */
+
+/*
+ * local function to place `t' on the wheel according to its deadline
+ */
+static void addTimer(HmData *hmd, HmTimer *t) {
+    long delta = t->deadline - hmd->clock;
+    long when = t->deadline;
+    HmTimer *s;
+    int k;
+
+    if (delta < 0L) {
+        delta = 0L;
+        when = hmd->clock;
+    }
+    for (k = 0; k < WHEEL_LEVELS - 1 &&
+                delta >= (1L << (WHEEL_BITS * (k + 1))); k++)
+        ;
+    if (delta >= (1L << (WHEEL_BITS * WHEEL_LEVELS)))	/* beyond the wheel; */
+        when = hmd->clock + (1L << (WHEEL_BITS * WHEEL_LEVELS)) - 1L;
+    s = SLOT(hmd, k, (when >> (WHEEL_BITS * k)) & (WHEEL_SLOTS - 1));
+    t->next = s;
+    t->prev = s->prev;
+    s->prev->next = t;
+    s->prev = t;
+    t->level = k;
+    hmd->levelTimers[k]++;
+    hmd->timers++;
+}
+
+static void unlinkTimer(HmData *hmd, HmTimer *t) {
+    t->prev->next = t->next;
+    t->next->prev = t->prev;
+    hmd->levelTimers[t->level]--;
+    hmd->timers--;
+}
+
+/*
+ * local function to remove the timer, if any, of `entry'
+ */
+static void cancelTimer(HmData *hmd, HMEntry *entry) {
+    HmTimer *t = TIMER(entry);
+
+    if (t != NULL) {
+        unlinkTimer(hmd, t);
+        nodepool_free(hmd->pool, t, sizeof(HmTimer));
+        TIMER(entry) = NULL;
+    }
+}
+
+/*
+ * local function to give `entry' the absolute `deadline', replacing any
+ * timer it already has
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int setTimer(HmData *hmd, HMEntry *entry, long deadline) {
+    HmTimer *t = TIMER(entry);
+    long i;
+
+    if (hmd->wheel == NULL) {
+        hmd->wheel = (HmTimer *)malloc(WHEEL_LEVELS * WHEEL_SLOTS *
+                                       sizeof(HmTimer));
+        if (hmd->wheel == NULL)
+            return 0;
+        for (i = 0L; i < WHEEL_LEVELS * WHEEL_SLOTS; i++)
+            hmd->wheel[i].next = hmd->wheel[i].prev = &hmd->wheel[i];
+    }
+    if (t != NULL)
+        unlinkTimer(hmd, t);
+    else {
+        t = (HmTimer *)nodepool_alloc(hmd->pool, sizeof(HmTimer));
+        if (t == NULL)
+            return 0;
+    }
+    t->entry = entry;
+    t->deadline = deadline;
+    TIMER(entry) = t;
+    addTimer(hmd, t);
+    return 1;
+}
+
+/*
+ * local function to return all timers to the node pool and release the
+ * wheel
+ */
+static void freeWheel(HmData *hmd) {
+    HmTimer *s, *t, *u;
+    long i;
+
+    if (hmd->wheel == NULL)
+        return;
+    for (i = 0L; i < WHEEL_LEVELS * WHEEL_SLOTS; i++) {
+        s = &hmd->wheel[i];
+        for (t = s->next; t != s; t = u) {
+            u = t->next;
+            nodepool_free(hmd->pool, t, sizeof(HmTimer));
+        }
+    }
+    free(hmd->wheel);
+    hmd->wheel = NULL;
+    hmd->timers = 0L;
+    for (i = 0L; i < WHEEL_LEVELS; i++)
+        hmd->levelTimers[i] = 0L;
+}
+
+/*
+ * local function to unlink `entry' from its chain, which is in
+ * oldBuckets if the entry has not been migrated yet
+ */
+static void unlinkEntry(HmData *hmd, HMEntry *entry) {
+    HMEntry **bucket;
+    HMEntry *p, *c;
+
+    bucket = &hmd->buckets[entry->hash % (unsigned long long)hmd->capacity];
+    for (c = *bucket; c != NULL && c != entry; c = c->next)
+        ;
+    if (c == NULL)
+        bucket = &hmd->oldBuckets[entry->hash %
+                                  (unsigned long long)hmd->oldCapacity];
+    /* determine where the entry lives in the singly linked list */
+    for (p = NULL, c = *bucket; c != entry; p = c, c = c->next)
+        ;
+    if (p == NULL)
+        *bucket = entry->next;
+    else
+        p->next = entry->next;
+}
+
+/*
+ * local function to unlink `entry' from the table and free it
+ */
+static void deleteEntry(HmData *hmd, HMEntry *entry) {
+    cancelTimer(hmd, entry);
+    unlinkEntry(hmd, entry);
+    hmd->stale++;
+    hmd->size--;
+    hmd->load -= hmd->increment;
+    hmd->changes++;
+    freeEntry(hmd, entry);
+}
+
+/*
+ * local function to remove an entry whose deadline has passed, invoking
+ * the expiry callback on it
+ */
+static void reap(HmData *hmd, HMEntry *entry) {
+    if (hmd->expiryFxn != NULL)
+        (*hmd->expiryFxn)(entry->key, entry->element);
+    deleteEntry(hmd, entry);
+}
+
+/*
+ * frees the entries on the chain starting at `p', calling freeFxn on
+ * each element
+ */
+static void purgeChain(HmData *hmd, HMEntry *p,
+                       void (*freeFxn)(void *element)) {
+    HMEntry *q;
+
+    while (p != NULL) {
+        if (freeFxn != NULL)
+            (*freeFxn)(p->element);
+        q = p->next;
+        freeEntry(hmd, p);
+        p = q;
+    }
 }
 
 /*
  * traverses the hashmap, calling freeFxn on each element
  * then frees storage associated with the key and the HMEntry structure
+ *
+ * with HM_ARENA, the chains are only walked if freeFxn != NULL, since
+ * the entries are released a slab at a time
  */
-static void purge(HmData *hmd, void (*freeFxn)(void *element)) {
+static void purge(HmData *hmd, void (*freeFxn)(void *element), int keep) {
 
     long i;
+    int walk = (freeFxn != NULL || ! (hmd->flags & HM_ARENA));
 
     for (i = 0L; i < hmd->capacity; i++) {
-        HMEntry *p, *q;
-        p = hmd->buckets[i];
-        while (p != NULL) {
-            if (freeFxn != NULL)
-                (*freeFxn)(p->element);
-            q = p->next;
-            free(p->key);
-            free(p);
-            p = q;
-        }
+        if (walk)
+            purgeChain(hmd, hmd->buckets[i], freeFxn);
         hmd->buckets[i] = NULL;
     }
+    if (hmd->oldBuckets != NULL) {
+        if (walk)
+            for (i = hmd->migrated; i < hmd->oldCapacity; i++)
+                purgeChain(hmd, hmd->oldBuckets[i], freeFxn);
+        free(hmd->oldBuckets);
+        hmd->oldBuckets = NULL;
+    }
+    freeSlabs(hmd, keep);
+    freeWheel(hmd);
+    if (hmd->filter != NULL)
+        hmd->filter->clear(hmd->filter);
+    hmd->stale = 0L;
 }
 
 static void hm_destroy(const HashMap *hm, void (*freeFxn)(void *element)) {
     HmData *hmd = (HmData *)hm->self;
-    purge(hmd, freeFxn);
+    purge(hmd, freeFxn, 0);
+    if (hmd->filter != NULL)
+        hmd->filter->destroy(hmd->filter);
+    nodepool_destroy(hmd->pool);
     free(hmd->buckets);
     free(hmd);
     free((void *)hm);
@@ -100,36 +409,123 @@ static void hm_destroy(const HashMap *hm, void (*freeFxn)(void *element)) {
 
 static void hm_clear(const HashMap *hm, void (*freeFxn)(void *element)) {
     HmData *hmd = (HmData *)hm->self;
-    purge(hmd, freeFxn);
+    purge(hmd, freeFxn, 1);
     hmd->size = 0;
     hmd->load = 0.0;
     hmd->changes = 0;
 }
 
 /*
- * local function to locate key in a hashmap
+ * moves up to `n' buckets of an incremental resize from oldBuckets to
+ * buckets, releasing oldBuckets once all of them have been moved
+ */
+static void migrate(HmData *hmd, long n) {
+    HMEntry *p, *q;
+    long j;
+
+    for (; n > 0 && hmd->migrated < hmd->oldCapacity; n--, hmd->migrated++) {
+        for (p = hmd->oldBuckets[hmd->migrated]; p != NULL; p = q) {
+            q = p->next;
+            j = (long)(p->hash % (unsigned long long)hmd->capacity);
+            p->next = hmd->buckets[j];
+            hmd->buckets[j] = p;
+        }
+    }
+    if (hmd->migrated == hmd->oldCapacity) {
+        free(hmd->oldBuckets);
+        hmd->oldBuckets = NULL;
+    }
+}
+
+#define MIGRATE(hmd) if ((hmd)->oldBuckets != NULL) migrate((hmd), MIGRATE_STEP)
+
+/*
+ * local function that replaces the filter of an HM_FILTERED hashmap by
+ * one sized for its current capacity and holding only the keys present;
+ * the stored hashes are used, so no key is rehashed; if malloc failure,
+ * the old filter, which still holds every key present, is kept
+ */
+static void refilter(HmData *hmd) {
+    const BloomFilter *bf;
+    HMEntry *p;
+    long i;
+
+    bf = BloomFilter_create((long)(hmd->loadFactor * (double)hmd->capacity)
+                            + TRIGGER, FILTER_FP);
+    if (bf == NULL)
+        return;
+    for (i = 0L; i < hmd->capacity; i++)
+        for (p = hmd->buckets[i]; p != NULL; p = p->next)
+            bf->add(bf, p->hash);
+    if (hmd->oldBuckets != NULL)
+        for (i = hmd->migrated; i < hmd->oldCapacity; i++)
+            for (p = hmd->oldBuckets[i]; p != NULL; p = p->next)
+                bf->add(bf, p->hash);
+    hmd->filter->destroy(hmd->filter);
+    hmd->filter = bf;
+    hmd->stale = 0L;
+}
+
+/*
+ * local function to locate the `len'-byte key in a hashmap; `h' is the
+ * hash of `key'; an entry whose deadline has passed is reaped and not found
  *
  * returns pointer to entry, if found, as function value; NULL if not found
- * returns bucket index in `bucket'
+ * returns bucket index in `bucket'; if a resize is in progress, the entry
+ * may be on a chain of oldBuckets, but `bucket' always indexes buckets
  */
-static HMEntry *findKey(HmData *hmd, char *key, long *bucket) {
-    long i = hash(key, hmd->capacity);
+static HMEntry *findKey(HmData *hmd, void *key, size_t len,
+                        unsigned long long h, long *bucket) {
+    long i = (long)(h % (unsigned long long)hmd->capacity);
     HMEntry *p;
 
     *bucket = i;
+    if (hmd->filter != NULL && ! hmd->filter->mightContain(hmd->filter, h)) {
+        STAT(hmd->misses++);
+        return NULL;
+    }
     for (p = hmd->buckets[i]; p != NULL; p = p->next) {
-        if (strcmp(p->key, key) == 0) {
+        STAT(hmd->probes++);
+        if (p->hash == h && p->keylen == len &&
+            memcmp(p->key, key, len) == 0) {
             break;
         }
     }
+    if (p == NULL && hmd->oldBuckets != NULL) {
+        i = (long)(h % (unsigned long long)hmd->oldCapacity);
+        if (i >= hmd->migrated) {
+            for (p = hmd->oldBuckets[i]; p != NULL; p = p->next) {
+                STAT(hmd->probes++);
+                if (p->hash == h && p->keylen == len &&
+                    memcmp(p->key, key, len) == 0) {
+                    break;
+                }
+            }
+        }
+    }
+    if (p != NULL && EXPIRED(hmd, p)) {
+        reap(hmd, p);
+        p = NULL;
+    }
+    STAT((p != NULL) ? hmd->hits++ : hmd->misses++);
     return p;
 }
 
-static int hm_containsKey(const HashMap *hm, char *key) {
+int hashmap_containsHashed(const HashMap *hm, void *key, size_t len,
+                           unsigned long long h) {
     HmData *hmd = (HmData *)hm->self;
     long bucket;
 
-    return (findKey(hmd, key, &bucket) != NULL);
+    MIGRATE(hmd);
+    return (findKey(hmd, key, len, h, &bucket) != NULL);
+}
+
+static int hm_containsKeyn(const HashMap *hm, void *key, long len) {
+    return hashmap_containsHashed(hm, key, len, hash64(key, len));
+}
+
+static int hm_containsKey(const HashMap *hm, char *key) {
+    return hm_containsKeyn(hm, key, (long)strlen(key));
 }
 
 /*
@@ -152,6 +548,13 @@ static HMEntry **entries(HmData *hmd) {
                     p = p->next;
                 }
             }
+            if (hmd->oldBuckets != NULL) {
+                for (i = hmd->migrated; i < hmd->oldCapacity; i++) {
+                    HMEntry *p;
+                    for (p = hmd->oldBuckets[i]; p != NULL; p = p->next)
+                        tmp[n++] = p;
+                }
+            }
         }
     }
     return tmp;
@@ -166,13 +569,15 @@ static HMEntry **hm_entryArray(const HashMap *hm, long *len) {
     return tmp;
 }
 
-static int hm_get(const HashMap *hm, char *key, void **element) {
+int hashmap_getHashed(const HashMap *hm, void *key, size_t len,
+                      unsigned long long h, void **element) {
     HmData *hmd = (HmData *)hm->self;
     long i;
     HMEntry *p;
     int ans = 0;
 
-    p = findKey(hmd, key, &i);
+    MIGRATE(hmd);
+    p = findKey(hmd, key, len, h, &i);
     if (p != NULL) {
         ans = 1;
         *element = p->element;
@@ -180,6 +585,14 @@ static int hm_get(const HashMap *hm, char *key, void **element) {
     return ans;
 }
 
+static int hm_getn(const HashMap *hm, void *key, long len, void **element) {
+    return hashmap_getHashed(hm, key, len, hash64(key, len), element);
+}
+
+static int hm_get(const HashMap *hm, char *key, void **element) {
+    return hm_getn(hm, key, (long)strlen(key), element);
+}
+
 static int hm_isEmpty(const HashMap *hm) {
     HmData *hmd = (HmData *)hm->self;
     return (hmd->size == 0L);
@@ -205,6 +618,13 @@ static char **keys(HmData *hmd) {
                     p = p->next;
                 }
             }
+            if (hmd->oldBuckets != NULL) {
+                for (i = hmd->migrated; i < hmd->oldCapacity; i++) {
+                    HMEntry *p;
+                    for (p = hmd->oldBuckets[i]; p != NULL; p = p->next)
+                        tmp[n++] = p->key;
+                }
+            }
         }
     }
     return tmp;
@@ -220,136 +640,412 @@ static char **hm_keyArray(const HashMap *hm, long *len) {
 }
 
 /*
- * routine that resizes the hashmap
+ * routine that resizes the hashmap to N buckets, which may be more or
+ * fewer than it has now; entries are redistributed using the hash cached
+ * in each entry, so keys are not rehashed
+ *
+ * if HM_INCREMENTAL was specified, the new bucket array is installed and
+ * the entries are moved over MIGRATE_STEP buckets at a time by subsequent
+ * operations on the hashmap
+ *
+ * returns 1 if successful, 0 if malloc failure
  */
-static void resize(HmData *hmd) {
-    int N;
-    HMEntry *p, *q, **array;
-    long i, j;
+static int resize(HmData *hmd, long N) {
+    HMEntry **array;
+    long j;
+    double start = chainstats_clock();
 
-    N = 2 * hmd->capacity;
+    if (hmd->oldBuckets != NULL)	/* finish previous resize first */
+        migrate(hmd, hmd->oldCapacity);
     if (N > MAX_CAPACITY)
         N = MAX_CAPACITY;
     if (N == hmd->capacity)
-        return;
+        return 1;
     array = (HMEntry **)malloc(N * sizeof(HMEntry *));
     if (array == NULL)
-        return;
+        return 0;
     for (j = 0; j < N; j++)
         array[j] = NULL;
+    hmd->oldBuckets = hmd->buckets;
+    hmd->oldCapacity = hmd->capacity;
+    hmd->migrated = 0L;
+    hmd->buckets = array;
+    hmd->capacity = N;
+    hmd->load = (double)hmd->size / (double)N;
+    hmd->changes = 0;
+    hmd->increment = 1.0 / (double)N;
     /*
      * now redistribute the entries into the new set of buckets
      */
-    for (i = 0; i < hmd->capacity; i++) {
-        for (p = hmd->buckets[i]; p != NULL; p = q) {
-            q = p->next;
-            j = hash(p->key, N);
-            p->next = array[j];
-            array[j] = p;
+    if (! (hmd->flags & HM_INCREMENTAL))
+        migrate(hmd, hmd->oldCapacity);
+    if (hmd->filter != NULL)
+        refilter(hmd);
+    hmd->resizes++;
+    hmd->resizeTime += chainstats_clock() - start;
+    return 1;
+}
+
+/*
+ * routine invoked before each put or remove; every TRIGGER changes, the
+ * table is doubled if the load exceeds the load factor, or halved until
+ * the load is at least half the load factor if it has fallen below
+ * loadFactor / SHRINK_LOAD; the gap between the thresholds keeps a
+ * hashmap whose size hovers around one of them from resizing repeatedly
+ */
+static void checkLoad(HmData *hmd) {
+    long N;
+
+    if (hmd->changes > TRIGGER) {
+        hmd->changes = 0;
+        if (hmd->load > hmd->loadFactor)
+            (void) resize(hmd, 2 * hmd->capacity);
+        else if (hmd->load < hmd->loadFactor / SHRINK_LOAD &&
+                 hmd->capacity > hmd->minCapacity) {
+            for (N = hmd->capacity; N / 2 >= hmd->minCapacity &&
+                 (double)hmd->size / (double)(N / 2) <= hmd->loadFactor / 2.0;
+                 N /= 2)
+                ;
+            (void) resize(hmd, N);
         }
+        if (hmd->filter != NULL && hmd->stale > hmd->size + TRIGGER)
+            refilter(hmd);		/* mostly removed keys, so rebuild */
     }
-    free(hmd->buckets);
-    hmd->buckets = array;
-    hmd->capacity = N;
-    hmd->load /= 2.0;
-    hmd->changes = 0;
-    hmd->increment = 1.0 / (double)N;
 }
 
 /*
- * helper function to insert new (key, element) into table
+ * helper function to insert new (key, element) into bucket `i' of table;
+ * `h' is the hash of the `len'-byte key; the stored copy of the key is
+ * always followed by a '\0'
  */
-static int insertEntry(HmData *hmd, char *key, void *element, long i) {
-    HMEntry *p = (HMEntry *)malloc(sizeof(HMEntry));
+static int insertEntry(HmData *hmd, void *key, size_t len, void *element,
+                       unsigned long long h, long i) {
+    HMEntry *p = newEntry(hmd, len);
     int ans = 0;
 
     if (p != NULL) {
-        char *q = strdup(key);
-        if (q != NULL) {
-            p->key = q;
-            p->element = element;
-            p->next = hmd->buckets[i];
-            hmd->buckets[i] = p;
-            hmd->size++;
-            hmd->load += hmd->increment;
-            hmd->changes++;
-            ans = 1;
-        } else {
-            free(p);
-        }
+        memcpy(p->key, key, len);
+        p->key[len] = '\0';
+        p->keylen = len;
+        p->hash = h;
+        p->element = element;
+        p->next = hmd->buckets[i];
+        hmd->buckets[i] = p;
+        if (hmd->filter != NULL)
+            hmd->filter->add(hmd->filter, h);
+        hmd->size++;
+        hmd->load += hmd->increment;
+        hmd->changes++;
+        ans = 1;
     }
     return ans;
 }
 
-static int hm_put(const HashMap *hm, char *key, void *element, void **previous) {
-    HmData *hmd = (HmData *)hm->self;
+/*
+ * local function that implements put(); `h' is the hash of the `len'-byte key
+ */
+static int putHashed(HmData *hmd, void *key, size_t len, unsigned long long h,
+                     void *element, void **previous) {
     long i;
     HMEntry *p;
     int ans = 0;
 
-    if (hmd->changes > TRIGGER) {
-        hmd->changes = 0;
-        if (hmd->load > hmd->loadFactor)
-            resize(hmd);
-    }
-    p = findKey(hmd, key, &i);
+    checkLoad(hmd);
+    MIGRATE(hmd);
+    p = findKey(hmd, key, len, h, &i);
     if (p != NULL && previous != NULL) {
         *previous = p->element;
         p->element = element;
+        cancelTimer(hmd, p);
         ans = 1;
     } else {
         if (previous != NULL)
             *previous = NULL;
-        ans = insertEntry(hmd, key, element, i);
+        ans = insertEntry(hmd, key, len, element, h, i);
     }
     return ans;
 }
 
-static int hm_putUnique(const HashMap *hm, char *key, void *element) {
+int hashmap_putHashed(const HashMap *hm, void *key, size_t len,
+                      unsigned long long h, void *element, void **previous) {
+    return putHashed((HmData *)hm->self, key, len, h, element, previous);
+}
+
+static int hm_putn(const HashMap *hm, void *key, long len, void *element,
+                   void **previous) {
+    HmData *hmd = (HmData *)hm->self;
+
+    return putHashed(hmd, key, len, hash64(key, len), element, previous);
+}
+
+static int hm_put(const HashMap *hm, char *key, void *element, void **previous) {
+    return hm_putn(hm, key, (long)strlen(key), element, previous);
+}
+
+int hashmap_putWithDeadlineHashed(const HashMap *hm, char *key, size_t len,
+                                  unsigned long long h, void *element,
+                                  long deadline, void **previous) {
     HmData *hmd = (HmData *)hm->self;
     long i;
     HMEntry *p;
-    int ans = 0;
 
-    if (hmd->changes > TRIGGER) {
-        hmd->changes = 0;
-        if (hmd->load > hmd->loadFactor)
-            resize(hmd);
+    checkLoad(hmd);
+    MIGRATE(hmd);
+    if ((p = findKey(hmd, key, len, h, &i)) != NULL) {
+        if (!setTimer(hmd, p, deadline))
+            return 0;
+        if (previous != NULL)
+            *previous = p->element;
+        p->element = element;
+    } else {
+        if (!insertEntry(hmd, key, len, element, h, i))
+            return 0;
+        p = hmd->buckets[i];	/* insertEntry() adds at head of chain */
+        if (!setTimer(hmd, p, deadline)) {
+            deleteEntry(hmd, p);
+            return 0;
+        }
+        if (previous != NULL)
+            *previous = NULL;
     }
-    p = findKey(hmd, key, &i);
+    return 1;
+}
+
+static int hm_putWithTTL(const HashMap *hm, char *key, void *element,
+                         long ttl, void **previous) {
+    HmData *hmd = (HmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+
+    if (ttl <= 0L)
+        return putHashed(hmd, key, len, h, element, previous);
+    return hashmap_putWithDeadlineHashed(hm, key, len, h, element,
+                                         hmd->clock + ttl, previous);
+}
+
+int hashmap_putUniqueHashed(const HashMap *hm, char *key, size_t len,
+                            unsigned long long h, void *element) {
+    HmData *hmd = (HmData *)hm->self;
+    long i;
+    HMEntry *p;
+    int ans = 0;
+
+    checkLoad(hmd);
+    MIGRATE(hmd);
+    p = findKey(hmd, key, len, h, &i);
     if (p == NULL) {
-        ans = insertEntry(hmd, key, element, i);
+        ans = insertEntry(hmd, key, len, element, h, i);
     }
     return ans;
 }
 
-static int hm_remove(const HashMap *hm, char *key, void **element) {
+static int hm_putUnique(const HashMap *hm, char *key, void *element) {
+    size_t len = strlen(key);
+
+    return hashmap_putUniqueHashed(hm, key, len, hash64(key, len), element);
+}
+
+int hashmap_removeHashed(const HashMap *hm, void *key, size_t len,
+                         unsigned long long h, void **element) {
     HmData *hmd = (HmData *)hm->self;
     long i;
     HMEntry *entry;
     int ans = 0;
 
-    entry = findKey(hmd, key, &i);
+    checkLoad(hmd);
+    MIGRATE(hmd);
+    entry = findKey(hmd, key, len, h, &i);
     if (entry != NULL) {
-        HMEntry *p, *c;
         *element = entry->element;
-        /* determine where the entry lives in the singly linked list */
-        for (p = NULL, c = hmd->buckets[i]; c != entry; p = c, c = c->next)
-            ;
-        if (p == NULL)
-            hmd->buckets[i] = entry->next;
-        else
-            p->next = entry->next;
-        hmd->size--;
-        hmd->load -= hmd->increment;
-        hmd->changes++;
-        free(entry->key);
-        free(entry);
+        deleteEntry(hmd, entry);
         ans = 1;
     }
     return ans;
 }
 
+static int hm_removen(const HashMap *hm, void *key, long len, void **element) {
+    return hashmap_removeHashed(hm, key, len, hash64(key, len), element);
+}
+
+static int hm_remove(const HashMap *hm, char *key, void **element) {
+    return hm_removen(hm, key, (long)strlen(key), element);
+}
+
+/*
+ * local function that locates the entry for the `len'-byte `key' whose hash
+ * is `h', adding one with a NULL element if there is none; `*added' is set
+ * to 1 if the entry was added
+ *
+ * returns pointer to the entry, or NULL if malloc failure
+ */
+static HMEntry *findOrAdd(HmData *hmd, char *key, size_t len,
+                          unsigned long long h, int *added) {
+    long i;
+    HMEntry *p;
+
+    checkLoad(hmd);
+    MIGRATE(hmd);
+    *added = 0;
+    p = findKey(hmd, key, len, h, &i);
+    if (p == NULL && insertEntry(hmd, key, len, NULL, h, i)) {
+        p = hmd->buckets[i];	/* insertEntry() adds at head of chain */
+        *added = 1;
+    }
+    return p;
+}
+
+int hashmap_computeIfAbsentHashed(const HashMap *hm, char *key, size_t len,
+                                  unsigned long long h,
+                                  void *(*factory)(char *key, void *ctx),
+                                  void *ctx, void **element) {
+    HmData *hmd = (HmData *)hm->self;
+    HMEntry *p;
+    int added;
+
+    if ((p = findOrAdd(hmd, key, len, h, &added)) == NULL)
+        return 0;
+    if (added)
+        p->element = factory(key, ctx);
+    *element = p->element;
+    return 1;
+}
+
+static int hm_computeIfAbsent(const HashMap *hm, char *key,
+                              void *(*factory)(char *key, void *ctx),
+                              void *ctx, void **element) {
+    size_t len = strlen(key);
+
+    return hashmap_computeIfAbsentHashed(hm, key, len, hash64(key, len),
+                                         factory, ctx, element);
+}
+
+int hashmap_computeHashed(const HashMap *hm, char *key, size_t len,
+                          unsigned long long h,
+                          int (*fxn)(char *key, void **element, void *ctx),
+                          void *ctx) {
+    HmData *hmd = (HmData *)hm->self;
+    HMEntry *p;
+    int added;
+
+    if ((p = findOrAdd(hmd, key, len, h, &added)) == NULL)
+        return 0;
+    if (fxn(key, &p->element, ctx))
+        return 1;
+    deleteEntry(hmd, p);
+    return 0;
+}
+
+static int hm_compute(const HashMap *hm, char *key,
+                      int (*fxn)(char *key, void **element, void *ctx),
+                      void *ctx) {
+    size_t len = strlen(key);
+
+    return hashmap_computeHashed(hm, key, len, hash64(key, len), fxn, ctx);
+}
+
+int hashmap_mergeHashed(const HashMap *hm, char *key, size_t len,
+                        unsigned long long h, void *element,
+                        void *(*mergeFxn)(void *old, void *element)) {
+    HmData *hmd = (HmData *)hm->self;
+    HMEntry *p;
+    int added;
+
+    if ((p = findOrAdd(hmd, key, len, h, &added)) == NULL)
+        return 0;
+    p->element = (added) ? element : mergeFxn(p->element, element);
+    return 1;
+}
+
+static int hm_merge(const HashMap *hm, char *key, void *element,
+                    void *(*mergeFxn)(void *old, void *element)) {
+    size_t len = strlen(key);
+
+    return hashmap_mergeHashed(hm, key, len, hash64(key, len), element,
+                               mergeFxn);
+}
+
+/*
+ * local function to advance the clock by one tick, cascading the timers
+ * of the slots of higher levels whose time has come
+ */
+static void tick(HmData *hmd) {
+    HmTimer *s, *t, *u;
+    long j;
+    int k;
+
+    hmd->clock++;
+    for (k = 1; k < WHEEL_LEVELS; k++) {
+        if (((hmd->clock >> (WHEEL_BITS * (k - 1))) & (WHEEL_SLOTS - 1)) != 0)
+            break;
+        j = (hmd->clock >> (WHEEL_BITS * k)) & (WHEEL_SLOTS - 1);
+        s = SLOT(hmd, k, j);
+        if (s->next == s)
+            continue;
+        t = s->next;
+        s->prev->next = NULL;
+        s->next = s->prev = s;
+        for (; t != NULL; t = u) {
+            u = t->next;
+            hmd->levelTimers[k]--;
+            hmd->timers--;
+            addTimer(hmd, t);
+        }
+    }
+}
+
+static long hm_expire(const HashMap *hm, long now, long maxWork) {
+    HmData *hmd = (HmData *)hm->self;
+    long work = 0L, n = 0L;
+    HmTimer *s;
+    int k;
+
+    if (maxWork <= 0L)
+        maxWork = -1L;		/* no limit */
+    MIGRATE(hmd);
+    while (work != maxWork) {
+        if (hmd->wheel != NULL) {
+            s = SLOT(hmd, 0, hmd->clock & (WHEEL_SLOTS - 1));
+            while (s->next != s && work != maxWork) {
+                reap(hmd, s->next->entry);
+                work++;
+                n++;
+            }
+            if (s->next != s)
+                break;
+        }
+        if (hmd->clock >= now)
+            break;
+        if (hmd->timers == 0L) {
+            hmd->clock = now;
+            break;
+        }
+        /*
+         * if the lowest k levels are empty, nothing happens until the
+         * clock reaches the next multiple of the span of a level-k slot
+         */
+        for (k = 0; hmd->levelTimers[k] == 0L; k++)
+            ;
+        if (k > 0) {
+            long next = hmd->clock | ((1L << (WHEEL_BITS * k)) - 1L);
+            if (next >= now) {
+                hmd->clock = now;
+                break;
+            }
+            hmd->clock = next;
+        }
+        tick(hmd);
+        work++;
+    }
+    return n;
+}
+
+static void hm_setExpiryFxn(const HashMap *hm,
+                            void (*expiryFxn)(char *key, void *element)) {
+    HmData *hmd = (HmData *)hm->self;
+
+    hmd->expiryFxn = expiryFxn;
+}
+
 static long hm_size(const HashMap *hm) {
     HmData *hmd = (HmData *)hm->self;
     return hmd->size;
@@ -368,10 +1064,180 @@ static const Iterator *hm_itCreate(const HashMap *hm) {
     return it;
 }
 
+/*
+ * local function that computes the lengths and hashes of the `n' keys
+ * (n <= BATCH), and prefetches the bucket each key will be found in, then
+ * the first entry on each of those chains; the loads of the bucket
+ * pointers are independent, so their cache misses overlap
+ */
+static void prepareBatch(HmData *hmd, char **keys, long n, size_t *lens,
+                         unsigned long long *hashes) {
+    unsigned long long N = (unsigned long long)hmd->capacity;
+    long j;
+
+    for (j = 0; j < n; j++) {
+        lens[j] = strlen(keys[j]);
+        hashes[j] = hash64(keys[j], lens[j]);
+        PREFETCH(&hmd->buckets[hashes[j] % N]);
+    }
+    for (j = 0; j < n; j++)
+        PREFETCH(hmd->buckets[hashes[j] % N]);
+}
+
+static long hm_getBatch(const HashMap *hm, char **keys, long n,
+                        void **elements, int *found) {
+    HmData *hmd = (HmData *)hm->self;
+    size_t lens[BATCH];
+    unsigned long long hashes[BATCH];
+    long i, j, m, bucket, ans = 0L;
+
+    for (i = 0L; i < n; i += BATCH) {
+        m = (n - i < BATCH) ? n - i : BATCH;
+        MIGRATE(hmd);
+        prepareBatch(hmd, keys + i, m, lens, hashes);
+        for (j = 0; j < m; j++) {
+            HMEntry *p = findKey(hmd, keys[i + j], lens[j], hashes[j], &bucket);
+            elements[i + j] = (p != NULL) ? p->element : NULL;
+            if (found != NULL)
+                found[i + j] = (p != NULL);
+            if (p != NULL)
+                ans++;
+        }
+    }
+    return ans;
+}
+
+static long hm_putBatch(const HashMap *hm, char **keys, long n,
+                        void **elements, void **previous) {
+    HmData *hmd = (HmData *)hm->self;
+    size_t lens[BATCH];
+    unsigned long long hashes[BATCH];
+    long i, j, m, ans = 0L;
+    void *prev;
+
+    for (i = 0L; i < n; i += BATCH) {
+        m = (n - i < BATCH) ? n - i : BATCH;
+        prepareBatch(hmd, keys + i, m, lens, hashes);
+        for (j = 0; j < m; j++) {
+            if (putHashed(hmd, keys[i + j], lens[j], hashes[j],
+                          elements[i + j], &prev))
+                ans++;
+            if (previous != NULL)
+                previous[i + j] = prev;
+        }
+    }
+    return ans;
+}
+
+static int hm_forEach(const HashMap *hm,
+                      int (*callback)(HMEntry *entry, void *ctx), void *ctx) {
+    HmData *hmd = (HmData *)hm->self;
+    HMEntry *p;
+    long i;
+    int ans;
+
+    for (i = 0L; i < hmd->capacity; i++) {
+        for (p = hmd->buckets[i]; p != NULL; p = p->next) {
+            if ((ans = (*callback)(p, ctx)) != 0)
+                return ans;
+        }
+    }
+    if (hmd->oldBuckets != NULL) {
+        for (i = hmd->migrated; i < hmd->oldCapacity; i++) {
+            for (p = hmd->oldBuckets[i]; p != NULL; p = p->next) {
+                if ((ans = (*callback)(p, ctx)) != 0)
+                    return ans;
+            }
+        }
+    }
+    return 0;
+}
+
+/*
+ * the cursor indexes buckets [0, capacity), followed by the unmigrated
+ * buckets of oldBuckets if a resize is in progress; offset counts the
+ * entries on the current chain that have already been returned
+ */
+static int hm_scan(const HashMap *hm, HMCursor *cursor, HMEntry **entry) {
+    HmData *hmd = (HmData *)hm->self;
+    long i, k;
+    HMEntry *p;
+
+    for (i = cursor->bucket; ; i++, cursor->offset = 0L) {
+        if (i < hmd->capacity)
+            p = hmd->buckets[i];
+        else if (hmd->oldBuckets != NULL && i < hmd->capacity + hmd->oldCapacity)
+            p = (i - hmd->capacity >= hmd->migrated) ?
+                hmd->oldBuckets[i - hmd->capacity] : NULL;
+        else
+            break;
+        for (k = cursor->offset; p != NULL && k > 0L; k--)
+            p = p->next;
+        if (p != NULL) {
+            *entry = p;
+            cursor->bucket = i;
+            cursor->offset++;
+            return 1;
+        }
+    }
+    cursor->bucket = i;
+    return 0;
+}
+
+static int hm_compact(const HashMap *hm) {
+    HmData *hmd = (HmData *)hm->self;
+    long N = (long)((double)hmd->size / hmd->loadFactor) + 1L;
+    int ans;
+
+    if (N < DEFAULT_CAPACITY)
+        N = DEFAULT_CAPACITY;
+    ans = resize(hmd, N);
+    if (hmd->oldBuckets != NULL)	/* complete an incremental resize */
+        migrate(hmd, hmd->oldCapacity);
+    return ans;
+}
+
+/*
+ * while an incremental resize is in progress, the unmigrated chains of
+ * oldBuckets are counted along with those of buckets
+ */
+static void hm_stats(const HashMap *hm, HashStats *hs) {
+    HmData *hmd = (HmData *)hm->self;
+    HMEntry *p;
+    long i, n;
+
+    chainstats_init(hs);
+    hs->size = hmd->size;
+    hs->capacity = hmd->capacity;
+    for (i = 0L; i < hmd->capacity; i++) {
+        for (n = 0L, p = hmd->buckets[i]; p != NULL; p = p->next)
+            n++;
+        chainstats_add(hs, n);
+    }
+    if (hmd->oldBuckets != NULL) {
+        for (i = hmd->migrated; i < hmd->oldCapacity; i++) {
+            for (n = 0L, p = hmd->oldBuckets[i]; p != NULL; p = p->next)
+                n++;
+            chainstats_add(hs, n);
+        }
+    }
+    chainstats_finish(hs, hmd->resizes, hmd->resizeTime, hmd->hits,
+                      hmd->misses, hmd->probes);
+}
+
+static long hm_trim(const HashMap *hm) {
+    HmData *hmd = (HmData *)hm->self;
+    return nodepool_trim(hmd->pool);
+}
+
 char *hmentry_key(HMEntry *hme) {
     return hme->key;
 }
 
+long hmentry_keylen(HMEntry *hme) {
+    return (long)hme->keylen;
+}
+
 void *hmentry_value(HMEntry *hme) {
     return hme->element;
 }
@@ -379,14 +1245,20 @@ void *hmentry_value(HMEntry *hme) {
 static HashMap template = {
     NULL, hm_destroy, hm_clear, hm_containsKey, hm_entryArray,hm_get,
     hm_isEmpty, hm_keyArray, hm_put, hm_putUnique, hm_remove, hm_size,
-    hm_itCreate
-}; 
+    hm_itCreate, hm_containsKeyn, hm_getn, hm_putn, hm_removen, hm_getBatch,
+    hm_putBatch, hm_forEach, hm_scan, hm_trim, hm_compact, hm_stats,
+    hm_computeIfAbsent, hm_compute, hm_merge, hm_putWithTTL, hm_expire,
+    hm_setExpiryFxn
+};
 
-const HashMap *HashMap_create(long capacity, double loadFactor) {
+const HashMap *HashMap_createWithFlags(long capacity, double loadFactor,
+                                       int flags) {
     HashMap *hm = (HashMap *)malloc(sizeof(HashMap));
     long N;
     double lf;
     HMEntry **array;
+    NodePool *pool;
+    const BloomFilter *filter = NULL;
     long i;
 
     if (hm != NULL) {
@@ -398,19 +1270,47 @@ const HashMap *HashMap_create(long capacity, double loadFactor) {
                 N = MAX_CAPACITY;
             lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
             array = (HMEntry **)malloc(N * sizeof(HMEntry *));
-            if (array != NULL) {
+            pool = (flags & HM_POOLED) ? NodePool_create() : NULL;
+            if (flags & HM_FILTERED)
+                filter = BloomFilter_create((long)(lf * (double)N) + TRIGGER,
+                                            FILTER_FP);
+            if (array != NULL && (pool != NULL || ! (flags & HM_POOLED)) &&
+                (filter != NULL || ! (flags & HM_FILTERED))) {
                 hmd->capacity = N;
+                hmd->minCapacity = N;
                 hmd->loadFactor = lf;
                 hmd->size = 0L;
                 hmd->load = 0.0;
                 hmd->changes = 0L;
                 hmd->increment = 1.0 / (double)N;
+                hmd->flags = flags;
                 hmd->buckets = array;
+                hmd->oldBuckets = NULL;
+                hmd->oldCapacity = 0L;
+                hmd->migrated = 0L;
+                hmd->slabs = NULL;
+                hmd->pool = pool;
+                hmd->resizes = 0L;
+                hmd->resizeTime = 0.0;
+                hmd->hits = hmd->misses = hmd->probes = 0L;
+                hmd->wheel = NULL;
+                hmd->clock = 0L;
+                hmd->timers = 0L;
+                for (i = 0; i < WHEEL_LEVELS; i++)
+                    hmd->levelTimers[i] = 0L;
+                hmd->expiryFxn = NULL;
+                hmd->filter = filter;
+                hmd->stale = 0L;
                 for (i = 0; i < N; i++)
                     array[i] = NULL;
                 *hm = template;
                 hm->self = hmd;
             } else {
+                free(array);
+                if (pool != NULL)
+                    nodepool_destroy(pool);
+                if (filter != NULL)
+                    filter->destroy(filter);
                 free(hmd);
                 free(hm);
                 hm = NULL;
@@ -422,3 +1322,7 @@ const HashMap *HashMap_create(long capacity, double loadFactor) {
     }
     return hm;
 }
+
+const HashMap *HashMap_create(long capacity, double loadFactor) {
+    return HashMap_createWithFlags(capacity, loadFactor, 0);
+}
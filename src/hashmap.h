@@ -33,6 +33,7 @@
  */
 
 #include "iterator.h"			/* needed for factory method */
+#include "hashstats.h"
 
 /*
  * interface definition for generic hashmap implementation
@@ -43,18 +44,149 @@
 typedef struct hashmap HashMap;		/* forward reference */
 typedef struct hmentry HMEntry;		/* opaque type definition */
 
+/*
+ * position of a scan() of a hashmap; a cursor is started by initializing
+ * it with HMCURSOR_INIT, and holds only the index of the current bucket
+ * and the number of entries of that bucket already returned, so no
+ * storage is needed and a scan may be abandoned at any point
+ */
+typedef struct hmcursor {
+    long bucket;
+    long offset;
+} HMCursor;
+
+#define HMCURSOR_INIT {0L, 0L}
+
 /*
  * create a hashmap with the specified capacity and load factor;
  * if capacity == 0, a default initial capacity (16 elements) is used
  * if loadFactor == 0.0, a default load factor (0.75) is used
  * if number of elements/number of buckets exceeds the load factor, the
  * table is resized, doubling the number of buckets, up to a max number
- * of buckets (134,217,728)
+ * of buckets (134,217,728); if it falls below a quarter of the load factor
+ * as entries are removed, the table is shrunk, but never below the
+ * initial capacity
  *
  * returns a pointer to the hashmap, or NULL if there are malloc() errors
  */
 const HashMap *HashMap_create(long capacity, double loadFactor);
 
+/*
+ * flags that may be or'ed together and passed to HashMap_createWithFlags()
+ *
+ * HM_INCREMENTAL - when the table is resized, the entries are moved to the
+ *                  new bucket array a few buckets at a time by subsequent
+ *                  operations on the hashmap, rather than all at once by
+ *                  the put() that triggered the resize; this keeps the
+ *                  worst case cost of an operation low for large hashmaps
+ * HM_ARENA       - entries, including their copies of the keys, are carved
+ *                  from large slabs of storage owned by the hashmap; this
+ *                  makes put() cheaper, and clear()/destroy() release whole
+ *                  slabs, only visiting entries if freeFxn != NULL; the
+ *                  storage for removed entries is not reused until the
+ *                  hashmap is cleared, so this suits bulk-loaded hashmaps
+ *                  rather than ones with many removals
+ * HM_FILTERED    - a Bloom filter (see bloomfilter.h) of the hashes of the
+ *                  keys is kept beside the table, and is consulted before
+ *                  a chain is searched; a key that is absent is then
+ *                  usually rejected after touching one cache line, without
+ *                  following any chain; this suits hashmaps at which most
+ *                  lookups miss; the filter costs about 12 bits per entry
+ *                  and is rebuilt, from the hashes stored in the entries,
+ *                  whenever the table is resized or most of the keys put
+ *                  since it was last built have been removed
+ * HM_POOLED      - entries are carved from 64 KiB slabs owned by the
+ *                  hashmap, and those removed are kept on free lists for
+ *                  reuse by later puts, until trim() returns the slabs
+ *                  holding no entries to the heap; this saves a call to
+ *                  malloc() or free() for most puts and removes in a large
+ *                  hashmap with much churn, but costs at least one slab per
+ *                  size of entry, so it does not suit small hashmaps; it
+ *                  has no effect on entries with HM_ARENA
+ */
+#define HM_INCREMENTAL 0x01
+#define HM_ARENA 0x02
+#define HM_FILTERED 0x04
+#define HM_POOLED 0x08
+
+/*
+ * create a hashmap as with HashMap_create(), with its behavior modified
+ * by `flags'
+ *
+ * returns a pointer to the hashmap, or NULL if there are malloc() errors
+ */
+const HashMap *HashMap_createWithFlags(long capacity, double loadFactor,
+                                       int flags);
+
+/*
+ * create a hashmap that uses open addressing instead of chaining; entries
+ * are stored directly in the table next to an array of one-byte hash
+ * fingerprints, so most lookups touch a single cache line of fingerprints
+ * and a single entry
+ *
+ * capacity is rounded up to a power of 2 (minimum of 16 slots);
+ * if loadFactor == 0.0, a default load factor (0.875) is used; load factors
+ * greater than 0.875 are reduced to 0.875; as for HashMap_create(), the
+ * table shrinks when the load falls below a quarter of the load factor
+ *
+ * NB - HMEntry pointers returned by entryArray() or the iterator are only
+ * valid until the next put(), putUnique(), remove() or compact() on the
+ * hashmap
+ *
+ * time-to-live is supported, but the deadlines are kept in the table
+ * rather than on a timer wheel: expire() sets the current time to `now'
+ * at once, so that lookups no longer find the entries whose deadlines
+ * are <= now, and sweeps the table for them from where the previous call
+ * stopped; with maxWork > 0, each entry reaped and each group of 16 slots
+ * examined counts as one unit of work
+ *
+ * returns a pointer to the hashmap, or NULL if there are malloc() errors
+ */
+const HashMap *HashMap_createFlat(long capacity, double loadFactor);
+
+/*
+ * writes the contents of `hm' to the file `path' in a position-independent
+ * form that can later be mapped by HashMap_openMapped(); if
+ * sizeFxn != NULL, it is invoked on each element to obtain the number of
+ * bytes of that element to write, otherwise the elements are assumed to
+ * be '\0'-terminated strings; NULL elements are preserved
+ *
+ * the file is written under a temporary name and renamed to `path', so a
+ * process that has the previous version mapped is not disturbed
+ *
+ * returns 1 if successful, 0 if there were malloc() or I/O errors
+ */
+int HashMap_save(const HashMap *hm, char *path,
+                 long (*sizeFxn)(void *element));
+
+/*
+ * maps a file written by HashMap_save() read-only into memory and returns
+ * a hashmap that performs its lookups directly against the mapped pages;
+ * nothing is read or allocated per entry, so opening is O(1) regardless
+ * of the number of entries, and processes that map the same file share
+ * its pages
+ *
+ * the elements returned are pointers into the mapping (aligned to 8
+ * bytes); put(), putUnique(), putn(), putBatch(), remove(), removen(),
+ * computeIfAbsent(), compute() and merge() always return 0 without
+ * invoking their callbacks, clear() does nothing, and destroy() unmaps
+ * the file without invoking freeFxn
+ *
+ * NB - the HMEntry returned by scan() is held by the hashmap, and is only
+ * valid until the next call to scan() on it, so scan() is single-threaded:
+ * threads that scan the same mapped hashmap must serialize their scans;
+ * all of the other lookups may be made by any number of threads at once
+ *
+ * only the header of the file is checked when it is mapped; an entry whose
+ * record does not lie within the file is skipped, as if it were absent, so
+ * a corrupt file does not crash the process, but a file that is truncated
+ * or rewritten in place while it is mapped can still raise SIGBUS
+ *
+ * returns a pointer to the hashmap, or NULL if the file cannot be mapped,
+ * is not a file written by HashMap_save(), or if there are malloc() errors
+ */
+const HashMap *HashMap_openMapped(char *path);
+
 /*
  * now define struct hashmap
  */
@@ -154,6 +286,217 @@ struct hashmap {
  * returns pointer to the Iterator or NULL if failure
  */
     const Iterator *(*itCreate)(const HashMap *hm);
+
+/*
+ * the `n' methods below are equivalent to the methods without the `n',
+ * except that the key is the `len' bytes starting at `key' rather than
+ * a '\0'-terminated string, so keys may contain arbitrary bytes; the
+ * string key "abc" and the 3-byte key "abc" are the same key
+ */
+
+/*
+ * returns 1 if hashmap has an entry for the `len'-byte `key', 0 otherwise
+ */
+    int (*containsKeyn)(const HashMap *hm, void *key, long len);
+
+/*
+ * returns the element to which the `len'-byte `key' is mapped in `*element'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*getn)(const HashMap *hm, void *key, long len, void **element);
+
+/*
+ * associates `element' with the `len'-byte `key'; if this replaces an
+ * existing mapping, the old value is returned in `*previous'; otherwise
+ * *previous == NULL
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*putn)(const HashMap *hm, void *key, long len, void *element,
+                void **previous);
+
+/*
+ * removes the entry associated with the `len'-byte `key' if one exists;
+ * returns element associated with key in `*element'
+ *
+ * returns 1 if successful, 0 if no element associated with `key'
+ */
+    int (*removen)(const HashMap *hm, void *key, long len, void **element);
+
+/*
+ * looks up each of the `n' keys in `keys[]', returning the element to
+ * which keys[i] is mapped in elements[i] (NULL if there is no mapping);
+ * if found != NULL, found[i] is set to 1 if keys[i] has a mapping, 0 if not
+ *
+ * the keys are hashed and the memory they will touch is prefetched a
+ * block at a time before any of them are resolved, so the cache misses
+ * for different keys overlap; this is much faster than `n' calls to get()
+ * for large hashmaps
+ *
+ * returns the number of keys that were found
+ */
+    long (*getBatch)(const HashMap *hm, char **keys, long n, void **elements,
+                     int *found);
+
+/*
+ * associates elements[i] with keys[i] for each of the `n' keys, replacing
+ * any existing mappings; if previous != NULL, previous[i] is set to the
+ * element that keys[i] was previously mapped to, or NULL
+ *
+ * returns the number of mappings that were successfully made
+ */
+    long (*putBatch)(const HashMap *hm, char **keys, long n, void **elements,
+                     void **previous);
+
+/*
+ * invokes callback(entry, ctx) on each entry of the hashmap in an arbitrary
+ * order, walking the buckets in place rather than allocating an array of
+ * the entries as entryArray() and itCreate() do; if callback returns a
+ * non-zero value, the walk stops and that value is returned
+ *
+ * callback must not modify the hashmap
+ *
+ * returns 0 if callback was invoked on every entry
+ */
+    int (*forEach)(const HashMap *hm, int (*callback)(HMEntry *entry, void *ctx),
+                   void *ctx);
+
+/*
+ * returns the entry at `*cursor' in `*entry' and advances the cursor past
+ * it; no storage is allocated, so a scan of a very large hashmap may be
+ * performed a piece at a time and stopped early
+ *
+ * the hashmap may be modified between calls without invalidating the
+ * cursor, but entries added, removed or moved by a resize during the scan
+ * may be missed or returned twice; with HM_INCREMENTAL, any method call
+ * may move entries while a resize is in progress
+ *
+ * returns 1 if successful, 0 if the scan is complete
+ */
+    int (*scan)(const HashMap *hm, HMCursor *cursor, HMEntry **entry);
+
+/*
+ * with HM_POOLED, entries removed from the hashmap are kept on a free list
+ * for reuse by later puts rather than being returned to the heap; trim()
+ * returns the storage of those that are no longer needed to the heap
+ *
+ * returns the number of bytes returned to the heap, 0 without HM_POOLED
+ */
+    long (*trim)(const HashMap *hm);
+
+/*
+ * resizes the table of the hashmap to the smallest capacity that holds
+ * its current entries within the load factor, regardless of the capacity
+ * with which it was created; an incremental resize in progress is
+ * completed
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+    int (*compact)(const HashMap *hm);
+
+/*
+ * fills in `*hs' with statistics describing the table of the hashmap and
+ * the work done by its lookups and resizes; see hashstats.h
+ *
+ * the cost is proportional to the capacity of the table
+ */
+    void (*stats)(const HashMap *hm, HashStats *hs);
+
+/*
+ * the three methods below each locate the entry for `key' once and then
+ * act on it in place, so a read-modify-write of an element costs a single
+ * lookup rather than a get() followed by a put(); the callbacks are
+ * invoked on the entry while it is located, so they must not modify the
+ * hashmap
+ */
+
+/*
+ * if `key' has no mapping, invokes factory(key, ctx) and associates the
+ * element it returns with `key'; factory is not invoked if `key' already
+ * has a mapping; the element associated with `key' upon return is
+ * returned in `*element'
+ *
+ * returns 1 if successful, 0 if not (malloc failure, in which case factory
+ * has not been invoked)
+ */
+    int (*computeIfAbsent)(const HashMap *hm, char *key,
+                           void *(*factory)(char *key, void *ctx), void *ctx,
+                           void **element);
+
+/*
+ * invokes fxn(key, &element, ctx), where element is the element currently
+ * associated with `key', or NULL if `key' has no mapping; if fxn returns
+ * a non-zero value, the (possibly updated) element is associated with
+ * `key', adding a mapping if there was none; if fxn returns 0, any mapping
+ * for `key' is removed, and fxn is responsible for the element it was
+ * passed
+ *
+ * returns 1 if `key' has a mapping upon return, 0 if not (fxn returned 0,
+ * or malloc failure, in which case fxn has not been invoked)
+ */
+    int (*compute)(const HashMap *hm, char *key,
+                   int (*fxn)(char *key, void **element, void *ctx), void *ctx);
+
+/*
+ * if `key' has no mapping, associates `element' with it; otherwise, the
+ * element `old' associated with `key' is replaced by
+ * mergeFxn(old, element)
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*merge)(const HashMap *hm, char *key, void *element,
+                 void *(*mergeFxn)(void *old, void *element));
+
+/*
+ * the three methods below give entries a time-to-live; time is measured
+ * in ticks of whatever length the application chooses (e.g. milliseconds
+ * of a monotonic clock), and the current time of the hashmap is the `now'
+ * passed to the most recent expire(), starting at 0
+ *
+ * an entry whose deadline has passed is reaped by the first lookup that
+ * finds it, which then behaves as if there were no mapping, or by
+ * expire(); until then it is still counted by size() and returned by
+ * entryArray(), keyArray(), the iterator, forEach() and scan()
+ *
+ * TTLs are supported by the chained and flat hashmaps; a mapped hashmap
+ * is read-only, so its putWithTTL() returns 0 as put() does, expire()
+ * returns 0, and setExpiryFxn() does nothing
+ */
+
+/*
+ * associates `element' with `key' as put() does, and sets the mapping to
+ * expire `ttl' ticks after the current time of the hashmap; if ttl <= 0,
+ * the mapping does not expire; put() of an existing key also removes any
+ * time-to-live it had, whereas compute() and merge() keep it
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*putWithTTL)(const HashMap *hm, char *key, void *element, long ttl,
+                      void **previous);
+
+/*
+ * advances the current time of the hashmap to `now', reaping the entries
+ * whose deadlines are <= now; the deadlines are kept on a hierarchical
+ * timer wheel, so the cost is proportional to the number of entries
+ * reaped, not to the size of the hashmap
+ *
+ * if maxWork > 0, at most maxWork entries are reaped or steps of the wheel
+ * taken, and the time is only advanced as far as that work allows; the
+ * application calls expire() again to continue, so reaping a large number
+ * of entries can be spread over many short calls
+ *
+ * returns the number of entries reaped
+ */
+    long (*expire)(const HashMap *hm, long now, long maxWork);
+
+/*
+ * sets the function invoked as expiryFxn(key, element) on each entry that
+ * is reaped, e.g. to free the element; `key' is only valid during the
+ * call, which must not use the hashmap
+ */
+    void (*setExpiryFxn)(const HashMap *hm,
+                         void (*expiryFxn)(char *key, void *element));
 };
 
 /*
@@ -164,4 +507,10 @@ struct hashmap {
 char *hmentry_key(HMEntry *hme);
 void *hmentry_value(HMEntry *hme);
 
+/*
+ * returns the length of the key of an HMEntry; needed for keys stored with
+ * putn(), which may contain '\0' bytes
+ */
+long hmentry_keylen(HMEntry *hme);
+
 #endif /* _HASHMAP_H_ */
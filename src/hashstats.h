@@ -0,0 +1,70 @@
+#ifndef _HASHSTATS_H_
+#define _HASHSTATS_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * statistics reported by the stats() method of the hash-based ADTs
+ * (HashMap, UnorderedSet, TSHashMap and TSUnorderedSet)
+ *
+ * the shape of the table is computed by stats() itself, so it costs
+ * nothing until it is asked for; the resize counters are maintained
+ * always, as resizes are rare; the lookup counters cost a few increments
+ * per lookup, so they are only maintained if the library is compiled
+ * with -DHASH_STATS, and are otherwise reported as -1
+ *
+ * for a chained table, a chain is the list of entries in a bucket; for
+ * an open-addressed table (HashMap_createFlat() and HashMap_openMapped()),
+ * each entry has a chain whose length is the number of probes needed to
+ * reach it, so occupied is the number of full slots, and meanChain is the
+ * mean number of probes for a successful lookup
+ */
+
+#define HASHSTATS_BINS 8		/* number of bins in the histogram */
+
+typedef struct hashstats {
+    long size;			/* number of entries */
+    long capacity;		/* number of buckets (or slots) */
+    long occupied;		/* number of non-empty chains */
+    long maxChain;		/* length of the longest chain */
+    double meanChain;		/* mean length of the non-empty chains */
+    long histogram[HASHSTATS_BINS];	/* [i] = chains of length i+1; the */
+					/* last bin also counts longer ones */
+    long resizes;		/* number of times the table was resized */
+    double resizeSeconds;	/* total time spent in those resizes */
+    long hits;			/* key searches that found the key */
+    long misses;		/* key searches that did not */
+    long probes;		/* entries (or groups) examined by searches */
+    double meanProbes;		/* probes / (hits + misses) */
+} HashStats;
+
+#endif /* _HASHSTATS_H_ */
@@ -0,0 +1,77 @@
+#ifndef _HMHASHED_H_
+#define _HMHASHED_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"
+#include <stddef.h>
+
+/*
+ * private entry points to the chained HashMap for callers that have already
+ * computed hash64() of the key, such as the striped TSHashMap, which hashes
+ * each key to choose its stripe; they are not installed with the public
+ * headers
+ *
+ * `hm' must have been made by HashMap_create[WithFlags](), `len' is the
+ * length of `key' and `h' must be hash64(key, len); otherwise each behaves
+ * exactly as the method of the same name, except that
+ * hashmap_putWithDeadlineHashed() takes the absolute time at which the
+ * mapping expires in place of a time-to-live, so that a caller keeping its
+ * own clock need not rely on that of the hashmap
+ */
+
+int hashmap_containsHashed(const HashMap *hm, void *key, size_t len,
+                           unsigned long long h);
+int hashmap_getHashed(const HashMap *hm, void *key, size_t len,
+                      unsigned long long h, void **element);
+int hashmap_putHashed(const HashMap *hm, void *key, size_t len,
+                      unsigned long long h, void *element, void **previous);
+int hashmap_removeHashed(const HashMap *hm, void *key, size_t len,
+                         unsigned long long h, void **element);
+int hashmap_putUniqueHashed(const HashMap *hm, char *key, size_t len,
+                            unsigned long long h, void *element);
+int hashmap_putWithDeadlineHashed(const HashMap *hm, char *key, size_t len,
+                                  unsigned long long h, void *element,
+                                  long deadline, void **previous);
+int hashmap_computeIfAbsentHashed(const HashMap *hm, char *key, size_t len,
+                                  unsigned long long h,
+                                  void *(*factory)(char *key, void *ctx),
+                                  void *ctx, void **element);
+int hashmap_computeHashed(const HashMap *hm, char *key, size_t len,
+                          unsigned long long h,
+                          int (*fxn)(char *key, void **element, void *ctx),
+                          void *ctx);
+int hashmap_mergeHashed(const HashMap *hm, char *key, size_t len,
+                        unsigned long long h, void *element,
+                        void *(*mergeFxn)(void *old, void *element));
+
+#endif /* _HMHASHED_H_ */
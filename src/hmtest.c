@@ -33,13 +33,99 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
+
+/*
+ * returns the resident size of the process in bytes, or -1 if it cannot
+ * be determined
+ */
+static long residentBytes(void) {
+    FILE *fd = fopen("/proc/self/statm", "r");
+    long size, resident = -1L;
+
+    if (fd != NULL) {
+        if (fscanf(fd, "%ld %ld", &size, &resident) != 2)
+            resident = -1L;
+        fclose(fd);
+    }
+    return (resident < 0L) ? -1L : resident * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * forEach() callback that counts entries, stopping when *ctx reaches 0
+ */
+static int countDown(HMEntry *entry, void *ctx) {
+    long *n = (long *)ctx;
+
+    (void) entry;
+    return (--(*n) == 0L);
+}
+
+/*
+ * prints the parts of `*hs' that do not depend on how the hash function
+ * spreads the keys, and checks that the rest are consistent
+ */
+static void printStats(HashStats *hs) {
+    long i, n;
+
+    printf("size = %ld, capacity = %ld, resizes = %ld\n", hs->size,
+           hs->capacity, hs->resizes);
+    for (i = 0, n = 0; i < HASHSTATS_BINS; i++)
+        n += hs->histogram[i];
+    printf("histogram consistent = %d, ", n == hs->occupied &&
+           hs->maxChain >= 1 && hs->occupied <= hs->size);
+    printf("meanChain consistent = %d, ", hs->meanChain >= 1.0 &&
+           hs->meanChain <= (double)hs->maxChain);
+    printf("lookup counters consistent = %d\n", hs->hits == -1L ||
+           (hs->hits >= hs->size && hs->probes >= hs->hits));
+}
+
+/*
+ * callbacks for the computeIfAbsent/compute/merge test; elements are
+ * counts stored directly in the element pointers
+ */
+static void *newCount(char *key, void *ctx) {
+    (void) key;
+    (*(long *)ctx)++;			/* number of times invoked */
+    return (void *)1000L;
+}
+
+static int bumpCount(char *key, void **element, void *ctx) {
+    long n = (long)*element;
+
+    (void) key;
+    if (n == 1000L)			/* drop those made by newCount() */
+        return 0;
+    if (n == 0L && ctx != NULL)		/* only update existing counts */
+        return 0;
+    *element = (void *)(n + 1L);
+    return 1;
+}
+
+static void *addCounts(void *old, void *element) {
+    return (void *)((long)old + (long)element);
+}
+
+/*
+ * expiry callback for the putWithTTL/expire test; each element is the
+ * deadline of its entry, which must not be later than `horizon'
+ */
+static long expired = 0L, early = 0L, horizon = 0L;
+
+static void countExpired(char *key, void *element) {
+    (void) key;
+    expired++;
+    if ((long)element > horizon)
+        early++;
+}
 
 int main(int argc, char *argv[]) {
     char buf[1024];
-    char key[20];
+    char key[32];
     char *p;
     const HashMap *hm;
     long i, n;
+    HashStats hs;
     FILE *fd;
     HMEntry **array;
     const Iterator *it;
@@ -191,6 +277,438 @@ int main(int argc, char *argv[]) {
      */
     printf("===== test of destroy(free)\n");
     hm->destroy(hm, free);
+    /*
+     * test of incremental resizing
+     */
+    printf("===== test of HM_INCREMENTAL\n");
+    if ((hm = HashMap_createWithFlags(1L, 0.0, HM_INCREMENTAL)) == NULL) {
+        fprintf(stderr, "Error creating incremental hashmap\n");
+        return -1;
+    }
+    for (i = 0; i < 10000; i++) {
+        sprintf(key, "%ld", i);
+        if (!hm->putUnique(hm, key, argv[1])) {
+            fprintf(stderr, "Error adding %ld'th key to hashmap\n", i);
+            return -1;
+        }
+    }
+    printf("Size after putUnique = %ld\n", hm->size(hm));
+    for (i = 0; i < 10000; i++) {
+        sprintf(key, "%ld", i);
+        if (!hm->get(hm, key, (void **)&p) || p != argv[1]) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+    }
+    for (i = 0; i < 10000; i += 2) {
+        sprintf(key, "%ld", i);
+        if (!hm->remove(hm, key, (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th element\n", i);
+            return -1;
+        }
+    }
+    printf("Size after remove = %ld\n", hm->size(hm));
+    if ((array = hm->entryArray(hm, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking hm->entryArray()\n");
+        return -1;
+    }
+    printf("entryArray length = %ld\n", n);
+    free(array);
+    hm->destroy(hm, NULL);
+    /*
+     * test of arena allocation of entries
+     */
+    printf("===== test of HM_ARENA\n");
+    if ((hm = HashMap_createWithFlags(0L, 0.0, HM_ARENA)) == NULL) {
+        fprintf(stderr, "Error creating arena hashmap\n");
+        return -1;
+    }
+    for (n = 0; n < 2; n++) {
+        for (i = 0; i < 10000; i++) {
+            sprintf(key, "%ld", i);
+            if ((p = strdup(key)) == NULL) {
+                fprintf(stderr, "Error duplicating string\n");
+                return -1;
+            }
+            if (!hm->putUnique(hm, key, p)) {
+                fprintf(stderr, "Error adding %ld'th key to hashmap\n", i);
+                return -1;
+            }
+        }
+        for (i = 0; i < 10000; i++) {
+            sprintf(key, "%ld", i);
+            if (!hm->get(hm, key, (void **)&p) || strcmp(p, key) != 0) {
+                fprintf(stderr, "Error retrieving %ld'th element\n", i);
+                return -1;
+            }
+        }
+        printf("Size after putUnique = %ld\n", hm->size(hm));
+        hm->clear(hm, free);
+        printf("Size after clear = %ld\n", hm->size(hm));
+    }
+    hm->destroy(hm, free);
+
+    /*
+     * test of binary keys
+     */
+    printf("===== test of putn/getn/containsKeyn/removen\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of binary keys\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->putn(hm, bkey, sizeof(bkey), argv[1], (void **)&p)) {
+            fprintf(stderr, "Error adding %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    printf("Size after putn = %ld\n", hm->size(hm));
+    for (i = 0, n = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (hm->getn(hm, bkey, sizeof(bkey), (void **)&p) && p == argv[1])
+            n++;
+        if (hm->containsKeyn(hm, bkey, sizeof(bkey) - 1))
+            n--;		/* prefix of a key must not match */
+    }
+    printf("Number of keys found = %ld\n", n);
+    (void) hm->put(hm, "abc", argv[1], (void **)&p);
+    printf("containsKeyn(\"abc\", 3) = %d\n", hm->containsKeyn(hm, "abc", 3));
+    printf("containsKeyn(\"abc\", 4) = %d\n", hm->containsKeyn(hm, "abc", 4));
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->removen(hm, bkey, sizeof(bkey), (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    (void) hm->removen(hm, "abc", 3, (void **)&p);
+    printf("Size after removen = %ld\n", hm->size(hm));
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of batch methods
+     */
+    printf("===== test of putBatch/getBatch\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for batches\n");
+        return -1;
+    }
+    {
+        char kbuf[2000][20];
+        char *bkeys[2000];
+        void *values[2000];
+        int found[2000];
+
+        for (i = 0; i < 2000; i++) {
+            sprintf(kbuf[i], "k%ld", i);
+            bkeys[i] = kbuf[i];
+            values[i] = kbuf[i];
+        }
+        n = hm->putBatch(hm, bkeys, 1000, values, NULL);
+        printf("putBatch stored %ld mappings, size = %ld\n", n, hm->size(hm));
+        n = hm->getBatch(hm, bkeys, 2000, values, found);
+        printf("getBatch found %ld of 2000 keys\n", n);
+        for (i = 0; i < 2000; i++) {
+            if (found[i] != (i < 1000) ||
+                (found[i] && strcmp((char *)values[i], bkeys[i]) != 0)) {
+                fprintf(stderr, "Error in getBatch for %ld'th key\n", i);
+                return -1;
+            }
+        }
+    }
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of forEach() and scan()
+     */
+    printf("===== test of forEach/scan\n");
+    if ((hm = HashMap_createWithFlags(0L, 0.0, HM_INCREMENTAL)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for forEach\n");
+        return -1;
+    }
+    {
+        char kbuf[2000][20];
+        char seen[2000];
+        HMCursor cursor = HMCURSOR_INIT;
+        HMEntry *entry;
+
+        for (i = 0; i < 2000; i++) {
+            sprintf(kbuf[i], "%ld", i);
+            seen[i] = 0;
+            (void) hm->put(hm, kbuf[i], kbuf[i], (void **)&p);
+        }
+        n = -1L;
+        printf("forEach over all entries returned %d\n",
+               hm->forEach(hm, countDown, &n));
+        printf("forEach visited %ld entries\n", -1L - n);
+        n = 10L;
+        printf("forEach stopped early returned %d\n",
+               hm->forEach(hm, countDown, &n));
+        for (n = 0L; n < 500L && hm->scan(hm, &cursor, &entry); n++)
+            seen[atol(hmentry_key(entry))]++;
+        printf("scan stopped after %ld entries\n", n);
+        while (hm->scan(hm, &cursor, &entry)) {    /* resume the scan */
+            i = atol(hmentry_key(entry));
+            if (seen[i]++)
+                fprintf(stderr, "Error: scan returned %ld twice\n", i);
+            n++;
+        }
+        printf("scan returned %ld entries\n", n);
+        printf("scan after end returned %d\n",
+               hm->scan(hm, &cursor, &entry));
+    }
+    hm->destroy(hm, NULL);
+    /*
+     * test of reuse of removed entries and of trim()
+     */
+    printf("===== test of trim\n");
+    if ((hm = HashMap_createWithFlags(0L, 0.0, HM_POOLED)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for trim\n");
+        return -1;
+    }
+    for (i = 0; i < 20000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, NULL, (void **)&p);
+    }
+    printf("trim() of full hashmap returned %ld\n", hm->trim(hm));
+    for (i = 0; i < 20000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->remove(hm, buf, (void **)&p);
+    }
+    for (i = 0; i < 10000; i++) {         /* reuses the removed entries */
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, NULL, (void **)&p);
+    }
+    n = hm->trim(hm);
+    printf("trim() after removes returned storage: %s\n",
+           (n > 0L) ? "yes" : "no");
+    printf("second trim() returned %ld\n", hm->trim(hm));
+    for (i = 0, n = 0; i < 20000; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    printf("Size after trim = %ld, %ld keys found\n", hm->size(hm), n);
+    hm->destroy(hm, NULL);
+    /*
+     * test that small hashmaps do not each pay for slabs of entries
+     */
+    printf("===== test of footprint of small hashmaps\n");
+    {
+        const HashMap **maps;
+        long before, after;
+
+        if ((maps = (const HashMap **)malloc(10000 * sizeof(HashMap *)))
+            == NULL) {
+            fprintf(stderr, "Error allocating array of hashmaps\n");
+            return -1;
+        }
+        before = residentBytes();
+        for (i = 0; i < 10000; i++) {
+            if ((maps[i] = HashMap_create(0L, 0.0)) == NULL) {
+                fprintf(stderr, "Error creating %ld'th small hashmap\n", i);
+                return -1;
+            }
+            (void) maps[i]->put(maps[i], "one", NULL, (void **)&p);
+            (void) maps[i]->put(maps[i], "two", NULL, (void **)&p);
+        }
+        after = residentBytes();
+        printf("10000 two-entry hashmaps resident in under 32 MiB: %s\n",
+               (before < 0L || after < 0L || after - before < 32L << 20) ?
+               "yes" : "no");
+        for (i = 0; i < 10000; i++)
+            maps[i]->destroy(maps[i], NULL);
+        free(maps);
+    }
+    /*
+     * test of shrinking as entries are removed, and of compact()
+     */
+    printf("===== test of shrinking and compact\n");
+    if ((hm = HashMap_createWithFlags(0L, 0.0, HM_INCREMENTAL)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for compact\n");
+        return -1;
+    }
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, NULL, (void **)&p);
+    }
+    hm->stats(hm, &hs);
+    printf("Capacity after puts = %ld\n", hs.capacity);
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        if (i % 100 != 0 && !hm->remove(hm, buf, (void **)&p))
+            fprintf(stderr, "Error removing %s\n", buf);
+    }
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    hm->stats(hm, &hs);
+    printf("Size after removes = %ld, %ld keys found, capacity = %ld\n",
+           hm->size(hm), n, hs.capacity);
+    printf("compact() returned %d\n", hm->compact(hm));
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    hm->stats(hm, &hs);
+    printf("Size after compact = %ld, %ld keys found, capacity = %ld\n",
+           hm->size(hm), n, hs.capacity);
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, NULL, (void **)&p);
+    }
+    hm->stats(hm, &hs);
+    printf("Size after puts = %ld, capacity = %ld\n", hm->size(hm),
+           hs.capacity);
+    hm->destroy(hm, NULL);
+    /*
+     * test of stats()
+     */
+    printf("===== test of stats\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for stats\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, NULL, (void **)&p);
+        (void) hm->containsKey(hm, buf);
+    }
+    hm->stats(hm, &hs);
+    printStats(&hs);
+    hm->destroy(hm, NULL);
+    /*
+     * test of computeIfAbsent(), compute() and merge()
+     */
+    printf("===== test of computeIfAbsent/compute/merge\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for compute\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i % 100);
+        if (!hm->merge(hm, buf, (void *)1L, addCounts))
+            fprintf(stderr, "Error merging %s\n", buf);
+    }
+    for (i = 0, n = 0; i < 100; i++) {
+        sprintf(buf, "%ld", i);
+        if (hm->get(hm, buf, (void **)&p) && (long)p == 10L)
+            n++;
+    }
+    printf("Size after merges = %ld, %ld counts of 10\n", hm->size(hm), n);
+    n = 0L;
+    for (i = 0; i < 200; i++) {
+        sprintf(buf, "%ld", i);
+        if (!hm->computeIfAbsent(hm, buf, newCount, &n, (void **)&p) ||
+            (long)p != ((i < 100) ? 10L : 1000L))
+            fprintf(stderr, "Error in computeIfAbsent for %s\n", buf);
+    }
+    printf("Size after computeIfAbsent = %ld, factory invoked %ld times\n",
+           hm->size(hm), n);
+    for (i = 0, n = 0; i < 200; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->compute(hm, buf, bumpCount, NULL);
+    }
+    (void) hm->get(hm, "42", (void **)&p);
+    printf("Size after compute = %ld, %ld kept, \"42\" -> %ld\n",
+           hm->size(hm), n, (long)p);
+    i = hm->compute(hm, "absent", bumpCount, &n);
+    printf("compute(\"absent\") declined = %ld, ", i);
+    printf("containsKey(\"absent\") = %d\n", hm->containsKey(hm, "absent"));
+    i = hm->compute(hm, "absent", bumpCount, NULL);
+    (void) hm->get(hm, "absent", (void **)&p);
+    printf("compute(\"absent\") = %ld, \"absent\" -> %ld\n", i, (long)p);
+    hm->destroy(hm, NULL);
+    /*
+     * test of putWithTTL() and expire()
+     */
+    printf("===== test of putWithTTL/expire\n");
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for TTL\n");
+        return -1;
+    }
+    hm->setExpiryFxn(hm, countExpired);
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i);
+        n = 1L + i * i;				/* spread over the levels */
+        if (!hm->putWithTTL(hm, buf, (void *)n, n, (void **)&p))
+            fprintf(stderr, "Error in putWithTTL for %s\n", buf);
+    }
+    (void) hm->put(hm, "forever", NULL, (void **)&p);
+    (void) hm->putWithTTL(hm, "999", (void *)2000000000L, 2000000000L,
+                          (void **)&p);	/* beyond the wheel */
+    (void) hm->put(hm, "500", (void *)0L, (void **)&p);	/* cancels TTL */
+    for (horizon = 1L; horizon <= 1000000L; horizon *= 10L) {
+        n = hm->expire(hm, horizon, 0L);
+        printf("expire(%ld) reaped %ld, size = %ld\n", horizon, n,
+               hm->size(hm));
+    }
+    printf("expiryFxn invoked %ld times, %ld before the deadline\n",
+           expired, early);
+    printf("containsKey(\"500\") = %d, containsKey(\"forever\") = %d\n",
+           hm->containsKey(hm, "500"), hm->containsKey(hm, "forever"));
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "same%ld", i);
+        (void) hm->putWithTTL(hm, buf, (void *)(horizon + 10L), 10L,
+                              (void **)&p);
+    }
+    horizon += 10L;
+    n = hm->expire(hm, horizon, 100L);
+    printf("expire(now + 10, 100) reaped %ld, size = %ld\n", n,
+           hm->size(hm));
+    for (i = 0, n = 0; i < 1000; i++) {
+        sprintf(buf, "same%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    printf("%ld found by containsKey(), size = %ld\n", n, hm->size(hm));
+    printf("expiryFxn invoked %ld times, %ld before the deadline\n",
+           expired, early);
+    hm->destroy(hm, NULL);
+    /*
+     * test of HM_FILTERED; lookups must find every key present, through
+     * resizes and removals, and no key absent
+     */
+    printf("===== test of HM_FILTERED\n");
+    if ((hm = HashMap_createWithFlags(0L, 0.0, HM_FILTERED)) == NULL) {
+        fprintf(stderr, "Error creating filtered hashmap\n");
+        return -1;
+    }
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) hm->put(hm, buf, (void *)i, (void **)&p);
+    }
+    for (i = 0, n = 0; i < 110000; i++) {
+        sprintf(buf, "%ld", i);
+        n += hm->containsKey(hm, buf);
+    }
+    printf("size = %ld, %ld of 110000 keys found\n", hm->size(hm), n);
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        if (i % 10 != 0)
+            (void) hm->remove(hm, buf, (void **)&p);
+    }
+    for (i = 0, n = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        if (hm->get(hm, buf, (void **)&p) && (long)p == i)
+            n++;
+    }
+    printf("size after remove = %ld, %ld found\n", hm->size(hm), n);
+    hm->clear(hm, NULL);
+    (void) hm->put(hm, "after", (void *)0L, (void **)&p);
+    printf("size after clear = %ld, containsKey(\"0\") = %d, ",
+           hm->size(hm), hm->containsKey(hm, "0"));
+    printf("containsKey(\"after\") = %d\n", hm->containsKey(hm, "after"));
+    hm->destroy(hm, NULL);
 
     return 0;
 }
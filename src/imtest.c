@@ -0,0 +1,211 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "int64map.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*
+ * key for the i'th line; line 3 has the key 0, and the keys of earlier
+ * lines are negative
+ */
+#define KEY(i) (((long long)(i) - 3LL) * 0x100000001LL)
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char *p;
+    const Int64Map *im;
+    long i, n;
+    FILE *fd;
+    I64MEntry **array;
+    const Iterator *it;
+    long long *keys;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./imtest file\n");
+        return -1;
+    }
+    if ((im = Int64Map_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating int64map\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of put()
+     */
+    printf("===== test of put when key not in int64map\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!im->put(im, KEY(i++), p, (void **)&prev)) {
+            fprintf(stderr, "Error adding key,string to int64map\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    n = im->size(im);
+    /*
+     * test of get()
+     */
+    printf("===== test of get\n");
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        if (!im->get(im, KEY(i), (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%lld,%s", KEY(i), element);
+    }
+    /*
+     * test of put replacing value associated with an existing key
+     */
+    printf("===== test of put (replace value associated with key)\n");
+    for (i = 0; i < n; i += 2) {
+        char bf[1024], *q;
+        sprintf(bf, "line %ld\n", i);
+        if ((p = strdup(bf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!im->put(im, KEY(i), p, (void **)&q)) {
+            fprintf(stderr, "Error replacing %ld'th element\n", i);
+            return -1;
+        }
+        free(q);
+    }
+    printf("putUnique of existing key = %d\n", im->putUnique(im, KEY(4), NULL));
+    printf("Size after replacement = %ld\n", im->size(im));
+    /*
+     * test of entryArray
+     */
+    printf("===== test of entryArray\n");
+    if ((array = im->entryArray(im, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking im->entryArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        printf("%lld,%s", i64mentry_key(array[i]),
+               (char *)i64mentry_value(array[i]));
+    }
+    free(array);
+    /*
+     * test of keyArray
+     */
+    printf("===== test of keyArray\n");
+    if ((keys = im->keyArray(im, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking im->keyArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        if (!im->containsKey(im, keys[i])) {
+            fprintf(stderr, "Error: key %lld not found\n", keys[i]);
+            return -1;
+        }
+    }
+    printf("keyArray returned %ld keys, all present\n", n);
+    free(keys);
+    /*
+     * test of iterator
+     */
+    printf("===== test of iterator\n");
+    if ((it = im->itCreate(im)) == NULL) {
+        fprintf(stderr, "Error in creating iterator\n");
+        return -1;
+    }
+    while (it->hasNext(it)) {
+        I64MEntry *p;
+        (void) it->next(it, (void **)&p);
+        printf("%lld,%s", i64mentry_key(p), (char *)i64mentry_value(p));
+    }
+    it->destroy(it);
+    /*
+     * test of remove
+     */
+    printf("===== test of remove\n");
+    printf("Size before remove = %ld\n", n);
+    for (i = 1; i < n; i += 2) {		/* includes KEY(3) == 0 */
+        if (!im->remove(im, KEY(i), (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th element\n", i);
+            return -1;
+        }
+        free(p);
+    }
+    printf("Size after remove = %ld\n", im->size(im));
+    for (i = 0; i < n; i++) {
+        if (im->containsKey(im, KEY(i)) != (i % 2 == 0)) {
+            fprintf(stderr, "Error: wrong containsKey for %ld'th key\n", i);
+            return -1;
+        }
+    }
+    printf("containsKey(0) = %d\n", im->containsKey(im, 0LL));
+    printf("remove(0) = %d\n", im->remove(im, 0LL, (void **)&p));
+    /*
+     * test of destroy with free() as freeFxn
+     */
+    printf("===== test of destroy(free)\n");
+    im->destroy(im, free);
+    /*
+     * test of many insertions and removals
+     */
+    printf("===== test of growth and removal\n");
+    if ((im = Int64Map_create(0L, 0.9)) == NULL) {
+        fprintf(stderr, "Error creating int64map\n");
+        return -1;
+    }
+    for (i = 0; i < 100000; i++) {
+        if (!im->putUnique(im, (long long)i * 7LL, argv[1])) {
+            fprintf(stderr, "Error adding %ld'th key to int64map\n", i);
+            return -1;
+        }
+    }
+    printf("Size after putUnique = %ld\n", im->size(im));
+    for (i = 0; i < 100000; i += 3)
+        (void) im->remove(im, (long long)i * 7LL, (void **)&p);
+    for (i = 0, n = 0; i < 700000; i++)
+        n += im->containsKey(im, (long long)i);
+    printf("Size after remove = %ld, %ld keys found\n", im->size(im), n);
+    im->clear(im, NULL);
+    printf("Size after clear = %ld, isEmpty = %d\n", im->size(im),
+           im->isEmpty(im));
+    im->destroy(im, NULL);
+
+    return 0;
+}
@@ -0,0 +1,384 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "int64map.h"
+#include "hash64.h"
+#include <stdlib.h>
+
+#define DEFAULT_CAPACITY 16L
+#define MIN_CAPACITY 16L
+#define MAX_CAPACITY 1073741824L
+#define DEFAULT_LOAD_FACTOR 0.75
+#define MAX_LOAD_FACTOR 0.9
+
+/*
+ * implementation of the int64map using linear probing in a power of 2
+ * sized table; a slot whose key is 0 is empty, so a mapping for the key 0
+ * is kept outside of the table, in `zero'; removal shifts later members of
+ * the probe run back into the vacated slot, so there are no tombstones
+ */
+
+struct i64mentry {
+    long long key;
+    void *value;
+};
+
+typedef struct im_data {
+    long size;			/* includes the mapping for 0, if any */
+    long capacity;
+    long limit;			/* resize when size of table exceeds this */
+    double loadFactor;
+    int hasZero;
+    I64MEntry zero;
+    I64MEntry *slots;
+} ImData;
+
+#define HOME(imd, k) \
+    ((long)(hash64_int((unsigned long long)(k)) & ((imd)->capacity - 1)))
+
+static I64MEntry *newSlots(long N) {
+    I64MEntry *slots = (I64MEntry *)malloc(N * sizeof(I64MEntry));
+    long i;
+
+    if (slots != NULL)
+        for (i = 0L; i < N; i++)
+            slots[i].key = 0LL;
+    return slots;
+}
+
+/*
+ * local function to call freeFxn on every value
+ */
+static void purge(ImData *imd, void (*freeFxn)(void *value)) {
+    long i;
+
+    if (freeFxn == NULL)
+        return;
+    if (imd->hasZero)
+        (*freeFxn)(imd->zero.value);
+    for (i = 0L; i < imd->capacity; i++)
+        if (imd->slots[i].key != 0LL)
+            (*freeFxn)(imd->slots[i].value);
+}
+
+static void im_destroy(const Int64Map *im, void (*freeFxn)(void *value)) {
+    ImData *imd = (ImData *)im->self;
+
+    purge(imd, freeFxn);
+    free(imd->slots);
+    free(imd);
+    free((void *)im);
+}
+
+static void im_clear(const Int64Map *im, void (*freeFxn)(void *value)) {
+    ImData *imd = (ImData *)im->self;
+    long i;
+
+    purge(imd, freeFxn);
+    for (i = 0L; i < imd->capacity; i++)
+        imd->slots[i].key = 0LL;
+    imd->hasZero = 0;
+    imd->size = 0L;
+}
+
+/*
+ * local function to locate `key'
+ *
+ * returns pointer to its entry, or NULL if not present; if not present,
+ * returns in `*slot' the index of the empty slot where it would be placed
+ */
+static I64MEntry *findKey(ImData *imd, long long key, long *slot) {
+    long mask = imd->capacity - 1;
+    long i;
+
+    if (key == 0LL)
+        return imd->hasZero ? &imd->zero : NULL;
+    for (i = HOME(imd, key); imd->slots[i].key != 0LL; i = (i + 1) & mask)
+        if (imd->slots[i].key == key)
+            return &imd->slots[i];
+    *slot = i;
+    return NULL;
+}
+
+static int im_containsKey(const Int64Map *im, long long key) {
+    long slot;
+
+    return (findKey((ImData *)im->self, key, &slot) != NULL);
+}
+
+static int im_get(const Int64Map *im, long long key, void **value) {
+    long slot;
+    I64MEntry *p = findKey((ImData *)im->self, key, &slot);
+
+    if (p == NULL)
+        return 0;
+    *value = p->value;
+    return 1;
+}
+
+static int im_isEmpty(const Int64Map *im) {
+    ImData *imd = (ImData *)im->self;
+    return (imd->size == 0L);
+}
+
+static long im_size(const Int64Map *im) {
+    ImData *imd = (ImData *)im->self;
+    return imd->size;
+}
+
+/*
+ * local function for generating an array of I64MEntry * from an int64map
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static I64MEntry **entries(ImData *imd) {
+    I64MEntry **tmp = NULL;
+    long i, n = 0L;
+
+    if (imd->size > 0L) {
+        tmp = (I64MEntry **)malloc(imd->size * sizeof(I64MEntry *));
+        if (tmp != NULL) {
+            if (imd->hasZero)
+                tmp[n++] = &imd->zero;
+            for (i = 0L; i < imd->capacity; i++)
+                if (imd->slots[i].key != 0LL)
+                    tmp[n++] = &imd->slots[i];
+        }
+    }
+    return tmp;
+}
+
+static I64MEntry **im_entryArray(const Int64Map *im, long *len) {
+    ImData *imd = (ImData *)im->self;
+    I64MEntry **tmp = entries(imd);
+
+    if (tmp != NULL)
+        *len = imd->size;
+    return tmp;
+}
+
+static long long *im_keyArray(const Int64Map *im, long *len) {
+    ImData *imd = (ImData *)im->self;
+    long long *tmp = NULL;
+    long i, n = 0L;
+
+    if (imd->size > 0L) {
+        tmp = (long long *)malloc(imd->size * sizeof(long long));
+        if (tmp != NULL) {
+            if (imd->hasZero)
+                tmp[n++] = 0LL;
+            for (i = 0L; i < imd->capacity; i++)
+                if (imd->slots[i].key != 0LL)
+                    tmp[n++] = imd->slots[i].key;
+            *len = n;
+        }
+    }
+    return tmp;
+}
+
+static long growthLimit(long capacity, double loadFactor) {
+    long limit = (long)(loadFactor * (double)capacity);
+
+    return (limit < capacity) ? limit : capacity - 1;
+}
+
+/*
+ * local function that doubles the size of the table
+ *
+ * returns 1 if successful, 0 if malloc failure or already at maximum size
+ */
+static int resize(ImData *imd) {
+    I64MEntry *old = imd->slots, *slots;
+    long oldN = imd->capacity, N = 2 * oldN;
+    long i, j;
+
+    if (N > MAX_CAPACITY || (slots = newSlots(N)) == NULL)
+        return 0;
+    imd->slots = slots;
+    imd->capacity = N;
+    imd->limit = growthLimit(N, imd->loadFactor);
+    for (i = 0L; i < oldN; i++) {
+        if (old[i].key != 0LL) {
+            for (j = HOME(imd, old[i].key); slots[j].key != 0LL;
+                 j = (j + 1) & (N - 1))
+                ;
+            slots[j] = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+/*
+ * local function that adds a mapping for `key', known to be absent
+ *
+ * returns 1 if successful, 0 if the table is full and cannot be resized
+ */
+static int insertKey(ImData *imd, long long key, void *value, long slot) {
+    if (key == 0LL) {
+        imd->hasZero = 1;
+        imd->zero.key = 0LL;
+        imd->zero.value = value;
+        imd->size++;
+        return 1;
+    }
+    if (imd->size - imd->hasZero >= imd->limit) {
+        if (! resize(imd)) {
+            if (imd->size - imd->hasZero >= imd->capacity - 1)
+                return 0;
+        } else
+            (void) findKey(imd, key, &slot);
+    }
+    imd->slots[slot].key = key;
+    imd->slots[slot].value = value;
+    imd->size++;
+    return 1;
+}
+
+static int im_put(const Int64Map *im, long long key, void *value,
+                  void **previous) {
+    ImData *imd = (ImData *)im->self;
+    long slot;
+    I64MEntry *p = findKey(imd, key, &slot);
+
+    if (p != NULL) {
+        *previous = p->value;
+        p->value = value;
+        return 1;
+    }
+    *previous = NULL;
+    return insertKey(imd, key, value, slot);
+}
+
+static int im_putUnique(const Int64Map *im, long long key, void *value) {
+    ImData *imd = (ImData *)im->self;
+    long slot;
+
+    if (findKey(imd, key, &slot) != NULL)
+        return 0;
+    return insertKey(imd, key, value, slot);
+}
+
+static int im_remove(const Int64Map *im, long long key, void **value) {
+    ImData *imd = (ImData *)im->self;
+    long mask = imd->capacity - 1;
+    long slot, i, j, k;
+    I64MEntry *p = findKey(imd, key, &slot);
+
+    if (p == NULL)
+        return 0;
+    *value = p->value;
+    imd->size--;
+    if (key == 0LL) {
+        imd->hasZero = 0;
+        return 1;
+    }
+    /*
+     * move each later entry of the probe run whose home slot does not lie
+     * cyclically in (i, j] back into the hole at i
+     */
+    i = p - imd->slots;
+    for (j = (i + 1) & mask; imd->slots[j].key != 0LL; j = (j + 1) & mask) {
+        k = HOME(imd, imd->slots[j].key);
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        imd->slots[i] = imd->slots[j];
+        i = j;
+    }
+    imd->slots[i].key = 0LL;
+    return 1;
+}
+
+static const Iterator *im_itCreate(const Int64Map *im) {
+    ImData *imd = (ImData *)im->self;
+    const Iterator *it = NULL;
+    void **tmp = (void **)entries(imd);
+
+    if (tmp != NULL) {
+        it = Iterator_create(imd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+long long i64mentry_key(I64MEntry *ime) {
+    return ime->key;
+}
+
+void *i64mentry_value(I64MEntry *ime) {
+    return ime->value;
+}
+
+static Int64Map template = {
+    NULL, im_destroy, im_clear, im_containsKey, im_entryArray, im_get,
+    im_isEmpty, im_keyArray, im_put, im_putUnique, im_remove, im_size,
+    im_itCreate
+};
+
+const Int64Map *Int64Map_create(long capacity, double loadFactor) {
+    Int64Map *im = (Int64Map *)malloc(sizeof(Int64Map));
+
+    if (im != NULL) {
+        ImData *imd = (ImData *)malloc(sizeof(ImData));
+
+        if (imd != NULL) {
+            long N = MIN_CAPACITY;
+            double lf;
+
+            if (capacity <= 0L)
+                capacity = DEFAULT_CAPACITY;
+            while (N < capacity && N < MAX_CAPACITY)
+                N <<= 1;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            if (lf > MAX_LOAD_FACTOR)
+                lf = MAX_LOAD_FACTOR;
+            imd->slots = newSlots(N);
+            if (imd->slots != NULL) {
+                imd->size = 0L;
+                imd->capacity = N;
+                imd->loadFactor = lf;
+                imd->limit = growthLimit(N, lf);
+                imd->hasZero = 0;
+                *im = template;
+                im->self = imd;
+            } else {
+                free(imd);
+                free(im);
+                im = NULL;
+            }
+        } else {
+            free(im);
+            im = NULL;
+        }
+    }
+    return im;
+}
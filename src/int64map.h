@@ -0,0 +1,173 @@
+#ifndef _INT64MAP_H_
+#define _INT64MAP_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "iterator.h"			/* needed for factory method */
+
+/*
+ * interface definition for a hashmap with 64-bit integer keys
+ *
+ * the keys and values are stored directly in a flat, open addressed table,
+ * so there is no allocation per mapping, keys are hashed by an inline
+ * integer mixing function and are compared with ==; this is much cheaper
+ * than converting integer keys to strings for a HashMap, or boxing them
+ * for an UnorderedMap
+ */
+
+typedef struct int64map Int64Map;	/* forward reference */
+typedef struct i64mentry I64MEntry;	/* opaque type definition */
+
+/*
+ * create an int64map with the specified capacity and load factor;
+ * capacity is rounded up to a power of 2 (minimum of 16 slots);
+ * if capacity == 0, a default initial capacity (16 slots) is used
+ * if loadFactor == 0.0, a default load factor (0.75) is used; load factors
+ * greater than 0.9 are reduced to 0.9
+ * if number of mappings/number of slots exceeds the load factor, the
+ * table is resized, doubling the number of slots
+ *
+ * returns a pointer to the int64map, or NULL if there are malloc() errors
+ */
+const Int64Map *Int64Map_create(long capacity, double loadFactor);
+
+/*
+ * now define struct int64map
+ */
+struct int64map {
+/*
+ * the private data of the int64map
+ */
+    void *self;
+
+/*
+ * destroys the int64map; for each mapping, if freeFxn != NULL,
+ * it is invoked on the value of that mapping; the storage associated with
+ * the int64map is then returned to the heap
+ */
+    void (*destroy)(const Int64Map *im, void (*freeFxn)(void *value));
+
+/*
+ * clears all mappings from the int64map; for each mapping,
+ * if freeFxn != NULL, it is invoked on the value of that mapping
+ *
+ * upon return, the int64map will be empty
+ */
+    void (*clear)(const Int64Map *im, void (*freeFxn)(void *value));
+
+/*
+ * returns 1 if the int64map has a mapping for `key', 0 otherwise
+ */
+    int (*containsKey)(const Int64Map *im, long long key);
+
+/*
+ * returns an array containing all of the entries of the int64map in
+ * an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to I64MEntry * array of entries, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the I64MEntry * array when
+ * finished; the I64MEntry pointers are only valid until the next put(),
+ * putUnique() or remove() on the int64map
+ */
+    I64MEntry **(*entryArray)(const Int64Map *im, long *len);
+
+/*
+ * returns the value to which `key' is mapped in `*value'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*get)(const Int64Map *im, long long key, void **value);
+
+/*
+ * returns 1 if the int64map is empty, 0 if it is not
+ */
+    int (*isEmpty)(const Int64Map *im);
+
+/*
+ * returns an array containing all of the keys in the int64map in
+ * an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to long long array of keys, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the array when finished
+ */
+    long long *(*keyArray)(const Int64Map *im, long *len);
+
+/*
+ * associates `value' with `key'; if this replaces an existing mapping, the
+ * old value is returned in `*previous'; otherwise *previous == NULL
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*put)(const Int64Map *im, long long key, void *value,
+               void **previous);
+
+/*
+ * associates `value' with `key'; fails if `key' is already present
+ *
+ * returns 1 if successful, 0 if not (malloc failure or already present)
+ */
+    int (*putUnique)(const Int64Map *im, long long key, void *value);
+
+/*
+ * removes the mapping for `key' if one exists; returns the value
+ * associated with key in `*value'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*remove)(const Int64Map *im, long long key, void **value);
+
+/*
+ * returns the number of mappings in the int64map
+ */
+    long (*size)(const Int64Map *im);
+
+/*
+ * create generic iterator to this int64map
+ * note that iterator will return pointers to I64MEntry's, which are only
+ * valid until the int64map is next modified
+ *
+ * returns pointer to the Iterator or NULL if failure
+ */
+    const Iterator *(*itCreate)(const Int64Map *im);
+};
+
+/*
+ * accessor methods for obtaining key and value from an I64MEntry
+ * used with return from it_next() on iterator and with elements of
+ * I64MEntry * array returned by entryArray()
+ */
+long long i64mentry_key(I64MEntry *ime);
+void *i64mentry_value(I64MEntry *ime);
+
+#endif /* _INT64MAP_H_ */
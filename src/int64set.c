@@ -0,0 +1,298 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "int64set.h"
+#include "hash64.h"
+#include <stdlib.h>
+
+#define DEFAULT_CAPACITY 16L
+#define MIN_CAPACITY 16L
+#define MAX_CAPACITY 1073741824L
+#define DEFAULT_LOAD_FACTOR 0.75
+#define MAX_LOAD_FACTOR 0.9
+
+/*
+ * implementation of the int64set using linear probing in a power of 2
+ * sized table, as for Int64Map; a slot holding 0 is empty, so membership
+ * of 0 is recorded in `hasZero'
+ */
+
+typedef struct is_data {
+    long size;			/* includes 0, if a member */
+    long capacity;
+    long limit;			/* resize when size of table exceeds this */
+    double loadFactor;
+    int hasZero;
+    long long zero;		/* always 0; returned by the iterator */
+    long long *slots;
+} IsData;
+
+#define HOME(isd, k) \
+    ((long)(hash64_int((unsigned long long)(k)) & ((isd)->capacity - 1)))
+
+static long long *newSlots(long N) {
+    long long *slots = (long long *)malloc(N * sizeof(long long));
+    long i;
+
+    if (slots != NULL)
+        for (i = 0L; i < N; i++)
+            slots[i] = 0LL;
+    return slots;
+}
+
+static void is_destroy(const Int64Set *is) {
+    IsData *isd = (IsData *)is->self;
+
+    free(isd->slots);
+    free(isd);
+    free((void *)is);
+}
+
+static void is_clear(const Int64Set *is) {
+    IsData *isd = (IsData *)is->self;
+    long i;
+
+    for (i = 0L; i < isd->capacity; i++)
+        isd->slots[i] = 0LL;
+    isd->hasZero = 0;
+    isd->size = 0L;
+}
+
+/*
+ * local function to locate non-zero `key'
+ *
+ * returns 1 if found, 0 if not; returns in `*slot' the index of the slot
+ * holding the key, or of the empty slot where it would be placed
+ */
+static int findKey(IsData *isd, long long key, long *slot) {
+    long mask = isd->capacity - 1;
+    long i;
+
+    for (i = HOME(isd, key); isd->slots[i] != 0LL; i = (i + 1) & mask)
+        if (isd->slots[i] == key) {
+            *slot = i;
+            return 1;
+        }
+    *slot = i;
+    return 0;
+}
+
+static long growthLimit(long capacity, double loadFactor) {
+    long limit = (long)(loadFactor * (double)capacity);
+
+    return (limit < capacity) ? limit : capacity - 1;
+}
+
+/*
+ * local function that doubles the size of the table
+ *
+ * returns 1 if successful, 0 if malloc failure or already at maximum size
+ */
+static int resize(IsData *isd) {
+    long long *old = isd->slots, *slots;
+    long oldN = isd->capacity, N = 2 * oldN;
+    long i, j;
+
+    if (N > MAX_CAPACITY || (slots = newSlots(N)) == NULL)
+        return 0;
+    isd->slots = slots;
+    isd->capacity = N;
+    isd->limit = growthLimit(N, isd->loadFactor);
+    for (i = 0L; i < oldN; i++) {
+        if (old[i] != 0LL) {
+            for (j = HOME(isd, old[i]); slots[j] != 0LL; j = (j + 1) & (N - 1))
+                ;
+            slots[j] = old[i];
+        }
+    }
+    free(old);
+    return 1;
+}
+
+static int is_add(const Int64Set *is, long long key) {
+    IsData *isd = (IsData *)is->self;
+    long slot;
+
+    if (key == 0LL) {
+        if (isd->hasZero)
+            return 0;
+        isd->hasZero = 1;
+        isd->size++;
+        return 1;
+    }
+    if (findKey(isd, key, &slot))
+        return 0;
+    if (isd->size - isd->hasZero >= isd->limit) {
+        if (! resize(isd)) {
+            if (isd->size - isd->hasZero >= isd->capacity - 1)
+                return 0;
+        } else
+            (void) findKey(isd, key, &slot);
+    }
+    isd->slots[slot] = key;
+    isd->size++;
+    return 1;
+}
+
+static int is_contains(const Int64Set *is, long long key) {
+    IsData *isd = (IsData *)is->self;
+    long slot;
+
+    if (key == 0LL)
+        return isd->hasZero;
+    return findKey(isd, key, &slot);
+}
+
+static int is_isEmpty(const Int64Set *is) {
+    IsData *isd = (IsData *)is->self;
+    return (isd->size == 0L);
+}
+
+static int is_remove(const Int64Set *is, long long key) {
+    IsData *isd = (IsData *)is->self;
+    long mask = isd->capacity - 1;
+    long i, j, k;
+
+    if (key == 0LL) {
+        if (! isd->hasZero)
+            return 0;
+        isd->hasZero = 0;
+        isd->size--;
+        return 1;
+    }
+    if (! findKey(isd, key, &i))
+        return 0;
+    isd->size--;
+    /*
+     * move each later member of the probe run whose home slot does not lie
+     * cyclically in (i, j] back into the hole at i
+     */
+    for (j = (i + 1) & mask; isd->slots[j] != 0LL; j = (j + 1) & mask) {
+        k = HOME(isd, isd->slots[j]);
+        if ((i <= j) ? (i < k && k <= j) : (i < k || k <= j))
+            continue;
+        isd->slots[i] = isd->slots[j];
+        i = j;
+    }
+    isd->slots[i] = 0LL;
+    return 1;
+}
+
+static long is_size(const Int64Set *is) {
+    IsData *isd = (IsData *)is->self;
+    return isd->size;
+}
+
+static long long *is_toArray(const Int64Set *is, long *len) {
+    IsData *isd = (IsData *)is->self;
+    long long *tmp = NULL;
+    long i, n = 0L;
+
+    if (isd->size > 0L) {
+        tmp = (long long *)malloc(isd->size * sizeof(long long));
+        if (tmp != NULL) {
+            if (isd->hasZero)
+                tmp[n++] = 0LL;
+            for (i = 0L; i < isd->capacity; i++)
+                if (isd->slots[i] != 0LL)
+                    tmp[n++] = isd->slots[i];
+            *len = n;
+        }
+    }
+    return tmp;
+}
+
+static const Iterator *is_itCreate(const Int64Set *is) {
+    IsData *isd = (IsData *)is->self;
+    const Iterator *it = NULL;
+    void **tmp = NULL;
+    long i, n = 0L;
+
+    if (isd->size > 0L) {
+        tmp = (void **)malloc(isd->size * sizeof(void *));
+        if (tmp != NULL) {
+            if (isd->hasZero)
+                tmp[n++] = &isd->zero;
+            for (i = 0L; i < isd->capacity; i++)
+                if (isd->slots[i] != 0LL)
+                    tmp[n++] = &isd->slots[i];
+            it = Iterator_create(n, tmp);
+            if (it == NULL)
+                free(tmp);
+        }
+    }
+    return it;
+}
+
+static Int64Set template = {
+    NULL, is_destroy, is_clear, is_add, is_contains, is_isEmpty,
+    is_remove, is_size, is_toArray, is_itCreate
+};
+
+const Int64Set *Int64Set_create(long capacity, double loadFactor) {
+    Int64Set *is = (Int64Set *)malloc(sizeof(Int64Set));
+
+    if (is != NULL) {
+        IsData *isd = (IsData *)malloc(sizeof(IsData));
+
+        if (isd != NULL) {
+            long N = MIN_CAPACITY;
+            double lf;
+
+            if (capacity <= 0L)
+                capacity = DEFAULT_CAPACITY;
+            while (N < capacity && N < MAX_CAPACITY)
+                N <<= 1;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            if (lf > MAX_LOAD_FACTOR)
+                lf = MAX_LOAD_FACTOR;
+            isd->slots = newSlots(N);
+            if (isd->slots != NULL) {
+                isd->size = 0L;
+                isd->capacity = N;
+                isd->loadFactor = lf;
+                isd->limit = growthLimit(N, lf);
+                isd->hasZero = 0;
+                isd->zero = 0LL;
+                *is = template;
+                is->self = isd;
+            } else {
+                free(isd);
+                free(is);
+                is = NULL;
+            }
+        } else {
+            free(is);
+            is = NULL;
+        }
+    }
+    return is;
+}
@@ -0,0 +1,135 @@
+#ifndef _INT64SET_H_
+#define _INT64SET_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "iterator.h"			/* needed for factory method */
+
+/*
+ * interface definition for a hash set of 64-bit integers
+ *
+ * the members are stored directly in a flat, open addressed table, so
+ * there is no allocation per member, members are hashed by an inline
+ * integer mixing function and are compared with ==; this avoids the
+ * boxing and the calls through cmpFunction and hashFunction needed to
+ * hold integers in an UnorderedSet
+ */
+
+typedef struct int64set Int64Set;	/* forward reference */
+
+/*
+ * create an int64set with the specified capacity and load factor;
+ * capacity is rounded up to a power of 2 (minimum of 16 slots);
+ * if capacity == 0, a default initial capacity (16 slots) is used
+ * if loadFactor == 0.0, a default load factor (0.75) is used; load factors
+ * greater than 0.9 are reduced to 0.9
+ * if number of members/number of slots exceeds the load factor, the
+ * table is resized, doubling the number of slots
+ *
+ * returns a pointer to the int64set, or NULL if there are malloc() errors
+ */
+const Int64Set *Int64Set_create(long capacity, double loadFactor);
+
+/*
+ * now define struct int64set
+ */
+struct int64set {
+/*
+ * the private data of the int64set
+ */
+    void *self;
+
+/*
+ * destroys the int64set; the storage associated with the set is returned
+ * to the heap
+ */
+    void (*destroy)(const Int64Set *is);
+
+/*
+ * clears all members from the set
+ *
+ * upon return, the set will be empty
+ */
+    void (*clear)(const Int64Set *is);
+
+/*
+ * adds `key' to the set if it is not already present
+ *
+ * returns 1 if the key was added, 0 if it was already present (or if the
+ * set could not be resized)
+ */
+    int (*add)(const Int64Set *is, long long key);
+
+/*
+ * returns 1 if the set contains `key', 0 if not
+ */
+    int (*contains)(const Int64Set *is, long long key);
+
+/*
+ * returns 1 if the set is empty, 0 if it is not
+ */
+    int (*isEmpty)(const Int64Set *is);
+
+/*
+ * removes `key' from the set, if present
+ *
+ * returns 1 if successful, 0 if not present
+ */
+    int (*remove)(const Int64Set *is, long long key);
+
+/*
+ * returns the number of members of the set
+ */
+    long (*size)(const Int64Set *is);
+
+/*
+ * return the members of the set as an array of long long in an arbitrary
+ * order
+ *
+ * returns pointer to the array or NULL if error
+ * returns the number of members in the array in `*len'
+ *
+ * NB - the caller is responsible for freeing the array when finished
+ */
+    long long *(*toArray)(const Int64Set *is, long *len);
+
+/*
+ * create generic iterator to this int64set
+ * note that iterator will return pointers to the long long members, which
+ * are only valid until the set is next modified
+ *
+ * returns pointer to the Iterator or NULL if failure
+ */
+    const Iterator *(*itCreate)(const Int64Set *is);
+};
+
+#endif /* _INT64SET_H_ */
@@ -0,0 +1,131 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "int64set.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+int main(int argc, char *argv[]) {
+    const Int64Set *is;
+    const Iterator *it;
+    long long *array, sum;
+    long i, n;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./istest file\n");
+        return -1;
+    }
+    (void) argv;			/* the set is filled with computed keys */
+    if ((is = Int64Set_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating int64set\n");
+        return -1;
+    }
+    /*
+     * test of add()
+     */
+    printf("===== test of add\n");
+    for (i = -10; i <= 10; i++) {
+        if (!is->add(is, (long long)i * 1000000007LL)) {
+            fprintf(stderr, "Error adding %ld to int64set\n", i);
+            return -1;
+        }
+    }
+    printf("Size after add = %ld\n", is->size(is));
+    printf("add of existing member = %d\n", is->add(is, 0LL));
+    /*
+     * test of contains()
+     */
+    printf("===== test of contains\n");
+    for (i = -12; i <= 12; i++)
+        printf("contains(%lld) = %d\n", (long long)i * 1000000007LL,
+               is->contains(is, (long long)i * 1000000007LL));
+    /*
+     * test of toArray
+     */
+    printf("===== test of toArray\n");
+    if ((array = is->toArray(is, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking is->toArray()\n");
+        return -1;
+    }
+    for (i = 0, sum = 0LL; i < n; i++)
+        sum += array[i];
+    printf("toArray returned %ld members, sum = %lld\n", n, sum);
+    free(array);
+    /*
+     * test of iterator
+     */
+    printf("===== test of iterator\n");
+    if ((it = is->itCreate(is)) == NULL) {
+        fprintf(stderr, "Error in creating iterator\n");
+        return -1;
+    }
+    for (n = 0, sum = 0LL; it->hasNext(it); n++) {
+        long long *p;
+        (void) it->next(it, (void **)&p);
+        sum += *p;
+    }
+    it->destroy(it);
+    printf("iterator returned %ld members, sum = %lld\n", n, sum);
+    /*
+     * test of remove
+     */
+    printf("===== test of remove\n");
+    for (i = -10; i <= 10; i += 2) {
+        if (!is->remove(is, (long long)i * 1000000007LL)) {
+            fprintf(stderr, "Error removing %ld from int64set\n", i);
+            return -1;
+        }
+    }
+    printf("Size after remove = %ld\n", is->size(is));
+    printf("remove of non-member = %d\n", is->remove(is, 0LL));
+    for (i = -10, n = 0; i <= 10; i++)
+        n += is->contains(is, (long long)i * 1000000007LL);
+    printf("%ld members remain\n", n);
+    /*
+     * test of many insertions and removals
+     */
+    printf("===== test of growth and removal\n");
+    is->clear(is);
+    printf("Size after clear = %ld, isEmpty = %d\n", is->size(is),
+           is->isEmpty(is));
+    for (i = 0; i < 200000; i++)
+        (void) is->add(is, (long long)(i % 100000) << 20);
+    printf("Size after add = %ld\n", is->size(is));
+    for (i = 0; i < 100000; i += 2)
+        (void) is->remove(is, (long long)i << 20);
+    for (i = 0, n = 0; i < 100000; i++)
+        n += is->contains(is, (long long)i << 20);
+    printf("Size after remove = %ld, %ld members found\n", is->size(is), n);
+    is->destroy(is);
+
+    return 0;
+}
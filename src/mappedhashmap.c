@@ -0,0 +1,684 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"
+#include "hmentry.h"
+#include "hash64.h"
+#include "chainstats.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+/*
+ * implementation of the HashMap interface over a file mapped read-only
+ * into memory, and of HashMap_save(), which writes such files
+ *
+ * the file consists of a header, a table of slots, and the records for
+ * the entries; all references within the file are byte offsets from its
+ * start, so the mapping may be placed at any address
+ *
+ * the slot table is a power of 2 in size and at most half full; each slot
+ * holds the hash64() of its key and the offset of its record (0 if the
+ * slot is empty), and keys are found by linear probing from slot
+ * (hash & (nslots - 1)); a record holds the key length and the value
+ * length, followed by the key and its '\0', then the value, each padded
+ * to a multiple of 8 bytes
+ *
+ * only the header is checked when the file is opened, so that opening
+ * stays O(1); each record is checked to lie within the file before it is
+ * used, and a slot whose record does not is treated as empty, so a corrupt
+ * file loses entries rather than crashing the process
+ */
+
+#define MAGIC "ADTsHM01"
+#define ORDER 0x0102030405060708ULL	/* detects files of other byte order */
+#define MIN_SLOTS 16ULL
+#define BATCH 16	/* keys hashed and prefetched together in getBatch() */
+#define ALIGN(n) (((n) + 7) & ~((unsigned long long)7))
+
+#ifdef __GNUC__
+#define PREFETCH(p) __builtin_prefetch(p)
+#else
+#define PREFETCH(p)
+#endif
+
+typedef struct mhm_header {
+    char magic[8];
+    unsigned long long order;
+    unsigned long long size;		/* number of entries */
+    unsigned long long nslots;		/* always a power of 2 */
+    unsigned long long length;		/* of the file in bytes */
+    unsigned long long unused[3];	/* pads the header to 64 bytes */
+} MhmHeader;
+
+typedef struct mhm_slot {
+    unsigned long long hash;
+    unsigned long long offset;
+} MhmSlot;
+
+typedef struct mhm_record {
+    unsigned long long keylen;
+    unsigned long long vallen;		/* 0 for a NULL element, else bytes + 1 */
+} MhmRecord;
+
+typedef struct mhm_data {
+    char *base;				/* start of the mapping */
+    size_t length;
+    long size;
+    unsigned long long mask;		/* nslots - 1 */
+    unsigned long long records;		/* offset of the first record */
+    MhmSlot *slots;
+    HMEntry scratch;			/* entry returned by scan(), which is */
+					/* why scan() is single-threaded */
+    long hits;				/* maintained if compiled with */
+    long misses;			/* -DHASH_STATS */
+    long probes;
+} MhmData;
+
+#define KEY(r) ((char *)((r) + 1))
+
+/*
+ * local function returning the record of the slot `s', or NULL if the
+ * slot is empty, or its record, with the key and value lengths it holds,
+ * does not lie within the file
+ */
+static MhmRecord *record(MhmData *mhd, MhmSlot *s) {
+    unsigned long long offset = s->offset;
+    unsigned long long length = (unsigned long long)mhd->length;
+    MhmRecord *r;
+
+    if (offset < mhd->records || (offset & 7) != 0 ||
+        offset > length - sizeof(MhmRecord))
+        return NULL;
+    r = (MhmRecord *)(mhd->base + offset);
+    if (r->keylen >= length || r->vallen >= length)	/* no overflow below */
+        return NULL;
+    if (offset + sizeof(MhmRecord) + ALIGN(r->keylen + 1) +
+        (r->vallen ? ALIGN(r->vallen - 1) : 0) > length)
+        return NULL;
+    return (KEY(r)[r->keylen] == '\0') ? r : NULL;
+}
+
+static void *element(MhmRecord *r) {
+    if (r->vallen == 0)
+        return NULL;
+    return KEY(r) + ALIGN(r->keylen + 1);
+}
+
+/*
+ * local function that fills in `e' from the record in slot `s'
+ *
+ * returns 1 if successful, 0 if the slot has no valid record
+ */
+static int fillEntry(MhmData *mhd, MhmSlot *s, HMEntry *e) {
+    MhmRecord *r = record(mhd, s);
+
+    if (r == NULL)
+        return 0;
+    e->next = NULL;
+    e->hash = s->hash;
+    e->keylen = (size_t)r->keylen;
+    e->key = KEY(r);
+    e->element = element(r);
+    return 1;
+}
+
+static void mhm_destroy(const HashMap *hm, void (*freeFxn)(void *element)) {
+    MhmData *mhd = (MhmData *)hm->self;
+
+    (void) freeFxn;		/* the elements belong to the mapping */
+    munmap(mhd->base, mhd->length);
+    free(mhd);
+    free((void *)hm);
+}
+
+static void mhm_clear(const HashMap *hm, void (*freeFxn)(void *element)) {
+    (void) hm;
+    (void) freeFxn;
+}
+
+/*
+ * local function to locate the record for a key, given its hash `h'; any
+ * number of threads may look up at once, so the statistics are counted
+ * with relaxed atomics
+ *
+ * returns pointer to the record, or NULL if the key is not present
+ */
+static MhmRecord *findKey(MhmData *mhd, void *key, size_t len,
+                          unsigned long long h) {
+    unsigned long long i, n;
+    MhmSlot *s;
+    MhmRecord *r = NULL;
+
+    for (i = h & mhd->mask, n = 0; n <= mhd->mask; i = (i + 1) & mhd->mask) {
+        s = &mhd->slots[i];
+        n++;
+        if (s->offset == 0)
+            break;
+        if (s->hash == h) {
+            r = record(mhd, s);
+            if (r != NULL && r->keylen == len &&
+                memcmp(KEY(r), key, len) == 0)
+                break;
+            r = NULL;
+        }
+    }
+    STAT(__atomic_fetch_add(&mhd->probes, (long)n, __ATOMIC_RELAXED));
+    STAT(__atomic_fetch_add((r != NULL) ? &mhd->hits : &mhd->misses, 1L,
+                            __ATOMIC_RELAXED));
+    return r;
+}
+
+static int mhm_containsKeyn(const HashMap *hm, void *key, long len) {
+    MhmData *mhd = (MhmData *)hm->self;
+
+    return (findKey(mhd, key, (size_t)len, hash64(key, (size_t)len)) != NULL);
+}
+
+static int mhm_containsKey(const HashMap *hm, char *key) {
+    return mhm_containsKeyn(hm, key, (long)strlen(key));
+}
+
+/*
+ * local function for generating an array of HMEntry * from the slots;
+ * the HMEntry structures are allocated in the same block of storage,
+ * after the array of pointers, so that free() of the array releases both;
+ * the number of entries, which is less than the size only if the file is
+ * corrupt, is stored in `*len'
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static HMEntry **entries(MhmData *mhd, long *len) {
+    HMEntry **tmp = NULL;
+    long n = 0L;
+    if (mhd->size > 0L) {
+        size_t nbytes = mhd->size * (sizeof(HMEntry *) + sizeof(HMEntry));
+        tmp = (HMEntry **)malloc(nbytes);
+        if (tmp != NULL) {
+            HMEntry *e = (HMEntry *)(tmp + mhd->size);
+            unsigned long long i;
+            for (i = 0; i <= mhd->mask && n < mhd->size; i++) {
+                if (fillEntry(mhd, &mhd->slots[i], &e[n])) {
+                    tmp[n] = &e[n];
+                    n++;
+                }
+            }
+        }
+    }
+    *len = n;
+    return tmp;
+}
+
+static HMEntry **mhm_entryArray(const HashMap *hm, long *len) {
+    MhmData *mhd = (MhmData *)hm->self;
+    long n;
+    HMEntry **tmp = entries(mhd, &n);
+
+    if (tmp != NULL)
+        *len = n;
+    return tmp;
+}
+
+static int mhm_getn(const HashMap *hm, void *key, long len, void **element_) {
+    MhmData *mhd = (MhmData *)hm->self;
+    MhmRecord *r = findKey(mhd, key, (size_t)len, hash64(key, (size_t)len));
+
+    if (r != NULL) {
+        *element_ = element(r);
+        return 1;
+    }
+    return 0;
+}
+
+static int mhm_get(const HashMap *hm, char *key, void **element_) {
+    return mhm_getn(hm, key, (long)strlen(key), element_);
+}
+
+static int mhm_isEmpty(const HashMap *hm) {
+    MhmData *mhd = (MhmData *)hm->self;
+    return (mhd->size == 0L);
+}
+
+/*
+ * local function for generating an array of keys from the slots; the
+ * keys point into the mapping, and their number is stored in `*len'
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static char **keys(MhmData *mhd, long *len) {
+    char **tmp = NULL;
+    long n = 0L;
+    if (mhd->size > 0L) {
+        size_t nbytes = mhd->size * sizeof(char *);
+        tmp = (char **)malloc(nbytes);
+        if (tmp != NULL) {
+            unsigned long long i;
+            MhmRecord *r;
+            for (i = 0; i <= mhd->mask && n < mhd->size; i++)
+                if ((r = record(mhd, &mhd->slots[i])) != NULL)
+                    tmp[n++] = KEY(r);
+        }
+    }
+    *len = n;
+    return tmp;
+}
+
+static char **mhm_keyArray(const HashMap *hm, long *len) {
+    MhmData *mhd = (MhmData *)hm->self;
+    long n;
+    char **tmp = keys(mhd, &n);
+
+    if (tmp != NULL)
+        *len = n;
+    return tmp;
+}
+
+/*
+ * the mapping is read-only, so none of the mutators can succeed
+ */
+static int mhm_putn(const HashMap *hm, void *key, long len, void *element_,
+                    void **previous) {
+    (void) hm;
+    (void) key;
+    (void) len;
+    (void) element_;
+    (void) previous;
+    return 0;
+}
+
+static int mhm_put(const HashMap *hm, char *key, void *element_,
+                   void **previous) {
+    return mhm_putn(hm, key, 0L, element_, previous);
+}
+
+static int mhm_putUnique(const HashMap *hm, char *key, void *element_) {
+    return mhm_putn(hm, key, 0L, element_, NULL);
+}
+
+static int mhm_removen(const HashMap *hm, void *key, long len,
+                       void **element_) {
+    return mhm_putn(hm, key, len, NULL, element_);
+}
+
+static int mhm_remove(const HashMap *hm, char *key, void **element_) {
+    return mhm_putn(hm, key, 0L, NULL, element_);
+}
+
+static int mhm_computeIfAbsent(const HashMap *hm, char *key,
+                               void *(*factory)(char *key, void *ctx),
+                               void *ctx, void **element_) {
+    (void) factory;
+    (void) ctx;
+    return mhm_putn(hm, key, 0L, NULL, element_);
+}
+
+static int mhm_compute(const HashMap *hm, char *key,
+                       int (*fxn)(char *key, void **element, void *ctx),
+                       void *ctx) {
+    (void) fxn;
+    (void) ctx;
+    return mhm_putn(hm, key, 0L, NULL, NULL);
+}
+
+static int mhm_merge(const HashMap *hm, char *key, void *element_,
+                     void *(*mergeFxn)(void *old, void *element)) {
+    (void) mergeFxn;
+    return mhm_putn(hm, key, 0L, element_, NULL);
+}
+
+static int mhm_putWithTTL(const HashMap *hm, char *key, void *element_,
+                          long ttl, void **previous) {
+    (void) ttl;
+    return mhm_putn(hm, key, 0L, element_, previous);
+}
+
+static long mhm_expire(const HashMap *hm, long now, long maxWork) {
+    (void) hm;
+    (void) now;
+    (void) maxWork;
+    return 0L;
+}
+
+static void mhm_setExpiryFxn(const HashMap *hm,
+                             void (*expiryFxn)(char *key, void *element)) {
+    (void) hm;
+    (void) expiryFxn;
+}
+
+static long mhm_size(const HashMap *hm) {
+    MhmData *mhd = (MhmData *)hm->self;
+    return mhd->size;
+}
+
+static const Iterator *mhm_itCreate(const HashMap *hm) {
+    MhmData *mhd = (MhmData *)hm->self;
+    const Iterator *it = NULL;
+    long n;
+    void **tmp = (void **)entries(mhd, &n);
+
+    if (tmp != NULL) {
+        it = Iterator_create(n, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+static long mhm_getBatch(const HashMap *hm, char **keys_, long n,
+                         void **elements, int *found) {
+    MhmData *mhd = (MhmData *)hm->self;
+    size_t lens[BATCH];
+    unsigned long long hashes[BATCH];
+    long i, j, m, ans = 0L;
+
+    for (i = 0L; i < n; i += BATCH) {
+        m = (n - i < BATCH) ? n - i : BATCH;
+        for (j = 0; j < m; j++) {
+            lens[j] = strlen(keys_[i + j]);
+            hashes[j] = hash64(keys_[i + j], lens[j]);
+            PREFETCH(&mhd->slots[hashes[j] & mhd->mask]);
+        }
+        for (j = 0; j < m; j++) {
+            MhmRecord *r = findKey(mhd, keys_[i + j], lens[j], hashes[j]);
+            elements[i + j] = (r != NULL) ? element(r) : NULL;
+            if (found != NULL)
+                found[i + j] = (r != NULL);
+            if (r != NULL)
+                ans++;
+        }
+    }
+    return ans;
+}
+
+static long mhm_putBatch(const HashMap *hm, char **keys_, long n,
+                         void **elements, void **previous) {
+    (void) hm;
+    (void) keys_;
+    (void) n;
+    (void) elements;
+    (void) previous;
+    return 0L;
+}
+
+static int mhm_forEach(const HashMap *hm,
+                       int (*callback)(HMEntry *entry, void *ctx), void *ctx) {
+    MhmData *mhd = (MhmData *)hm->self;
+    HMEntry e;
+    unsigned long long i;
+    int ans;
+
+    for (i = 0; i <= mhd->mask; i++) {
+        if (fillEntry(mhd, &mhd->slots[i], &e) &&
+            (ans = (*callback)(&e, ctx)) != 0)
+            return ans;
+    }
+    return 0;
+}
+
+/*
+ * the cursor is simply the index of the next slot to examine; the entry
+ * returned is the one scratch entry of the hashmap, so only one thread
+ * may scan a mapped hashmap at a time
+ */
+static int mhm_scan(const HashMap *hm, HMCursor *cursor, HMEntry **entry) {
+    MhmData *mhd = (MhmData *)hm->self;
+    long i;
+
+    for (i = cursor->bucket; i <= (long)mhd->mask; i++) {
+        if (fillEntry(mhd, &mhd->slots[i], &mhd->scratch)) {
+            *entry = &mhd->scratch;
+            cursor->bucket = i + 1;
+            return 1;
+        }
+    }
+    cursor->bucket = i;
+    return 0;
+}
+
+static long mhm_trim(const HashMap *hm) {
+    (void) hm;
+    return 0L;
+}
+
+static int mhm_compact(const HashMap *hm) {
+    (void) hm;
+    return 1;
+}
+
+/*
+ * the chain of each entry is the sequence of slots probed to reach it
+ */
+static void mhm_stats(const HashMap *hm, HashStats *hs) {
+    MhmData *mhd = (MhmData *)hm->self;
+    unsigned long long i;
+
+    chainstats_init(hs);
+    hs->size = mhd->size;
+    hs->capacity = (long)(mhd->mask + 1);
+    for (i = 0; i <= mhd->mask; i++)
+        if (record(mhd, &mhd->slots[i]) != NULL)
+            chainstats_add(hs, (long)((i - mhd->slots[i].hash) & mhd->mask) + 1L);
+    chainstats_finish(hs, 0L, 0.0,
+                      __atomic_load_n(&mhd->hits, __ATOMIC_RELAXED),
+                      __atomic_load_n(&mhd->misses, __ATOMIC_RELAXED),
+                      __atomic_load_n(&mhd->probes, __ATOMIC_RELAXED));
+}
+
+static HashMap template = {
+    NULL, mhm_destroy, mhm_clear, mhm_containsKey, mhm_entryArray, mhm_get,
+    mhm_isEmpty, mhm_keyArray, mhm_put, mhm_putUnique, mhm_remove, mhm_size,
+    mhm_itCreate, mhm_containsKeyn, mhm_getn, mhm_putn, mhm_removen,
+    mhm_getBatch, mhm_putBatch, mhm_forEach, mhm_scan, mhm_trim,
+    mhm_compact, mhm_stats, mhm_computeIfAbsent, mhm_compute, mhm_merge,
+    mhm_putWithTTL, mhm_expire, mhm_setExpiryFxn
+};
+
+/*
+ * local function that returns the number of bytes of `element' to save
+ */
+static unsigned long long valueSize(void *element_,
+                                    long (*sizeFxn)(void *element)) {
+    if (element_ == NULL)
+        return 0;
+    if (sizeFxn != NULL)
+        return (unsigned long long)(*sizeFxn)(element_) + 1;
+    return (unsigned long long)strlen((char *)element_) + 2;
+}
+
+/*
+ * local function that writes `n' bytes of `p', followed by enough '\0's
+ * to pad them to a multiple of 8 bytes
+ *
+ * returns 1 if successful, 0 if there was an I/O error
+ */
+static int writePadded(FILE *fd, void *p, unsigned long long n) {
+    static char zeros[8] = {0, 0, 0, 0, 0, 0, 0, 0};
+    size_t pad = (size_t)(ALIGN(n) - n);
+
+    if (n > 0 && fwrite(p, 1, (size_t)n, fd) != (size_t)n)
+        return 0;
+    return (pad == 0 || fwrite(zeros, 1, pad, fd) == pad);
+}
+
+/*
+ * local function that writes the header, the slots, and then the records
+ * of `hm' in the order in which they were assigned their offsets
+ *
+ * returns 1 if successful, 0 if there was an I/O error
+ */
+static int writeFile(FILE *fd, const HashMap *hm, MhmHeader *header,
+                     MhmSlot *slots, long (*sizeFxn)(void *element)) {
+    HMCursor cursor = HMCURSOR_INIT;
+    HMEntry *e;
+    MhmRecord r;
+
+    if (fwrite(header, sizeof(MhmHeader), 1, fd) != 1)
+        return 0;
+    if (fwrite(slots, sizeof(MhmSlot), (size_t)header->nslots, fd) !=
+        (size_t)header->nslots)
+        return 0;
+    while (hm->scan(hm, &cursor, &e)) {
+        r.keylen = e->keylen;
+        r.vallen = valueSize(e->element, sizeFxn);
+        if (fwrite(&r, sizeof(MhmRecord), 1, fd) != 1)
+            return 0;
+        if (!writePadded(fd, e->key, r.keylen + 1))	/* key[keylen] == '\0' */
+            return 0;
+        if (r.vallen > 0 && !writePadded(fd, e->element, r.vallen - 1))
+            return 0;
+    }
+    return (fflush(fd) == 0);
+}
+
+int HashMap_save(const HashMap *hm, char *path,
+                 long (*sizeFxn)(void *element)) {
+    HMCursor cursor = HMCURSOR_INIT;
+    HMEntry *e;
+    MhmHeader header;
+    MhmSlot *slots;
+    unsigned long long n, mask, i, offset, vallen;
+    char *tmp;
+    FILE *fd;
+    int ans = 0;
+
+    n = (unsigned long long)hm->size(hm);
+    for (i = MIN_SLOTS; i < 2 * n; i *= 2)
+        ;
+    mask = i - 1;
+    if ((slots = (MhmSlot *)calloc((size_t)i, sizeof(MhmSlot))) == NULL)
+        return 0;
+    offset = sizeof(MhmHeader) + i * sizeof(MhmSlot);
+    while (hm->scan(hm, &cursor, &e)) {
+        for (i = e->hash & mask; slots[i].offset != 0; i = (i + 1) & mask)
+            ;
+        slots[i].hash = e->hash;
+        slots[i].offset = offset;
+        vallen = valueSize(e->element, sizeFxn);
+        offset += sizeof(MhmRecord) + ALIGN(e->keylen + 1) +
+                  (vallen ? ALIGN(vallen - 1) : 0);
+    }
+    memset(&header, 0, sizeof(MhmHeader));
+    memcpy(header.magic, MAGIC, sizeof(header.magic));
+    header.order = ORDER;
+    header.size = n;
+    header.nslots = mask + 1;
+    header.length = offset;
+    if ((tmp = (char *)malloc(strlen(path) + 5)) != NULL) {
+        sprintf(tmp, "%s.tmp", path);
+        if ((fd = fopen(tmp, "wb")) != NULL) {
+            ans = writeFile(fd, hm, &header, slots, sizeFxn);
+            if (fclose(fd) != 0)
+                ans = 0;
+            if (ans)
+                ans = (rename(tmp, path) == 0);
+            if (!ans)
+                remove(tmp);
+        }
+        free(tmp);
+    }
+    free(slots);
+    return ans;
+}
+
+/*
+ * local function that maps the file `path' read-only, setting `*length'
+ * to its size
+ *
+ * returns the address of the mapping, or NULL if it could not be mapped
+ */
+static char *mapFile(char *path, size_t *length) {
+    struct stat st;
+    void *p = MAP_FAILED;
+    int fd;
+
+    if ((fd = open(path, O_RDONLY)) < 0)
+        return NULL;
+    if (fstat(fd, &st) == 0 && st.st_size >= (off_t)sizeof(MhmHeader)) {
+        *length = (size_t)st.st_size;
+        p = mmap(NULL, *length, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    return (p == MAP_FAILED) ? NULL : (char *)p;
+}
+
+/*
+ * local function that checks that the `length' bytes at `base' start with
+ * a header written by HashMap_save() on a machine of the same byte order
+ */
+static int validHeader(char *base, size_t length) {
+    MhmHeader *h = (MhmHeader *)base;
+
+    return (memcmp(h->magic, MAGIC, sizeof(h->magic)) == 0 &&
+            h->order == ORDER && h->length == (unsigned long long)length &&
+            h->nslots >= MIN_SLOTS && (h->nslots & (h->nslots - 1)) == 0 &&
+            h->size < h->nslots &&
+            h->nslots <= (h->length - sizeof(MhmHeader)) / sizeof(MhmSlot));
+}
+
+const HashMap *HashMap_openMapped(char *path) {
+    HashMap *hm = (HashMap *)malloc(sizeof(HashMap));
+    size_t length;
+    char *base;
+
+    if (hm != NULL) {
+        MhmData *mhd = (MhmData *)malloc(sizeof(MhmData));
+
+        if (mhd != NULL) {
+            if ((base = mapFile(path, &length)) != NULL &&
+                validHeader(base, length)) {
+                MhmHeader *h = (MhmHeader *)base;
+                mhd->base = base;
+                mhd->length = length;
+                mhd->size = (long)h->size;
+                mhd->mask = h->nslots - 1;
+                mhd->records = sizeof(MhmHeader) + h->nslots * sizeof(MhmSlot);
+                mhd->slots = (MhmSlot *)(base + sizeof(MhmHeader));
+                mhd->hits = mhd->misses = mhd->probes = 0L;
+                *hm = template;
+                hm->self = mhd;
+            } else {
+                if (base != NULL)
+                    munmap(base, length);
+                free(mhd);
+                free(hm);
+                hm = NULL;
+            }
+        } else {
+            free(hm);
+            hm = NULL;
+        }
+    }
+    return hm;
+}
@@ -0,0 +1,310 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "hashmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+static long longSize(void *element) {
+    (void) element;
+    return (long)sizeof(long);
+}
+
+static int countEntries(HMEntry *entry, void *ctx) {
+    (void) entry;
+    (*(long *)ctx)++;
+    return 0;
+}
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char key[32];
+    char path[64];
+    char *p;
+    const HashMap *hm, *mhm;
+    const Iterator *it;
+    HMCursor cursor = HMCURSOR_INIT;
+    HMEntry *entry, **entries;
+    long i, n, values[3];
+    FILE *fd;
+    char **keys;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./mhmtest file\n");
+        return -1;
+    }
+    sprintf(path, "/tmp/mhmtest.%ld", (long)getpid());
+    if ((hm = HashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of strings\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!hm->put(hm, key, p, (void**)&prev)) {
+            fprintf(stderr, "Error adding key,string to hashmap\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    /*
+     * test of HashMap_save() and HashMap_openMapped()
+     */
+    printf("===== test of HashMap_save and HashMap_openMapped\n");
+    if (!HashMap_save(hm, path, NULL)) {
+        fprintf(stderr, "Error saving hashmap to %s\n", path);
+        return -1;
+    }
+    hm->destroy(hm, free);
+    if ((mhm = HashMap_openMapped(path)) == NULL) {
+        fprintf(stderr, "Error mapping %s\n", path);
+        return -1;
+    }
+    n = mhm->size(mhm);
+    printf("Size of mapped hashmap = %ld, isEmpty = %d\n", n, mhm->isEmpty(mhm));
+    /*
+     * test of get()
+     */
+    printf("===== test of get\n");
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        sprintf(key, "%ld", i);
+        if (!mhm->get(mhm, key, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%s,%s", key, element);
+    }
+    for (i = n, n = 0; i < 10000; i++) {
+        sprintf(key, "%ld", i);
+        n += mhm->containsKey(mhm, key);
+    }
+    printf("containsKey found %ld absent keys\n", n);
+    /*
+     * test that the mutators fail
+     */
+    printf("===== test of mutators\n");
+    printf("put = %d, ", mhm->put(mhm, "0", "x", (void **)&p));
+    printf("putUnique = %d, ", mhm->putUnique(mhm, "x", "x"));
+    printf("remove = %d, ", mhm->remove(mhm, "0", (void **)&p));
+    printf("removen = %d\n", mhm->removen(mhm, "0", 1L, (void **)&p));
+    printf("computeIfAbsent = %d, ",
+           mhm->computeIfAbsent(mhm, "x", NULL, NULL, (void **)&p));
+    printf("compute = %d, ", mhm->compute(mhm, "0", NULL, NULL));
+    printf("merge = %d\n", mhm->merge(mhm, "0", "x", NULL));
+    printf("putWithTTL = %d, ",
+           mhm->putWithTTL(mhm, "x", "x", 10L, (void **)&p));
+    printf("expire = %ld\n", mhm->expire(mhm, 100L, 0L));
+    mhm->clear(mhm, free);
+    printf("Size after clear = %ld\n", mhm->size(mhm));
+    /*
+     * test of keyArray, entryArray, iterator, forEach and scan
+     */
+    printf("===== test of keyArray, entryArray, it, forEach and scan\n");
+    if ((keys = mhm->keyArray(mhm, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking mhm->keyArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++)
+        if (!mhm->containsKey(mhm, keys[i]))
+            break;
+    printf("keyArray returned %ld keys, %ld present\n", n, i);
+    free(keys);
+    if ((entries = mhm->entryArray(mhm, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking mhm->entryArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        mhm->get(mhm, hmentry_key(entries[i]), (void **)&p);
+        if (p != hmentry_value(entries[i]))
+            break;
+    }
+    printf("entryArray returned %ld entries, %ld match\n", n, i);
+    free(entries);
+    if ((it = mhm->itCreate(mhm)) == NULL) {
+        fprintf(stderr, "Error in creating iterator\n");
+        return -1;
+    }
+    for (n = 0; it->hasNext(it); n++)
+        (void) it->next(it, (void **)&entry);
+    it->destroy(it);
+    printf("iterator returned %ld entries\n", n);
+    n = 0;
+    (void) mhm->forEach(mhm, countEntries, &n);
+    printf("forEach visited %ld entries\n", n);
+    for (n = 0; mhm->scan(mhm, &cursor, &entry); n++)
+        ;
+    printf("scan returned %ld entries\n", n);
+    mhm->destroy(mhm, free);
+    /*
+     * test of binary keys, non-string elements and NULL elements
+     */
+    printf("===== test of binary keys and sizeFxn\n");
+    if ((hm = HashMap_createFlat(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating flat hashmap\n");
+        return -1;
+    }
+    values[0] = 17L;
+    values[1] = -1L;
+    (void) hm->putn(hm, "a\0b", 3L, &values[0], (void **)&p);
+    (void) hm->putn(hm, "a\0c", 3L, &values[1], (void **)&p);
+    (void) hm->putn(hm, "", 0L, NULL, (void **)&p);
+    if (!HashMap_save(hm, path, longSize)) {
+        fprintf(stderr, "Error saving hashmap to %s\n", path);
+        return -1;
+    }
+    hm->destroy(hm, NULL);
+    if ((mhm = HashMap_openMapped(path)) == NULL) {
+        fprintf(stderr, "Error mapping %s\n", path);
+        return -1;
+    }
+    if (mhm->getn(mhm, "a\0b", 3L, (void **)&p))
+        printf("a\\0b -> %ld\n", *(long *)p);
+    if (mhm->getn(mhm, "a\0c", 3L, (void **)&p))
+        printf("a\\0c -> %ld\n", *(long *)p);
+    if (mhm->getn(mhm, "", 0L, (void **)&p))
+        printf("\"\" -> %s\n", (p == NULL) ? "NULL" : "not NULL");
+    printf("containsKeyn(\"a\", 1) = %d\n", mhm->containsKeyn(mhm, "a", 1L));
+    mhm->destroy(mhm, NULL);
+    /*
+     * test of a corrupt file: the first occupied slot is given an offset
+     * beyond the end of the file, and the record of the second a key
+     * length that runs past it; the header is 64 bytes, and is followed
+     * by 16 slots of 16 bytes, each a hash and an offset
+     */
+    printf("===== test of corrupt files\n");
+    if ((fd = fopen(path, "r+b")) == NULL) {
+        fprintf(stderr, "Error opening %s for update\n", path);
+        return -1;
+    }
+    for (i = 0, n = 0; i < 16 && n < 2; i++) {
+        unsigned long long slot[2], huge = 1ULL << 40;
+
+        if (fseek(fd, 64L + 16L * i, SEEK_SET) != 0 ||
+            fread(slot, sizeof(slot[0]), 2, fd) != 2) {
+            fprintf(stderr, "Error reading slot %ld of %s\n", i, path);
+            return -1;
+        }
+        if (slot[1] == 0)
+            continue;
+        if (n++ == 0)
+            (void) fseek(fd, 64L + 16L * i + 8L, SEEK_SET);
+        else
+            (void) fseek(fd, (long)slot[1], SEEK_SET);
+        if (fwrite(&huge, sizeof(huge), 1, fd) != 1) {
+            fprintf(stderr, "Error corrupting %s\n", path);
+            return -1;
+        }
+    }
+    fclose(fd);
+    if ((mhm = HashMap_openMapped(path)) == NULL) {
+        fprintf(stderr, "Error mapping %s\n", path);
+        return -1;
+    }
+    n = mhm->getn(mhm, "a\0b", 3L, (void **)&p) +
+        mhm->getn(mhm, "a\0c", 3L, (void **)&p) +
+        mhm->getn(mhm, "", 0L, (void **)&p);
+    printf("keys found = %ld of %ld\n", n, mhm->size(mhm));
+    n = 0L;
+    (void) mhm->forEach(mhm, countEntries, &n);
+    printf("forEach() visited %ld, ", n);
+    {
+        HMCursor start = HMCURSOR_INIT;
+
+        cursor = start;
+        for (n = 0L; mhm->scan(mhm, &cursor, &entry); n++)
+            ;
+    }
+    printf("scan() returned %ld, ", n);
+    if ((keys = mhm->keyArray(mhm, &n)) == NULL) {
+        fprintf(stderr, "Error in keyArray()\n");
+        return -1;
+    }
+    printf("keyArray() length = %ld\n", n);
+    free(keys);
+    mhm->destroy(mhm, NULL);
+    /*
+     * a header claiming 2^60 slots in an 80-byte file; the size of the
+     * slot array wraps around if it is computed by multiplying
+     */
+    {
+        unsigned long long header[10];
+
+        if ((fd = fopen(path, "rb")) == NULL ||
+            fread(header, sizeof(header[0]), 8, fd) != 8) {
+            fprintf(stderr, "Error reading header of %s\n", path);
+            return -1;
+        }
+        fclose(fd);
+        header[2] = 0ULL;		/* size */
+        header[3] = 1ULL << 60;		/* nslots */
+        header[4] = sizeof(header);	/* length */
+        header[8] = header[9] = 0ULL;
+        if ((fd = fopen(path, "wb")) == NULL ||
+            fwrite(header, sizeof(header), 1, fd) != 1) {
+            fprintf(stderr, "Error writing header to %s\n", path);
+            return -1;
+        }
+        fclose(fd);
+    }
+    mhm = HashMap_openMapped(path);
+    printf("openMapped of 80 bytes claiming 2^60 slots = %s",
+           (mhm == NULL) ? "NULL" : "not NULL");
+    if (mhm != NULL) {
+        printf(", get() = %d", mhm->get(mhm, "a", (void **)&p));
+        mhm->destroy(mhm, NULL);
+    }
+    printf("\n");
+    /*
+     * test of files that cannot be mapped
+     */
+    printf("===== test of invalid files\n");
+    printf("openMapped(%s) = %s\n", argv[1],
+           (HashMap_openMapped(argv[1]) == NULL) ? "NULL" : "not NULL");
+    unlink(path);
+    printf("openMapped of missing file = %s\n",
+           (HashMap_openMapped(path) == NULL) ? "NULL" : "not NULL");
+
+    return 0;
+}
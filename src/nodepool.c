@@ -0,0 +1,212 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "nodepool.h"
+#include <stdlib.h>
+
+#define SLAB_SIZE 65536		/* bytes per slab, which is also its alignment */
+#define GRAIN 8			/* node sizes are rounded up to a multiple */
+#define NCLASSES (NODEPOOL_MAX / GRAIN)
+#define CLASS(n) (((n) + GRAIN - 1) / GRAIN - 1)
+#define ALIGN(n) (((n) + GRAIN - 1) & ~((size_t)GRAIN - 1))
+
+/*
+ * header at the start of each slab; since slabs are aligned to their size,
+ * the slab holding a node is found by masking the node's address
+ */
+typedef struct pslab {
+    struct pslab *next;		/* all slabs of the pool are on a doubly */
+    struct pslab *prev;		/* linked list, so any one may be removed */
+    long live;			/* nodes allocated and not yet freed */
+    size_t used;		/* bytes of the slab carved into nodes */
+} PSlab;
+
+#define SLAB_OF(p) ((PSlab *)((size_t)(p) & ~((size_t)SLAB_SIZE - 1)))
+
+typedef struct pnode {
+    struct pnode *next;
+} PNode;
+
+struct nodepool {
+    PNode *freel[NCLASSES];	/* free nodes of each size class */
+    PSlab *current[NCLASSES];	/* slab from which new nodes are carved */
+    PSlab *slabs;
+};
+
+NodePool *NodePool_create(void) {
+    NodePool *np = (NodePool *)malloc(sizeof(NodePool));
+
+    if (np != NULL) {
+        int i;
+        for (i = 0; i < NCLASSES; i++) {
+            np->freel[i] = NULL;
+            np->current[i] = NULL;
+        }
+        np->slabs = NULL;
+    }
+    return np;
+}
+
+void nodepool_destroy(NodePool *np) {
+    PSlab *s, *t;
+
+    if (np == NULL)
+        return;
+    for (s = np->slabs; s != NULL; s = t) {
+        t = s->next;
+        free(s);
+    }
+    free(np);
+}
+
+/*
+ * local function that obtains a new slab and links it onto the pool
+ *
+ * returns pointer to the slab, or NULL if malloc failure
+ */
+static PSlab *newSlab(NodePool *np) {
+    void *p;
+    PSlab *s;
+
+    if (posix_memalign(&p, SLAB_SIZE, SLAB_SIZE) != 0)
+        return NULL;
+    s = (PSlab *)p;
+    s->live = 0L;
+    s->used = ALIGN(sizeof(PSlab));
+    s->prev = NULL;
+    s->next = np->slabs;
+    if (np->slabs != NULL)
+        np->slabs->prev = s;
+    np->slabs = s;
+    return s;
+}
+
+void *nodepool_alloc(NodePool *np, size_t nbytes) {
+    PNode *p;
+    PSlab *s;
+    int c;
+
+    if (np == NULL || nbytes > NODEPOOL_MAX)
+        return malloc(nbytes);
+    c = CLASS(nbytes);
+    if ((p = np->freel[c]) != NULL) {
+        np->freel[c] = p->next;
+        SLAB_OF(p)->live++;
+        return p;
+    }
+    nbytes = ALIGN(nbytes);
+    s = np->current[c];
+    if (s == NULL || s->used + nbytes > SLAB_SIZE) {
+        if ((s = newSlab(np)) == NULL)
+            return NULL;
+        np->current[c] = s;
+    }
+    p = (PNode *)((char *)s + s->used);
+    s->used += nbytes;
+    s->live++;
+    return p;
+}
+
+void nodepool_free(NodePool *np, void *p, size_t nbytes) {
+    PNode *q = (PNode *)p;
+    int c;
+
+    if (np == NULL || nbytes > NODEPOOL_MAX) {
+        free(p);
+        return;
+    }
+    c = CLASS(nbytes);
+    SLAB_OF(q)->live--;
+    q->next = np->freel[c];
+    np->freel[c] = q;
+}
+
+void nodepool_absorb(NodePool *np, NodePool *other) {
+    PSlab *s;
+    PNode *p;
+    int c;
+
+    if (other == NULL)
+        return;
+    for (c = 0; c < NCLASSES; c++) {
+        if ((p = other->freel[c]) != NULL) {
+            while (p->next != NULL)
+                p = p->next;
+            p->next = np->freel[c];
+            np->freel[c] = other->freel[c];
+        }
+        if (np->current[c] == NULL)
+            np->current[c] = other->current[c];
+    }
+    if ((s = other->slabs) != NULL) {
+        while (s->next != NULL)
+            s = s->next;
+        s->next = np->slabs;
+        if (np->slabs != NULL)
+            np->slabs->prev = s;
+        np->slabs = other->slabs;
+    }
+    free(other);
+}
+
+long nodepool_trim(NodePool *np) {
+    PSlab *s, *t;
+    PNode **pp;
+    long ans = 0L;
+    int c;
+
+    if (np == NULL)
+        return 0L;
+    for (c = 0; c < NCLASSES; c++) {
+        for (pp = &np->freel[c]; *pp != NULL; ) {
+            if (SLAB_OF(*pp)->live == 0L)
+                *pp = (*pp)->next;
+            else
+                pp = &(*pp)->next;
+        }
+        if (np->current[c] != NULL && np->current[c]->live == 0L)
+            np->current[c] = NULL;
+    }
+    for (s = np->slabs; s != NULL; s = t) {
+        t = s->next;
+        if (s->live == 0L) {
+            if (s->prev != NULL)
+                s->prev->next = s->next;
+            else
+                np->slabs = s->next;
+            if (s->next != NULL)
+                s->next->prev = s->prev;
+            free(s);
+            ans += SLAB_SIZE;
+        }
+    }
+    return ans;
+}
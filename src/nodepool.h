@@ -0,0 +1,102 @@
+#ifndef _NODEPOOL_H_
+#define _NODEPOOL_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <stddef.h>
+
+/*
+ * private slab allocator for the chain nodes of the hash-based ADTs; it is
+ * not installed with the public headers
+ *
+ * nodes are carved from 64 KiB slabs, one size class per multiple of 8
+ * bytes up to NODEPOOL_MAX, and freed nodes are kept on a free list per
+ * size class for reuse by the same container; each slab counts its live
+ * nodes, so that slabs whose nodes are all free can be returned to the
+ * heap by nodepool_trim()
+ *
+ * nodes larger than NODEPOOL_MAX are obtained directly from malloc()
+ *
+ * a pool is not synchronized; it belongs to a single container
+ *
+ * a slab is only worthwhile for a container that holds many nodes, so a
+ * container that is not asked to pool its nodes uses a NULL pool: every
+ * function below accepts one, nodepool_alloc() and nodepool_free() then
+ * calling malloc() and free() directly
+ */
+
+#define NODEPOOL_MAX 256
+
+typedef struct nodepool NodePool;
+
+/*
+ * creates an empty pool
+ *
+ * returns a pointer to the pool, or NULL if there are malloc() errors
+ */
+NodePool *NodePool_create(void);
+
+/*
+ * returns all of the pool's slabs, including nodes still in use, to the heap
+ */
+void nodepool_destroy(NodePool *np);
+
+/*
+ * returns a node of (at least) `nbytes' bytes, aligned to 8 bytes
+ *
+ * returns pointer to the node, or NULL if malloc failure
+ */
+void *nodepool_alloc(NodePool *np, size_t nbytes);
+
+/*
+ * returns the node `p', which was obtained from nodepool_alloc(np, nbytes),
+ * to the pool
+ */
+void nodepool_free(NodePool *np, void *p, size_t nbytes);
+
+/*
+ * moves the slabs and free nodes of `other' into `np', and destroys
+ * `other'; nodes obtained from `other' are then freed to `np'
+ *
+ * this lets threads filling one container each allocate from a pool of
+ * their own; if `other' is NULL, nothing is done
+ */
+void nodepool_absorb(NodePool *np, NodePool *other);
+
+/*
+ * returns each slab none of whose nodes are in use to the heap
+ *
+ * returns the number of bytes returned, 0 for a NULL pool
+ */
+long nodepool_trim(NodePool *np);
+
+#endif /* _NODEPOOL_H_ */
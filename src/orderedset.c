@@ -39,8 +39,9 @@
 
 typedef struct tnode {
     struct tnode *link[2];	/* 0 is left, 1 is right */
+    struct tnode *parent;	/* NULL for the root */
     void *element;
-    int balance;		/* difference between heights of l and r subs */
+    int balance;		/* difference between heights of r and l subs */
 } TNode;
 
 typedef struct os_data {
@@ -50,196 +51,234 @@ typedef struct os_data {
 } OsData;
 
 /*
- * structure needed for recursive population of array of pointers
+ * the tree is updated and traversed without recursion: the parent links
+ * let insertion and removal retrace the path to the root to restore the
+ * balance, and let a cursor step to the next or previous node in place
  */
-typedef struct popstruct {
-    void **a;
-    long len;
-} PopStruct;
 
 /*
- * routines used in rotations when rebalancing the tree
- */
-
-/*
- * allocates a new node with the given element and NULL left and right links
+ * allocates a new node with the given element and NULL links
  */
 static TNode *newNode(void *element) {
     TNode *node = (TNode *)malloc(sizeof(TNode));
 
     if (node != NULL) {
         node->element = element;
-        node->link[0] = node->link[1] = NULL;
+        node->link[0] = node->link[1] = node->parent = NULL;
         node->balance = 0;
     }
     return node;
 }
 
-static TNode *singleRotate(TNode *root, int dir) {
-    TNode *save = root->link[!dir];
+/*
+ * replaces `old' by `new' as the child of old's parent, or as the root
+ */
+static void replaceChild(OsData *osd, TNode *old, TNode *new) {
+    TNode *p = old->parent;
 
-    root->link[!dir] = save->link[dir];
-    save->link[dir] = root;
-    return save;
+    if (p == NULL)
+        osd->root = new;
+    else
+        p->link[p->link[1] == old] = new;
+    if (new != NULL)
+        new->parent = p;
 }
 
-static TNode *doubleRotate(TNode *root, int dir) {
-    TNode *save = root->link[!dir]->link[dir];
+/*
+ * rotates the subtree rooted at `root' in direction `dir' (0 is left),
+ * so that its child link[!dir] takes its place
+ *
+ * returns the new root of the subtree
+ */
+static TNode *rotate(OsData *osd, TNode *root, int dir) {
+    TNode *save = root->link[!dir];
 
-    root->link[!dir]->link[dir] = save->link[!dir];
-    save->link[!dir] = root->link[!dir];
-    root->link[!dir] = save;
-    save = root->link[!dir];
     root->link[!dir] = save->link[dir];
+    if (save->link[dir] != NULL)
+        save->link[dir]->parent = root;
+    replaceChild(osd, root, save);
     save->link[dir] = root;
+    root->parent = save;
     return save;
 }
 
-static void adjustBalance(TNode *root, int dir, int bal) {
+/*
+ * restores the balance of `root', whose balance is +2 or -2, with a
+ * single or double rotation; `*shorter' is set to 1 if the subtree is
+ * then lower than it was before the insertion or removal that unbalanced
+ * it, which is always so after an insertion
+ *
+ * returns the new root of the subtree
+ */
+static TNode *rebalance(OsData *osd, TNode *root, int *shorter) {
+    int dir = (root->balance > 0);		/* the heavy side */
+    int bal = dir ? +1 : -1;
     TNode *n = root->link[dir];
-    TNode *nn = n->link[!dir];
 
-    if (nn->balance == 0)
+    if (n->balance == -bal) {		/* double rotation */
+        TNode *nn = n->link[!dir];
+
+        (void) rotate(osd, n, dir);
+        (void) rotate(osd, root, !dir);
+        if (nn->balance == bal) {
+            root->balance = -bal;
+            n->balance = 0;
+        } else if (nn->balance == -bal) {
+            root->balance = 0;
+            n->balance = bal;
+        } else
+            root->balance = n->balance = 0;
+        nn->balance = 0;
+        *shorter = 1;
+        return nn;
+    }
+    (void) rotate(osd, root, !dir);
+    if (n->balance == 0) {		/* only after a removal */
+        root->balance = bal;
+        n->balance = -bal;
+        *shorter = 0;
+    } else {
         root->balance = n->balance = 0;
-    else if (nn->balance == bal) {
-        root->balance = -bal;
-        n->balance = 0;
-    } else {	/* nn->balance == -bal */
-        root->balance = 0;
-        n->balance = bal;
+        *shorter = 1;
     }
-    nn->balance = 0;
+    return n;
 }
 
-static TNode *insertBalance(TNode *root, int dir) {
-    TNode *n = root->link[dir];
-    int bal = (dir == 0) ? -1 : +1;
+/*
+ * local function that retraces the path from the new leaf `node' to the
+ * root after an insertion, stopping once a subtree keeps its height
+ */
+static void insertRetrace(OsData *osd, TNode *node) {
+    TNode *p;
+    int shorter;
 
-    if (n->balance == bal) {
-        root->balance = n->balance = 0;
-        root = singleRotate(root, !dir);
-    } else {	/* n->balance == -bal */
-        adjustBalance(root, dir, bal);
-        root = doubleRotate(root, !dir);
-    }
-    return root;
-}
-
-static TNode *insert(TNode *root, void *element, int *done,
-                     int (*cmp)(void*,void*)) {
-    if (root == NULL)
-        root = newNode(element);
-    else {
-        int dir = ((*cmp)(root->element, element) < 0);
-
-        root->link[dir] = insert(root->link[dir], element, done, cmp);
-        if (! *done) {
-            root->balance += (dir == 0) ? -1 : +1;
-            if (root->balance == 0)
-                *done = 1;
-            else if (abs(root->balance) > 1) {
-                root = insertBalance(root, dir);
-                *done = 1;
-            }
+    for (p = node->parent; p != NULL; node = p, p = p->parent) {
+        p->balance += (p->link[1] == node) ? +1 : -1;
+        if (p->balance == 0)
+            break;
+        if (p->balance == 2 || p->balance == -2) {
+            (void) rebalance(osd, p, &shorter);
+            break;
         }
     }
-    return root;
 }
 
-static TNode *removeBalance(TNode *root, int dir, int *done) {
-    TNode *n = root->link[!dir];
-    int bal = (dir == 0) ? -1 : +1;
-
-    if (n->balance == -bal) {
-        root->balance = n->balance = 0;
-        root = singleRotate(root, dir);
-    } else if (n->balance == bal) {
-        adjustBalance(root, !dir, -bal);
-        root = doubleRotate(root, dir);
-    } else {	/* n->balance == 0 */
-        root->balance = -bal;
-        n->balance = bal;
-        root = singleRotate(root, dir);
-        *done = 1;
+/*
+ * local function that unlinks `node', which has at most one child, and
+ * retraces the path to the root, stopping once a subtree keeps its height
+ */
+static void unlinkNode(OsData *osd, TNode *node) {
+    TNode *p = node->parent;
+    TNode *child = node->link[node->link[0] == NULL];
+    int dir = (p != NULL && p->link[1] == node);
+    int shorter;
+
+    replaceChild(osd, node, child);
+    while (p != NULL) {
+        p->balance += dir ? -1 : +1;
+        if (p->balance == 1 || p->balance == -1)
+            break;			/* height unchanged */
+        if (p->balance != 0) {
+            p = rebalance(osd, p, &shorter);
+            if (! shorter)
+                break;
+        }
+        node = p;
+        p = node->parent;
+        dir = (p != NULL && p->link[1] == node);
     }
-    return root;
 }
 
-static TNode *remove(TNode *root, void *element, int *done,
-                     int (*cmp)(void*,void*), void (*uf)(void*)) {
-    if (root != NULL) {
-        int dir;
+/*
+ * find node with minimum value in subtree
+ */
+static TNode *findMin(TNode *tree) {
+    if (tree != NULL)
+        while (tree->link[0] != NULL)
+            tree = tree->link[0];
+    return tree;
+}
 
-        if ((*cmp)(element, root->element) == 0) {
-            if (root->link[0] == NULL || root->link[1] == NULL) {
-                TNode *save;
+/*
+ * find node with maximum value in subtree
+ */
+static TNode *findMax(TNode *tree) {
+    if (tree != NULL)
+        while (tree->link[1] != NULL)
+            tree = tree->link[1];
+    return tree;
+}
 
-                dir = (root->link[0] == NULL);
-                save = root->link[dir];
-                if (uf != NULL)
-                    (*uf)(root->element);
-                free(root);
-                return save;
-            } else {
-                TNode *heir = root->link[0];
+/*
+ * returns the node after (dir == 1) or before (dir == 0) `node' in order,
+ * or NULL if there is none; stepping through the whole tree this way
+ * follows each link twice, so each step is O(1) amortized
+ */
+static TNode *step(TNode *node, int dir) {
+    TNode *p;
 
-                while (heir->link[1] != NULL)
-                    heir = heir->link[1];
-                root->element = heir->element;
-                element = heir->element;
-            }
-        }
-        dir = ((*cmp)(root->element, element) < 0);
-        root->link[dir] = remove(root->link[dir], element, done, cmp, uf);
-        if (! *done) {
-            root->balance += (dir != 0) ? -1 : +1;
-            if (abs(root->balance) == 1)
-                *done = 1;
-            else if (abs(root->balance) > 1)
-                root = removeBalance(root, dir, done);
-        }
+    if (node->link[dir] != NULL) {
+        for (node = node->link[dir]; node->link[!dir] != NULL; )
+            node = node->link[!dir];
+        return node;
     }
-    return root;
+    for (p = node->parent; p != NULL && p->link[dir] == node; p = p->parent)
+        node = p;
+    return p;
 }
 
 /*
- * finds element in the set; returns null if it cannot be found
+ * local function that removes `node' from the tree and frees it; a node
+ * with two children takes the element of its successor, which is removed
+ * in its place
  */
-static TNode *find(void *element, TNode *tree, int (*cmp)(void*,void*)) {
-    int result;
+static void removeNode(OsData *osd, TNode *node) {
+    if (node->link[0] != NULL && node->link[1] != NULL) {
+        TNode *heir = findMin(node->link[1]);
 
-    if (tree == NULL)
-        return NULL;
-    result = (*cmp)(element, tree->element);
-    if (result < 0)
-        return find(element, tree->link[0], cmp);
-    else if (result > 0)
-        return find(element, tree->link[1], cmp);
-    else
-        return tree;
+        node->element = heir->element;
+        node = heir;
+    }
+    unlinkNode(osd, node);
+    free(node);
+    osd->size--;
 }
 
 /*
- * infix traversal to populate array of pointers
+ * finds element in the set; returns null if it cannot be found
  */
-static void populate(PopStruct *ps, TNode *node) {
-    if (node != NULL) {
-        populate(ps, node->link[0]);
-        (ps->a)[ps->len++] = node->element;
-        populate(ps, node->link[1]);
+static TNode *find(void *element, TNode *tree, int (*cmp)(void*,void*)) {
+    while (tree != NULL) {
+        int result = (*cmp)(element, tree->element);
+
+        if (result == 0)
+            break;
+        tree = tree->link[result > 0];
     }
+    return tree;
 }
 
 /*
- * postorder traversal, invoking freeFxn and then freeing node
+ * postorder traversal, invoking freeFxn and then freeing node; each node
+ * is freed after both of its subtrees, found by descending from its parent
  */
 static void postpurge(TNode *leaf, void (*freeFxn)(void *element)) {
-    if (leaf != NULL) {
-        postpurge(leaf->link[0], freeFxn);
-        postpurge(leaf->link[1], freeFxn);
-        if (freeFxn != NULL)
-            (*freeFxn)(leaf->element);
-        free(leaf);
+    TNode *p;
+
+    while (leaf != NULL) {
+        if (leaf->link[0] != NULL)
+            leaf = leaf->link[0];
+        else if (leaf->link[1] != NULL)
+            leaf = leaf->link[1];
+        else {
+            p = leaf->parent;
+            if (p != NULL)
+                p->link[p->link[1] == leaf] = NULL;
+            if (freeFxn != NULL)
+                (*freeFxn)(leaf->element);
+            free(leaf);
+            leaf = p;
+        }
     }
 }
 
@@ -252,11 +291,26 @@ static void os_destroy(const OrderedSet *os, void (*freeFxn)(void *element)) {
 
 static int os_add(const OrderedSet *os, void *element) {
     OsData *osd = (OsData *)os->self;
-    int done = 0;
+    TNode *p = NULL, *t = osd->root, *node;
+    int dir = 0;
+
+    while (t != NULL) {
+        int cmp = (*osd->cmp)(element, t->element);
 
-    if (find(element, osd->root, osd->cmp) != NULL)
+        if (cmp == 0)
+            return 0;
+        p = t;
+        dir = (cmp > 0);
+        t = t->link[dir];
+    }
+    if ((node = newNode(element)) == NULL)
         return 0;
-    osd->root = insert(osd->root, element, &done, osd->cmp);
+    node->parent = p;
+    if (p == NULL)
+        osd->root = node;
+    else
+        p->link[dir] = node;
+    insertRetrace(osd, node);
     osd->size++;
     return 1;
 }
@@ -318,16 +372,6 @@ static int os_contains(const OrderedSet *os, void *element) {
     return (find(element, osd->root, osd->cmp) != NULL);
 }
 
-/*
- * find node with minimum value in subtree
- */
-TNode *findMin(TNode *tree) {
-    if (tree != NULL)
-        while (tree->link[0] != NULL)
-            tree = tree->link[0];
-    return tree;
-}
-
 static int os_first(const OrderedSet *os, void **element) {
     OsData *osd = (OsData *)os->self;
     TNode *current = findMin(osd->root);
@@ -386,16 +430,6 @@ static int os_isEmpty(const OrderedSet *os) {
     return (osd->size == 0L);
 }
 
-/*
- * find node with maximum value in subtree
- */
-TNode *findMax(TNode *tree) {
-    if (tree != NULL)
-        while (tree->link[1] != NULL)
-            tree = tree->link[1];
-    return tree;
-}
-
 static int os_last(const OrderedSet *os, void **element) {
     OsData *osd = (OsData *)os->self;
     TNode *current = findMax(osd->root);
@@ -429,35 +463,34 @@ static int os_lower(const OrderedSet *os, void *element, void **lower) {
 static int os_pollFirst(const OrderedSet *os, void **element) {
     OsData *osd = (OsData *)os->self;
     TNode *node = findMin(osd->root);
-    int done = 0;
 
     if (node == NULL)
         return 0;
     *element = node->element;
-    osd->root = remove(osd->root, node->element, &done, osd->cmp, NULL);
+    removeNode(osd, node);
     return 1;
 }
 
 static int os_pollLast(const OrderedSet *os, void **element) {
     OsData *osd = (OsData *)os->self;
     TNode *node = findMax(osd->root);
-    int done = 0;
 
     if (node == NULL)
         return 0;
     *element = node->element;
-    osd->root = remove(osd->root, node->element, &done, osd->cmp, NULL);
+    removeNode(osd, node);
     return 1;
 }
 
 static int os_remove(const OrderedSet *os, void *element, void (*freeFxn)(void *element)) {
     OsData *osd = (OsData *)os->self;
-    int done = 0;
+    TNode *node = find(element, osd->root, osd->cmp);
 
-    if (find(element, osd->root, osd->cmp) == NULL)
+    if (node == NULL)
         return 0;
-    osd->root = remove(osd->root, element, &done, osd->cmp, freeFxn);
-    osd->size--;
+    if (freeFxn != NULL)
+        (*freeFxn)(node->element);
+    removeNode(osd, node);
     return 1;
 }
 
@@ -474,14 +507,14 @@ static long os_size(const OrderedSet *os) {
  */
 static void **genArray(OsData *osd) {
     void **tmp = NULL;
-    PopStruct ps;
     if (osd->size > 0L) {
         size_t nbytes = osd->size * sizeof(void *);
         tmp = (void **)malloc(nbytes);
         if (tmp != NULL) {
-            ps.a = tmp;
-            ps.len = 0;
-            populate(&ps, osd->root);
+            TNode *node;
+            long n = 0L;
+            for (node = findMin(osd->root); node != NULL; node = step(node, 1))
+                tmp[n++] = node->element;
         }
     }
     return tmp;
@@ -509,10 +542,324 @@ static const Iterator *os_itCreate(const OrderedSet *os) {
     return it;
 }
 
+/*
+ * set algebra
+ *
+ * the elements of both sets are listed in order, merged in a single
+ * linear pass, and the merged elements are then built into a perfectly
+ * balanced tree, bottom up, without any comparisons or rotations
+ */
+
+/*
+ * local function that builds a balanced tree from the `n' ordered elements
+ * in `a', returning its height in `*height'
+ *
+ * returns the root of the tree, or NULL if empty or malloc failure; in the
+ * latter case, `*ok' is set to 0 and the nodes built so far are freed
+ */
+static TNode *build(void **a, long n, int *height, int *ok) {
+    TNode *node;
+    int hl, hr;
+    long mid = n / 2;
+
+    *height = 0;
+    if (n == 0L)
+        return NULL;
+    if ((node = newNode(a[mid])) == NULL) {
+        *ok = 0;
+        return NULL;
+    }
+    node->link[0] = build(a, mid, &hl, ok);
+    if (*ok)
+        node->link[1] = build(a + mid + 1, n - mid - 1, &hr, ok);
+    if (node->link[0] != NULL)
+        node->link[0]->parent = node;
+    if (node->link[1] != NULL)
+        node->link[1]->parent = node;
+    if (! *ok) {
+        postpurge(node, NULL);
+        return NULL;
+    }
+    node->balance = hr - hl;
+    *height = ((hl > hr) ? hl : hr) + 1;
+    return node;
+}
+
+#define OS_UNION 0
+#define OS_INTERSECT 1
+#define OS_DIFFERENCE 2
+
+/*
+ * local function that implements setUnion(), intersect() and difference()
+ * by merging the ordered elements of the two sets
+ */
+static const OrderedSet *merge(const OrderedSet *os, const OrderedSet *other,
+                               int op) {
+    OsData *osd = (OsData *)os->self;
+    const OrderedSet *ans = NULL;
+    void **a = NULL, **b = NULL, **c = NULL;
+    long i = 0L, j = 0L, k = 0L, na = osd->size, nb = 0L;
+    int ok = 1, height;
+
+    if (na > 0L && (a = genArray(osd)) == NULL)
+        ok = 0;
+    if (ok && ! other->isEmpty(other) && (b = other->toArray(other, &nb)) == NULL)
+        ok = 0;
+    if (ok && na + nb > 0L &&
+        (c = (void **)malloc((na + nb) * sizeof(void *))) == NULL)
+        ok = 0;
+    if (ok) {
+        while (i < na && j < nb) {
+            int r = osd->cmp(a[i], b[j]);
+
+            if (r < 0) {
+                if (op != OS_INTERSECT)
+                    c[k++] = a[i];
+                i++;
+            } else if (r > 0) {
+                if (op == OS_UNION)
+                    c[k++] = b[j];
+                j++;
+            } else {
+                if (op != OS_DIFFERENCE)
+                    c[k++] = a[i];
+                i++;
+                j++;
+            }
+        }
+        if (op != OS_INTERSECT)
+            while (i < na)
+                c[k++] = a[i++];
+        if (op == OS_UNION)
+            while (j < nb)
+                c[k++] = b[j++];
+        if ((ans = OrderedSet_create(osd->cmp)) != NULL) {
+            OsData *rd = (OsData *)ans->self;
+
+            rd->root = build(c, k, &height, &ok);
+            if (ok)
+                rd->size = k;
+            else {
+                ans->destroy(ans, NULL);
+                ans = NULL;
+            }
+        }
+    }
+    free(a);
+    free(b);
+    free(c);
+    return ans;
+}
+
+static const OrderedSet *os_setUnion(const OrderedSet *os,
+                                     const OrderedSet *other) {
+    return merge(os, other, OS_UNION);
+}
+
+static const OrderedSet *os_intersect(const OrderedSet *os,
+                                      const OrderedSet *other) {
+    return merge(os, other, OS_INTERSECT);
+}
+
+static const OrderedSet *os_difference(const OrderedSet *os,
+                                       const OrderedSet *other) {
+    return merge(os, other, OS_DIFFERENCE);
+}
+
+static int os_isSubset(const OrderedSet *os, const OrderedSet *other) {
+    OsData *osd = (OsData *)os->self;
+    void **a = NULL, **b = NULL;
+    long i, j = 0L, na = osd->size, nb = 0L;
+    int ans = 1;
+
+    if (na == 0L)
+        return 1;
+    if (na > other->size(other))
+        return 0;
+    if ((a = genArray(osd)) == NULL || (b = other->toArray(other, &nb)) == NULL)
+        ans = -1;
+    else
+        for (i = 0L; ans == 1 && i < na; i++) {
+            while (j < nb && osd->cmp(b[j], a[i]) < 0)
+                j++;
+            if (j == nb || osd->cmp(b[j], a[i]) != 0)
+                ans = 0;
+        }
+    free(a);
+    free(b);
+    return ans;
+}
+
+/*
+ * a cursor over an AVL tree holds the node it is on, which the parent
+ * links let it leave in either direction
+ */
+static int place(OSCursor *cursor, TNode *node, void **found) {
+    cursor->node = node;
+    if (node == NULL)
+        return 0;
+    *found = node->element;
+    return 1;
+}
+
+static int os_cursorFirst(const OrderedSet *os, OSCursor *cursor,
+                          void **found) {
+    OsData *osd = (OsData *)os->self;
+
+    return place(cursor, findMin(osd->root), found);
+}
+
+static int os_cursorLast(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    OsData *osd = (OsData *)os->self;
+
+    return place(cursor, findMax(osd->root), found);
+}
+
+static int os_cursorSeek(const OrderedSet *os, OSCursor *cursor,
+                         void *element, void **found) {
+    OsData *osd = (OsData *)os->self;
+    TNode *t = osd->root, *current = NULL;
+
+    while (t != NULL) {
+        int cmp = (*osd->cmp)(element, t->element);
+
+        if (cmp == 0) {
+            current = t;
+            break;
+        }
+        if (cmp < 0)
+            current = t;		/* every later candidate is smaller */
+        t = t->link[cmp > 0];
+    }
+    return place(cursor, current, found);
+}
+
+static int os_cursorNext(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    (void) os;
+    if (cursor->node == NULL)
+        return 0;
+    return place(cursor, step((TNode *)cursor->node, 1), found);
+}
+
+static int os_cursorPrev(const OrderedSet *os, OSCursor *cursor,
+                         void **found) {
+    (void) os;
+    if (cursor->node == NULL)
+        return 0;
+    return place(cursor, step((TNode *)cursor->node, 0), found);
+}
+
+/*
+ * a range is walked with a cursor; rangeStart() places the cursor on the
+ * first element of the range, and inRange() tests against the upper bound
+ */
+static int rangeStart(const OrderedSet *os, OSCursor *cursor, void *lo,
+                      int loInclusive, void **found) {
+    OsData *osd = (OsData *)os->self;
+    int status;
+
+    if (lo == NULL)
+        return os_cursorFirst(os, cursor, found);
+    status = os_cursorSeek(os, cursor, lo, found);
+    if (status && !loInclusive && (*osd->cmp)(*found, lo) == 0)
+        status = os_cursorNext(os, cursor, found);
+    return status;
+}
+
+static int inRange(OsData *osd, void *element, void *hi, int hiInclusive) {
+    int c;
+
+    if (hi == NULL)
+        return 1;
+    c = (*osd->cmp)(element, hi);
+    return (c < 0 || (c == 0 && hiInclusive));
+}
+
+typedef struct range_data {
+    const OrderedSet *os;
+    OSCursor cursor;
+    void *next;
+    int more;
+    void *hi;
+    int hiInclusive;
+} RangeData;
+
+static int range_hasNext(const Iterator *it) {
+    RangeData *rd = (RangeData *)it->self;
+
+    return rd->more;
+}
+
+static int range_next(const Iterator *it, void **element) {
+    RangeData *rd = (RangeData *)it->self;
+    OsData *osd = (OsData *)rd->os->self;
+
+    if (!rd->more)
+        return 0;
+    *element = rd->next;
+    rd->more = os_cursorNext(rd->os, &rd->cursor, &rd->next) &&
+               inRange(osd, rd->next, rd->hi, rd->hiInclusive);
+    return 1;
+}
+
+static void range_destroy(const Iterator *it) {
+    free(it->self);
+    free((void *)it);
+}
+
+static Iterator rangeTemplate = {
+    NULL, range_hasNext, range_next, range_destroy
+};
+
+static const Iterator *os_range(const OrderedSet *os, void *lo,
+                                int loInclusive, void *hi, int hiInclusive) {
+    OsData *osd = (OsData *)os->self;
+    Iterator *it = (Iterator *)malloc(sizeof(Iterator));
+
+    if (it != NULL) {
+        RangeData *rd = (RangeData *)malloc(sizeof(RangeData));
+
+        if (rd != NULL) {
+            rd->os = os;
+            rd->hi = hi;
+            rd->hiInclusive = hiInclusive;
+            rd->more = rangeStart(os, &rd->cursor, lo, loInclusive,
+                                  &rd->next) &&
+                       inRange(osd, rd->next, hi, hiInclusive);
+            *it = rangeTemplate;
+            it->self = rd;
+        } else {
+            free(it);
+            it = NULL;
+        }
+    }
+    return it;
+}
+
+static long os_countRange(const OrderedSet *os, void *lo, int loInclusive,
+                          void *hi, int hiInclusive) {
+    OsData *osd = (OsData *)os->self;
+    OSCursor cursor;
+    void *element;
+    long n = 0L;
+    int status;
+
+    for (status = rangeStart(os, &cursor, lo, loInclusive, &element);
+         status && inRange(osd, element, hi, hiInclusive);
+         status = os_cursorNext(os, &cursor, &element))
+        n++;
+    return n;
+}
+
 static OrderedSet template = {
     NULL, os_destroy, os_add, os_ceiling, os_clear, os_contains,
     os_first, os_floor, os_higher, os_isEmpty, os_last, os_lower,
-    os_pollFirst, os_pollLast, os_remove, os_size, os_toArray, os_itCreate
+    os_pollFirst, os_pollLast, os_remove, os_size, os_toArray, os_itCreate,
+    os_setUnion, os_intersect, os_difference, os_isSubset, os_cursorFirst,
+    os_cursorLast, os_cursorSeek, os_cursorNext, os_cursorPrev,
+    os_range, os_countRange
 };
 
 const OrderedSet *OrderedSet_create(int (*cmpFunction)(void *, void *)) {
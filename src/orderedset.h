@@ -42,6 +42,21 @@
 
 typedef struct orderedset OrderedSet;	/* forward reference */
 
+/*
+ * position of a cursor over an ordered set; a cursor is placed on an
+ * element by cursorFirst(), cursorLast() or cursorSeek(), and then moved
+ * through the set in order by cursorNext() and cursorPrev(); it walks the
+ * set in place, so no storage is allocated, and a walk over the whole set
+ * takes O(1) amortized time per step
+ *
+ * adding elements to or removing elements from the set invalidates every
+ * cursor over it
+ */
+typedef struct oscursor {
+    void *node;
+    long index;
+} OSCursor;
+
 /*
  * create a treeset that is ordered using `cmpFunction' to compare two elements
  *
@@ -52,6 +67,25 @@ typedef struct orderedset OrderedSet;	/* forward reference */
  */
 const OrderedSet *OrderedSet_create(int (*cmpFunction)(void *, void *));
 
+/*
+ * create a treeset as with OrderedSet_create(), implemented as a B+tree
+ * rather than as an AVL tree
+ *
+ * each node of a B+tree holds a sorted array of up to `fanout' elements,
+ * so a search visits a few adjacent cache lines at each of a small number
+ * of levels, and each element costs little more than one pointer; the
+ * leaves are linked in order, so first(), last(), the neighbour queries
+ * and toArray() need no further descents; a set built in ascending order
+ * has full leaves
+ *
+ * if fanout <= 0, a default (28) is used, which makes each leaf 4 cache
+ * lines; fanouts below 4 are raised to 4 and above 4096 reduced to 4096
+ *
+ * returns a pointer to the treeset, or NULL if there are malloc() errors
+ */
+const OrderedSet *OrderedSet_createBTree(int (*cmpFunction)(void *, void *),
+                                         int fanout);
+
 /*
  * now define struct orderedset
  */
@@ -180,6 +214,80 @@ struct orderedset {
  * returns pointer to the Iterator or NULL if failure
  */
     const Iterator *(*itCreate)(const OrderedSet *os);
+
+/*
+ * set algebra: setUnion(), intersect() and difference() return a new
+ * ordered set, with the same cmpFunction as `os', holding the elements in
+ * either set, in both sets, or in `os' but not in `other', respectively;
+ * when an element is in both sets, the one from `os' is used
+ *
+ * `other' must be ordered by the same cmpFunction; each operation is a
+ * single linear merge of the two sets in order, so takes time proportional
+ * to the sum of their sizes
+ *
+ * the elements are shared with the operands, not copied, so the result
+ * should be destroyed with a NULL freeFxn unless it owns its elements
+ *
+ * each returns a pointer to the new set, or NULL if malloc() errors
+ */
+    const OrderedSet *(*setUnion)(const OrderedSet *os,
+                                  const OrderedSet *other);
+    const OrderedSet *(*intersect)(const OrderedSet *os,
+                                   const OrderedSet *other);
+    const OrderedSet *(*difference)(const OrderedSet *os,
+                                    const OrderedSet *other);
+
+/*
+ * returns 1 if every element of `os' is also in `other', 0 if not,
+ * -1 if malloc() errors
+ */
+    int (*isSubset)(const OrderedSet *os, const OrderedSet *other);
+
+/*
+ * place `*cursor' on the first (smallest) element, the last (largest)
+ * element, or the least element greater than or equal to `element',
+ * respectively, returning that element in `*found'
+ *
+ * each returns 1 if there is such an element, 0 if not; in the latter
+ * case, cursorNext() and cursorPrev() on the cursor return 0
+ */
+    int (*cursorFirst)(const OrderedSet *os, OSCursor *cursor, void **found);
+    int (*cursorLast)(const OrderedSet *os, OSCursor *cursor, void **found);
+    int (*cursorSeek)(const OrderedSet *os, OSCursor *cursor, void *element,
+                      void **found);
+
+/*
+ * move `*cursor' to the next (cursorNext) or previous (cursorPrev) element
+ * in order, returning it in `*found'
+ *
+ * returns 1 if successful, 0 if the cursor was on the last (first) element
+ * or not on any element, in which case it is then not on any element
+ */
+    int (*cursorNext)(const OrderedSet *os, OSCursor *cursor, void **found);
+    int (*cursorPrev)(const OrderedSet *os, OSCursor *cursor, void **found);
+
+/*
+ * create an iterator over the elements from `lo' to `hi', in order;
+ * `lo' (`hi') is included in the range if `loInclusive' (`hiInclusive')
+ * is 1, excluded if it is 0; a NULL `lo' (`hi') leaves the range unbounded
+ * below (above)
+ *
+ * the iterator is lazy: it walks the set in place with a cursor, so
+ * creating it takes O(log n) time, and each call to next() O(1) amortized;
+ * the set must not be changed while the iterator is in use
+ *
+ * returns pointer to the Iterator or NULL if failure
+ */
+    const Iterator *(*range)(const OrderedSet *os, void *lo, int loInclusive,
+                             void *hi, int hiInclusive);
+
+/*
+ * returns the number of elements in the range from `lo' to `hi', with
+ * the bounds interpreted as for range(); takes O(log n + k) time for
+ * k elements in the range
+ */
+    long (*countRange)(const OrderedSet *os, void *lo, int loInclusive,
+                       void *hi, int hiInclusive);
 };
 
 #endif /* _ORDEREDSET_H_ */
@@ -205,6 +205,268 @@ int main(int argc, char *argv[]) {
      */
     printf("===== test of destroy(free)\n");
     os->destroy(os, free);
+    /*
+     * test of set algebra; a holds 00000..14999 and b 10000..24999
+     */
+    printf("===== test of setUnion/intersect/difference/isSubset\n");
+    {
+        const OrderedSet *a, *b, *u, *in, *d;
+        char **s = (char **)malloc(25000 * sizeof(char *));
+
+        a = OrderedSet_create(scmp);
+        b = OrderedSet_create(scmp);
+        if (s == NULL || a == NULL || b == NULL) {
+            fprintf(stderr, "Error creating sets for set algebra\n");
+            return -1;
+        }
+        for (i = 0; i < 25000; i++) {
+            sprintf(buf, "%05ld", i);
+            if ((s[i] = strdup(buf)) == NULL) {
+                fprintf(stderr, "Error duplicating %ld\n", i);
+                return -1;
+            }
+            if (i < 15000)
+                (void) a->add(a, s[i]);
+            if (i >= 10000)
+                (void) b->add(b, s[i]);
+        }
+        u = a->setUnion(a, b);
+        in = a->intersect(a, b);
+        d = a->difference(a, b);
+        if (u == NULL || in == NULL || d == NULL) {
+            fprintf(stderr, "Error in set algebra\n");
+            return -1;
+        }
+        printf("union = %ld, intersect = %ld, difference = %ld\n",
+               u->size(u), in->size(in), d->size(d));
+        printf("isSubset: a of union = %d, intersect of b = %d, ",
+               a->isSubset(a, u), in->isSubset(in, b));
+        printf("a of b = %d, difference of b = %d\n", a->isSubset(a, b),
+               d->isSubset(d, b));
+        (void) in->first(in, (void **)&p);
+        printf("intersect: first = %s, ", p);
+        (void) in->last(in, (void **)&p);
+        printf("last = %s\n", p);
+        (void) d->last(d, (void **)&p);
+        printf("difference: last = %s, ", p);
+        printf("contains(\"10000\") = %d\n", d->contains(d, "10000"));
+        if ((array = u->toArray(u, &n)) == NULL) {
+            fprintf(stderr, "Error in invoking u->toArray()\n");
+            return -1;
+        }
+        for (i = 0; i < n && array[i] == s[i]; i++)
+            ;
+        printf("union in order = %d\n", i == 25000);
+        free(array);
+        for (i = 0; i < 25000; i += 2)
+            (void) u->remove(u, s[i], NULL);
+        for (i = 0; i < 25000 && u->contains(u, s[i]) == (i % 2); i++)
+            ;
+        printf("union after removing evens = %ld, consistent = %d\n",
+               u->size(u), i == 25000);
+        u->destroy(u, NULL);
+        in->destroy(in, NULL);
+        d->destroy(d, NULL);
+        a->destroy(a, NULL);
+        b->destroy(b, NULL);
+        for (i = 0; i < 25000; i++)
+            free(s[i]);
+        free(s);
+    }
+    /*
+     * test of OrderedSet_createBTree(); with the smallest fanout, the
+     * lines of this file split and merge nodes at every level, and the
+     * tree must answer every query as the AVL tree does
+     */
+    printf("===== test of OrderedSet_createBTree\n");
+    {
+        const OrderedSet *bt, *avl;
+        void **a1, **a2;
+        long n1, n2;
+        int same;
+
+        bt = OrderedSet_createBTree(scmp, 4);
+        avl = OrderedSet_create(scmp);
+        if (bt == NULL || avl == NULL) {
+            fprintf(stderr, "Error creating treesets of strings\n");
+            return -1;
+        }
+        fd = fopen(argv[1], "r");		/* we know we can open it */
+        while (fgets(buf, 1024, fd) != NULL) {
+            p = strchr(buf, '\n');
+            *p = '\0';
+            if ((p = strdup(buf)) == NULL) {
+                fprintf(stderr, "Error duplicating string\n");
+                return -1;
+            }
+            if (avl->add(avl, p))
+                (void) bt->add(bt, p);
+            else
+                free(p);
+        }
+        fclose(fd);
+        printf("Size of B+tree = %ld, of AVL tree = %ld\n", bt->size(bt),
+               avl->size(avl));
+        a1 = bt->toArray(bt, &n1);
+        a2 = avl->toArray(avl, &n2);
+        if (a1 == NULL || a2 == NULL) {
+            fprintf(stderr, "Error in invoking toArray()\n");
+            return -1;
+        }
+        for (i = 0, same = 1; i < n1; i++) {
+            void *x, *y;
+
+            same &= (a1[i] == a2[i]);
+            same &= (bt->ceiling(bt, a1[i], &x) && x == a1[i]);
+            same &= (bt->higher(bt, a1[i], &x) == avl->higher(avl, a1[i], &y));
+            same &= (bt->lower(bt, a1[i], &x) == avl->lower(avl, a1[i], &y));
+        }
+        printf("toArray and queries agree = %d\n", same);
+        for (i = 0; i < n1; i += 2)
+            (void) bt->remove(bt, a1[i], NULL);
+        for (i = 0, same = 1; i < n1; i++)
+            same &= (bt->contains(bt, a1[i]) == (i % 2));
+        printf("Size after removing every other = %ld, consistent = %d\n",
+               bt->size(bt), same);
+        free(a1);
+        free(a2);
+        (void) bt->first(bt, (void **)&p);
+        printf("First is \"%s\", ", p);
+        (void) bt->last(bt, (void **)&p);
+        printf("last is \"%s\"\n", p);
+        while (bt->pollFirst(bt, (void **)&p))
+            ;
+        printf("Size after pollFirst until empty = %ld\n", bt->size(bt));
+        bt->destroy(bt, NULL);
+        avl->destroy(avl, free);
+    }
+    /*
+     * test of cursors, over both implementations
+     */
+    printf("===== test of cursorFirst/Last/Seek/Next/Prev\n");
+    {
+        const OrderedSet *sets[2];
+        char **s = (char **)malloc(1000 * sizeof(char *));
+        int k;
+
+        sets[0] = OrderedSet_create(scmp);
+        sets[1] = OrderedSet_createBTree(scmp, 0);
+        if (s == NULL || sets[0] == NULL || sets[1] == NULL) {
+            fprintf(stderr, "Error creating sets for cursors\n");
+            return -1;
+        }
+        for (i = 0; i < 1000; i++) {
+            sprintf(buf, "%05ld", 7 * ((i * 37) % 1000));
+            if ((s[i] = strdup(buf)) == NULL) {
+                fprintf(stderr, "Error duplicating %ld\n", i);
+                return -1;
+            }
+            (void) sets[0]->add(sets[0], s[i]);
+            (void) sets[1]->add(sets[1], s[i]);
+        }
+        for (k = 0; k < 2; k++) {
+            const OrderedSet *set = sets[k];
+            OSCursor c;
+            char *prev = NULL;
+            int inOrder = 1;
+
+            printf("%s:\n", (k == 0) ? "AVL tree" : "B+tree");
+            for (n = 0, i = set->cursorFirst(set, &c, (void **)&p); i;
+                 i = set->cursorNext(set, &c, (void **)&p), n++) {
+                if (prev != NULL && strcmp(prev, p) >= 0)
+                    inOrder = 0;
+                prev = p;
+            }
+            printf("forward: %ld elements, in order = %d, ", n, inOrder);
+            printf("cursorNext() after end = %d\n",
+                   set->cursorNext(set, &c, (void **)&p));
+            for (n = 0, i = set->cursorLast(set, &c, (void **)&p); i;
+                 i = set->cursorPrev(set, &c, (void **)&p))
+                n++;
+            printf("backward: %ld elements\n", n);
+            (void) set->cursorSeek(set, &c, "03500", (void **)&p);
+            printf("cursorSeek(\"03500\") -> \"%s\", ", p);
+            (void) set->cursorSeek(set, &c, "03501", (void **)&p);
+            printf("cursorSeek(\"03501\") -> \"%s\", ", p);
+            (void) set->cursorPrev(set, &c, (void **)&p);
+            printf("cursorPrev() -> \"%s\"\n", p);
+            printf("cursorSeek(\"99999\") = %d\n",
+                   set->cursorSeek(set, &c, "99999", (void **)&p));
+            for (i = 0; set->pollFirst(set, (void **)&p); i++)
+                ;
+            printf("pollFirst() removed %ld, size = %ld\n", i,
+                   set->size(set));
+            printf("cursorFirst() of empty set = %d\n",
+                   set->cursorFirst(set, &c, (void **)&p));
+            set->destroy(set, NULL);
+        }
+        for (i = 0; i < 1000; i++)
+            free(s[i]);
+        free(s);
+    }
+    /*
+     * test of range and countRange, over both implementations
+     */
+    printf("===== test of range and countRange\n");
+    {
+        const OrderedSet *sets[2];
+        int k;
+
+        sets[0] = OrderedSet_create(scmp);
+        sets[1] = OrderedSet_createBTree(scmp, 4);
+        if (sets[0] == NULL || sets[1] == NULL) {
+            fprintf(stderr, "Error creating sets for range\n");
+            return -1;
+        }
+        for (i = 0; i < 1000; i++) {
+            sprintf(buf, "%04ld", 3 * i);
+            if ((p = strdup(buf)) == NULL) {
+                fprintf(stderr, "Error duplicating %ld\n", i);
+                return -1;
+            }
+            (void) sets[0]->add(sets[0], p);
+            (void) sets[1]->add(sets[1], p);
+        }
+        for (k = 0; k < 2; k++) {
+            const OrderedSet *set = sets[k];
+
+            printf("%s:\n", (k == 0) ? "AVL tree" : "B+tree");
+            if ((it = set->range(set, "0100", 1, "0130", 1)) == NULL) {
+                fprintf(stderr, "Error creating range iterator\n");
+                return -1;
+            }
+            printf("range [0100, 0130]:");
+            while (it->hasNext(it)) {
+                (void) it->next(it, (void **)&p);
+                printf(" %s", p);
+            }
+            printf("\n");
+            it->destroy(it);
+            if ((it = set->range(set, "0102", 0, "0129", 0)) == NULL) {
+                fprintf(stderr, "Error creating range iterator\n");
+                return -1;
+            }
+            printf("range (0102, 0129):");
+            while (it->next(it, (void **)&p))
+                printf(" %s", p);
+            printf("\n");
+            it->destroy(it);
+            printf("countRange [0102, 0129] = %ld\n",
+                   set->countRange(set, "0102", 1, "0129", 1));
+            printf("countRange (0102, 0129) = %ld\n",
+                   set->countRange(set, "0102", 0, "0129", 0));
+            printf("countRange [NULL, 1500) = %ld\n",
+                   set->countRange(set, NULL, 1, "1500", 0));
+            printf("countRange (1500, NULL] = %ld\n",
+                   set->countRange(set, "1500", 0, NULL, 1));
+            printf("countRange [NULL, NULL] = %ld\n",
+                   set->countRange(set, NULL, 1, NULL, 1));
+            printf("countRange [0200, 0100] = %ld\n",
+                   set->countRange(set, "0200", 1, "0100", 1));
+        }
+        sets[1]->destroy(sets[1], NULL);
+        sets[0]->destroy(sets[0], free);
+    }
 
     return 0;
 }
@@ -0,0 +1,216 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation for generic threadsafe bounded cache
+ */
+
+#include "tscache.h"
+#include "cache.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#define LOCK(c) &((c)->lock)
+
+typedef struct tsc_data {
+    const Cache *c;
+    pthread_mutex_t lock;	/* this is a recursive lock */
+} TSCData;
+
+static void tsc_destroy(const TSCache *c, void (*freeFxn)(void *element)) {
+    TSCData *cd = (TSCData *)c->self;
+
+    pthread_mutex_lock(LOCK(cd));
+    cd->c->destroy(cd->c, freeFxn);
+    pthread_mutex_unlock(LOCK(cd));
+    pthread_mutex_destroy(LOCK(cd));
+    free(cd);
+    free((void *)c);
+}
+
+static void tsc_clear(const TSCache *c, void (*freeFxn)(void *element)) {
+    TSCData *cd = (TSCData *)c->self;
+
+    pthread_mutex_lock(LOCK(cd));
+    cd->c->clear(cd->c, freeFxn);
+    pthread_mutex_unlock(LOCK(cd));
+}
+
+static void tsc_lock(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+
+    pthread_mutex_lock(LOCK(cd));
+}
+
+static void tsc_unlock(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+
+    pthread_mutex_unlock(LOCK(cd));
+}
+
+static int tsc_containsKey(const TSCache *c, char *key) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->containsKey(cd->c, key);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static int tsc_get(const TSCache *c, char *key, void **element) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->get(cd->c, key, element);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static int tsc_isEmpty(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->isEmpty(cd->c);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static char **tsc_keyArray(const TSCache *c, long *len) {
+    TSCData *cd = (TSCData *)c->self;
+    char **result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->keyArray(cd->c, len);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static int tsc_peek(const TSCache *c, char *key, void **element) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->peek(cd->c, key, element);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static int tsc_put(const TSCache *c, char *key, void *element,
+                   void **previous) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->put(cd->c, key, element, previous);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static int tsc_remove(const TSCache *c, char *key, void **element) {
+    TSCData *cd = (TSCData *)c->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->remove(cd->c, key, element);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static long tsc_size(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->size(cd->c);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static long tsc_used(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->used(cd->c);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static long tsc_evictions(const TSCache *c) {
+    TSCData *cd = (TSCData *)c->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(cd));
+    result = cd->c->evictions(cd->c);
+    pthread_mutex_unlock(LOCK(cd));
+    return  result;
+}
+
+static TSCache template = {
+    NULL, tsc_destroy, tsc_clear, tsc_lock, tsc_unlock, tsc_containsKey,
+    tsc_get, tsc_isEmpty, tsc_keyArray, tsc_peek, tsc_put, tsc_remove,
+    tsc_size, tsc_used, tsc_evictions
+};
+
+const TSCache *TSCache_create(long capacity, int policy,
+                              long (*sizeFxn)(void *element),
+                              void (*evictFxn)(char *key, void *element)) {
+    TSCache *tsc = (TSCache *)malloc(sizeof(TSCache));
+
+    if (tsc != NULL) {
+        TSCData *cd = (TSCData *)malloc(sizeof(TSCData));
+
+        if (cd != NULL) {
+            cd->c = Cache_create(capacity, policy, sizeFxn, evictFxn);
+
+            if (cd->c != NULL) {
+                pthread_mutexattr_t ma;
+                pthread_mutexattr_init(&ma);
+                pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+                pthread_mutex_init(LOCK(cd), &ma);
+                pthread_mutexattr_destroy(&ma);
+                *tsc = template;
+                tsc->self = cd;
+            } else {
+                free(cd);
+                free(tsc);
+                tsc = NULL;
+            }
+        } else {
+            free(tsc);
+            tsc = NULL;
+        }
+    }
+    return tsc;
+}
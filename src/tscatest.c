@@ -0,0 +1,178 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tscache.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <pthread.h>
+
+#define NTHREADS 4
+#define NOPS 50000
+
+static const char *names[] = {"CACHE_LRU", "CACHE_CLOCK", "CACHE_S3FIFO"};
+
+/*
+ * thread function for the concurrency test; each thread gets keys from a
+ * key space three times the capacity of the cache, putting those that
+ * are missing, and checks that each element found matches its key; the
+ * lock is held while the element is checked, as evictFree() frees it
+ */
+typedef struct worker {
+    const TSCache *c;
+    long id;
+    long errors;
+} Worker;
+
+static void evictFree(char *key, void *element) {
+    (void) key;
+    free(element);
+}
+
+static void *work(void *arg) {
+    Worker *w = (Worker *)arg;
+    char key[32];
+    char *p;
+    long i;
+
+    for (i = 0; i < NOPS; i++) {
+        sprintf(key, "%ld", ((i + w->id * 1000L) * 7919L) % 300L);
+        w->c->lock(w->c);
+        if (w->c->get(w->c, key, (void **)&p)) {
+            if (strcmp(key, p) != 0)
+                w->errors++;
+            w->c->unlock(w->c);
+        } else {
+            w->c->unlock(w->c);
+            if (!w->c->put(w->c, key, strdup(key), (void **)&p))
+                w->errors++;
+            else
+                free(p);	/* another thread may have put it first */
+        }
+    }
+    return NULL;
+}
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char key[32];
+    char *p;
+    const TSCache *c;
+    long i, n;
+    int policy;
+    FILE *fd;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./tscatest file\n");
+        return -1;
+    }
+    if ((c = TSCache_create(10L, CACHE_LRU, NULL, evictFree)) == NULL) {
+        fprintf(stderr, "Error creating cache\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of put() beyond the capacity
+     */
+    printf("===== test of put beyond capacity\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        sprintf(key, "%ld", i++);
+        if (!c->put(c, key, p, (void **)&prev)) {
+            fprintf(stderr, "Error adding key,string to cache\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    printf("%ld lines put, size = %ld, used = %ld, evictions = %ld\n",
+           i, c->size(c), c->used(c), c->evictions(c));
+    /*
+     * test of get() of the lines that are left, holding the lock
+     */
+    printf("===== test of get\n");
+    c->lock(c);
+    for (n = i, i = 0; i < n; i++) {
+        sprintf(key, "%ld", i);
+        if (c->get(c, key, (void **)&p))
+            printf("%s,%s", key, p);
+    }
+    c->unlock(c);
+    c->clear(c, free);
+    printf("Size after clear = %ld, isEmpty = %d\n", c->size(c),
+           c->isEmpty(c));
+    c->destroy(c, free);
+    /*
+     * test of concurrent gets and puts
+     */
+    printf("===== test of concurrent gets and puts\n");
+    for (policy = CACHE_LRU; policy <= CACHE_S3FIFO; policy++) {
+        pthread_t threads[NTHREADS];
+        Worker workers[NTHREADS];
+        char **keys;
+        long found = 0L;
+
+        if ((c = TSCache_create(100L, policy, NULL, evictFree)) == NULL) {
+            fprintf(stderr, "Error creating cache\n");
+            return -1;
+        }
+        for (i = 0; i < NTHREADS; i++) {
+            workers[i].c = c;
+            workers[i].id = i;
+            workers[i].errors = 0L;
+            pthread_create(&threads[i], NULL, work, &workers[i]);
+        }
+        n = 0L;
+        for (i = 0; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            n += workers[i].errors;
+        }
+        if ((keys = c->keyArray(c, &i)) != NULL) {
+            for (found = 0L; i > 0L; i--)
+                found += c->containsKey(c, keys[i - 1]);
+            free(keys);
+        }
+        printf("%s: %d threads finished with %ld errors, ", names[policy],
+               NTHREADS, n);
+        printf("size = %ld, %ld keys found\n", c->size(c), found);
+        c->destroy(c, free);
+    }
+
+    return 0;
+}
@@ -181,10 +181,150 @@ static const TSIterator *tshm_itCreate(const TSHashMap *hm) {
     return it;
 }
 
+static int tshm_containsKeyn(const TSHashMap *hm, void *key, long len) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->containsKeyn(hmd->hm, key, len);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_getn(const TSHashMap *hm, void *key, long len, void **element) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->getn(hmd->hm, key, len, element);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_putn(const TSHashMap *hm, void *key, long len, void *element,
+                     void **previous) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->putn(hmd->hm, key, len, element, previous);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_removen(const TSHashMap *hm, void *key, long len,
+                        void **element) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->removen(hmd->hm, key, len, element);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static long tshm_getBatch(const TSHashMap *hm, char **keys, long n,
+                          void **elements, int *found) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->getBatch(hmd->hm, keys, n, elements, found);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static long tshm_putBatch(const TSHashMap *hm, char **keys, long n,
+                          void **elements, void **previous) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->putBatch(hmd->hm, keys, n, elements, previous);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static void tshm_stats(const TSHashMap *hm, HashStats *hs) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+
+    pthread_mutex_lock(LOCK(hmd));
+    hmd->hm->stats(hmd->hm, hs);
+    pthread_mutex_unlock(LOCK(hmd));
+}
+
+static int tshm_computeIfAbsent(const TSHashMap *hm, char *key,
+                                void *(*factory)(char *key, void *ctx),
+                                void *ctx, void **element) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->computeIfAbsent(hmd->hm, key, factory, ctx, element);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_compute(const TSHashMap *hm, char *key,
+                        int (*fxn)(char *key, void **element, void *ctx),
+                        void *ctx) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->compute(hmd->hm, key, fxn, ctx);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_merge(const TSHashMap *hm, char *key, void *element,
+                      void *(*mergeFxn)(void *old, void *element)) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->merge(hmd->hm, key, element, mergeFxn);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tshm_putWithTTL(const TSHashMap *hm, char *key, void *element,
+                           long ttl, void **previous) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->putWithTTL(hmd->hm, key, element, ttl, previous);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static long tshm_expire(const TSHashMap *hm, long now, long maxWork) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = hmd->hm->expire(hmd->hm, now, maxWork);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static void tshm_setExpiryFxn(const TSHashMap *hm,
+                              void (*expiryFxn)(char *key, void *element)) {
+    TSHmData *hmd = (TSHmData *)hm->self;
+
+    pthread_mutex_lock(LOCK(hmd));
+    hmd->hm->setExpiryFxn(hmd->hm, expiryFxn);
+    pthread_mutex_unlock(LOCK(hmd));
+}
+
 static TSHashMap template = {
     NULL, tshm_destroy, tshm_clear, tshm_lock, tshm_unlock, tshm_containsKey,
     tshm_entryArray, tshm_get, tshm_isEmpty, tshm_keyArray, tshm_put,
-    tshm_putUnique, tshm_remove, tshm_size, tshm_itCreate
+    tshm_putUnique, tshm_remove, tshm_size, tshm_itCreate, tshm_containsKeyn,
+    tshm_getn, tshm_putn, tshm_removen, tshm_getBatch, tshm_putBatch,
+    tshm_stats, tshm_computeIfAbsent, tshm_compute, tshm_merge,
+    tshm_putWithTTL, tshm_expire, tshm_setExpiryFxn
 };
 
 const TSHashMap *TSHashMap_create(long capacity, double loadFactor) {
@@ -55,6 +55,50 @@ typedef struct tshashmap TSHashMap;	/* forward reference */
  */
 const TSHashMap *TSHashMap_create(long capacity, double loadFactor);
 
+/*
+ * create a hashmap whose keys are divided by hash among `stripes'
+ * independent hashmaps, each protected by its own lock, so that operations
+ * on keys in different stripes may proceed in parallel; `stripes' is
+ * rounded up to a power of 2 (if stripes == 0, 16 stripes are used), and
+ * `capacity' and `loadFactor' are as for TSHashMap_create(), with the
+ * capacity shared among the stripes
+ *
+ * size() and isEmpty() read per-stripe counts without acquiring any locks;
+ * lock(), entryArray(), keyArray(), clear() and itCreate() acquire the locks
+ * of all stripes; the batch methods acquire the lock of each stripe once
+ * for each run of consecutive keys that fall in that stripe; expire()
+ * acquires the lock of one stripe at a time, starting each call with the
+ * stripe after the one that the previous call started with, and advances
+ * every stripe, sharing maxWork among them (each takes at least one step);
+ * the deadlines given by putWithTTL() are always relative to the latest
+ * `now' passed to expire(), even in a stripe whose timer wheel lags behind
+ *
+ * returns a pointer to the hashmap, or NULL if there are malloc() errors
+ */
+const TSHashMap *TSHashMap_createStriped(long capacity, double loadFactor,
+                                         long stripes);
+
+/*
+ * create a hashmap for workloads dominated by lookups; get(), getn(),
+ * containsKey(), containsKeyn(), getBatch(), size() and isEmpty() acquire
+ * no lock, so readers never wait for each other or for writers; writers
+ * still serialize on a single lock, and entries and bucket arrays that
+ * they replace are freed only once no reader can still be using them
+ *
+ * capacity and loadFactor are as for TSHashMap_create()
+ *
+ * NB - a reader may return an element that a concurrent remove() or put()
+ * has just replaced, so the application must not free an element while
+ * readers might still be looking it up; HMEntry pointers returned by
+ * entryArray() are only valid until the next put(), remove() or clear()
+ *
+ * time-to-live is not supported: putWithTTL() stores nothing and returns
+ * -1, expire() returns 0, and setExpiryFxn() does nothing
+ *
+ * returns a pointer to the hashmap, or NULL if there are malloc() errors
+ */
+const TSHashMap *TSHashMap_createReadMostly(long capacity, double loadFactor);
+
 /*
  * now define struct tshashmap
  */
@@ -160,6 +204,152 @@ struct tshashmap {
  * returns pointer to the Iterator or NULL if failure
  */
     const TSIterator *(*itCreate)(const TSHashMap *hm);
+
+/*
+ * the `n' methods below are equivalent to the methods without the `n',
+ * except that the key is the `len' bytes starting at `key' rather than
+ * a '\0'-terminated string, so keys may contain arbitrary bytes
+ */
+
+/*
+ * returns 1 if hashmap has an entry for the `len'-byte `key', 0 otherwise
+ */
+    int (*containsKeyn)(const TSHashMap *hm, void *key, long len);
+
+/*
+ * returns the element to which the `len'-byte `key' is mapped in `*element'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*getn)(const TSHashMap *hm, void *key, long len, void **element);
+
+/*
+ * associates `element' with the `len'-byte `key'; if this replaces an
+ * existing mapping, the old value is returned in `*previous'
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*putn)(const TSHashMap *hm, void *key, long len, void *element,
+                void **previous);
+
+/*
+ * removes the entry associated with the `len'-byte `key' if one exists;
+ * returns element associated with key in `*element'
+ *
+ * returns 1 if successful, 0 if no element associated with `key'
+ */
+    int (*removen)(const TSHashMap *hm, void *key, long len, void **element);
+
+/*
+ * looks up each of the `n' keys in `keys[]', returning the element to
+ * which keys[i] is mapped in elements[i] (NULL if there is no mapping);
+ * if found != NULL, found[i] is set to 1 if keys[i] has a mapping, 0 if not
+ *
+ * the keys are hashed and the memory they will touch is prefetched a
+ * block at a time before any of them are resolved, so the cache misses
+ * for different keys overlap; the lock is acquired once for the whole
+ * batch, rather than once per key as with `n' calls to get()
+ *
+ * returns the number of keys that were found
+ */
+    long (*getBatch)(const TSHashMap *hm, char **keys, long n, void **elements,
+                     int *found);
+
+/*
+ * associates elements[i] with keys[i] for each of the `n' keys, replacing
+ * any existing mappings; if previous != NULL, previous[i] is set to the
+ * element that keys[i] was previously mapped to, or NULL
+ *
+ * returns the number of mappings that were successfully made
+ */
+    long (*putBatch)(const TSHashMap *hm, char **keys, long n, void **elements,
+                     void **previous);
+
+/*
+ * fills in `*hs' with statistics describing the table of the hashmap and
+ * the work done by its lookups and resizes; see hashstats.h
+ *
+ * for a striped hashmap, the stripes are reported together as one table;
+ * they are visited one at a time, so the result is not a snapshot if
+ * other threads are modifying the hashmap
+ */
+    void (*stats)(const TSHashMap *hm, HashStats *hs);
+
+/*
+ * the three methods below each locate the entry for `key' once and act on
+ * it in place while holding the lock (for a striped hashmap, the lock of
+ * the stripe holding `key'), so a read-modify-write of an element is a
+ * single atomic operation rather than a get() and a put() between which
+ * another thread may intervene; the callbacks are invoked with the lock
+ * held, so they should be short and must not use the hashmap
+ */
+
+/*
+ * if `key' has no mapping, invokes factory(key, ctx) and associates the
+ * element it returns with `key'; factory is not invoked if `key' already
+ * has a mapping; the element associated with `key' upon return is
+ * returned in `*element'
+ *
+ * returns 1 if successful, 0 if not (malloc failure, in which case factory
+ * has not been invoked)
+ */
+    int (*computeIfAbsent)(const TSHashMap *hm, char *key,
+                           void *(*factory)(char *key, void *ctx), void *ctx,
+                           void **element);
+
+/*
+ * invokes fxn(key, &element, ctx), where element is the element currently
+ * associated with `key', or NULL if `key' has no mapping; if fxn returns
+ * a non-zero value, the (possibly updated) element is associated with
+ * `key', adding a mapping if there was none; if fxn returns 0, any mapping
+ * for `key' is removed, and fxn is responsible for the element it was
+ * passed
+ *
+ * returns 1 if `key' has a mapping upon return, 0 if not (fxn returned 0,
+ * or malloc failure, in which case fxn has not been invoked)
+ */
+    int (*compute)(const TSHashMap *hm, char *key,
+                   int (*fxn)(char *key, void **element, void *ctx), void *ctx);
+
+/*
+ * if `key' has no mapping, associates `element' with it; otherwise, the
+ * element `old' associated with `key' is replaced by
+ * mergeFxn(old, element)
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*merge)(const TSHashMap *hm, char *key, void *element,
+                 void *(*mergeFxn)(void *old, void *element));
+
+/*
+ * associates `element' with `key', set to expire `ttl' ticks after the
+ * current time of the hashmap, as for HashMap's putWithTTL(); entries
+ * whose deadlines have passed are reaped by lookups that find them or by
+ * expire()
+ *
+ * returns 1 if successful, 0 if not (malloc failure), -1 if the hashmap
+ * does not support time-to-live (TSHashMap_createReadMostly())
+ */
+    int (*putWithTTL)(const TSHashMap *hm, char *key, void *element, long ttl,
+                      void **previous);
+
+/*
+ * advances the current time of the hashmap to `now', reaping the entries
+ * whose deadlines are <= now; if maxWork > 0, stops after about maxWork
+ * entries have been reaped or steps of the timer wheel taken, so that a
+ * background thread can reap in short bursts without holding up others
+ *
+ * returns the number of entries reaped
+ */
+    long (*expire)(const TSHashMap *hm, long now, long maxWork);
+
+/*
+ * sets the function invoked as expiryFxn(key, element) on each entry that
+ * is reaped; it is invoked with the lock held, so it must not use the
+ * hashmap
+ */
+    void (*setExpiryFxn)(const TSHashMap *hm,
+                         void (*expiryFxn)(char *key, void *element));
 };
 
 #endif /* _TSHASHMAP_H_ */
@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * benchmark of the concurrent hashmaps under a read-mostly workload
+ *
+ * usage: ./tshmbench [maxthreads [opsPerThread]]
+ *
+ * for each kind of TSHashMap and for 1, 2, 4, ... maxthreads threads,
+ * every thread performs opsPerThread operations on random keys, 98% of
+ * them get() and 2% put(); the aggregate throughput is printed
+ */
+
+#include "tshashmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/time.h>
+
+#define NKEYS 100000
+#define PUT_PERCENT 2
+
+static char keys[NKEYS][16];
+
+typedef struct worker {
+    const TSHashMap *hm;
+    long ops;
+    unsigned long seed;
+} Worker;
+
+static void *work(void *arg) {
+    Worker *w = (Worker *)arg;
+    unsigned long x = w->seed;
+    void *p;
+    long i;
+
+    for (i = 0L; i < w->ops; i++) {
+        char *key;
+
+        x = x * 6364136223846793005UL + 1442695040888963407UL;
+        key = keys[(x >> 33) % NKEYS];
+        if ((x >> 20) % 100 < PUT_PERCENT)
+            (void) w->hm->put(w->hm, key, key, &p);
+        else
+            (void) w->hm->get(w->hm, key, &p);
+    }
+    return NULL;
+}
+
+static double now(void) {
+    struct timeval tv;
+
+    gettimeofday(&tv, NULL);
+    return (double)tv.tv_sec + (double)tv.tv_usec / 1000000.0;
+}
+
+static const TSHashMap *create(int kind) {
+    switch (kind) {
+    case 0: return TSHashMap_create(0L, 0.0);
+    case 1: return TSHashMap_createStriped(0L, 0.0, 64L);
+    default: return TSHashMap_createReadMostly(0L, 0.0);
+    }
+}
+
+static char *names[] = {"TSHashMap_create", "TSHashMap_createStriped",
+                        "TSHashMap_createReadMostly"};
+
+int main(int argc, char *argv[]) {
+    long maxThreads = (argc > 1) ? atol(argv[1]) : 8L;
+    long ops = (argc > 2) ? atol(argv[2]) : 1000000L;
+    pthread_t *threads;
+    Worker *workers;
+    long i, t;
+    int kind;
+
+    if (maxThreads < 1L || ops < 1L) {
+        fprintf(stderr, "usage: ./tshmbench [maxthreads [opsPerThread]]\n");
+        return -1;
+    }
+    threads = (pthread_t *)malloc(maxThreads * sizeof(pthread_t));
+    workers = (Worker *)malloc(maxThreads * sizeof(Worker));
+    if (threads == NULL || workers == NULL) {
+        fprintf(stderr, "Unable to allocate thread structures\n");
+        return -1;
+    }
+    for (i = 0L; i < NKEYS; i++)
+        sprintf(keys[i], "key%ld", i);
+    for (kind = 0; kind < 3; kind++) {
+        printf("%s\n", names[kind]);
+        for (t = 1L; t <= maxThreads; t *= 2) {
+            const TSHashMap *hm = create(kind);
+            double start, elapsed;
+            void *p;
+
+            if (hm == NULL) {
+                fprintf(stderr, "Error creating %s\n", names[kind]);
+                return -1;
+            }
+            for (i = 0L; i < NKEYS; i++)
+                (void) hm->put(hm, keys[i], keys[i], &p);
+            start = now();
+            for (i = 0L; i < t; i++) {
+                workers[i].hm = hm;
+                workers[i].ops = ops;
+                workers[i].seed = (unsigned long)i + 1UL;
+                pthread_create(&threads[i], NULL, work, &workers[i]);
+            }
+            for (i = 0L; i < t; i++)
+                pthread_join(threads[i], NULL);
+            elapsed = now() - start;
+            printf("  %3ld threads: %8.2f Mops/s\n", t,
+                   (double)(t * ops) / elapsed / 1000000.0);
+            hm->destroy(hm, NULL);
+        }
+    }
+    free(threads);
+    free(workers);
+    return 0;
+}
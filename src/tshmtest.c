@@ -33,13 +33,141 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <pthread.h>
+
+#define NTHREADS 4
+#define NKEYS 10000
+
+/*
+ * thread function for striped hashmap test; each thread puts NKEYS keys
+ * of its own, then gets and removes every other one of them
+ */
+typedef struct worker {
+    const TSHashMap *hm;
+    long id;
+    long errors;
+} Worker;
+
+/*
+ * prints the parts of `*hs' that do not depend on how the hash function
+ * spreads the keys, and checks that the rest are consistent
+ */
+static void printStats(HashStats *hs) {
+    long i, n;
+
+    printf("size = %ld, capacity = %ld, resizes = %ld\n", hs->size,
+           hs->capacity, hs->resizes);
+    for (i = 0, n = 0; i < HASHSTATS_BINS; i++)
+        n += hs->histogram[i];
+    printf("histogram consistent = %d, ", n == hs->occupied &&
+           hs->maxChain >= 1 && hs->occupied <= hs->size);
+    printf("meanChain consistent = %d, ", hs->meanChain >= 1.0 &&
+           hs->meanChain <= (double)hs->maxChain);
+    printf("lookup counters consistent = %d\n", hs->hits == -1L ||
+           (hs->hits >= hs->size && hs->probes >= hs->hits));
+}
+
+static void *work(void *arg) {
+    Worker *w = (Worker *)arg;
+    char key[32];
+    void *p;
+    long i;
+
+    for (i = 0; i < NKEYS; i++) {
+        sprintf(key, "t%ld-%ld", w->id, i);
+        if (!w->hm->put(w->hm, key, (void *)w, &p))
+            w->errors++;
+    }
+    for (i = 0; i < NKEYS; i++) {
+        sprintf(key, "t%ld-%ld", w->id, i);
+        if (!w->hm->get(w->hm, key, &p) || p != (void *)w)
+            w->errors++;
+        if (i % 2 == 1 && !w->hm->remove(w->hm, key, &p))
+            w->errors++;
+    }
+    return NULL;
+}
+
+/*
+ * callbacks for the computeIfAbsent/compute/merge test; elements are
+ * counts stored directly in the element pointers
+ */
+static void *newCount(char *key, void *ctx) {
+    (void) key;
+    (*(long *)ctx)++;			/* number of times invoked */
+    return (void *)1000L;
+}
+
+static int bumpCount(char *key, void **element, void *ctx) {
+    long n = (long)*element;
+
+    (void) key;
+    (void) ctx;
+    if (n == 1000L)			/* drop those made by newCount() */
+        return 0;
+    *element = (void *)(n + 1L);
+    return 1;
+}
+
+static void *addCounts(void *old, void *element) {
+    return (void *)((long)old + (long)element);
+}
+
+/*
+ * thread function for merge test; each thread adds 1 to the counts of
+ * 100 shared keys NKEYS / 100 times each, so updates collide
+ */
+static void *tally(void *arg) {
+    Worker *w = (Worker *)arg;
+    char key[32];
+    long i;
+
+    for (i = 0; i < NKEYS; i++) {
+        sprintf(key, "c%ld", i % 100);
+        if (!w->hm->merge(w->hm, key, (void *)1L, addCounts))
+            w->errors++;
+    }
+    return NULL;
+}
+
+/*
+ * thread function for putWithTTL/expire test; each thread puts NKEYS keys
+ * of its own with time-to-lives of 1 to 100 ticks, reaping a few entries
+ * after each put; expiryFxn counts the entries reaped
+ */
+static pthread_mutex_t expiredLock = PTHREAD_MUTEX_INITIALIZER;
+static long expired = 0L;
+
+static void countExpired(char *key, void *element) {
+    (void) key;
+    (void) element;
+    pthread_mutex_lock(&expiredLock);
+    expired++;
+    pthread_mutex_unlock(&expiredLock);
+}
+
+static void *expiring(void *arg) {
+    Worker *w = (Worker *)arg;
+    char key[32];
+    void *p;
+    long i;
+
+    for (i = 0; i < NKEYS; i++) {
+        sprintf(key, "e%ld-%ld", w->id, i);
+        if (!w->hm->putWithTTL(w->hm, key, (void *)w, 1L + i % 100L, &p))
+            w->errors++;
+        (void) w->hm->expire(w->hm, i / 100L, 4L);
+    }
+    return NULL;
+}
 
 int main(int argc, char *argv[]) {
     char buf[1024];
-    char key[20];
+    char key[32];
     char *p;
     const TSHashMap *hm;
     long i, n;
+    HashStats hs;
     FILE *fd;
     HMEntry **array;
     const TSIterator *it;
@@ -194,5 +322,325 @@ int main(int argc, char *argv[]) {
     printf("===== test of destroy(free)\n");
     hm->destroy(hm, free);
 
+    /*
+     * test of binary keys
+     */
+    printf("===== test of putn/getn/containsKeyn/removen\n");
+    if ((hm = TSHashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap of binary keys\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->putn(hm, bkey, sizeof(bkey), argv[1], (void **)&p)) {
+            fprintf(stderr, "Error adding %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    printf("Size after putn = %ld\n", hm->size(hm));
+    for (i = 0, n = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (hm->getn(hm, bkey, sizeof(bkey), (void **)&p) && p == argv[1])
+            n++;
+        if (hm->containsKeyn(hm, bkey, sizeof(bkey) - 1))
+            n--;		/* prefix of a key must not match */
+    }
+    printf("Number of keys found = %ld\n", n);
+    (void) hm->put(hm, "abc", argv[1], (void **)&p);
+    printf("containsKeyn(\"abc\", 3) = %d\n", hm->containsKeyn(hm, "abc", 3));
+    printf("containsKeyn(\"abc\", 4) = %d\n", hm->containsKeyn(hm, "abc", 4));
+    for (i = 0; i < 1000; i++) {
+        char bkey[2 * sizeof(long)];
+
+        memset(bkey, 0, sizeof(bkey));
+        memcpy(bkey, &i, sizeof(long));
+        if (!hm->removen(hm, bkey, sizeof(bkey), (void **)&p)) {
+            fprintf(stderr, "Error removing %ld'th binary key\n", i);
+            return -1;
+        }
+    }
+    (void) hm->removen(hm, "abc", 3, (void **)&p);
+    printf("Size after removen = %ld\n", hm->size(hm));
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of batch methods
+     */
+    printf("===== test of putBatch/getBatch\n");
+    if ((hm = TSHashMap_create(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashmap for batches\n");
+        return -1;
+    }
+    {
+        char kbuf[2000][20];
+        char *bkeys[2000];
+        void *values[2000];
+        int found[2000];
+
+        for (i = 0; i < 2000; i++) {
+            sprintf(kbuf[i], "k%ld", i);
+            bkeys[i] = kbuf[i];
+            values[i] = kbuf[i];
+        }
+        n = hm->putBatch(hm, bkeys, 1000, values, NULL);
+        printf("putBatch stored %ld mappings, size = %ld\n", n, hm->size(hm));
+        n = hm->getBatch(hm, bkeys, 2000, values, found);
+        printf("getBatch found %ld of 2000 keys\n", n);
+        for (i = 0; i < 2000; i++) {
+            if (found[i] != (i < 1000) ||
+                (found[i] && strcmp((char *)values[i], bkeys[i]) != 0)) {
+                fprintf(stderr, "Error in getBatch for %ld'th key\n", i);
+                return -1;
+            }
+        }
+    }
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of striped hashmap
+     */
+    printf("===== test of TSHashMap_createStriped\n");
+    if ((hm = TSHashMap_createStriped(0L, 0.0, 8L)) == NULL) {
+        fprintf(stderr, "Error creating striped hashmap\n");
+        return -1;
+    }
+    {
+        pthread_t threads[NTHREADS];
+        Worker workers[NTHREADS];
+
+        for (i = 0; i < NTHREADS; i++) {
+            workers[i].hm = hm;
+            workers[i].id = i;
+            workers[i].errors = 0L;
+            pthread_create(&threads[i], NULL, work, &workers[i]);
+        }
+        n = 0L;
+        for (i = 0; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            n += workers[i].errors;
+        }
+        printf("%d threads finished with %ld errors\n", NTHREADS, n);
+    }
+    printf("Size after threads = %ld\n", hm->size(hm));
+    printf("containsKey(\"t2-10\") = %d, containsKey(\"t2-11\") = %d\n",
+           hm->containsKey(hm, "t2-10"), hm->containsKey(hm, "t2-11"));
+    printf("putUnique(\"t2-10\") = %d\n", hm->putUnique(hm, "t2-10", NULL));
+    if ((array = hm->entryArray(hm, &n)) == NULL) {
+        fprintf(stderr, "Error in entryArray() of striped hashmap\n");
+        return -1;
+    }
+    printf("entryArray returned %ld entries\n", n);
+    free(array);
+    if ((it = hm->itCreate(hm)) == NULL) {
+        fprintf(stderr, "Error in itCreate() of striped hashmap\n");
+        return -1;
+    }
+    for (n = 0L; it->hasNext(it); n++)
+        (void) it->next(it, (void **)&p);
+    it->destroy(it);
+    printf("iterator returned %ld entries\n", n);
+    hm->clear(hm, NULL);
+    printf("Size after clear = %ld, isEmpty = %d\n", hm->size(hm),
+           hm->isEmpty(hm));
+    hm->destroy(hm, NULL);
+
+    /*
+     * test of read-mostly hashmap
+     */
+    printf("===== test of TSHashMap_createReadMostly\n");
+    if ((hm = TSHashMap_createReadMostly(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating read-mostly hashmap\n");
+        return -1;
+    }
+    {
+        pthread_t threads[NTHREADS];
+        Worker workers[NTHREADS];
+
+        for (i = 0; i < NTHREADS; i++) {
+            workers[i].hm = hm;
+            workers[i].id = i;
+            workers[i].errors = 0L;
+            pthread_create(&threads[i], NULL, work, &workers[i]);
+        }
+        n = 0L;
+        for (i = 0; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            n += workers[i].errors;
+        }
+        printf("%d threads finished with %ld errors\n", NTHREADS, n);
+    }
+    printf("Size after threads = %ld\n", hm->size(hm));
+    printf("containsKey(\"t2-10\") = %d, containsKey(\"t2-11\") = %d\n",
+           hm->containsKey(hm, "t2-10"), hm->containsKey(hm, "t2-11"));
+    printf("putUnique(\"t2-10\") = %d\n", hm->putUnique(hm, "t2-10", NULL));
+    if ((it = hm->itCreate(hm)) == NULL) {
+        fprintf(stderr, "Error in itCreate() of read-mostly hashmap\n");
+        return -1;
+    }
+    for (n = 0L; it->hasNext(it); n++)
+        (void) it->next(it, (void **)&p);
+    it->destroy(it);
+    printf("iterator returned %ld entries\n", n);
+    hm->clear(hm, NULL);
+    printf("Size after clear = %ld, isEmpty = %d\n", hm->size(hm),
+           hm->isEmpty(hm));
+    hm->destroy(hm, NULL);
+    /*
+     * test of stats() for each kind of TSHashMap
+     */
+    printf("===== test of stats\n");
+    for (n = 0; n < 3; n++) {
+        if (n == 0)
+            hm = TSHashMap_create(0L, 0.0);
+        else if (n == 1)
+            hm = TSHashMap_createStriped(0L, 0.0, 4L);
+        else
+            hm = TSHashMap_createReadMostly(0L, 0.0);
+        if (hm == NULL) {
+            fprintf(stderr, "Error creating hashmap for stats\n");
+            return -1;
+        }
+        for (i = 0; i < 1000; i++) {
+            sprintf(key, "%ld", i);
+            (void) hm->put(hm, key, NULL, (void **)&p);
+            (void) hm->containsKey(hm, key);
+        }
+        hm->stats(hm, &hs);
+        printStats(&hs);
+        hm->destroy(hm, NULL);
+    }
+    /*
+     * test of computeIfAbsent(), compute() and merge() for each kind of
+     * TSHashMap; the merges are made by concurrent threads
+     */
+    printf("===== test of computeIfAbsent/compute/merge\n");
+    for (n = 0; n < 3; n++) {
+        pthread_t threads[NTHREADS];
+        Worker workers[NTHREADS];
+        long count, errors;
+
+        if (n == 0)
+            hm = TSHashMap_create(0L, 0.0);
+        else if (n == 1)
+            hm = TSHashMap_createStriped(0L, 0.0, 4L);
+        else
+            hm = TSHashMap_createReadMostly(0L, 0.0);
+        if (hm == NULL) {
+            fprintf(stderr, "Error creating hashmap for compute\n");
+            return -1;
+        }
+        for (i = 0; i < NTHREADS; i++) {
+            workers[i].hm = hm;
+            workers[i].id = i;
+            workers[i].errors = 0L;
+            pthread_create(&threads[i], NULL, tally, &workers[i]);
+        }
+        for (i = 0, errors = 0L; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            errors += workers[i].errors;
+        }
+        for (i = 0, count = 0L; i < 100; i++) {
+            sprintf(key, "c%ld", i);
+            if (hm->get(hm, key, (void **)&p) &&
+                (long)p == NTHREADS * NKEYS / 100)
+                count++;
+        }
+        printf("Size after merges = %ld, %ld errors, %ld counts of %d\n",
+               hm->size(hm), errors, count, NTHREADS * NKEYS / 100);
+        count = 0L;
+        for (i = 0; i < 200; i++) {
+            sprintf(key, "c%ld", i);
+            if (!hm->computeIfAbsent(hm, key, newCount, &count, (void **)&p))
+                fprintf(stderr, "Error in computeIfAbsent for %s\n", key);
+        }
+        printf("Size after computeIfAbsent = %ld, factory invoked %ld times\n",
+               hm->size(hm), count);
+        for (i = 0, count = 0L; i < 200; i++) {
+            sprintf(key, "c%ld", i);
+            count += hm->compute(hm, key, bumpCount, NULL);
+        }
+        (void) hm->get(hm, "c42", (void **)&p);
+        printf("Size after compute = %ld, %ld kept, \"c42\" -> %ld\n",
+               hm->size(hm), count, (long)p);
+        hm->destroy(hm, NULL);
+    }
+    /*
+     * test of putWithTTL() and expire(); the read-mostly hashmap does not
+     * support time-to-live
+     */
+    printf("===== test of putWithTTL/expire\n");
+    for (n = 0; n < 2; n++) {
+        pthread_t threads[NTHREADS];
+        Worker workers[NTHREADS];
+        long errors;
+
+        if (n == 0)
+            hm = TSHashMap_create(0L, 0.0);
+        else
+            hm = TSHashMap_createStriped(0L, 0.0, 4L);
+        if (hm == NULL) {
+            fprintf(stderr, "Error creating hashmap for TTL\n");
+            return -1;
+        }
+        hm->setExpiryFxn(hm, countExpired);
+        expired = 0L;
+        for (i = 0; i < NTHREADS; i++) {
+            workers[i].hm = hm;
+            workers[i].id = i;
+            workers[i].errors = 0L;
+            pthread_create(&threads[i], NULL, expiring, &workers[i]);
+        }
+        for (i = 0, errors = 0L; i < NTHREADS; i++) {
+            pthread_join(threads[i], NULL);
+            errors += workers[i].errors;
+        }
+        (void) hm->put(hm, "forever", NULL, (void **)&p);
+        (void) hm->expire(hm, 1000L, 0L);
+        printf("%ld errors, size after expire = %ld, ", errors, hm->size(hm));
+        printf("expiryFxn invoked %ld times\n", expired);
+        hm->destroy(hm, NULL);
+    }
+    /*
+     * a striped hashmap whose expire() was cut short by maxWork must still
+     * give each new entry a deadline relative to the latest `now', whatever
+     * its stripe
+     */
+    if ((hm = TSHashMap_createStriped(0L, 0.0, 16L)) == NULL) {
+        fprintf(stderr, "Error creating striped hashmap for TTL\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "%ld", i);
+        (void) hm->putWithTTL(hm, key, NULL, 1L + i, (void **)&p);
+    }
+    (void) hm->expire(hm, 5000L, 1L);
+    for (i = 0; i < 1000; i++) {
+        sprintf(key, "late%ld", i);
+        (void) hm->putWithTTL(hm, key, NULL, 100L, (void **)&p);
+    }
+    (void) hm->expire(hm, 5099L, 0L);
+    for (i = 0, n = 0; i < 1000; i++) {
+        sprintf(key, "late%ld", i);
+        n += hm->containsKey(hm, key);
+    }
+    printf("striped: %ld of 1000 alive just before their deadline, ", n);
+    (void) hm->expire(hm, 5100L, 0L);
+    printf("size at the deadline = %ld\n", hm->size(hm));
+    hm->destroy(hm, NULL);
+    if ((hm = TSHashMap_createReadMostly(0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating read-mostly hashmap for TTL\n");
+        return -1;
+    }
+    printf("read-mostly putWithTTL() = %d, expire() = %ld\n",
+           hm->putWithTTL(hm, "k", NULL, 1L, (void **)&p),
+           hm->expire(hm, 1L, 0L));
+    hm->destroy(hm, NULL);
+
     return 0;
 }
@@ -41,7 +41,8 @@ typedef struct tsit_data {
     long next;
     long size;
     void **elements;
-    pthread_mutex_t *lock;
+    void (*unlock)(void *arg);
+    void *arg;
 } TSItData;
 
 static int tsit_hasNext(const TSIterator *it) {
@@ -65,7 +66,7 @@ static void tsit_destroy(const TSIterator *it) {
     TSItData *itd = (TSItData *)it->self;
 
     free(itd->elements);
-    pthread_mutex_unlock(itd->lock);
+    (*itd->unlock)(itd->arg);
     free(itd);
     free((void *)it);
 }
@@ -74,8 +75,9 @@ static TSIterator template = {
     NULL, tsit_hasNext, tsit_next, tsit_destroy
 };
 
-const TSIterator *TSIterator_create(pthread_mutex_t *lock, long size,
-                                    void **elements) {
+const TSIterator *TSIterator_createWithUnlock(void (*unlock)(void *arg),
+                                              void *arg, long size,
+                                              void **elements) {
     TSIterator *it = (TSIterator *)malloc(sizeof(TSIterator));
 
     if (it != NULL) {
@@ -85,7 +87,8 @@ const TSIterator *TSIterator_create(pthread_mutex_t *lock, long size,
             itd->next = 0L;
             itd->size = size;
             itd->elements = elements;
-            itd->lock = lock;
+            itd->unlock = unlock;
+            itd->arg = arg;
             *it = template;
             it->self = itd;
         } else {
@@ -95,3 +98,12 @@ const TSIterator *TSIterator_create(pthread_mutex_t *lock, long size,
     }
     return it;
 }
+
+static void unlockMutex(void *arg) {
+    pthread_mutex_unlock((pthread_mutex_t *)arg);
+}
+
+const TSIterator *TSIterator_create(pthread_mutex_t *lock, long size,
+                                    void **elements) {
+    return TSIterator_createWithUnlock(unlockMutex, lock, size, elements);
+}
@@ -58,6 +58,18 @@ typedef struct tsiterator TSIterator;	/* forward reference */
 const TSIterator *TSIterator_create(pthread_mutex_t *lock, long size,
                                     void **elements);
 
+/*
+ * creates a thread-safe iterator as with TSIterator_create(), for ADTs that
+ * protect an instance with more than one lock; instead of releasing a single
+ * lock, destroy invokes unlock(arg) to release all of the locks that were
+ * held when the iterator was created
+ *
+ * returns pointer to iterator if successful, NULL otherwise
+ */
+const TSIterator *TSIterator_createWithUnlock(void (*unlock)(void *arg),
+                                              void *arg, long size,
+                                              void **elements);
+
 /*
  * now define struct tsiterator
  */
@@ -238,11 +238,53 @@ static const TSIterator *tsos_itCreate(const TSOrderedSet *os) {
     return it;
 }
 
+static const TSIterator *tsos_range(const TSOrderedSet *os, void *lo,
+                                    int loInclusive, void *hi,
+                                    int hiInclusive) {
+    TSOsData *osd = (TSOsData *)os->self;
+    const TSIterator *it = NULL;
+    const Iterator *rit;
+    void **tmp;
+    long len;
+
+    pthread_mutex_lock(LOCK(osd));
+    len = osd->os->countRange(osd->os, lo, loInclusive, hi, hiInclusive);
+    tmp = (void **)malloc(((len > 0L) ? len : 1L) * sizeof(void *));
+    if (tmp != NULL) {
+        rit = osd->os->range(osd->os, lo, loInclusive, hi, hiInclusive);
+        if (rit != NULL) {
+            long i;
+
+            for (i = 0L; rit->next(rit, tmp + i); i++)
+                ;
+            rit->destroy(rit);
+            it = TSIterator_create(LOCK(osd), len, tmp);
+        }
+        if (it == NULL)
+            free(tmp);
+    }
+    if (it == NULL)
+        pthread_mutex_unlock(LOCK(osd));
+    return it;
+}
+
+static long tsos_countRange(const TSOrderedSet *os, void *lo, int loInclusive,
+                            void *hi, int hiInclusive) {
+    TSOsData *osd = (TSOsData *)os->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(osd));
+    result = osd->os->countRange(osd->os, lo, loInclusive, hi, hiInclusive);
+    pthread_mutex_unlock(LOCK(osd));
+    return result;
+}
+
 static TSOrderedSet template = {
     NULL, tsos_destroy, tsos_lock, tsos_unlock, tsos_add, tsos_ceiling,
     tsos_clear, tsos_contains, tsos_first, tsos_floor, tsos_higher,
     tsos_isEmpty, tsos_last, tsos_lower, tsos_pollFirst, tsos_pollLast,
-    tsos_remove, tsos_size, tsos_toArray, tsos_itCreate
+    tsos_remove, tsos_size, tsos_toArray, tsos_itCreate, tsos_range,
+    tsos_countRange
 };
 
 const TSOrderedSet *TSOrderedSet_create(int (*cmpFunction)(void *, void *)) {
@@ -189,6 +189,28 @@ struct tsorderedset {
  * returns pointer to the Iterator or NULL if failure
  */
     const TSIterator *(*itCreate)(const TSOrderedSet *ts);
+
+/*
+ * create generic iterator over the elements from `lo' to `hi', in order;
+ * `lo' (`hi') is included in the range if `loInclusive' (`hiInclusive')
+ * is 1, excluded if it is 0; a NULL `lo' (`hi') leaves the range unbounded
+ * below (above)
+ *
+ * as with itCreate(), the lock is held until the iterator is destroyed;
+ * only the k elements in the range are copied, so creation takes
+ * O(log n + k) time
+ *
+ * returns pointer to the Iterator or NULL if failure
+ */
+    const TSIterator *(*range)(const TSOrderedSet *ts, void *lo,
+                               int loInclusive, void *hi, int hiInclusive);
+
+/*
+ * returns the number of elements in the range from `lo' to `hi', with
+ * the bounds interpreted as for range()
+ */
+    long (*countRange)(const TSOrderedSet *ts, void *lo, int loInclusive,
+                       void *hi, int hiInclusive);
 };
 
 #endif /* _TSORDEREDSET_H_ */
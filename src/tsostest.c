@@ -205,6 +205,41 @@ int main(int argc, char *argv[]) {
      */
     printf("===== test of destroy(free)\n");
     ts->destroy(ts, free);
+    /*
+     * test of range and countRange
+     */
+    printf("===== test of range and countRange\n");
+    if ((ts = TSOrderedSet_create(scmp)) == NULL) {
+        fprintf(stderr, "Error creating ordered set for range\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%04ld", 3 * i);
+        if ((p = strdup(buf)) == NULL || !ts->add(ts, p)) {
+            fprintf(stderr, "Error adding %s\n", buf);
+            return -1;
+        }
+    }
+    if ((it = ts->range(ts, "0100", 1, "0130", 1)) == NULL) {
+        fprintf(stderr, "Error creating range iterator\n");
+        return -1;
+    }
+    printf("range [0100, 0130]:");
+    while (it->next(it, (void **)&p))
+        printf(" %s", p);
+    printf("\n");
+    it->destroy(it);
+    printf("countRange [0102, 0129] = %ld\n",
+           ts->countRange(ts, "0102", 1, "0129", 1));
+    printf("countRange (0102, 0129) = %ld\n",
+           ts->countRange(ts, "0102", 0, "0129", 0));
+    printf("countRange [NULL, 1500) = %ld\n",
+           ts->countRange(ts, NULL, 1, "1500", 0));
+    printf("countRange (1500, NULL] = %ld\n",
+           ts->countRange(ts, "1500", 0, NULL, 1));
+    printf("countRange [0200, 0100] = %ld\n",
+           ts->countRange(ts, "0200", 1, "0100", 1));
+    ts->destroy(ts, free);
 
     return 0;
 }
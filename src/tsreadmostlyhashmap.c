@@ -0,0 +1,801 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of TSHashMap_createReadMostly()
+ *
+ * the hashmap is a chained table whose bucket array and entries are only
+ * changed by writers, which serialize on a recursive mutex; every change
+ * is published with a single atomic pointer store, so readers traverse
+ * the table without a lock and always see either the old or the new
+ * state of a chain
+ *
+ * removed entries, and the bucket array and entries replaced by a resize
+ * (which copies the entries into a new table rather than relinking them
+ * under the feet of readers), are retired rather than freed; they are
+ * freed once every reader that might still hold a pointer to them has
+ * finished, which is detected with a global epoch and per-epoch reader
+ * counts:
+ *
+ *   a reader announces itself by incrementing the count for the parity of
+ *   the current epoch in one of NSLOTS padded slots, rechecking that the
+ *   epoch did not change meanwhile; it decrements the count when done
+ *
+ *   a writer may advance the epoch from e to e+1 once no reader remains
+ *   counted under the parity of e-1; anything retired during epoch e-1 or
+ *   earlier can then no longer be reached by any reader, and is freed
+ */
+
+#include "tshashmap.h"
+#include "hashmap.h"
+#include "hmentry.h"
+#include "hash64.h"
+#include "chainstats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define DEFAULT_CAPACITY 16L
+#define MAX_CAPACITY 134217728L
+#define DEFAULT_LOAD_FACTOR 0.75
+#define NSLOTS 64		/* number of reader count slots */
+#define CACHE_LINE 64
+#define RECLAIM_EVERY 32	/* retirements between reclamation attempts */
+
+#define LOAD(p) __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define STORE(p, v) __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+
+#define LOCK(hm) &((hm)->lock)
+
+/*
+ * bucket array; a resize replaces the whole structure
+ */
+typedef struct table {
+    long capacity;
+    HMEntry *buckets[1];	/* actually capacity buckets */
+} Table;
+
+/*
+ * an entry or table awaiting reclamation; if `table' is set, the entries
+ * still chained from it are freed along with it
+ */
+typedef struct retired {
+    struct retired *next;
+    unsigned long epoch;
+    HMEntry *entry;
+    Table *table;
+} Retired;
+
+typedef struct slot {
+    long count[2];		/* readers in even and odd epochs */
+    char pad[CACHE_LINE - 2 * sizeof(long)];
+} Slot;
+
+typedef struct tsrm_data {
+    Table *table;		/* read without the lock */
+    long size;			/* read without the lock */
+    double loadFactor;
+    unsigned long epoch;	/* read without the lock */
+    Retired *retired;
+    long nretired;
+    pthread_mutex_t lock;	/* this is a recursive lock, held by writers */
+    Slot slots[NSLOTS];
+    long resizes;		/* counters reported by stats(); the last */
+    double resizeTime;		/* three are only maintained, atomically, */
+    long hits;			/* if compiled with -DHASH_STATS */
+    long misses;
+    long probes;
+} TSRmData;
+
+/*
+ * local function to pick the slot of the calling thread; threads have
+ * distinct stacks, so the address of a local variable identifies the thread
+ * well enough to spread readers over the slots; threads that share a slot
+ * merely contend on its counts
+ */
+static Slot *mySlot(TSRmData *hmd) {
+    char probe;
+    unsigned long long a = (unsigned long long)(size_t)&probe >> 12;
+
+    return &hmd->slots[(a * HASH64_S0 >> 32) % NSLOTS];
+}
+
+/*
+ * local functions to begin and end a read-side critical section; any
+ * entry or table reached between them remains allocated until the end
+ */
+static unsigned long readBegin(TSRmData *hmd, Slot *s) {
+    unsigned long e;
+
+    for (;;) {
+        e = __atomic_load_n(&hmd->epoch, __ATOMIC_SEQ_CST);
+        __atomic_fetch_add(&s->count[e & 1], 1L, __ATOMIC_SEQ_CST);
+        if (__atomic_load_n(&hmd->epoch, __ATOMIC_SEQ_CST) == e)
+            return e;
+        __atomic_fetch_sub(&s->count[e & 1], 1L, __ATOMIC_RELEASE);
+    }
+}
+
+static void readEnd(Slot *s, unsigned long e) {
+    __atomic_fetch_sub(&s->count[e & 1], 1L, __ATOMIC_RELEASE);
+}
+
+static HMEntry *newEntry(void *key, size_t len, unsigned long long h,
+                         void *element) {
+    HMEntry *p = (HMEntry *)malloc(sizeof(HMEntry) + len + 1);
+
+    if (p != NULL) {
+        p->key = (char *)(p + 1);
+        memcpy(p->key, key, len);
+        p->key[len] = '\0';
+        p->keylen = len;
+        p->hash = h;
+        p->element = element;
+        p->next = NULL;
+    }
+    return p;
+}
+
+static Table *newTable(long N) {
+    Table *t = (Table *)malloc(sizeof(Table) + (N - 1) * sizeof(HMEntry *));
+    long i;
+
+    if (t != NULL) {
+        t->capacity = N;
+        for (i = 0L; i < N; i++)
+            t->buckets[i] = NULL;
+    }
+    return t;
+}
+
+/*
+ * local function to free a table and the entries chained from it, invoking
+ * freeFxn on each element if freeFxn != NULL
+ */
+static void freeTable(Table *t, void (*freeFxn)(void *element)) {
+    HMEntry *p, *q;
+    long i;
+
+    for (i = 0L; i < t->capacity; i++) {
+        for (p = t->buckets[i]; p != NULL; p = q) {
+            q = p->next;
+            if (freeFxn != NULL)
+                (*freeFxn)(p->element);
+            free(p);
+        }
+    }
+    free(t);
+}
+
+static void freeRetired(Retired *r) {
+    if (r->table != NULL)
+        freeTable(r->table, NULL);
+    else
+        free(r->entry);
+    free(r);
+}
+
+/*
+ * local function that advances the epoch if no readers remain from the
+ * previous one, then frees whatever was retired two or more epochs ago;
+ * the lock must be held
+ */
+static void reclaim(TSRmData *hmd) {
+    unsigned long e = hmd->epoch;
+    Retired *r, **pp;
+    long i, n = 0L;
+
+    for (i = 0L; i < NSLOTS; i++)
+        n += __atomic_load_n(&hmd->slots[i].count[(e + 1) & 1],
+                             __ATOMIC_SEQ_CST);
+    if (n != 0L)
+        return;
+    __atomic_store_n(&hmd->epoch, ++e, __ATOMIC_SEQ_CST);
+    for (pp = &hmd->retired; (r = *pp) != NULL; ) {
+        if (r->epoch + 2 <= e) {
+            *pp = r->next;
+            freeRetired(r);
+            hmd->nretired--;
+        } else
+            pp = &r->next;
+    }
+}
+
+/*
+ * local function to retire an entry or a table; if the Retired record
+ * cannot be allocated, the retired memory is leaked rather than freed
+ * while readers may be using it
+ */
+static void retire(TSRmData *hmd, HMEntry *entry, Table *table) {
+    Retired *r = (Retired *)malloc(sizeof(Retired));
+
+    if (r != NULL) {
+        r->epoch = hmd->epoch;
+        r->entry = entry;
+        r->table = table;
+        r->next = hmd->retired;
+        hmd->retired = r;
+        if (++hmd->nretired % RECLAIM_EVERY == 0L || table != NULL)
+            reclaim(hmd);
+    }
+}
+
+static void tsrm_destroy(const TSHashMap *hm, void (*freeFxn)(void *element)) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    Retired *r, *q;
+
+    pthread_mutex_lock(LOCK(hmd));
+    freeTable(hmd->table, freeFxn);
+    for (r = hmd->retired; r != NULL; r = q) {
+        q = r->next;
+        freeRetired(r);
+    }
+    pthread_mutex_unlock(LOCK(hmd));
+    pthread_mutex_destroy(LOCK(hmd));
+    free(hmd);
+    free((void *)hm);
+}
+
+static void tsrm_clear(const TSHashMap *hm, void (*freeFxn)(void *element)) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    Table *old, *t;
+    HMEntry *p;
+    long i;
+
+    pthread_mutex_lock(LOCK(hmd));
+    old = hmd->table;
+    if ((t = newTable(old->capacity)) != NULL) {
+        if (freeFxn != NULL) {
+            for (i = 0L; i < old->capacity; i++)
+                for (p = old->buckets[i]; p != NULL; p = p->next)
+                    (*freeFxn)(p->element);
+        }
+        STORE(&hmd->table, t);
+        STORE(&hmd->size, 0L);
+        retire(hmd, NULL, old);
+    }
+    pthread_mutex_unlock(LOCK(hmd));
+}
+
+static void tsrm_lock(const TSHashMap *hm) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+
+    pthread_mutex_lock(LOCK(hmd));
+}
+
+static void tsrm_unlock(const TSHashMap *hm) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+
+    pthread_mutex_unlock(LOCK(hmd));
+}
+
+/*
+ * local function to locate the `len'-byte key in table `t' of `hmd'; safe
+ * to call without the lock inside a read-side critical section
+ */
+static HMEntry *findKey(TSRmData *hmd, Table *t, void *key, size_t len,
+                        unsigned long long h) {
+    HMEntry *p;
+    long n = 0L;
+
+    p = LOAD(&t->buckets[h % (unsigned long long)t->capacity]);
+    for (; p != NULL; p = LOAD(&p->next)) {
+        n++;
+        if (p->hash == h && p->keylen == len && memcmp(p->key, key, len) == 0)
+            break;
+    }
+    STAT(__atomic_fetch_add(&hmd->probes, n, __ATOMIC_RELAXED));
+    STAT(__atomic_fetch_add((p != NULL) ? &hmd->hits : &hmd->misses, 1L,
+                            __ATOMIC_RELAXED));
+    (void) hmd;
+    (void) n;
+    return p;
+}
+
+static int tsrm_getn(const TSHashMap *hm, void *key, long len,
+                     void **element) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    unsigned long long h = hash64(key, len);
+    Slot *s = mySlot(hmd);
+    unsigned long e = readBegin(hmd, s);
+    HMEntry *p = findKey(hmd, LOAD(&hmd->table), key, len, h);
+    int result = 0;
+
+    if (p != NULL) {
+        *element = LOAD(&p->element);
+        result = 1;
+    }
+    readEnd(s, e);
+    return  result;
+}
+
+static int tsrm_get(const TSHashMap *hm, char *key, void **element) {
+    return tsrm_getn(hm, key, (long)strlen(key), element);
+}
+
+static int tsrm_containsKeyn(const TSHashMap *hm, void *key, long len) {
+    void *element;
+
+    return tsrm_getn(hm, key, len, &element);
+}
+
+static int tsrm_containsKey(const TSHashMap *hm, char *key) {
+    return tsrm_containsKeyn(hm, key, (long)strlen(key));
+}
+
+/*
+ * local function for generating an array of HMEntry * or of keys from the
+ * hashmap; the lock must be held
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static void **entries(TSRmData *hmd, int wantKeys) {
+    Table *t = hmd->table;
+    void **tmp = NULL;
+    HMEntry *p;
+    long i, n = 0L;
+
+    if (hmd->size > 0L) {
+        tmp = (void **)malloc(hmd->size * sizeof(void *));
+        if (tmp != NULL) {
+            for (i = 0L; i < t->capacity; i++)
+                for (p = t->buckets[i]; p != NULL; p = p->next)
+                    tmp[n++] = wantKeys ? (void *)p->key : (void *)p;
+        }
+    }
+    return tmp;
+}
+
+static HMEntry **tsrm_entryArray(const TSHashMap *hm, long *len) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    HMEntry **result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = (HMEntry **)entries(hmd, 0);
+    if (result != NULL)
+        *len = hmd->size;
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static long tsrm_size(const TSHashMap *hm) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+
+    return __atomic_load_n(&hmd->size, __ATOMIC_RELAXED);
+}
+
+static int tsrm_isEmpty(const TSHashMap *hm) {
+    return (tsrm_size(hm) == 0L);
+}
+
+static char **tsrm_keyArray(const TSHashMap *hm, long *len) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    char **result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = (char **)entries(hmd, 1);
+    if (result != NULL)
+        *len = hmd->size;
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+/*
+ * local function that doubles the number of buckets; the entries are
+ * copied into the new table, which is then published, and the old table
+ * and its entries are retired; the lock must be held
+ */
+static void resize(TSRmData *hmd) {
+    Table *old = hmd->table, *t;
+    HMEntry *p, *q;
+    long i, j, N = 2 * old->capacity;
+    double start = chainstats_clock();
+
+    if (N > MAX_CAPACITY)
+        N = MAX_CAPACITY;
+    if (N == old->capacity || (t = newTable(N)) == NULL)
+        return;
+    for (i = 0L; i < old->capacity; i++) {
+        for (p = old->buckets[i]; p != NULL; p = p->next) {
+            if ((q = newEntry(p->key, p->keylen, p->hash, p->element)) == NULL) {
+                t->capacity = N;
+                freeTable(t, NULL);
+                return;
+            }
+            j = (long)(q->hash % (unsigned long long)N);
+            q->next = t->buckets[j];
+            t->buckets[j] = q;
+        }
+    }
+    STORE(&hmd->table, t);
+    retire(hmd, NULL, old);
+    hmd->resizes++;
+    hmd->resizeTime += chainstats_clock() - start;
+}
+
+/*
+ * local function that publishes the new entry `p' at the head of its
+ * chain, resizing the table if the load factor is exceeded; the lock must
+ * be held
+ */
+static void addEntry(TSRmData *hmd, HMEntry *p) {
+    Table *t = hmd->table;
+    long i = (long)(p->hash % (unsigned long long)t->capacity);
+
+    p->next = t->buckets[i];
+    STORE(&t->buckets[i], p);
+    STORE(&hmd->size, hmd->size + 1L);
+    if ((double)hmd->size / (double)t->capacity > hmd->loadFactor)
+        resize(hmd);
+}
+
+/*
+ * local function that adds or replaces the mapping for the `len'-byte key;
+ * the lock must be held
+ */
+static int putEntry(TSRmData *hmd, void *key, size_t len, void *element,
+                    void **previous, int unique) {
+    unsigned long long h = hash64(key, len);
+    HMEntry *p = findKey(hmd, hmd->table, key, len, h);
+
+    *previous = NULL;
+    if (p != NULL) {
+        if (unique)
+            return 0;
+        *previous = p->element;
+        STORE(&p->element, element);
+        return 1;
+    }
+    if ((p = newEntry(key, len, h, element)) == NULL)
+        return 0;
+    addEntry(hmd, p);
+    return 1;
+}
+
+static int tsrm_putn(const TSHashMap *hm, void *key, long len, void *element,
+                     void **previous) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = putEntry(hmd, key, len, element, previous, 0);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tsrm_put(const TSHashMap *hm, char *key, void *element,
+                    void **previous) {
+    return tsrm_putn(hm, key, (long)strlen(key), element, previous);
+}
+
+static int tsrm_putUnique(const TSHashMap *hm, char *key, void *element) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    void *previous;
+    int result;
+
+    pthread_mutex_lock(LOCK(hmd));
+    result = putEntry(hmd, key, strlen(key), element, &previous, 1);
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+/*
+ * local function returning the link that points to the entry for the
+ * `len'-byte key, or to the NULL that ends its chain if there is no entry;
+ * the lock must be held
+ */
+static HMEntry **findLink(TSRmData *hmd, void *key, size_t len,
+                          unsigned long long h) {
+    Table *t = hmd->table;
+    HMEntry *p, **pp;
+
+    pp = &t->buckets[h % (unsigned long long)t->capacity];
+    for (; (p = *pp) != NULL; pp = &p->next) {
+        if (p->hash == h && p->keylen == len && memcmp(p->key, key, len) == 0)
+            break;
+    }
+    return pp;
+}
+
+/*
+ * local function that unlinks the entry at `*pp' and retires it; the lock
+ * must be held
+ */
+static void unlinkEntry(TSRmData *hmd, HMEntry **pp) {
+    HMEntry *p = *pp;
+
+    STORE(pp, p->next);
+    STORE(&hmd->size, hmd->size - 1L);
+    retire(hmd, p, NULL);
+}
+
+static int tsrm_removen(const TSHashMap *hm, void *key, long len,
+                        void **element) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    HMEntry **pp;
+    int result = 0;
+
+    pthread_mutex_lock(LOCK(hmd));
+    pp = findLink(hmd, key, len, hash64(key, len));
+    if (*pp != NULL) {
+        *element = (*pp)->element;
+        unlinkEntry(hmd, pp);
+        result = 1;
+    }
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tsrm_remove(const TSHashMap *hm, char *key, void **element) {
+    return tsrm_removen(hm, key, (long)strlen(key), element);
+}
+
+/*
+ * the methods below never expose an entry to readers before its element
+ * is known: a new entry is allocated first, so that malloc failure is
+ * detected before any callback is invoked, but is only published once
+ * the callback has produced its element
+ */
+static int tsrm_computeIfAbsent(const TSHashMap *hm, char *key,
+                                void *(*factory)(char *key, void *ctx),
+                                void *ctx, void **element) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    HMEntry *p;
+    int result = 1;
+
+    pthread_mutex_lock(LOCK(hmd));
+    if ((p = *findLink(hmd, key, len, h)) != NULL)
+        *element = p->element;
+    else if ((p = newEntry(key, len, h, NULL)) != NULL) {
+        p->element = factory(key, ctx);
+        *element = p->element;
+        addEntry(hmd, p);
+    } else
+        result = 0;
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tsrm_compute(const TSHashMap *hm, char *key,
+                        int (*fxn)(char *key, void **element, void *ctx),
+                        void *ctx) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    HMEntry *p, **pp;
+    void *element;
+    int result = 0;
+
+    pthread_mutex_lock(LOCK(hmd));
+    pp = findLink(hmd, key, len, h);
+    if ((p = *pp) != NULL) {
+        element = p->element;
+        if ((result = fxn(key, &element, ctx)))
+            STORE(&p->element, element);
+        else
+            unlinkEntry(hmd, pp);
+    } else if ((p = newEntry(key, len, h, NULL)) != NULL) {
+        if ((result = fxn(key, &p->element, ctx)))
+            addEntry(hmd, p);
+        else
+            free(p);
+    }
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static int tsrm_merge(const TSHashMap *hm, char *key, void *element,
+                      void *(*mergeFxn)(void *old, void *element)) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    size_t len = strlen(key);
+    unsigned long long h = hash64(key, len);
+    HMEntry *p;
+    int result = 1;
+
+    pthread_mutex_lock(LOCK(hmd));
+    if ((p = *findLink(hmd, key, len, h)) != NULL)
+        STORE(&p->element, mergeFxn(p->element, element));
+    else if ((p = newEntry(key, len, h, element)) != NULL)
+        addEntry(hmd, p);
+    else
+        result = 0;
+    pthread_mutex_unlock(LOCK(hmd));
+    return  result;
+}
+
+static const TSIterator *tsrm_itCreate(const TSHashMap *hm) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    const TSIterator *it = NULL;
+    void **tmp;
+
+    pthread_mutex_lock(LOCK(hmd));
+    tmp = entries(hmd, 0);
+    if (tmp != NULL) {
+        it = TSIterator_create(LOCK(hmd), hmd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    if (it == NULL)
+        pthread_mutex_unlock(LOCK(hmd));
+    return it;
+}
+
+/*
+ * the whole batch is looked up in a single read-side critical section
+ */
+static long tsrm_getBatch(const TSHashMap *hm, char **keys, long n,
+                          void **elements, int *found) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    Slot *s = mySlot(hmd);
+    unsigned long e = readBegin(hmd, s);
+    Table *t = LOAD(&hmd->table);
+    long i, ans = 0L;
+
+    for (i = 0L; i < n; i++) {
+        size_t len = strlen(keys[i]);
+        HMEntry *p = findKey(hmd, t, keys[i], len, hash64(keys[i], len));
+
+        elements[i] = (p != NULL) ? LOAD(&p->element) : NULL;
+        if (found != NULL)
+            found[i] = (p != NULL);
+        if (p != NULL)
+            ans++;
+    }
+    readEnd(s, e);
+    return ans;
+}
+
+static long tsrm_putBatch(const TSHashMap *hm, char **keys, long n,
+                          void **elements, void **previous) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    long i, ans = 0L;
+    void *prev;
+
+    pthread_mutex_lock(LOCK(hmd));
+    for (i = 0L; i < n; i++) {
+        if (putEntry(hmd, keys[i], strlen(keys[i]), elements[i], &prev, 0))
+            ans++;
+        if (previous != NULL)
+            previous[i] = prev;
+    }
+    pthread_mutex_unlock(LOCK(hmd));
+    return ans;
+}
+
+/*
+ * the table only changes under the lock, so the chains are walked with it
+ * held
+ */
+static void tsrm_stats(const TSHashMap *hm, HashStats *hs) {
+    TSRmData *hmd = (TSRmData *)hm->self;
+    Table *t;
+    HMEntry *p;
+    long i, n;
+
+    pthread_mutex_lock(LOCK(hmd));
+    t = hmd->table;
+    chainstats_init(hs);
+    hs->size = hmd->size;
+    hs->capacity = t->capacity;
+    for (i = 0L; i < t->capacity; i++) {
+        for (n = 0L, p = t->buckets[i]; p != NULL; p = p->next)
+            n++;
+        chainstats_add(hs, n);
+    }
+    chainstats_finish(hs, hmd->resizes, hmd->resizeTime,
+                      __atomic_load_n(&hmd->hits, __ATOMIC_RELAXED),
+                      __atomic_load_n(&hmd->misses, __ATOMIC_RELAXED),
+                      __atomic_load_n(&hmd->probes, __ATOMIC_RELAXED));
+    pthread_mutex_unlock(LOCK(hmd));
+}
+
+/*
+ * time-to-live is not supported, since reaping an entry on lookup would
+ * turn readers into writers; putWithTTL() says so by returning -1, which
+ * a caller cannot mistake for the 0 of a malloc failure
+ */
+static int tsrm_putWithTTL(const TSHashMap *hm, char *key, void *element,
+                           long ttl, void **previous) {
+    (void) hm;
+    (void) key;
+    (void) element;
+    (void) ttl;
+    (void) previous;
+    return -1;
+}
+
+static long tsrm_expire(const TSHashMap *hm, long now, long maxWork) {
+    (void) hm;
+    (void) now;
+    (void) maxWork;
+    return 0L;
+}
+
+static void tsrm_setExpiryFxn(const TSHashMap *hm,
+                              void (*expiryFxn)(char *key, void *element)) {
+    (void) hm;
+    (void) expiryFxn;
+}
+
+static TSHashMap template = {
+    NULL, tsrm_destroy, tsrm_clear, tsrm_lock, tsrm_unlock, tsrm_containsKey,
+    tsrm_entryArray, tsrm_get, tsrm_isEmpty, tsrm_keyArray, tsrm_put,
+    tsrm_putUnique, tsrm_remove, tsrm_size, tsrm_itCreate, tsrm_containsKeyn,
+    tsrm_getn, tsrm_putn, tsrm_removen, tsrm_getBatch, tsrm_putBatch,
+    tsrm_stats, tsrm_computeIfAbsent, tsrm_compute, tsrm_merge,
+    tsrm_putWithTTL, tsrm_expire, tsrm_setExpiryFxn
+};
+
+const TSHashMap *TSHashMap_createReadMostly(long capacity, double loadFactor) {
+    TSHashMap *tshm = (TSHashMap *)malloc(sizeof(TSHashMap));
+
+    if (tshm != NULL) {
+        TSRmData *hmd = (TSRmData *)malloc(sizeof(TSRmData));
+
+        if (hmd != NULL) {
+            long N = ((capacity > 0) ? capacity : DEFAULT_CAPACITY);
+
+            if (N > MAX_CAPACITY)
+                N = MAX_CAPACITY;
+            hmd->table = newTable(N);
+            if (hmd->table != NULL) {
+                pthread_mutexattr_t ma;
+
+                hmd->size = 0L;
+                hmd->loadFactor = ((loadFactor > 0.000001) ? loadFactor :
+                                   DEFAULT_LOAD_FACTOR);
+                hmd->epoch = 2UL;
+                hmd->retired = NULL;
+                hmd->nretired = 0L;
+                memset(hmd->slots, 0, sizeof(hmd->slots));
+                hmd->resizes = 0L;
+                hmd->resizeTime = 0.0;
+                hmd->hits = hmd->misses = hmd->probes = 0L;
+                pthread_mutexattr_init(&ma);
+                pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+                pthread_mutex_init(LOCK(hmd), &ma);
+                pthread_mutexattr_destroy(&ma);
+                *tshm = template;
+                tshm->self = hmd;
+            } else {
+                free(hmd);
+                free(tshm);
+                tshm = NULL;
+            }
+        } else {
+            free(tshm);
+            tshm = NULL;
+        }
+    }
+    return tshm;
+}
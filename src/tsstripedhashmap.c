@@ -0,0 +1,588 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * implementation of TSHashMap_createStriped(); the keys are divided among
+ * a power of 2 number of stripes by bits of their hash that the stripes'
+ * hashmaps do not use to select buckets, and each stripe is a HashMap
+ * protected by its own recursive lock
+ */
+
+#include "tshashmap.h"
+#include "hashmap.h"
+#include "hmhashed.h"
+#include "hash64.h"
+#include "chainstats.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+
+#define DEFAULT_STRIPES 16L
+#define MAX_STRIPES 65536L
+#define CACHE_LINE 64
+
+typedef struct stripe {
+    pthread_mutex_t lock;	/* this is a recursive lock */
+    const HashMap *hm;
+    long size;			/* stored under lock, read without it */
+    char pad[CACHE_LINE];	/* keep stripes off each other's lines */
+} Stripe;
+
+typedef struct tsshm_data {
+    long nstripes;
+    unsigned long long mask;
+    Stripe *stripes;
+    long nextExpire;		/* stripe where the next expire() starts */
+    long clock;			/* the latest `now' passed to expire() */
+} TSShmData;
+
+#define STRIPE(hmd, h) (&(hmd)->stripes[((h) >> 32) & (hmd)->mask])
+
+/*
+ * local function returning the stripe for the `len'-byte `key'; its hash is
+ * returned in `*h' and handed to the stripe's hashmap, so that each key is
+ * only hashed once
+ */
+static Stripe *stripeOf(TSShmData *hmd, void *key, size_t len,
+                        unsigned long long *h) {
+    *h = hash64(key, len);
+    return STRIPE(hmd, *h);
+}
+
+/*
+ * local function that records the size of a stripe, whose lock is held;
+ * the sizes are read without the locks, so both sides use relaxed atomics
+ */
+static void setSize(Stripe *s) {
+    __atomic_store_n(&s->size, s->hm->size(s->hm), __ATOMIC_RELAXED);
+}
+
+/*
+ * local functions to acquire the locks of all stripes, always in the same
+ * order, and release them
+ */
+static void lockAll(TSShmData *hmd) {
+    long i;
+
+    for (i = 0L; i < hmd->nstripes; i++)
+        pthread_mutex_lock(&hmd->stripes[i].lock);
+}
+
+static void unlockAll(void *arg) {
+    TSShmData *hmd = (TSShmData *)arg;
+    long i;
+
+    for (i = hmd->nstripes - 1L; i >= 0L; i--)
+        pthread_mutex_unlock(&hmd->stripes[i].lock);
+}
+
+static void tsshm_destroy(const TSHashMap *hm,
+                          void (*freeFxn)(void *element)) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    long i;
+
+    lockAll(hmd);
+    for (i = 0L; i < hmd->nstripes; i++)
+        hmd->stripes[i].hm->destroy(hmd->stripes[i].hm, freeFxn);
+    unlockAll(hmd);
+    for (i = 0L; i < hmd->nstripes; i++)
+        pthread_mutex_destroy(&hmd->stripes[i].lock);
+    free(hmd->stripes);
+    free(hmd);
+    free((void *)hm);
+}
+
+static void tsshm_clear(const TSHashMap *hm, void (*freeFxn)(void *element)) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    long i;
+
+    lockAll(hmd);
+    for (i = 0L; i < hmd->nstripes; i++) {
+        hmd->stripes[i].hm->clear(hmd->stripes[i].hm, freeFxn);
+        setSize(&hmd->stripes[i]);
+    }
+    unlockAll(hmd);
+}
+
+static void tsshm_lock(const TSHashMap *hm) {
+    lockAll((TSShmData *)hm->self);
+}
+
+static void tsshm_unlock(const TSHashMap *hm) {
+    unlockAll(hm->self);
+}
+
+static int tsshm_containsKeyn(const TSHashMap *hm, void *key, long len) {
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_containsHashed(s->hm, key, len, h);
+    setSize(s);			/* may have reaped an expired entry */
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_containsKey(const TSHashMap *hm, char *key) {
+    return tsshm_containsKeyn(hm, key, (long)strlen(key));
+}
+
+/*
+ * local function that concatenates the entry or key arrays of all of the
+ * stripes; the locks of all stripes must be held
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static void **gather(TSShmData *hmd, int wantKeys, long *len) {
+    void **tmp, **part;
+    long i, n, total = 0L;
+
+    for (i = 0L; i < hmd->nstripes; i++)
+        total += __atomic_load_n(&hmd->stripes[i].size, __ATOMIC_RELAXED);
+    tmp = (void **)malloc((total > 0L ? total : 1L) * sizeof(void *));
+    if (tmp == NULL)
+        return NULL;
+    for (i = 0L, total = 0L; i < hmd->nstripes; i++) {
+        const HashMap *shm = hmd->stripes[i].hm;
+
+        if (shm->isEmpty(shm))
+            continue;
+        if (wantKeys)
+            part = (void **)shm->keyArray(shm, &n);
+        else
+            part = (void **)shm->entryArray(shm, &n);
+        if (part == NULL) {
+            free(tmp);
+            return NULL;
+        }
+        memcpy(tmp + total, part, n * sizeof(void *));
+        total += n;
+        free(part);
+    }
+    *len = total;
+    return tmp;
+}
+
+static HMEntry **tsshm_entryArray(const TSHashMap *hm, long *len) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    HMEntry **result;
+
+    lockAll(hmd);
+    result = (HMEntry **)gather(hmd, 0, len);
+    unlockAll(hmd);
+    return  result;
+}
+
+static int tsshm_getn(const TSHashMap *hm, void *key, long len,
+                      void **element) {
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_getHashed(s->hm, key, len, h, element);
+    setSize(s);			/* may have reaped an expired entry */
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_get(const TSHashMap *hm, char *key, void **element) {
+    return tsshm_getn(hm, key, (long)strlen(key), element);
+}
+
+static long tsshm_size(const TSHashMap *hm) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    long i, result = 0L;
+
+    for (i = 0L; i < hmd->nstripes; i++)
+        result += __atomic_load_n(&hmd->stripes[i].size, __ATOMIC_RELAXED);
+    return  result;
+}
+
+static int tsshm_isEmpty(const TSHashMap *hm) {
+    return (tsshm_size(hm) == 0L);
+}
+
+static char **tsshm_keyArray(const TSHashMap *hm, long *len) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    char **result;
+
+    lockAll(hmd);
+    result = (char **)gather(hmd, 1, len);
+    unlockAll(hmd);
+    return  result;
+}
+
+static int tsshm_putn(const TSHashMap *hm, void *key, long len, void *element,
+                      void **previous) {
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_putHashed(s->hm, key, len, h, element, previous);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_put(const TSHashMap *hm, char *key, void *element,
+                     void **previous) {
+    return tsshm_putn(hm, key, (long)strlen(key), element, previous);
+}
+
+static int tsshm_putUnique(const TSHashMap *hm, char *key, void *element) {
+    size_t len = strlen(key);
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_putUniqueHashed(s->hm, key, len, h, element);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_removen(const TSHashMap *hm, void *key, long len,
+                         void **element) {
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_removeHashed(s->hm, key, len, h, element);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_remove(const TSHashMap *hm, char *key, void **element) {
+    return tsshm_removen(hm, key, (long)strlen(key), element);
+}
+
+static const TSIterator *tsshm_itCreate(const TSHashMap *hm) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    const TSIterator *it = NULL;
+    void **tmp;
+    long len;
+
+    lockAll(hmd);
+    tmp = gather(hmd, 0, &len);
+    if (tmp != NULL) {
+        it = TSIterator_createWithUnlock(unlockAll, hmd, len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    if (it == NULL)
+        unlockAll(hmd);
+    return it;
+}
+
+/*
+ * the batch methods hold a stripe's lock across each run of consecutive
+ * keys that fall in that stripe, switching locks only when the stripe
+ * changes
+ */
+static long tsshm_getBatch(const TSHashMap *hm, char **keys, long n,
+                           void **elements, int *found) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    Stripe *s, *held = NULL;
+    unsigned long long h;
+    long i, ans = 0L;
+    int f;
+
+    for (i = 0L; i < n; i++) {
+        size_t len = strlen(keys[i]);
+
+        s = stripeOf(hmd, keys[i], len, &h);
+        if (s != held) {
+            if (held != NULL) {
+                setSize(held);
+                pthread_mutex_unlock(&held->lock);
+            }
+            pthread_mutex_lock(&s->lock);
+            held = s;
+        }
+        f = hashmap_getHashed(s->hm, keys[i], len, h, &elements[i]);
+        if (! f)
+            elements[i] = NULL;
+        if (found != NULL)
+            found[i] = f;
+        ans += f;
+    }
+    if (held != NULL) {
+        setSize(held);
+        pthread_mutex_unlock(&held->lock);
+    }
+    return ans;
+}
+
+static long tsshm_putBatch(const TSHashMap *hm, char **keys, long n,
+                           void **elements, void **previous) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    Stripe *s, *held = NULL;
+    unsigned long long h;
+    long i, ans = 0L;
+    void *prev;
+
+    for (i = 0L; i < n; i++) {
+        size_t len = strlen(keys[i]);
+
+        s = stripeOf(hmd, keys[i], len, &h);
+        if (s != held) {
+            if (held != NULL) {
+                setSize(held);
+                pthread_mutex_unlock(&held->lock);
+            }
+            pthread_mutex_lock(&s->lock);
+            held = s;
+        }
+        if (hashmap_putHashed(s->hm, keys[i], len, h, elements[i], &prev))
+            ans++;
+        if (previous != NULL)
+            previous[i] = prev;
+    }
+    if (held != NULL) {
+        setSize(held);
+        pthread_mutex_unlock(&held->lock);
+    }
+    return ans;
+}
+
+static int tsshm_computeIfAbsent(const TSHashMap *hm, char *key,
+                                 void *(*factory)(char *key, void *ctx),
+                                 void *ctx, void **element) {
+    size_t len = strlen(key);
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_computeIfAbsentHashed(s->hm, key, len, h, factory,
+                                           ctx, element);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_compute(const TSHashMap *hm, char *key,
+                         int (*fxn)(char *key, void **element, void *ctx),
+                         void *ctx) {
+    size_t len = strlen(key);
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_computeHashed(s->hm, key, len, h, fxn, ctx);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_merge(const TSHashMap *hm, char *key, void *element,
+                       void *(*mergeFxn)(void *old, void *element)) {
+    size_t len = strlen(key);
+    unsigned long long h;
+    Stripe *s = stripeOf((TSShmData *)hm->self, key, len, &h);
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    result = hashmap_mergeHashed(s->hm, key, len, h, element, mergeFxn);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+static int tsshm_putWithTTL(const TSHashMap *hm, char *key, void *element,
+                            long ttl, void **previous) {
+    size_t len = strlen(key);
+    unsigned long long h;
+    TSShmData *hmd = (TSShmData *)hm->self;
+    Stripe *s = stripeOf(hmd, key, len, &h);
+    long deadline = __atomic_load_n(&hmd->clock, __ATOMIC_RELAXED) + ttl;
+    int result;
+
+    pthread_mutex_lock(&s->lock);
+    if (ttl <= 0L)
+        result = hashmap_putHashed(s->hm, key, len, h, element, previous);
+    else
+        result = hashmap_putWithDeadlineHashed(s->hm, key, len, h, element,
+                                               deadline, previous);
+    setSize(s);
+    pthread_mutex_unlock(&s->lock);
+    return  result;
+}
+
+/*
+ * the hashmap keeps a single clock, from which putWithTTL() computes the
+ * deadlines of all stripes, so a stripe whose own timer wheel lags behind
+ * never hands out a deadline relative to a stale time
+ *
+ * every stripe is advanced on each call; if maxWork > 0, the work left is
+ * shared among the stripes still to be visited, each getting at least one
+ * step, and the starting stripe moves one further along on each call, so
+ * that no stripe is always the one left with the smallest share
+ */
+static long tsshm_expire(const TSHashMap *hm, long now, long maxWork) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    long i, start, share, ans = 0L;
+    long clock = __atomic_load_n(&hmd->clock, __ATOMIC_RELAXED);
+
+    while (clock < now &&
+           ! __atomic_compare_exchange_n(&hmd->clock, &clock, now, 0,
+                                         __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        ;
+    start = __atomic_fetch_add(&hmd->nextExpire, 1L, __ATOMIC_RELAXED);
+    for (i = 0L; i < hmd->nstripes; i++) {
+        Stripe *s = &hmd->stripes[(start + i) & hmd->mask];
+
+        share = 0L;			/* no limit */
+        if (maxWork > 0L) {
+            share = (maxWork - ans) / (hmd->nstripes - i);
+            if (share < 1L)
+                share = 1L;
+        }
+        pthread_mutex_lock(&s->lock);
+        ans += s->hm->expire(s->hm, now, share);
+        setSize(s);
+        pthread_mutex_unlock(&s->lock);
+    }
+    return ans;
+}
+
+static void tsshm_setExpiryFxn(const TSHashMap *hm,
+                               void (*expiryFxn)(char *key, void *element)) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    long i;
+
+    lockAll(hmd);
+    for (i = 0L; i < hmd->nstripes; i++)
+        hmd->stripes[i].hm->setExpiryFxn(hmd->stripes[i].hm, expiryFxn);
+    unlockAll(hmd);
+}
+
+/*
+ * the statistics of the stripes are gathered one stripe at a time and
+ * reported as those of a single table
+ */
+static void tsshm_stats(const TSHashMap *hm, HashStats *hs) {
+    TSShmData *hmd = (TSShmData *)hm->self;
+    HashStats one;
+    long i;
+
+    chainstats_init(hs);
+    for (i = 0L; i < hmd->nstripes; i++) {
+        Stripe *s = &hmd->stripes[i];
+
+        pthread_mutex_lock(&s->lock);
+        s->hm->stats(s->hm, &one);
+        pthread_mutex_unlock(&s->lock);
+        chainstats_merge(hs, &one);
+    }
+}
+
+static TSHashMap template = {
+    NULL, tsshm_destroy, tsshm_clear, tsshm_lock, tsshm_unlock,
+    tsshm_containsKey, tsshm_entryArray, tsshm_get, tsshm_isEmpty,
+    tsshm_keyArray, tsshm_put, tsshm_putUnique, tsshm_remove, tsshm_size,
+    tsshm_itCreate, tsshm_containsKeyn, tsshm_getn, tsshm_putn, tsshm_removen,
+    tsshm_getBatch, tsshm_putBatch, tsshm_stats, tsshm_computeIfAbsent,
+    tsshm_compute, tsshm_merge, tsshm_putWithTTL, tsshm_expire,
+    tsshm_setExpiryFxn
+};
+
+/*
+ * local function to allocate `n' stripes, each with a hashmap of capacity
+ * `N' and its own recursive lock
+ *
+ * returns pointer to the array of stripes, or NULL if malloc failure
+ */
+static Stripe *newStripes(long n, long N, double loadFactor) {
+    Stripe *array = (Stripe *)malloc(n * sizeof(Stripe));
+    pthread_mutexattr_t ma;
+    long i;
+
+    if (array == NULL)
+        return NULL;
+    for (i = 0L; i < n; i++) {
+        array[i].hm = HashMap_create(N, loadFactor);
+        array[i].size = 0L;
+        if (array[i].hm == NULL) {
+            while (--i >= 0L)
+                array[i].hm->destroy(array[i].hm, NULL);
+            free(array);
+            return NULL;
+        }
+    }
+    pthread_mutexattr_init(&ma);
+    pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+    for (i = 0L; i < n; i++)
+        pthread_mutex_init(&array[i].lock, &ma);
+    pthread_mutexattr_destroy(&ma);
+    return array;
+}
+
+const TSHashMap *TSHashMap_createStriped(long capacity, double loadFactor,
+                                         long stripes) {
+    TSHashMap *tshm = (TSHashMap *)malloc(sizeof(TSHashMap));
+
+    if (tshm != NULL) {
+        TSShmData *hmd = (TSShmData *)malloc(sizeof(TSShmData));
+
+        if (hmd != NULL) {
+            long n = DEFAULT_STRIPES;
+
+            if (stripes > 0L)
+                for (n = 1L; n < stripes && n < MAX_STRIPES; n <<= 1)
+                    ;
+            hmd->stripes = newStripes(n, (capacity + n - 1L) / n, loadFactor);
+            if (hmd->stripes != NULL) {
+                hmd->nstripes = n;
+                hmd->mask = (unsigned long long)(n - 1L);
+                hmd->nextExpire = 0L;
+                hmd->clock = 0L;
+                *tshm = template;
+                tshm->self = hmd;
+            } else {
+                free(hmd);
+                free(tshm);
+                tshm = NULL;
+            }
+        } else {
+            free(tshm);
+            tshm = NULL;
+        }
+    }
+    return tshm;
+}
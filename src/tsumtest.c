@@ -0,0 +1,209 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tsunorderedmap.h"
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+
+/*
+ * the keys are line numbers stored directly in the void * key
+ */
+static int lcmp(void *a, void *b) {
+    long x = (long)a, y = (long)b;
+
+    return (x < y) ? -1 : (x > y) ? 1 : 0;
+}
+
+static long lhash(void *k, long N) {
+    return (long)((unsigned long)k % (unsigned long)N);
+}
+
+static void freeValue(void *key, void *value) {
+    (void) key;
+    free(value);
+}
+
+int main(int argc, char *argv[]) {
+    char buf[1024];
+    char *p;
+    const TSUnorderedMap *um;
+    long i, n;
+    FILE *fd;
+    UMEntry **array;
+    const TSIterator *it;
+    void *k;
+
+    if (argc != 2) {
+        fprintf(stderr, "usage: ./tsumtest file\n");
+        return -1;
+    }
+    if ((um = TSUnorderedMap_create(lcmp, lhash, 0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating unordered map\n");
+        return -1;
+    }
+    if ((fd = fopen(argv[1], "r")) == NULL) {
+        fprintf(stderr, "Unable to open %s to read\n", argv[1]);
+        return -1;
+    }
+    /*
+     * test of put()
+     */
+    printf("===== test of put when key not in map\n");
+    i = 0;
+    while (fgets(buf, 1024, fd) != NULL) {
+        char *prev;
+
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!um->put(um, (void *)i++, p, (void **)&prev)) {
+            fprintf(stderr, "Error adding key,string to map\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    n = um->size(um);
+    /*
+     * test of get()
+     */
+    printf("===== test of get\n");
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        if (!um->get(um, (void *)i, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%ld,%s", i, element);
+    }
+    /*
+     * test of remove
+     */
+    printf("===== test of remove\n");
+    printf("Size before remove = %ld\n", n);
+    for (i = n - 1; i >= 0; i--) {
+        if (!um->remove(um, (void *)i, &k, (void **)&p) || (long)k != i) {
+            fprintf(stderr, "Error removing %ld'th element\n", i);
+            return -1;
+        }
+        free(p);
+    }
+    printf("Size after remove = %ld\n", um->size(um));
+    /*
+     * test of destroy with NULL freeFxn
+     */
+    printf("===== test of destroy(NULL)\n");
+    um->destroy(um, NULL);
+    /*
+     * test of insert
+     */
+    if ((um = TSUnorderedMap_create(lcmp, lhash, 0L, 3.0)) == NULL) {
+        fprintf(stderr, "Error creating unordered map\n");
+        return -1;
+    }
+    fd = fopen(argv[1], "r");		/* we know we can open it */
+    i = 0L;
+    while (fgets(buf, 1024, fd) != NULL) {
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!um->putUnique(um, (void *)i++, p)) {
+            fprintf(stderr, "Error adding key,value to map\n");
+            return -1;
+        }
+    }
+    fclose(fd);
+    printf("putUnique of existing key = %d\n",
+           um->putUnique(um, (void *)0L, NULL));
+    /*
+     * test of put replacing value associated with an existing key
+     */
+    printf("===== test of put (replace value associated with key)\n");
+    for (i = 0; i < n; i++) {
+        char bf[1024], *q;
+        sprintf(bf, "line %ld\n", i);
+        if ((p = strdup(bf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!um->put(um, (void *)i, p, (void **)&q)) {
+            fprintf(stderr, "Error replacing %ld'th element\n", i);
+            return -1;
+        }
+        free(q);
+    }
+    for (i = 0; i < n; i++) {
+        char *element;
+
+        if (!um->get(um, (void *)i, (void **)&element)) {
+            fprintf(stderr, "Error retrieving %ld'th element\n", i);
+            return -1;
+        }
+        printf("%ld,%s", i, element);
+    }
+    /*
+     * test of entryArray
+     */
+    printf("===== test of entryArray\n");
+    if ((array = um->entryArray(um, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking um->entryArray()\n");
+        return -1;
+    }
+    for (i = 0; i < n; i++) {
+        printf("%ld,%s", (long)umentry_key(array[i]),
+               (char *)umentry_value(array[i]));
+    }
+    free(array);
+    /*
+     * test of iterator
+     */
+    printf("===== test of iterator\n");
+    if ((it = um->itCreate(um)) == NULL) {
+        fprintf(stderr, "Error in creating iterator\n");
+        return -1;
+    }
+    while (it->hasNext(it)) {
+        UMEntry *p;
+        (void) it->next(it, (void **)&p);
+        printf("%ld,%s", (long)umentry_key(p), (char *)umentry_value(p));
+    }
+    it->destroy(it);
+    /*
+     * test of destroy with freeValue() as freeFxn
+     */
+    printf("===== test of destroy(freeValue)\n");
+    um->destroy(um, freeValue);
+
+    return 0;
+}
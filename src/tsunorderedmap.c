@@ -0,0 +1,225 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "tsunorderedmap.h"
+#include "unorderedmap.h"
+#include <stdlib.h>
+#include <pthread.h>
+
+#define LOCK(um) &((um)->lock)
+
+typedef struct tsum_data {
+    const UnorderedMap *um;
+    pthread_mutex_t lock;	/* this is a recursive lock */
+} TSUmData;
+
+static void tsum_destroy(const TSUnorderedMap *um,
+                         void (*freeFxn)(void *key, void *value)) {
+    TSUmData *umd = (TSUmData *)um->self;
+
+    pthread_mutex_lock(LOCK(umd));
+    umd->um->destroy(umd->um, freeFxn);
+    pthread_mutex_unlock(LOCK(umd));
+    pthread_mutex_destroy(LOCK(umd));
+    free(umd);
+    free((void *)um);
+}
+
+static void tsum_clear(const TSUnorderedMap *um,
+                       void (*freeFxn)(void *key, void *value)) {
+    TSUmData *umd = (TSUmData *)um->self;
+
+    pthread_mutex_lock(LOCK(umd));
+    umd->um->clear(umd->um, freeFxn);
+    pthread_mutex_unlock(LOCK(umd));
+}
+
+static void tsum_lock(const TSUnorderedMap *um) {
+    TSUmData *umd = (TSUmData *)um->self;
+
+    pthread_mutex_lock(LOCK(umd));
+}
+
+static void tsum_unlock(const TSUnorderedMap *um) {
+    TSUmData *umd = (TSUmData *)um->self;
+
+    pthread_mutex_unlock(LOCK(umd));
+}
+
+static int tsum_containsKey(const TSUnorderedMap *um, void *key) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->containsKey(umd->um, key);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static UMEntry **tsum_entryArray(const TSUnorderedMap *um, long *len) {
+    TSUmData *umd = (TSUmData *)um->self;
+    UMEntry **result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->entryArray(umd->um, len);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static int tsum_get(const TSUnorderedMap *um, void *key, void **value) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->get(umd->um, key, value);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static int tsum_isEmpty(const TSUnorderedMap *um) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->isEmpty(umd->um);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static void **tsum_keyArray(const TSUnorderedMap *um, long *len) {
+    TSUmData *umd = (TSUmData *)um->self;
+    void **result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->keyArray(umd->um, len);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static int tsum_put(const TSUnorderedMap *um, void *key, void *value,
+                    void **previous) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->put(umd->um, key, value, previous);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static int tsum_putUnique(const TSUnorderedMap *um, void *key, void *value) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->putUnique(umd->um, key, value);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static int tsum_remove(const TSUnorderedMap *um, void *key, void **storedKey,
+                       void **value) {
+    TSUmData *umd = (TSUmData *)um->self;
+    int result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->remove(umd->um, key, storedKey, value);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static long tsum_size(const TSUnorderedMap *um) {
+    TSUmData *umd = (TSUmData *)um->self;
+    long result;
+
+    pthread_mutex_lock(LOCK(umd));
+    result = umd->um->size(umd->um);
+    pthread_mutex_unlock(LOCK(umd));
+    return  result;
+}
+
+static const TSIterator *tsum_itCreate(const TSUnorderedMap *um) {
+    TSUmData *umd = (TSUmData *)um->self;
+    const TSIterator *it = NULL;
+    void **tmp;
+    long len;
+
+    pthread_mutex_lock(LOCK(umd));
+    tmp = (void **)umd->um->entryArray(umd->um, &len);
+    if (tmp != NULL) {
+        it = TSIterator_create(LOCK(umd), len, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    if (it == NULL)
+        pthread_mutex_unlock(LOCK(umd));
+    return it;
+}
+
+static TSUnorderedMap template = {
+    NULL, tsum_destroy, tsum_clear, tsum_lock, tsum_unlock, tsum_containsKey,
+    tsum_entryArray, tsum_get, tsum_isEmpty, tsum_keyArray, tsum_put,
+    tsum_putUnique, tsum_remove, tsum_size, tsum_itCreate
+};
+
+const TSUnorderedMap *TSUnorderedMap_create(
+                              int (*cmpFn)(void*,void*),
+                              long (*hashFn)(void*,long),
+                              long capacity, double loadFactor
+) {
+    TSUnorderedMap *tsum = (TSUnorderedMap *)malloc(sizeof(TSUnorderedMap));
+
+    if (tsum != NULL) {
+        TSUmData *umd = (TSUmData *)malloc(sizeof(TSUmData));
+
+        if (umd != NULL) {
+            umd->um = UnorderedMap_create(cmpFn, hashFn, capacity, loadFactor);
+
+            if (umd->um != NULL) {
+                pthread_mutexattr_t ma;
+                pthread_mutexattr_init(&ma);
+                pthread_mutexattr_settype(&ma, PTHREAD_MUTEX_RECURSIVE);
+                pthread_mutex_init(LOCK(umd), &ma);
+                pthread_mutexattr_destroy(&ma);
+                *tsum = template;
+                tsum->self = umd;
+            } else {
+                free(umd);
+                free(tsum);
+                tsum = NULL;
+            }
+        } else {
+            free(tsum);
+            tsum = NULL;
+        }
+    }
+    return tsum;
+}
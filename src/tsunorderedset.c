@@ -157,10 +157,18 @@ static const TSIterator *tsus_itCreate(const TSUnorderedSet *us) {
     return it;
 }
 
+static void tsus_stats(const TSUnorderedSet *us, HashStats *hs) {
+    TSUsData *usd = (TSUsData *)us->self;
+
+    pthread_mutex_lock(LOCK(usd));
+    usd->us->stats(usd->us, hs);
+    pthread_mutex_unlock(LOCK(usd));
+}
+
 static TSUnorderedSet template = {
     NULL, tsus_destroy, tsus_clear, tsus_lock, tsus_unlock, tsus_add,
     tsus_contains, tsus_isEmpty, tsus_remove, tsus_size,
-    tsus_toArray, tsus_itCreate
+    tsus_toArray, tsus_itCreate, tsus_stats
 };
 
 const TSUnorderedSet *TSUnorderedSet_create(
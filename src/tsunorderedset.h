@@ -33,6 +33,7 @@
  */
 
 #include "tsiterator.h"			/* needed for factory method */
+#include "hashstats.h"
 
 /*
  * interface definition for generic thread-safe unordered set implementation
@@ -147,6 +148,12 @@ struct tsunorderedset {
  * returns pointer to the Iterator or NULL if failure
  */
     const TSIterator *(*itCreate)(const TSUnorderedSet *us);
+
+/*
+ * fills in `*hs' with statistics describing the table of the set and the
+ * work done by its lookups and resizes; see hashstats.h
+ */
+    void (*stats)(const TSUnorderedSet *us, HashStats *hs);
 };
 
 #endif /* _TSUNORDEREDSET_H_ */
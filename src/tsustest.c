@@ -48,11 +48,31 @@ static long shash(void *s, long N) {
     return ans;
 }
 
+/*
+ * prints the parts of `*hs' that do not depend on how the hash function
+ * spreads the keys, and checks that the rest are consistent
+ */
+static void printStats(HashStats *hs) {
+    long i, n;
+
+    printf("size = %ld, capacity = %ld, resizes = %ld\n", hs->size,
+           hs->capacity, hs->resizes);
+    for (i = 0, n = 0; i < HASHSTATS_BINS; i++)
+        n += hs->histogram[i];
+    printf("histogram consistent = %d, ", n == hs->occupied &&
+           hs->maxChain >= 1 && hs->occupied <= hs->size);
+    printf("meanChain consistent = %d, ", hs->meanChain >= 1.0 &&
+           hs->meanChain <= (double)hs->maxChain);
+    printf("lookup counters consistent = %d\n", hs->hits == -1L ||
+           (hs->hits >= hs->size && hs->probes >= hs->hits));
+}
+
 int main(int argc, char *argv[]) {
     char buf[1024];
     char *p;
     const TSUnorderedSet *us;
     long i, n;
+    HashStats hs;
     FILE *fd;
     const TSIterator *it;
     void **array;
@@ -163,6 +183,22 @@ int main(int argc, char *argv[]) {
      */
     printf("===== test of destroy(free)\n");
     us->destroy(us, free);
+    /*
+     * test of stats()
+     */
+    printf("===== test of stats\n");
+    if ((us = TSUnorderedSet_create(scmp, shash, 0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashset for stats\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) us->add(us, strdup(buf));
+        (void) us->contains(us, buf);
+    }
+    us->stats(us, &hs);
+    printStats(&hs);
+    us->destroy(us, free);
 
     return 0;
 }
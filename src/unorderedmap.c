@@ -0,0 +1,377 @@
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "unorderedmap.h"
+#include <stdlib.h>
+
+#define DEFAULT_CAPACITY 16L
+#define MAX_CAPACITY 134217728L
+#define DEFAULT_LOAD_FACTOR 0.75
+#define TRIGGER 100	/* number of changes that will trigger a load check */
+
+/*
+ * the key and value are held directly in the entry, so a mapping costs
+ * a single allocation
+ */
+struct umentry {
+    struct umentry *next;
+    void *key;
+    void *value;
+};
+
+typedef struct um_data {
+    long size;
+    long capacity;
+    long changes;
+    double load;
+    double loadFactor;
+    double increment;
+    int (*cmp)(void *, void *);
+    long (*hash)(void *, long);
+    UMEntry **buckets;
+} UmData;
+
+/*
+ * traverses the map, calling freeFxn on each key and value
+ * then frees the UMEntry structures
+ */
+static void purge(UmData *umd, void (*freeFxn)(void *key, void *value)) {
+    long i;
+
+    for (i = 0L; i < umd->capacity; i++) {
+        UMEntry *p, *q;
+
+        for (p = umd->buckets[i]; p != NULL; p = q) {
+            if (freeFxn != NULL)
+                (*freeFxn)(p->key, p->value);
+            q = p->next;
+            free(p);
+        }
+        umd->buckets[i] = NULL;
+    }
+}
+
+static void um_destroy(const UnorderedMap *um,
+                       void (*freeFxn)(void *key, void *value)) {
+    UmData *umd = (UmData *)um->self;
+    purge(umd, freeFxn);
+    free(umd->buckets);
+    free(umd);
+    free((void *)um);
+}
+
+static void um_clear(const UnorderedMap *um,
+                     void (*freeFxn)(void *key, void *value)) {
+    UmData *umd = (UmData *)um->self;
+    purge(umd, freeFxn);
+    umd->size = 0;
+    umd->load = 0.0;
+    umd->changes = 0;
+}
+
+/*
+ * local function to locate key in a map
+ *
+ * returns pointer to entry, if found, as function value; NULL if not found
+ * returns bucket index in `*bucket'
+ */
+static UMEntry *findKey(UmData *umd, void *key, long *bucket) {
+    long i = umd->hash(key, umd->capacity);
+    UMEntry *p;
+
+    *bucket = i;
+    for (p = umd->buckets[i]; p != NULL; p = p->next) {
+        if (umd->cmp(p->key, key) == 0)
+            break;
+    }
+    return p;
+}
+
+static int um_containsKey(const UnorderedMap *um, void *key) {
+    UmData *umd = (UmData *)um->self;
+    long bucket;
+
+    return (findKey(umd, key, &bucket) != NULL);
+}
+
+/*
+ * local function for generating an array of UMEntry * or of keys from
+ * the map
+ *
+ * returns pointer to the array or NULL if malloc failure
+ */
+static void **entries(UmData *umd, int wantKeys) {
+    void **tmp = NULL;
+    if (umd->size > 0L) {
+        size_t nbytes = umd->size * sizeof(void *);
+        tmp = (void **)malloc(nbytes);
+        if (tmp != NULL) {
+            long i, n = 0L;
+            for (i = 0L; i < umd->capacity; i++) {
+                UMEntry *p;
+                for (p = umd->buckets[i]; p != NULL; p = p->next)
+                    tmp[n++] = wantKeys ? p->key : (void *)p;
+            }
+        }
+    }
+    return tmp;
+}
+
+static UMEntry **um_entryArray(const UnorderedMap *um, long *len) {
+    UmData *umd = (UmData *)um->self;
+    UMEntry **tmp = (UMEntry **)entries(umd, 0);
+
+    if (tmp != NULL)
+        *len = umd->size;
+    return tmp;
+}
+
+static int um_get(const UnorderedMap *um, void *key, void **value) {
+    UmData *umd = (UmData *)um->self;
+    long i;
+    UMEntry *p = findKey(umd, key, &i);
+
+    if (p != NULL) {
+        *value = p->value;
+        return 1;
+    }
+    return 0;
+}
+
+static int um_isEmpty(const UnorderedMap *um) {
+    UmData *umd = (UmData *)um->self;
+    return (umd->size == 0L);
+}
+
+static void **um_keyArray(const UnorderedMap *um, long *len) {
+    UmData *umd = (UmData *)um->self;
+    void **tmp = entries(umd, 1);
+
+    if (tmp != NULL)
+        *len = umd->size;
+    return tmp;
+}
+
+/*
+ * local function that resizes the map; entries are redistributed using
+ * the hash function
+ */
+static void resize(UmData *umd) {
+    long N;
+    UMEntry *p, *q, **array;
+    long i, j;
+
+    N = 2 * umd->capacity;
+    if (N > MAX_CAPACITY)
+        N = MAX_CAPACITY;
+    if (N == umd->capacity)
+        return;
+    array = (UMEntry **)malloc(N * sizeof(UMEntry *));
+    if (array == NULL)
+        return;
+    for (j = 0; j < N; j++)
+        array[j] = NULL;
+    /*
+     * now redistribute the entries into the new set of buckets
+     */
+    for (i = 0; i < umd->capacity; i++) {
+        for (p = umd->buckets[i]; p != NULL; p = q) {
+            q = p->next;
+            j = umd->hash(p->key, N);
+            p->next = array[j];
+            array[j] = p;
+        }
+    }
+    free(umd->buckets);
+    umd->buckets = array;
+    umd->capacity = N;
+    umd->load /= 2.0;
+    umd->changes = 0;
+    umd->increment = 1.0 / (double)N;
+}
+
+/*
+ * local function to insert a new entry into bucket `i'
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int insertEntry(UmData *umd, void *key, void *value, long i) {
+    UMEntry *p = (UMEntry *)malloc(sizeof(UMEntry));
+
+    if (p == NULL)
+        return 0;
+    p->key = key;
+    p->value = value;
+    p->next = umd->buckets[i];
+    umd->buckets[i] = p;
+    umd->size++;
+    umd->load += umd->increment;
+    umd->changes++;
+    return 1;
+}
+
+static int um_put(const UnorderedMap *um, void *key, void *value,
+                  void **previous) {
+    UmData *umd = (UmData *)um->self;
+    long i;
+    UMEntry *p;
+
+    if (umd->changes > TRIGGER) {
+        umd->changes = 0;
+        if (umd->load > umd->loadFactor)
+            resize(umd);
+    }
+    p = findKey(umd, key, &i);
+    if (p != NULL) {
+        *previous = p->value;
+        p->value = value;
+        return 1;
+    }
+    *previous = NULL;
+    return insertEntry(umd, key, value, i);
+}
+
+static int um_putUnique(const UnorderedMap *um, void *key, void *value) {
+    UmData *umd = (UmData *)um->self;
+    long i;
+
+    if (umd->changes > TRIGGER) {
+        umd->changes = 0;
+        if (umd->load > umd->loadFactor)
+            resize(umd);
+    }
+    if (findKey(umd, key, &i) != NULL)
+        return 0;
+    return insertEntry(umd, key, value, i);
+}
+
+static int um_remove(const UnorderedMap *um, void *key, void **storedKey,
+                     void **value) {
+    UmData *umd = (UmData *)um->self;
+    long i;
+    UMEntry *entry, *p, *c;
+
+    entry = findKey(umd, key, &i);
+    if (entry == NULL)
+        return 0;
+    /* determine where the entry lives in the singly linked list */
+    for (p = NULL, c = umd->buckets[i]; c != entry; p = c, c = c->next)
+        ;
+    if (p == NULL)
+        umd->buckets[i] = entry->next;
+    else
+        p->next = entry->next;
+    umd->size--;
+    umd->load -= umd->increment;
+    umd->changes++;
+    *storedKey = entry->key;
+    *value = entry->value;
+    free(entry);
+    return 1;
+}
+
+static long um_size(const UnorderedMap *um) {
+    UmData *umd = (UmData *)um->self;
+    return umd->size;
+}
+
+static const Iterator *um_itCreate(const UnorderedMap *um) {
+    UmData *umd = (UmData *)um->self;
+    const Iterator *it = NULL;
+    void **tmp = entries(umd, 0);
+
+    if (tmp != NULL) {
+        it = Iterator_create(umd->size, tmp);
+        if (it == NULL)
+            free(tmp);
+    }
+    return it;
+}
+
+void *umentry_key(UMEntry *ume) {
+    return ume->key;
+}
+
+void *umentry_value(UMEntry *ume) {
+    return ume->value;
+}
+
+static UnorderedMap template = {
+    NULL, um_destroy, um_clear, um_containsKey, um_entryArray, um_get,
+    um_isEmpty, um_keyArray, um_put, um_putUnique, um_remove, um_size,
+    um_itCreate
+};
+
+const UnorderedMap *UnorderedMap_create(
+                              int (*cmpFn)(void*,void*),
+                              long (*hashFn)(void*,long),
+                              long capacity, double loadFactor
+) {
+    UnorderedMap *um = (UnorderedMap *)malloc(sizeof(UnorderedMap));
+
+    if (um != NULL) {
+        UmData *umd = (UmData *)malloc(sizeof(UmData));
+        if (umd != NULL) {
+            long N;
+            double lf;
+            UMEntry **array;
+            long i;
+            N = ((capacity > 0) ? capacity : DEFAULT_CAPACITY);
+            if (N > MAX_CAPACITY)
+                N = MAX_CAPACITY;
+            lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
+            array = (UMEntry **)malloc(N * sizeof(UMEntry *));
+            if (array != NULL) {
+                umd->capacity = N;
+                umd->loadFactor = lf;
+                umd->size = 0L;
+                umd->load = 0.0;
+                umd->changes = 0L;
+                umd->increment = 1.0 / (double)N;
+                umd->cmp = cmpFn;
+                umd->hash = hashFn;
+                umd->buckets = array;
+                for (i = 0; i < N; i++)
+                    array[i] = NULL;
+                *um = template;
+                um->self = umd;
+            } else {
+                free(umd);
+                free(um);
+                um = NULL;
+            }
+        } else {
+            free(um);
+            um = NULL;
+        }
+    }
+    return um;
+}
@@ -0,0 +1,188 @@
+#ifndef _UNORDEREDMAP_H_
+#define _UNORDEREDMAP_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "iterator.h"			/* needed for factory method */
+
+/*
+ * interface definition for generic unordered map implementation
+ * implemented using a hash table
+ *
+ * patterned roughly after Java 6 HashMap generic class; unlike HashMap,
+ * keys are arbitrary void * values, compared and hashed by functions
+ * supplied by the application, as for UnorderedSet
+ */
+
+typedef struct unorderedmap UnorderedMap;	/* forward reference */
+typedef struct umentry UMEntry;			/* opaque type definition */
+
+/*
+ * create an unordered map with the specified capacity and load factor;
+ * if capacity == 0, a default initial capacity (16 elements) is used
+ * if loadFactor == 0.0, a default load factor (0.75) is used
+ * if number of elements/number of buckets exceeds the load factor, the
+ * table is resized, doubling the number of buckets, up to a max number
+ * of buckets (134,217,728)
+ *
+ * cmpFunction is used to determine equality between two keys, with
+ * `cmpFunction(first, second)' returning 0 if first==second, <>0 otherwise
+ *
+ * hashFunction is used to hash a key into the hash table that underlies
+ * the map, with `hashFunction(key, N)' returning a number in [0,N)
+ *
+ * keys are stored as supplied, not copied; a key must not be changed in
+ * a way that affects cmpFunction or hashFunction while it is in the map
+ *
+ * returns a pointer to the unordered map, or NULL if there are malloc() errors
+ */
+const UnorderedMap *UnorderedMap_create(
+                       int (*cmpFunction)(void *, void *),
+                       long (*hashFunction)(void *, long),
+                       long capacity, double loadFactor
+                      );
+
+/*
+ * now define struct unorderedmap
+ */
+struct unorderedmap {
+/*
+ * the private data of the unordered map
+ */
+    void *self;
+
+/*
+ * destroys the unordered map; for each entry, if freeFxn != NULL,
+ * it is invoked on the key and value of that entry; the storage associated
+ * with the map is then returned to the heap
+ */
+    void (*destroy)(const UnorderedMap *um,
+                    void (*freeFxn)(void *key, void *value));
+
+/*
+ * clears all entries from the unordered map; for each entry,
+ * if freeFxn != NULL, it is invoked on the key and value of that entry;
+ * any storage associated with the entry in the map is then
+ * returned to the heap
+ *
+ * upon return, the map will be empty
+ */
+    void (*clear)(const UnorderedMap *um,
+                  void (*freeFxn)(void *key, void *value));
+
+/*
+ * returns 1 if the map has an entry for `key', 0 otherwise
+ */
+    int (*containsKey)(const UnorderedMap *um, void *key);
+
+/*
+ * returns an array containing all of the entries of the map in
+ * an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to UMEntry * array of entries, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the UMEntry * array when finished
+ */
+    UMEntry **(*entryArray)(const UnorderedMap *um, long *len);
+
+/*
+ * returns the value to which the specified key is mapped in `*value'
+ *
+ * returns 1 if successful, 0 if no mapping for `key'
+ */
+    int (*get)(const UnorderedMap *um, void *key, void **value);
+
+/*
+ * returns 1 if the map is empty, 0 if it is not
+ */
+    int (*isEmpty)(const UnorderedMap *um);
+
+/*
+ * returns an array containing all of the keys in the map in
+ * an arbitrary order; returns the length of the list in `*len'
+ *
+ * returns pointer to void * array of keys, or NULL if malloc failure
+ *
+ * NB - the caller is responsible for freeing the void * array when finished
+ */
+    void **(*keyArray)(const UnorderedMap *um, long *len);
+
+/*
+ * associates `value' with `key'; if this replaces an existing mapping, the
+ * old value is returned in `*previous', and the key stored in the map is
+ * retained; otherwise *previous == NULL
+ *
+ * returns 1 if successful, 0 if not (malloc failure)
+ */
+    int (*put)(const UnorderedMap *um, void *key, void *value,
+               void **previous);
+
+/*
+ * associates `value' with `key'; fails if `key' is already present
+ *
+ * returns 1 if successful, 0 if not (malloc failure or already present)
+ */
+    int (*putUnique)(const UnorderedMap *um, void *key, void *value);
+
+/*
+ * removes the entry associated with `key' if one exists; returns the key
+ * stored in the map in `*storedKey' (so that it may be freed) and the
+ * value associated with it in `*value'
+ *
+ * returns 1 if successful, 0 if no value associated with `key'
+ */
+    int (*remove)(const UnorderedMap *um, void *key, void **storedKey,
+                  void **value);
+
+/*
+ * returns the number of mappings in the map
+ */
+    long (*size)(const UnorderedMap *um);
+
+/*
+ * create generic iterator to this unordered map
+ * note that iterator will return pointers to UMEntry's
+ *
+ * returns pointer to the Iterator or NULL if failure
+ */
+    const Iterator *(*itCreate)(const UnorderedMap *um);
+};
+
+/*
+ * accessor methods for obtaining key and value from an UMEntry
+ * used with return from it_next() on iterator and with elements of UMEntry *
+ * array returned by entryArray()
+ */
+void *umentry_key(UMEntry *ume);
+void *umentry_value(UMEntry *ume);
+
+#endif /* _UNORDEREDMAP_H_ */
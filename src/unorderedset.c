@@ -30,6 +30,11 @@
  */
 
 #include "unorderedset.h"
+#include "nodepool.h"
+#include "chainstats.h"
+#include "bloomfilter.h"
+#include "ustag.h"
+#include "workers.h"
 #include <stdlib.h>
 #include <string.h>
 
@@ -37,6 +42,11 @@
 #define MAX_CAPACITY 134217728L
 #define DEFAULT_LOAD_FACTOR 0.75
 #define TRIGGER 100	/* number of changes that will trigger a load check */
+#define SHRINK_LOAD 4	/* shrink if load < loadFactor / SHRINK_LOAD */
+#define MIGRATE_STEP 16	/* buckets migrated per operation if US_INCREMENTAL */
+#define PAR_MIN 16384L	/* set algebra on fewer candidates is not threaded */
+#define FILTER_FP 0.01	/* false positive rate of the filter if US_FILTERED */
+#define FILTER_RANGE 2147483647L	/* N passed to hash for the filter */
 
 typedef struct entry {
     struct entry *next;
@@ -44,16 +54,52 @@ typedef struct entry {
 } Entry;
 
 typedef struct us_data {
+    int tag;			/* US_TAG_CHAINED, see ustag.h */
     long size;
     long capacity;
+    long minCapacity;		/* automatic shrinking stops here */
     long changes;
     double load;
     double loadFactor;
     double increment;
     int (*cmp)(void *, void *);
     long (*hash)(void *, long);
+    int flags;
     Entry **buckets;
-} UsData;
+    Entry **oldBuckets;		/* non-NULL while an incremental resize is */
+    long oldCapacity;		/* in progress; buckets [0, migrated) of */
+    long migrated;		/* oldBuckets have been moved to buckets */
+    NodePool *pool;		/* US_POOLED only; source of entries */
+    long resizes;		/* counters reported by stats(); the last */
+    double resizeTime;		/* three are only maintained if compiled */
+    long hits;			/* with -DHASH_STATS */
+    long misses;
+    long probes;
+    const BloomFilter *filter;	/* US_FILTERED only; holds every element */
+    long stale;			/* added since it was built, `stale' of */
+} UsData;			/* which have since been removed */
+
+/*
+ * the filter of a US_FILTERED hashset is given hashes that do not depend
+ * on the capacity, so that it need not change when the table is resized
+ */
+#define FILTER_HASH(usd, e) ((unsigned long long)(usd)->hash((e), FILTER_RANGE))
+
+/*
+ * returns the entries on the chain starting at `p' to the node pool,
+ * calling freeFxn on each element
+ */
+static void purgeChain(UsData *usd, Entry *p, void (*freeFxn)(void *element)) {
+    Entry *q;
+
+    while (p != NULL) {
+        if (freeFxn != NULL)
+            (*freeFxn)(p->element);
+        q = p->next;
+        nodepool_free(usd->pool, p, sizeof(Entry));
+        p = q;
+    }
+}
 
 /*
  * traverses the hashset, calling freeFxn on each element
@@ -64,22 +110,26 @@ static void purge(UsData *usd, void (*freeFxn)(void *element)) {
     long i;
 
     for (i = 0L; i < usd->capacity; i++) {
-        Entry *p, *q;
-        p = usd->buckets[i];
-        while (p != NULL) {
-            if (freeFxn != NULL)
-                (*freeFxn)(p->element);
-            q = p->next;
-            free(p);
-            p = q;
-        }
+        purgeChain(usd, usd->buckets[i], freeFxn);
         usd->buckets[i] = NULL;
     }
+    if (usd->oldBuckets != NULL) {
+        for (i = usd->migrated; i < usd->oldCapacity; i++)
+            purgeChain(usd, usd->oldBuckets[i], freeFxn);
+        free(usd->oldBuckets);
+        usd->oldBuckets = NULL;
+    }
+    if (usd->filter != NULL)
+        usd->filter->clear(usd->filter);
+    usd->stale = 0L;
 }
 
 static void us_destroy(const UnorderedSet *us, void (*freeFxn)(void *element)) {
     UsData *usd = (UsData *)us->self;
     purge(usd, freeFxn);
+    if (usd->filter != NULL)
+        usd->filter->destroy(usd->filter);
+    nodepool_destroy(usd->pool);
     free(usd->buckets);
     free(usd);
     free((void *)us);
@@ -93,60 +143,167 @@ static void us_clear(const UnorderedSet *us, void (*freeFxn)(void *element)) {
     usd->changes = 0;
 }
 
+/*
+ * moves up to `n' buckets of an incremental resize from oldBuckets to
+ * buckets, releasing oldBuckets once all of them have been moved
+ */
+static void migrate(UsData *usd, long n) {
+    Entry *p, *q;
+    long j;
+
+    for (; n > 0 && usd->migrated < usd->oldCapacity; n--, usd->migrated++) {
+        for (p = usd->oldBuckets[usd->migrated]; p != NULL; p = q) {
+            q = p->next;
+            j = usd->hash(p->element, usd->capacity);
+            p->next = usd->buckets[j];
+            usd->buckets[j] = p;
+        }
+    }
+    if (usd->migrated == usd->oldCapacity) {
+        free(usd->oldBuckets);
+        usd->oldBuckets = NULL;
+    }
+}
+
+#define MIGRATE(usd) if ((usd)->oldBuckets != NULL) migrate((usd), MIGRATE_STEP)
+
+/*
+ * local function that replaces the filter of a US_FILTERED hashset by one
+ * sized for its current capacity and holding only the elements present;
+ * if malloc failure, the old filter, which still holds every element
+ * present, is kept
+ */
+static void refilter(UsData *usd) {
+    const BloomFilter *bf;
+    Entry *p;
+    long i;
+
+    bf = BloomFilter_create((long)(usd->loadFactor * (double)usd->capacity)
+                            + TRIGGER, FILTER_FP);
+    if (bf == NULL)
+        return;
+    for (i = 0L; i < usd->capacity; i++)
+        for (p = usd->buckets[i]; p != NULL; p = p->next)
+            bf->add(bf, FILTER_HASH(usd, p->element));
+    if (usd->oldBuckets != NULL)
+        for (i = usd->migrated; i < usd->oldCapacity; i++)
+            for (p = usd->oldBuckets[i]; p != NULL; p = p->next)
+                bf->add(bf, FILTER_HASH(usd, p->element));
+    usd->filter->destroy(usd->filter);
+    usd->filter = bf;
+    usd->stale = 0L;
+}
+
 /*
  * local function to locate entry in a hashset
  *
  * returns pointer to entry, if found, as function value; NULL if not found
- * returns bucket index in `*bucket'
+ * returns bucket index in `*bucket'; if a resize is in progress, the entry
+ * may be on a chain of oldBuckets, but `*bucket' always indexes buckets
  */
 static Entry *findEntry(UsData *usd, void *element, long *bucket) {
     long i = usd->hash(element, usd->capacity);
     Entry *p;
 
     *bucket = i;
+    if (usd->filter != NULL &&
+        ! usd->filter->mightContain(usd->filter, FILTER_HASH(usd, element))) {
+        STAT(usd->misses++);
+        return NULL;
+    }
     for (p = usd->buckets[i]; p != NULL; p = p->next) {
+        STAT(usd->probes++);
         if (usd->cmp(p->element, element) == 0) {
-            break;
+            STAT(usd->hits++);
+            return p;
         }
     }
+    if (usd->oldBuckets != NULL) {
+        i = usd->hash(element, usd->oldCapacity);
+        if (i >= usd->migrated) {
+            for (p = usd->oldBuckets[i]; p != NULL; p = p->next) {
+                STAT(usd->probes++);
+                if (usd->cmp(p->element, element) == 0) {
+                    break;
+                }
+            }
+        }
+    }
+    STAT((p != NULL) ? usd->hits++ : usd->misses++);
     return p;
 }
 
 /*
- * local function that resizes the hashset
+ * local function that resizes the hashset to N buckets, which may be more
+ * or fewer than it has now
+ *
+ * if US_INCREMENTAL was specified, the new bucket array is installed and
+ * the entries are moved over MIGRATE_STEP buckets at a time by subsequent
+ * operations on the hashset
+ *
+ * returns 1 if successful, 0 if malloc failure
  */
-static void resize(UsData *usd) {
-    int N;
-    Entry *p, *q, **array;
-    long i, j;
+static int resize(UsData *usd, long N) {
+    Entry **array;
+    long j;
+    double start = chainstats_clock();
 
-    N = 2 * usd->capacity;
+    if (usd->oldBuckets != NULL)	/* finish previous resize first */
+        migrate(usd, usd->oldCapacity);
     if (N > MAX_CAPACITY)
         N = MAX_CAPACITY;
     if (N == usd->capacity)
-        return;
+        return 1;
     array = (Entry **)malloc(N * sizeof(Entry *));
     if (array == NULL)
-        return;
+        return 0;
     for (j = 0; j < N; j++)
         array[j] = NULL;
+    usd->oldBuckets = usd->buckets;
+    usd->oldCapacity = usd->capacity;
+    usd->migrated = 0L;
+    usd->buckets = array;
+    usd->capacity = N;
+    usd->load = (double)usd->size / (double)N;
+    usd->changes = 0;
+    usd->increment = 1.0 / (double)N;
     /*
      * now redistribute the entries into the new set of buckets
      */
-    for (i = 0; i < usd->capacity; i++) {
-        for (p = usd->buckets[i]; p != NULL; p = q) {
-            q = p->next;
-            j = usd->hash(p->element, N);
-            p->next = array[j];
-            array[j] = p;
+    if (! (usd->flags & US_INCREMENTAL))
+        migrate(usd, usd->oldCapacity);
+    if (usd->filter != NULL)
+        refilter(usd);
+    usd->resizes++;
+    usd->resizeTime += chainstats_clock() - start;
+    return 1;
+}
+
+/*
+ * local function invoked before each add or remove; every TRIGGER changes,
+ * the table is doubled if the load exceeds the load factor, or halved
+ * until the load is at least half the load factor if it has fallen below
+ * loadFactor / SHRINK_LOAD, so that the table does not keep the size it
+ * reached at the set's peak
+ */
+static void checkLoad(UsData *usd) {
+    long N;
+
+    if (usd->changes > TRIGGER) {
+        usd->changes = 0;
+        if (usd->load > usd->loadFactor)
+            (void) resize(usd, 2 * usd->capacity);
+        else if (usd->load < usd->loadFactor / SHRINK_LOAD &&
+                 usd->capacity > usd->minCapacity) {
+            for (N = usd->capacity; N / 2 >= usd->minCapacity &&
+                 (double)usd->size / (double)(N / 2) <= usd->loadFactor / 2.0;
+                 N /= 2)
+                ;
+            (void) resize(usd, N);
         }
+        if (usd->filter != NULL && usd->stale > usd->size + TRIGGER)
+            refilter(usd);		/* mostly removed elements, so rebuild */
     }
-    free(usd->buckets);
-    usd->buckets = array;
-    usd->capacity = N;
-    usd->load /= 2.0;
-    usd->changes = 0;
-    usd->increment = 1.0 / (double)N;
 }
 
 static int us_add(const UnorderedSet *us, void *element) {
@@ -155,24 +312,21 @@ static int us_add(const UnorderedSet *us, void *element) {
     Entry *p;
     int ans = 0;
 
-    if (usd->changes > TRIGGER) {
-        usd->changes = 0;
-        if (usd->load > usd->loadFactor)
-            resize(usd);
-    }
+    checkLoad(usd);
+    MIGRATE(usd);
     p = findEntry(usd, element, &i);
     if (p == NULL) {	/* element does not exist in set */
-        p = (Entry *)malloc(sizeof(Entry));
+        p = (Entry *)nodepool_alloc(usd->pool, sizeof(Entry));
         if (p != NULL) {
             p->element = element;
             p->next = usd->buckets[i];
             usd->buckets[i] = p;
+            if (usd->filter != NULL)
+                usd->filter->add(usd->filter, FILTER_HASH(usd, element));
             usd->size++;
             usd->load += usd->increment;
             usd->changes++;
             ans = 1;
-        } else {
-            free(p);
         }
     }
     return ans;
@@ -182,6 +336,7 @@ static int us_contains(const UnorderedSet *us, void *element) {
     UsData *usd = (UsData *)us->self;
     long bucket;
 
+    MIGRATE(usd);
     return (findEntry(usd, element, &bucket) != NULL);
 }
 
@@ -196,22 +351,31 @@ static int us_remove(const UnorderedSet *us, void *element, void (*freeFxn)(void
     Entry *entry;
     int ans = 0;
 
+    checkLoad(usd);
+    MIGRATE(usd);
     entry = findEntry(usd, element, &i);
     if (entry != NULL) {
+        Entry **bucket = &usd->buckets[i];
         Entry *p, *c;
+
+        for (c = *bucket; c != NULL && c != entry; c = c->next)
+            ;
+        if (c == NULL)		/* not yet migrated */
+            bucket = &usd->oldBuckets[usd->hash(element, usd->oldCapacity)];
         /* determine where the entry lives in the singly linked list */
-        for (p = NULL, c = usd->buckets[i]; c != entry; p = c, c = c->next)
+        for (p = NULL, c = *bucket; c != entry; p = c, c = c->next)
             ;
         if (p == NULL)
-            usd->buckets[i] = entry->next;
+            *bucket = entry->next;
         else
             p->next = entry->next;
+        usd->stale++;
         usd->size--;
         usd->load -= usd->increment;
         usd->changes++;
         if (freeFxn != NULL)
             (*freeFxn)(entry->element);
-        free(entry);
+        nodepool_free(usd->pool, entry, sizeof(Entry));
         ans = 1;
     }
     return ans;
@@ -222,6 +386,25 @@ static long us_size(const UnorderedSet *us) {
     return usd->size;
 }
 
+/*
+ * local function that stores the elements of a hashset in tmp[]
+ *
+ * returns the number of elements stored
+ */
+static long fill(UsData *usd, void **tmp) {
+    long i, n = 0L;
+    Entry *p;
+
+    for (i = 0L; i < usd->capacity; i++)
+        for (p = usd->buckets[i]; p != NULL; p = p->next)
+            tmp[n++] = p->element;
+    if (usd->oldBuckets != NULL)
+        for (i = usd->migrated; i < usd->oldCapacity; i++)
+            for (p = usd->oldBuckets[i]; p != NULL; p = p->next)
+                tmp[n++] = p->element;
+    return n;
+}
+
 /*
  * local function for generating an array of void * from a hashset
  *
@@ -232,17 +415,8 @@ static void **entries(UsData *usd) {
     if (usd->size > 0L) {
         size_t nbytes = usd->size * sizeof(void *);
         tmp = (void **)malloc(nbytes);
-        if (tmp != NULL) {
-            long i, n = 0L;
-            for (i = 0L; i < usd->capacity; i++) {
-                Entry *p;
-                p = usd->buckets[i];
-                while (p != NULL) {
-                    tmp[n++] = p->element;
-                    p = p->next;
-                }
-            }
-        }
+        if (tmp != NULL)
+            (void) fill(usd, tmp);
     }
     return tmp;
 }
@@ -269,15 +443,431 @@ static const Iterator *us_itCreate(const UnorderedSet *us) {
     return it;
 }
 
+static long us_trim(const UnorderedSet *us) {
+    UsData *usd = (UsData *)us->self;
+    return nodepool_trim(usd->pool);
+}
+
+static int us_compact(const UnorderedSet *us) {
+    UsData *usd = (UsData *)us->self;
+    long N = (long)((double)usd->size / usd->loadFactor) + 1L;
+    int ans;
+
+    if (N < DEFAULT_CAPACITY)
+        N = DEFAULT_CAPACITY;
+    ans = resize(usd, N);
+    if (usd->oldBuckets != NULL)	/* complete an incremental resize */
+        migrate(usd, usd->oldCapacity);
+    return ans;
+}
+
+/*
+ * while an incremental resize is in progress, the unmigrated chains of
+ * oldBuckets are counted along with those of buckets
+ */
+static void us_stats(const UnorderedSet *us, HashStats *hs) {
+    UsData *usd = (UsData *)us->self;
+    Entry *p;
+    long i, n;
+
+    chainstats_init(hs);
+    hs->size = usd->size;
+    hs->capacity = usd->capacity;
+    for (i = 0L; i < usd->capacity; i++) {
+        for (n = 0L, p = usd->buckets[i]; p != NULL; p = p->next)
+            n++;
+        chainstats_add(hs, n);
+    }
+    if (usd->oldBuckets != NULL) {
+        for (i = usd->migrated; i < usd->oldCapacity; i++) {
+            for (n = 0L, p = usd->oldBuckets[i]; p != NULL; p = p->next)
+                n++;
+            chainstats_add(hs, n);
+        }
+    }
+    chainstats_finish(hs, usd->resizes, usd->resizeTime, usd->hits,
+                      usd->misses, usd->probes);
+}
+
+/*
+ * set algebra
+ *
+ * each operation filters an array of candidate elements by probing
+ * another set for them, and links those kept into a result created with
+ * enough buckets for every candidate, so that it is never resized; when
+ * there are enough candidates, the work is divided among worker threads
+ * in three phases:
+ *
+ *   1. each worker probes a contiguous share of the candidates, and
+ *      hashes each one kept to its bucket of the result
+ *   2. each worker copies the candidates it kept into a shared array,
+ *      partitioned by the range of result buckets each falls in
+ *   3. each worker links the candidates of its own range of buckets into
+ *      the result, taking their entries from its own node pool, which is
+ *      then merged into that of the result
+ *
+ * so no two workers write to the same bucket or pool, and no element is
+ * hashed twice
+ *
+ * the workers only read the sets, so cmp and hash must be safe to call
+ * concurrently; a chained hashset in the middle of an incremental resize
+ * is probed in both of its tables, and is left as it was; if the probed
+ * set is not a chained hashset, nothing is known about its thread-safety,
+ * and the calling thread does all the work
+ */
+typedef struct us_job {
+    void **elements;		/* the candidates */
+    long *bucket;		/* result bucket of each, -1 if dropped */
+    long start;			/* phases 1 and 2 cover candidates */
+    long end;			/* [start, end) */
+    long unprobed;		/* candidates below this are kept unprobed */
+    const UnorderedSet *probe;	/* set probed for the rest */
+    UsData *probeData;		/* non-NULL if probe is a chained hashset */
+    int keepIfFound;		/* keep candidates found (1) or absent (0) */
+    long (*hash)(void *, long);
+    long N;			/* capacity of the result, 0 if none */
+    long width;			/* number of result buckets in each range */
+    long kept;			/* number of candidates kept */
+    long next[WORKERS_MAX];	/* kept in each range, then where phase 2 */
+				/* copies the next one in each range */
+    void **pe;			/* kept candidates, partitioned by range, */
+    long *pb;			/* and their buckets */
+    long first;			/* phase 3 links [first, last) of pe/pb */
+    long last;
+    UsData *rd;			/* into the buckets of rd, with entries */
+    NodePool *pool;		/* from pool */
+    int ok;			/* 0 if malloc failure in phase 3 */
+} UsJob;
+
+/*
+ * local function to look up `element' without updating the statistics or
+ * advancing an incremental resize, so that workers may call it concurrently
+ */
+static int lookup(UsData *usd, void *element) {
+    long i = usd->hash(element, usd->capacity);
+    Entry *p;
+
+    if (usd->filter != NULL &&
+        ! usd->filter->mightContain(usd->filter, FILTER_HASH(usd, element)))
+        return 0;
+    for (p = usd->buckets[i]; p != NULL; p = p->next)
+        if (usd->cmp(p->element, element) == 0)
+            return 1;
+    if (usd->oldBuckets != NULL) {
+        i = usd->hash(element, usd->oldCapacity);
+        if (i >= usd->migrated)
+            for (p = usd->oldBuckets[i]; p != NULL; p = p->next)
+                if (usd->cmp(p->element, element) == 0)
+                    return 1;
+    }
+    return 0;
+}
+
+/*
+ * phase 1: probe for the candidates, hash those kept, and count how many
+ * fall in each range of buckets
+ */
+static void *probeJob(void *arg) {
+    UsJob *j = (UsJob *)arg;
+    long i, b;
+    int found;
+
+    j->kept = 0L;
+    for (i = 0L; i < WORKERS_MAX; i++)
+        j->next[i] = 0L;
+    for (i = j->start; i < j->end; i++) {
+        void *e = j->elements[i];
+
+        if (i < j->unprobed)
+            found = j->keepIfFound;
+        else if (j->probeData != NULL)
+            found = lookup(j->probeData, e);
+        else
+            found = j->probe->contains(j->probe, e);
+        b = -1L;
+        if (found == j->keepIfFound) {
+            j->kept++;
+            if (j->N > 0L) {
+                b = j->hash(e, j->N);
+                j->next[b / j->width]++;
+            }
+        }
+        if (j->N > 0L)
+            j->bucket[i] = b;
+    }
+    return NULL;
+}
+
+/*
+ * phase 2: copy the candidates kept to their ranges of pe/pb
+ */
+static void *partitionJob(void *arg) {
+    UsJob *j = (UsJob *)arg;
+    long i, k;
+
+    for (i = j->start; i < j->end; i++)
+        if (j->bucket[i] >= 0L) {
+            k = j->next[j->bucket[i] / j->width]++;
+            j->pe[k] = j->elements[i];
+            j->pb[k] = j->bucket[i];
+        }
+    return NULL;
+}
+
+/*
+ * phase 3: link the candidates of one range of buckets into the result
+ */
+static void *linkJob(void *arg) {
+    UsJob *j = (UsJob *)arg;
+    Entry **buckets = j->rd->buckets;
+    Entry *p;
+    long k;
+
+    for (k = j->first; j->ok && k < j->last; k++) {
+        if ((p = (Entry *)nodepool_alloc(j->pool, sizeof(Entry))) == NULL) {
+            j->ok = 0;
+            break;
+        }
+        p->element = j->pe[k];
+        p->next = buckets[j->pb[k]];
+        buckets[j->pb[k]] = p;
+    }
+    return NULL;
+}
+
+/*
+ * local function that filters the `n' candidates in `elements', keeping
+ * those before `unprobed', and of the rest those that are (keepIfFound
+ * == 1) or are not (keepIfFound == 0) found in `probe'; if `rd' is not
+ * NULL, the candidates kept are linked into it, and it must have a bucket
+ * for each candidate
+ *
+ * returns the number of candidates kept, or -1 if malloc failure
+ */
+static long filter(void **elements, long n, long unprobed,
+                   const UnorderedSet *probe, int keepIfFound, UsData *rd) {
+    UsJob jobs[WORKERS_MAX];
+    long *bucket = NULL;
+    void **pe = NULL;
+    long *pb = NULL;
+    long i, k, r, nw = 1L, kept = 0L;
+    long N = (rd != NULL) ? rd->capacity : 0L;
+    UsData *pd = NULL;
+    int ok = 1;
+
+    if (US_TAG(probe) == US_TAG_CHAINED)
+        pd = (UsData *)probe->self;
+    if (n >= PAR_MIN && pd != NULL)
+        nw = workers_count(n, PAR_MIN / 2);
+    if (N > 0L && n > 0L && (bucket = (long *)malloc(n * sizeof(long))) == NULL)
+        return -1L;
+    for (i = 0L; i < nw; i++) {
+        jobs[i].elements = elements;
+        jobs[i].bucket = bucket;
+        jobs[i].start = n * i / nw;
+        jobs[i].end = n * (i + 1) / nw;
+        jobs[i].unprobed = unprobed;
+        jobs[i].probe = probe;
+        jobs[i].probeData = pd;
+        jobs[i].keepIfFound = keepIfFound;
+        jobs[i].hash = (rd != NULL) ? rd->hash : NULL;
+        jobs[i].N = N;
+        jobs[i].width = (N + nw - 1L) / nw;
+    }
+    workers_run(probeJob, jobs, sizeof(UsJob), nw);
+    for (i = 0L; i < nw; i++)
+        kept += jobs[i].kept;
+    if (N > 0L && kept > 0L) {
+        pe = (void **)malloc(kept * sizeof(void *));
+        pb = (long *)malloc(kept * sizeof(long));
+        ok = (pe != NULL && pb != NULL);
+    }
+    if (N > 0L && kept > 0L && ok) {
+        for (r = 0L, k = 0L; r < nw; r++) {	/* range r is [first, last) */
+            jobs[r].first = k;
+            for (i = 0L; i < nw; i++) {
+                long c = jobs[i].next[r];
+                jobs[i].next[r] = k;
+                k += c;
+            }
+            jobs[r].last = k;
+        }
+        for (i = 0L; i < nw; i++) {
+            jobs[i].pe = pe;
+            jobs[i].pb = pb;
+        }
+        workers_run(partitionJob, jobs, sizeof(UsJob), nw);
+        for (i = 0L; i < nw; i++) {
+            jobs[i].rd = rd;
+            jobs[i].pool = rd->pool;
+            if (i > 0L && rd->pool != NULL)
+                jobs[i].pool = NodePool_create();
+            jobs[i].ok = (jobs[i].pool != NULL || rd->pool == NULL);
+        }
+        workers_run(linkJob, jobs, sizeof(UsJob), nw);
+        for (i = 0L; i < nw; i++) {
+            if (i > 0L)
+                nodepool_absorb(rd->pool, jobs[i].pool);
+            ok = ok && jobs[i].ok;
+        }
+        rd->size = kept;
+        rd->load = (double)rd->size * rd->increment;
+    }
+    free(bucket);
+    free(pe);
+    free(pb);
+    return ok ? kept : -1L;
+}
+
+/*
+ * local function that appends the elements of `us' to those in tmp[0..*n),
+ * advancing `*n'
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+static int append(const UnorderedSet *us, void **tmp, long *n) {
+    void **a;
+    long len;
+
+    if (US_TAG(us) == US_TAG_CHAINED)
+        *n += fill((UsData *)us->self, tmp + *n);
+    else if (! us->isEmpty(us)) {
+        if ((a = us->toArray(us, &len)) == NULL)
+            return 0;
+        memcpy(tmp + *n, a, len * sizeof(void *));
+        *n += len;
+        free(a);
+    }
+    return 1;
+}
+
+/*
+ * local function returning the elements of `us', followed by those of
+ * `other' if it is not NULL, in a heap array, which is NULL if there are
+ * none; `*ok' is set to 0 if malloc failure
+ */
+static void **candidates(const UnorderedSet *us, const UnorderedSet *other,
+                         long *n, int *ok) {
+    long total = us->size(us) + ((other != NULL) ? other->size(other) : 0L);
+    void **tmp;
+
+    *n = 0L;
+    if (total == 0L)
+        return NULL;
+    if ((tmp = (void **)malloc(total * sizeof(void *))) != NULL &&
+        append(us, tmp, n) && (other == NULL || append(other, tmp, n)))
+        return tmp;
+    free(tmp);
+    *ok = 0;
+    return NULL;
+}
+
+/*
+ * local function that creates an empty hashset like `usd' with N buckets
+ *
+ * returns pointer to the hashset, or NULL if malloc failure
+ */
+static const UnorderedSet *emptyLike(UsData *usd, long N) {
+    const UnorderedSet *us;
+
+    us = UnorderedSet_createWithFlags(usd->cmp, usd->hash, N,
+                                      usd->loadFactor, usd->flags);
+    if (us != NULL)				/* free to shrink later */
+        ((UsData *)us->self)->minCapacity = DEFAULT_CAPACITY;
+    return us;
+}
+
+/*
+ * local function returning the capacity that holds n elements within the
+ * load factor of `usd'
+ */
+static long capacityFor(UsData *usd, long n) {
+    long N = (long)((double)n / usd->loadFactor) + 1L;
+
+    if (N < DEFAULT_CAPACITY)
+        N = DEFAULT_CAPACITY;
+    if (N > MAX_CAPACITY)
+        N = MAX_CAPACITY;
+    return N;
+}
+
+#define US_UNION 0
+#define US_INTERSECT 1
+#define US_DIFFERENCE 2
+
+/*
+ * local function that implements setUnion(), intersect() and difference();
+ * the elements of `us' are candidates for all three, kept if found in
+ * `other' for intersect() and if not found for difference(); the union
+ * keeps all of them, and adds to them the elements of `other' not found in
+ * `us'
+ */
+static const UnorderedSet *algebra(const UnorderedSet *us,
+                                   const UnorderedSet *other, int op) {
+    UsData *usd = (UsData *)us->self;
+    const UnorderedSet *ans = NULL;
+    void **a;
+    long n, kept;
+    int ok = 1;
+
+    a = candidates(us, (op == US_UNION) ? other : NULL, &n, &ok);
+    if (ok && (ans = emptyLike(usd, capacityFor(usd, n))) != NULL) {
+        UsData *rd = (UsData *)ans->self;
+
+        if (op == US_UNION)
+            kept = filter(a, n, usd->size, us, 0, rd);
+        else
+            kept = filter(a, n, 0L, other, (op == US_INTERSECT), rd);
+        if (kept < 0L) {
+            ans->destroy(ans, NULL);
+            ans = NULL;
+        } else if (rd->filter != NULL)
+            refilter(rd);
+    }
+    free(a);
+    return ans;
+}
+
+static const UnorderedSet *us_setUnion(const UnorderedSet *us,
+                                       const UnorderedSet *other) {
+    return algebra(us, other, US_UNION);
+}
+
+static const UnorderedSet *us_intersect(const UnorderedSet *us,
+                                        const UnorderedSet *other) {
+    return algebra(us, other, US_INTERSECT);
+}
+
+static const UnorderedSet *us_difference(const UnorderedSet *us,
+                                         const UnorderedSet *other) {
+    return algebra(us, other, US_DIFFERENCE);
+}
+
+static int us_isSubset(const UnorderedSet *us, const UnorderedSet *other) {
+    UsData *usd = (UsData *)us->self;
+    void **a;
+    long n;
+    int ok = 1, ans = -1;
+
+    if (usd->size > other->size(other))
+        return 0;
+    a = candidates(us, NULL, &n, &ok);
+    if (ok)
+        ans = (filter(a, n, 0L, other, 0, NULL) == 0L);
+    free(a);
+    return ans;
+}
+
 static UnorderedSet template = {
     NULL, us_destroy, us_clear, us_add, us_contains, us_isEmpty,
-    us_remove, us_size, us_toArray, us_itCreate
+    us_remove, us_size, us_toArray, us_itCreate, us_trim, us_compact,
+    us_stats, us_setUnion, us_intersect, us_difference, us_isSubset
 };
 
-const UnorderedSet *UnorderedSet_create(
+const UnorderedSet *UnorderedSet_createWithFlags(
                               int (*cmpFn)(void*,void*),
                               long (*hashFn)(void*,long),
-                              long capacity, double loadFactor
+                              long capacity, double loadFactor, int flags
 ) {
     UnorderedSet *us = (UnorderedSet *)malloc(sizeof(UnorderedSet));
 
@@ -287,14 +877,23 @@ const UnorderedSet *UnorderedSet_create(
             long N;
             double lf;
             Entry **array;
+            NodePool *pool;
+            const BloomFilter *filter = NULL;
             long i;
             N = ((capacity > 0) ? capacity : DEFAULT_CAPACITY);
             if (N > MAX_CAPACITY)
                 N = MAX_CAPACITY;
             lf = ((loadFactor > 0.000001) ? loadFactor : DEFAULT_LOAD_FACTOR);
             array = (Entry **)malloc(N * sizeof(Entry *));
-            if (array != NULL) {
+            pool = (flags & US_POOLED) ? NodePool_create() : NULL;
+            if (flags & US_FILTERED)
+                filter = BloomFilter_create((long)(lf * (double)N) + TRIGGER,
+                                            FILTER_FP);
+            if (array != NULL && (pool != NULL || ! (flags & US_POOLED)) &&
+                (filter != NULL || ! (flags & US_FILTERED))) {
+                usd->tag = US_TAG_CHAINED;
                 usd->capacity = N;
+                usd->minCapacity = N;
                 usd->loadFactor = lf;
                 usd->size = 0L;
                 usd->load = 0.0;
@@ -302,12 +901,27 @@ const UnorderedSet *UnorderedSet_create(
                 usd->increment = 1.0 / (double)N;
                 usd->cmp = cmpFn;
                 usd->hash = hashFn;
+                usd->flags = flags;
                 usd->buckets = array;
+                usd->oldBuckets = NULL;
+                usd->oldCapacity = 0L;
+                usd->migrated = 0L;
+                usd->pool = pool;
+                usd->resizes = 0L;
+                usd->resizeTime = 0.0;
+                usd->hits = usd->misses = usd->probes = 0L;
+                usd->filter = filter;
+                usd->stale = 0L;
                 for (i = 0; i < N; i++)
                     array[i] = NULL;
                 *us = template;
                 us->self = usd;
             } else {
+                free(array);
+                if (pool != NULL)
+                    nodepool_destroy(pool);
+                if (filter != NULL)
+                    filter->destroy(filter);
                 free(usd);
                 free(us);
                 us = NULL;
@@ -319,3 +933,11 @@ const UnorderedSet *UnorderedSet_create(
     }
     return us;
 }
+
+const UnorderedSet *UnorderedSet_create(
+                              int (*cmpFn)(void*,void*),
+                              long (*hashFn)(void*,long),
+                              long capacity, double loadFactor
+) {
+    return UnorderedSet_createWithFlags(cmpFn, hashFn, capacity, loadFactor, 0);
+}
@@ -33,6 +33,7 @@
  */
 
 #include "iterator.h"			/* needed for factory method */
+#include "hashstats.h"
 
 /*
  * interface definition for generic unordered set implementation
@@ -49,7 +50,9 @@ typedef struct unorderedset UnorderedSet;  /* forward reference */
  * if loadFactor == 0.0, a default load factor (0.75) is used
  * if number of elements/number of buckets exceeds the load factor, the
  * table is resized, doubling the number of buckets, up to a max number
- * of buckets (134,217,728)
+ * of buckets (134,217,728); if it falls below a quarter of the load factor
+ * as elements are removed, the table is shrunk, but never below the
+ * initial capacity
  *
  * cmpFunction is used to determine equality between two objects, with
  * `cmpFunction(first, second)' returning 0 if first==second, <>0 otherwise
@@ -65,6 +68,77 @@ const UnorderedSet *UnorderedSet_create(
                        long capacity, double loadFactor
                       );
 
+/*
+ * flags that may be or'ed together and passed to
+ * UnorderedSet_createWithFlags()
+ *
+ * US_INCREMENTAL - when the table is resized, the elements are moved to the
+ *                  new bucket array a few buckets at a time by subsequent
+ *                  operations on the set, rather than all at once by the
+ *                  add() that triggered the resize; this keeps the worst
+ *                  case cost of an operation low for large sets
+ * US_FILTERED    - a Bloom filter (see bloomfilter.h) of the elements is
+ *                  kept beside the table, and is consulted before a chain
+ *                  is searched; an element that is absent is then usually
+ *                  rejected after touching one cache line, without calling
+ *                  cmpFunction or following any chain; this suits sets at
+ *                  which most lookups miss; the filter costs about 12 bits
+ *                  per element, and hashFunction is called a second time,
+ *                  with N = 2147483647, by each operation, and on every
+ *                  element when the filter is rebuilt, which happens when
+ *                  the table is resized or most of the elements added
+ *                  since it was last built have been removed
+ * US_POOLED      - entries are carved from 64 KiB slabs owned by the
+ *                  hashset, and those removed are kept on a free list for
+ *                  reuse by later adds, until trim() returns the slabs
+ *                  holding no entries to the heap; this saves a call to
+ *                  malloc() or free() for most adds and removes in a large
+ *                  hashset with much churn, but costs at least one slab, so
+ *                  it does not suit small hashsets
+ */
+#define US_INCREMENTAL 0x01
+#define US_FILTERED 0x02
+#define US_POOLED 0x04
+
+/*
+ * create a hashset as with UnorderedSet_create(), with its behavior
+ * modified by `flags'
+ *
+ * returns a pointer to the hashset, or NULL if there are malloc() errors
+ */
+const UnorderedSet *UnorderedSet_createWithFlags(
+                       int (*cmpFunction)(void *, void *),
+                       long (*hashFunction)(void *, long),
+                       long capacity, double loadFactor, int flags
+                      );
+
+/*
+ * create a hashset that uses open addressing instead of chaining, for
+ * elements whose hashes are expensive to compute; each slot of the table
+ * holds an element beside its full 64-bit hash, which is computed once,
+ * when the element is added, and is then used to place the element when
+ * the table is resized, so the hash function is never called on elements
+ * already in the set
+ *
+ * hashFunction returns a 64-bit hash of its argument; its bits need not be
+ * well mixed, but distinct elements should rarely share a hash, as
+ * cmpFunction is only called on elements whose hashes are equal
+ *
+ * cmpFunction is as for UnorderedSet_create()
+ *
+ * capacity is rounded up to a power of 2 (minimum of 16 slots);
+ * if loadFactor == 0.0, a default load factor (0.875) is used; load factors
+ * greater than 0.875 are reduced to 0.875; as for UnorderedSet_create(),
+ * the table shrinks when the load falls below a quarter of the load factor
+ *
+ * returns a pointer to the hashset, or NULL if there are malloc() errors
+ */
+const UnorderedSet *UnorderedSet_createFlat(
+                       int (*cmpFunction)(void *, void *),
+                       unsigned long long (*hashFunction)(void *),
+                       long capacity, double loadFactor
+                      );
+
 /*
  * now define struct unorderedset
  */
@@ -137,6 +211,66 @@ struct unorderedset {
  * returns pointer to the Iterator or NULL if failure
  */
     const Iterator *(*itCreate)(const UnorderedSet *us);
+
+/*
+ * with US_POOLED, entries removed from the hashset are kept on a free list
+ * for reuse by later adds rather than being returned to the heap; trim()
+ * returns the storage of those that are no longer needed to the heap
+ *
+ * returns the number of bytes returned to the heap, 0 without US_POOLED
+ */
+    long (*trim)(const UnorderedSet *us);
+
+/*
+ * resizes the table of the hashset to the smallest capacity that holds
+ * its current elements within the load factor, regardless of the capacity
+ * with which it was created; an incremental resize in progress is
+ * completed
+ *
+ * returns 1 if successful, 0 if malloc failure
+ */
+    int (*compact)(const UnorderedSet *us);
+
+/*
+ * fills in `*hs' with statistics describing the table of the hashset and
+ * the work done by its lookups and resizes; see hashstats.h
+ *
+ * the cost is proportional to the capacity of the table
+ */
+    void (*stats)(const UnorderedSet *us, HashStats *hs);
+
+/*
+ * set algebra: setUnion(), intersect() and difference() return a new
+ * hashset, of the same kind and with the same functions as `us', holding
+ * the elements in either set, in both sets, or in `us' but not in
+ * `other', respectively; when an element is in both sets, the one from
+ * `us' is used
+ *
+ * the elements are shared with the operands, not copied, so the result
+ * should be destroyed with a NULL freeFxn unless it owns its elements
+ *
+ * `other' may be any kind of UnorderedSet whose elements are compared by
+ * the same cmpFunction; when both sets are large and of the same kind, the
+ * work is divided among several threads, so cmpFunction and hashFunction
+ * must then be safe to call concurrently; the result is sized to hold its
+ * elements from the start, so it is never resized while it is built
+ *
+ * neither operand is modified, not even to advance an incremental resize
+ *
+ * each returns a pointer to the new hashset, or NULL if malloc() errors
+ */
+    const UnorderedSet *(*setUnion)(const UnorderedSet *us,
+                                    const UnorderedSet *other);
+    const UnorderedSet *(*intersect)(const UnorderedSet *us,
+                                     const UnorderedSet *other);
+    const UnorderedSet *(*difference)(const UnorderedSet *us,
+                                      const UnorderedSet *other);
+
+/*
+ * returns 1 if every element of `us' is also in `other', 0 if not,
+ * -1 if malloc() errors
+ */
+    int (*isSubset)(const UnorderedSet *us, const UnorderedSet *other);
 };
 
 #endif /* _UNORDEREDSET_H_ */
@@ -33,6 +33,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <unistd.h>
 
 static int scmp(void *a, void *b) {
     return strcmp((char *)a, (char *)b);
@@ -48,11 +49,97 @@ static long shash(void *s, long N) {
     return ans;
 }
 
+/*
+ * 64-bit FNV-1a hash and comparison for UnorderedSet_createFlat(); both
+ * count how often they are called
+ */
+static long hashCalls = 0L, cmpCalls = 0L;
+
+static unsigned long long fhash(void *s) {
+    unsigned long long ans = 0xcbf29ce484222325ULL;
+    char *sp;
+
+    hashCalls++;
+    for (sp = (char *)s; *sp != '\0'; sp++)
+        ans = (ans ^ (unsigned char)*sp) * 0x100000001b3ULL;
+    return ans;
+}
+
+static int fcmp(void *a, void *b) {
+    cmpCalls++;
+    return strcmp((char *)a, (char *)b);
+}
+
+/*
+ * prints the sizes of the union, intersection and difference of `a' and
+ * `b', and checks the subset relations among them and the operands
+ */
+static int algebra(const UnorderedSet *a, const UnorderedSet *b) {
+    const UnorderedSet *u, *in, *d;
+
+    u = a->setUnion(a, b);
+    in = a->intersect(a, b);
+    d = a->difference(a, b);
+    if (u == NULL || in == NULL || d == NULL) {
+        fprintf(stderr, "Error in set algebra\n");
+        return 0;
+    }
+    printf("union = %ld, intersect = %ld, difference = %ld\n", u->size(u),
+           in->size(in), d->size(d));
+    printf("isSubset: a of union = %d, intersect of b = %d, ",
+           a->isSubset(a, u), in->isSubset(in, b));
+    printf("a of b = %d, difference of b = %d\n", a->isSubset(a, b),
+           d->isSubset(d, b));
+    printf("union contains \"0\" = %d, \"249999\" = %d, \"250000\" = %d\n",
+           u->contains(u, "0"), u->contains(u, "249999"),
+           u->contains(u, "250000"));
+    u->destroy(u, NULL);
+    in->destroy(in, NULL);
+    d->destroy(d, NULL);
+    return 1;
+}
+
+/*
+ * returns the resident size of the process in bytes, or -1 if it cannot
+ * be determined
+ */
+static long residentBytes(void) {
+    FILE *fd = fopen("/proc/self/statm", "r");
+    long size, resident = -1L;
+
+    if (fd != NULL) {
+        if (fscanf(fd, "%ld %ld", &size, &resident) != 2)
+            resident = -1L;
+        fclose(fd);
+    }
+    return (resident < 0L) ? -1L : resident * sysconf(_SC_PAGESIZE);
+}
+
+/*
+ * prints the parts of `*hs' that do not depend on how the hash function
+ * spreads the keys, and checks that the rest are consistent
+ */
+static void printStats(HashStats *hs) {
+    long i, n;
+
+    printf("size = %ld, capacity = %ld, resizes = %ld\n", hs->size,
+           hs->capacity, hs->resizes);
+    for (i = 0, n = 0; i < HASHSTATS_BINS; i++)
+        n += hs->histogram[i];
+    printf("histogram consistent = %d, ", n == hs->occupied &&
+           hs->maxChain >= 1 && hs->occupied <= hs->size);
+    printf("meanChain consistent = %d, ", hs->meanChain >= 1.0 &&
+           hs->meanChain <= (double)hs->maxChain);
+    printf("lookup counters consistent = %d\n", hs->hits == -1L ||
+           (hs->hits >= hs->size && hs->probes >= hs->hits));
+}
+
 int main(int argc, char *argv[]) {
     char buf[1024];
     char *p;
     const UnorderedSet *us;
     long i, n;
+    HashStats hs;
     FILE *fd;
     const Iterator *it;
     void **array;
@@ -163,6 +250,281 @@ int main(int argc, char *argv[]) {
      */
     printf("===== test of destroy(free)\n");
     us->destroy(us, free);
+    /*
+     * test of incremental resizing
+     */
+    printf("===== test of US_INCREMENTAL\n");
+    if ((us = UnorderedSet_createWithFlags(scmp, shash, 1L, 0.0,
+                                   US_INCREMENTAL | US_POOLED)) == NULL) {
+        fprintf(stderr, "Error creating incremental hashset\n");
+        return -1;
+    }
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        if ((p = strdup(buf)) == NULL) {
+            fprintf(stderr, "Error duplicating string\n");
+            return -1;
+        }
+        if (!us->add(us, p)) {
+            fprintf(stderr, "Error adding %ld'th element\n", i);
+            return -1;
+        }
+    }
+    printf("Size after add = %ld\n", us->size(us));
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        if (!us->contains(us, buf)) {
+            fprintf(stderr, "Error finding %ld'th element\n", i);
+            return -1;
+        }
+    }
+    for (i = 0; i < 10000; i += 2) {
+        sprintf(buf, "%ld", i);
+        if (!us->remove(us, buf, free)) {
+            fprintf(stderr, "Error removing %ld'th element\n", i);
+            return -1;
+        }
+    }
+    printf("Size after remove = %ld\n", us->size(us));
+    if ((array = us->toArray(us, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking us->toArray()\n");
+        return -1;
+    }
+    printf("toArray length = %ld\n", n);
+    free(array);
+    /*
+     * test of trim()
+     */
+    printf("===== test of trim\n");
+    printf("trim() with half the elements removed returned storage: %s\n",
+           (us->trim(us) > 0L) ? "yes" : "no");
+    for (i = 1; i < 10000; i += 2) {
+        sprintf(buf, "%ld", i);
+        (void) us->remove(us, buf, free);
+    }
+    printf("trim() of empty set returned storage: %s\n",
+           (us->trim(us) > 0L) ? "yes" : "no");
+    printf("second trim() returned %ld\n", us->trim(us));
+    us->destroy(us, free);
+    /*
+     * test that small hashsets do not each pay for slabs of entries
+     */
+    printf("===== test of footprint of small hashsets\n");
+    {
+        const UnorderedSet **sets;
+        long before, after;
+
+        if ((sets = (const UnorderedSet **)malloc(10000 *
+                                    sizeof(UnorderedSet *))) == NULL) {
+            fprintf(stderr, "Error allocating array of hashsets\n");
+            return -1;
+        }
+        before = residentBytes();
+        for (i = 0; i < 10000; i++) {
+            if ((sets[i] = UnorderedSet_create(scmp, shash, 0L, 0.0))
+                == NULL) {
+                fprintf(stderr, "Error creating %ld'th small hashset\n", i);
+                return -1;
+            }
+            (void) sets[i]->add(sets[i], "one");
+        }
+        after = residentBytes();
+        printf("10000 one-element hashsets resident in under 32 MiB: %s\n",
+               (before < 0L || after < 0L || after - before < 32L << 20) ?
+               "yes" : "no");
+        for (i = 0; i < 10000; i++)
+            sets[i]->destroy(sets[i], NULL);
+        free(sets);
+    }
+    /*
+     * test of shrinking as elements are removed, and of compact()
+     */
+    printf("===== test of shrinking and compact\n");
+    if ((us = UnorderedSet_createWithFlags(scmp, shash, 0L, 0.0,
+                                           US_INCREMENTAL)) == NULL) {
+        fprintf(stderr, "Error creating hashset for compact\n");
+        return -1;
+    }
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) us->add(us, strdup(buf));
+    }
+    us->stats(us, &hs);
+    printf("Capacity after adds = %ld\n", hs.capacity);
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        if (i % 100 != 0 && !us->remove(us, buf, free))
+            fprintf(stderr, "Error removing %s\n", buf);
+    }
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    us->stats(us, &hs);
+    printf("Size after removes = %ld, %ld elements found, capacity = %ld\n",
+           us->size(us), n, hs.capacity);
+    printf("compact() returned %d\n", us->compact(us));
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    us->stats(us, &hs);
+    printf("Size after compact = %ld, %ld elements found, capacity = %ld\n",
+           us->size(us), n, hs.capacity);
+    us->destroy(us, free);
+    /*
+     * test of stats()
+     */
+    printf("===== test of stats\n");
+    if ((us = UnorderedSet_create(scmp, shash, 0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating hashset for stats\n");
+        return -1;
+    }
+    for (i = 0; i < 1000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) us->add(us, strdup(buf));
+        (void) us->contains(us, buf);
+    }
+    us->stats(us, &hs);
+    printStats(&hs);
+    us->destroy(us, free);
+    /*
+     * test of UnorderedSet_createFlat(); the hash function must be called
+     * once per operation, however often the table is resized, and cmp
+     * only on elements whose hashes match
+     */
+    printf("===== test of UnorderedSet_createFlat\n");
+    if ((us = UnorderedSet_createFlat(fcmp, fhash, 0L, 0.0)) == NULL) {
+        fprintf(stderr, "Error creating flat hashset\n");
+        return -1;
+    }
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        if ((p = strdup(buf)) == NULL || !us->add(us, p)) {
+            fprintf(stderr, "Error adding %ld'th element\n", i);
+            return -1;
+        }
+    }
+    printf("Size after add = %ld, ", us->size(us));
+    printf("add(\"42\") = %d\n", us->add(us, "42"));
+    for (i = 0, n = 0; i < 200000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    printf("%ld elements found\n", n);
+    for (i = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        if (i % 100 != 0 && !us->remove(us, buf, free))
+            fprintf(stderr, "Error removing %s\n", buf);
+    }
+    us->stats(us, &hs);
+    printf("Size after remove = %ld, capacity = %ld, ", us->size(us),
+           hs.capacity);
+    printf("compact() returned %d\n", us->compact(us));
+    for (i = 0, n = 0; i < 100000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    us->stats(us, &hs);
+    printf("Size after compact = %ld, %ld elements found, capacity = %ld\n",
+           us->size(us), n, hs.capacity);
+    printf("resizes = %ld, ", hs.resizes);
+    printf("hash calls = %ld, cmp calls = %ld\n", hashCalls, cmpCalls);
+    if ((array = us->toArray(us, &n)) == NULL) {
+        fprintf(stderr, "Error in invoking us->toArray()\n");
+        return -1;
+    }
+    printf("toArray length = %ld\n", n);
+    free(array);
+    us->clear(us, free);
+    printf("Size after clear = %ld, isEmpty = %d\n", us->size(us),
+           us->isEmpty(us));
+    us->destroy(us, free);
+    /*
+     * test of set algebra; a holds 0..149999 and b 100000..249999, which
+     * is large enough for chained hashsets to use several threads
+     */
+    printf("===== test of setUnion/intersect/difference/isSubset\n");
+    {
+        const UnorderedSet *a, *b, *fa, *fb;
+        char **s = (char **)malloc(250000 * sizeof(char *));
+
+        a = UnorderedSet_createWithFlags(scmp, shash, 0L, 0.0, US_INCREMENTAL);
+        b = UnorderedSet_create(scmp, shash, 0L, 0.0);
+        fa = UnorderedSet_createFlat(fcmp, fhash, 0L, 0.0);
+        fb = UnorderedSet_createFlat(fcmp, fhash, 0L, 0.0);
+        if (s == NULL || a == NULL || b == NULL || fa == NULL || fb == NULL) {
+            fprintf(stderr, "Error creating sets for set algebra\n");
+            return -1;
+        }
+        for (i = 0; i < 250000; i++) {
+            sprintf(buf, "%ld", i);
+            if ((s[i] = strdup(buf)) == NULL) {
+                fprintf(stderr, "Error duplicating %ld\n", i);
+                return -1;
+            }
+            if (i < 150000) {
+                (void) a->add(a, s[i]);
+                (void) fa->add(fa, s[i]);
+            }
+            if (i >= 100000) {
+                (void) b->add(b, s[i]);
+                (void) fb->add(fb, s[i]);
+            }
+        }
+        printf("chained with chained:\n");
+        if (!algebra(a, b))
+            return -1;
+        printf("chained with flat:\n");
+        if (!algebra(a, fb))
+            return -1;
+        printf("flat with chained:\n");
+        if (!algebra(fa, b))
+            return -1;
+        hashCalls = 0L;
+        printf("flat with flat:\n");
+        if (!algebra(fa, fb))
+            return -1;
+        printf("hash calls = %ld\n", hashCalls);
+        a->destroy(a, NULL);
+        b->destroy(b, NULL);
+        fa->destroy(fa, NULL);
+        fb->destroy(fb, NULL);
+        for (i = 0; i < 250000; i++)
+            free(s[i]);
+        free(s);
+    }
+    /*
+     * test of US_FILTERED; most lookups that miss must not reach cmp
+     */
+    printf("===== test of US_FILTERED\n");
+    if ((us = UnorderedSet_createWithFlags(fcmp, shash, 0L, 0.0,
+                                           US_FILTERED)) == NULL) {
+        fprintf(stderr, "Error creating filtered hashset\n");
+        return -1;
+    }
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        (void) us->add(us, strdup(buf));
+    }
+    cmpCalls = 0L;
+    for (i = 10000, n = 0; i < 110000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    printf("size = %ld, %ld of 100000 absent found, ", us->size(us), n);
+    printf("cmp calls below 2000 = %d\n", cmpCalls < 2000L);
+    for (i = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        if (i % 10 != 0)
+            (void) us->remove(us, buf, free);
+    }
+    for (i = 0, n = 0; i < 10000; i++) {
+        sprintf(buf, "%ld", i);
+        n += us->contains(us, buf);
+    }
+    printf("size after remove = %ld, %ld found\n", us->size(us), n);
+    us->destroy(us, free);
 
     return 0;
 }
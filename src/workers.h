@@ -0,0 +1,86 @@
+#ifndef _WORKERS_H_
+#define _WORKERS_H_
+
+/*
+ * Copyright (c) 2017, University of Oregon
+ * All rights reserved.
+
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+
+ * - Redistributions of source code must retain the above copyright notice,
+ *   this list of conditions and the following disclaimer.
+ *
+ * - Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * - Neither the name of the University of Oregon nor the names of its
+ *   contributors may be used to endorse or promote products derived from this
+ *   software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ */
+
+/*
+ * private helpers for dividing the work of an operation among a few
+ * threads; they are not installed with the public headers
+ */
+
+#include <pthread.h>
+#include <stddef.h>
+#include <unistd.h>
+
+#define WORKERS_MAX 8	/* most threads used by one operation */
+
+/*
+ * returns the number of workers among which to divide `n' items, so that
+ * each has at least `share' of them; it is at least 1, and at most the
+ * number of processors online or WORKERS_MAX
+ */
+static inline long workers_count(long n, long share) {
+    long nw = sysconf(_SC_NPROCESSORS_ONLN);
+
+    if (nw > WORKERS_MAX)
+        nw = WORKERS_MAX;
+    if (nw > n / share)
+        nw = n / share;
+    if (nw < 1L)
+        nw = 1L;
+    return nw;
+}
+
+/*
+ * calls fn() on each of the `nw' jobs, `size' bytes apart from `jobs'
+ * onwards, returning once all of them are done; job 0, and any job for
+ * which a thread cannot be created, is run by the calling thread, the
+ * others on threads of their own
+ */
+static inline void workers_run(void *(*fn)(void *), void *jobs, size_t size,
+                               long nw) {
+    pthread_t threads[WORKERS_MAX];
+    int started[WORKERS_MAX];
+    long i;
+
+    for (i = 0L; i < nw; i++)
+        started[i] = (i > 0L && pthread_create(&threads[i], NULL, fn,
+                                               (char *)jobs + i * size) == 0);
+    for (i = 0L; i < nw; i++)
+        if (! started[i])
+            (void) fn((char *)jobs + i * size);
+    for (i = 0L; i < nw; i++)
+        if (started[i])
+            pthread_join(threads[i], NULL);
+}
+
+#endif /* _WORKERS_H_ */